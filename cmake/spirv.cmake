@@ -0,0 +1,19 @@
+# ${CMAKE_SOURCE_DIR}/cmake/spirv.cmake
+find_program(GLSLANG_VALIDATOR glslangValidator)
+if(NOT GLSLANG_VALIDATOR)
+  message(FATAL_ERROR "ENABLE_SPIRV needs glslangValidator")
+endif()
+
+# spirv_shader(<output> <source> <stage>): compiles a GLSL file to SPIR-V for OpenGL, stage is vert or frag.
+# A shader that does not compile fails the build.
+function(spirv_shader output source stage)
+  get_filename_component(directory ${output} DIRECTORY)
+  add_custom_command(
+    OUTPUT ${output}
+    COMMAND ${CMAKE_COMMAND} -E make_directory ${directory}
+    COMMAND ${GLSLANG_VALIDATOR} -G -S ${stage} -o ${output} ${source}
+    DEPENDS ${source}
+    COMMENT "Compiling ${source} to SPIR-V"
+    VERBATIM
+  )
+endfunction()
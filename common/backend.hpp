@@ -0,0 +1,53 @@
+#pragma once
+// STL
+#include <string>
+#include <cstdlib>
+#include <iostream>
+#include <algorithm>
+#include <string_view>
+
+// Set DEMO_BACKEND=<window|headless|software>, or pass --backend <name>, to choose where a demo renders:
+// - window:   the GL window, the default
+// - headless: GL into an offscreen framebuffer of a hidden window, every frame read back into memory
+// - software: the port of the demo to the software renderer (mimicOpenGL) into memory, no GL driver at all
+// Without a window nobody closes the demo, it stops after BENCHMARK_FRAMES=<N> frames (default 300).
+enum class Backend { WINDOW, HEADLESS, SOFTWARE };
+
+inline auto backendName(Backend backend) -> const char * {
+  switch(backend) {
+  case Backend::WINDOW: return "window";
+  case Backend::HEADLESS: return "headless";
+  case Backend::SOFTWARE: return "software";
+  }
+  return "window";
+}
+
+inline auto parseBackend(std::string_view name) -> Backend {
+  for(const auto backend : {Backend::WINDOW, Backend::HEADLESS, Backend::SOFTWARE}) {
+    if(name == backendName(backend)) {
+      return backend;
+    }
+  }
+  std::cerr << "Unknown backend \"" << name << "\", using window\n";
+  return Backend::WINDOW;
+}
+
+// Removes --backend <name> from the arguments so the demo parses the rest as before, it wins over DEMO_BACKEND.
+inline auto selectBackend(int &argc, char *argv[]) -> Backend {
+  const auto *pName = std::getenv("DEMO_BACKEND");
+  auto backend = pName != nullptr ? parseBackend(pName) : Backend::WINDOW;
+  for(int i = 1; i + 1 < argc; ++i) {
+    if(std::string_view(argv[i]) == "--backend") {
+      backend = parseBackend(argv[i + 1]);
+      std::copy(argv + i + 2, argv + argc + 1, argv + i);
+      argc -= 2;
+      break;
+    }
+  }
+  return backend;
+}
+
+inline auto headlessFrames() -> std::size_t {
+  const auto *pFrames = std::getenv("BENCHMARK_FRAMES");
+  return pFrames != nullptr ? static_cast<std::size_t>(std::max(1, std::atoi(pFrames))) : 300U;
+}
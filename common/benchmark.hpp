@@ -0,0 +1,105 @@
+#pragma once
+// STL
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <utility>
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+// POSIX
+#if defined(__linux__)
+#  include <sys/resource.h>
+#endif
+
+// Set BENCHMARK_OUTPUT=<file.json> to record startup time, frame times and peak memory, and
+// BENCHMARK_FRAMES=<N> to stop the demo after N frames (default 300).
+inline const char *gBenchmarkOutput = std::getenv("BENCHMARK_OUTPUT");
+inline const char *gBenchmarkFrames = std::getenv("BENCHMARK_FRAMES");
+
+class BenchmarkRecorder final {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  explicit BenchmarkRecorder(std::string name) : mName(std::move(name)) {
+    if(gBenchmarkOutput == nullptr) {
+      return;
+    }
+    mFrames = gBenchmarkFrames != nullptr ? static_cast<std::size_t>(std::max(1, std::atoi(gBenchmarkFrames))) : 300U;
+    mFrameTimes.reserve(mFrames);
+  }
+
+  ~BenchmarkRecorder() { write(); }
+
+  BenchmarkRecorder(const BenchmarkRecorder &) = delete;
+  BenchmarkRecorder &operator=(const BenchmarkRecorder &) = delete;
+
+  [[nodiscard]] auto enabled() const -> bool { return gBenchmarkOutput != nullptr; }
+
+  // Swap interval the demo should use, benchmarks must not be capped by vsync.
+  [[nodiscard]] auto swapInterval(int interval) const -> int { return enabled() ? 0 : interval; }
+
+  void beginLoad() { mLoadStart = Clock::now(); }
+
+  void endLoad() { mLoadTime = milliseconds(Clock::now() - mLoadStart); }
+
+  void beginFrame() { mFrameStart = Clock::now(); }
+
+  void endFrame() {
+    if(!enabled()) {
+      return;
+    }
+    mFrameTimes.push_back(milliseconds(Clock::now() - mFrameStart));
+  }
+
+  [[nodiscard]] auto finished() const -> bool { return enabled() && mFrameTimes.size() >= mFrames; }
+
+  void write() {
+    if(!enabled() || mbWritten) {
+      return;
+    }
+    mbWritten = true;
+
+    std::ofstream output(gBenchmarkOutput);
+    if(!output.is_open()) {
+      std::cerr << "Can not write benchmark \"" << gBenchmarkOutput << "\"\n";
+      return;
+    }
+    output << std::setprecision(9);
+    output << "{\n";
+    output << "  \"name\": \"" << mName << "\",\n";
+    output << "  \"loadTimeMs\": " << mLoadTime << ",\n";
+    output << "  \"peakMemoryBytes\": " << peakMemory() << ",\n";
+    output << "  \"frameTimesMs\": [";
+    for(std::size_t i = 0; i < mFrameTimes.size(); ++i) {
+      output << (i == 0 ? "" : ", ") << mFrameTimes[i];
+    }
+    output << "]\n}\n";
+  }
+
+private:
+  static auto milliseconds(Clock::duration duration) -> double {
+    return std::chrono::duration<double, std::milli>(duration).count();
+  }
+
+  static auto peakMemory() -> long {
+#if defined(__linux__)
+    rusage usage{};
+    if(getrusage(RUSAGE_SELF, &usage) == 0) {
+      constexpr auto kilobyte = 1024L;
+      return usage.ru_maxrss * kilobyte;
+    }
+#endif
+    return 0;
+  }
+
+  std::string mName;
+  std::size_t mFrames = 0;
+  std::vector<double> mFrameTimes;
+  double mLoadTime = 0;
+  Clock::time_point mLoadStart;
+  Clock::time_point mFrameStart;
+  bool mbWritten = false;
+};
@@ -0,0 +1,84 @@
+#pragma once
+// STL
+#include <array>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <utility>
+#include <iostream>
+#include <algorithm>
+// POSIX
+#if defined(__linux__)
+#  include <unistd.h>
+#  include <sys/inotify.h>
+#endif
+
+// Set SHADER_HOT_RELOAD to watch the shader directories of a demo (Linux): poll() returns the files written since the
+// last call, so the demo can rebuild the programs that use them between two frames.
+inline const char *const gShaderHotReload = std::getenv("SHADER_HOT_RELOAD");
+
+class FileWatcher final {
+public:
+  // Watches the directory rather than its files, editors save by writing a new file and renaming it over the old one.
+  explicit FileWatcher(std::string directory) : mDirectory(std::move(directory)) {
+#if defined(__linux__)
+    if(gShaderHotReload == nullptr) {
+      return;
+    }
+    mFile = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if(mFile < 0 || inotify_add_watch(mFile, mDirectory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+      std::cerr << "Can not watch \"" << mDirectory << "\"\n";
+      return;
+    }
+    mbEnabled = true;
+    std::cout << "Watching \"" << mDirectory << "\" for shader changes\n";
+#endif
+  }
+
+  ~FileWatcher() {
+#if defined(__linux__)
+    if(mFile >= 0) {
+      close(mFile);
+    }
+#endif
+  }
+
+  FileWatcher(const FileWatcher &) = delete;
+  FileWatcher &operator=(const FileWatcher &) = delete;
+
+  [[nodiscard]] auto enabled() const -> bool { return mbEnabled; }
+
+  // Paths, `directory/name`, of the files written or moved into the directory since the last call, each once.
+  // Never blocks.
+  auto poll() -> std::vector<std::string> {
+    std::vector<std::string> files;
+#if defined(__linux__)
+    if(!mbEnabled) {
+      return files;
+    }
+    alignas(inotify_event) std::array<char, 4096> events{};
+    for(;;) {
+      const auto size = read(mFile, events.data(), events.size());
+      if(size <= 0) {
+        break;
+      }
+      for(auto offset = std::size_t{0}; offset < static_cast<std::size_t>(size);) {
+        const auto *pEvent = reinterpret_cast<const inotify_event *>(events.data() + offset);
+        if(pEvent->len > 0) {
+          auto file = mDirectory + '/' + pEvent->name;
+          if(std::find(files.begin(), files.end(), file) == files.end()) {
+            files.push_back(std::move(file));
+          }
+        }
+        offset += sizeof(inotify_event) + pEvent->len;
+      }
+    }
+#endif
+    return files;
+  }
+
+private:
+  std::string mDirectory;
+  bool mbEnabled = false;
+  int mFile = -1;
+};
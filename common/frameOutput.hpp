@@ -0,0 +1,308 @@
+#pragma once
+// STL
+#include <array>
+#include <deque>
+#include <mutex>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <algorithm>
+#include <string_view>
+#include <condition_variable>
+// common
+#include <common/memoryLedger.hpp>
+
+// Set FRAME_OUTPUT to hand every frame of the headless and software backends to a writer thread:
+// - a file name with one frame number, `%d` or zero padded to N digits by `%0Nd`, as in `frames/%05d.ppm` or
+//   `frames/%05d.png`, writes an image sequence
+// - `|<command>` streams raw top-down RGBA8 frames into the standard input of the command, for example
+//   FRAME_OUTPUT='|ffmpeg -y -f rawvideo -pixel_format rgba -video_size 640x480 -i - demo.mp4'
+// FRAME_QUEUE=<N> (default 3) frames can wait for the writer. Once all of them do, push() waits for the writer,
+// so slow I/O throttles rendering instead of growing memory. The time rendering waited is printed at exit. An empty
+// FRAME_OUTPUT writes nothing. The memory ledger counts the queued frames as staging.
+inline const char *const gFrameOutput = std::getenv("FRAME_OUTPUT");
+
+class FrameOutput final {
+public:
+  FrameOutput(int width, int height) : mWidth(static_cast<std::size_t>(width)), mHeight(static_cast<std::size_t>(height)) {
+    if(gFrameOutput == nullptr || *gFrameOutput == '\0') {
+      return;
+    }
+    const std::string_view output = gFrameOutput;
+    if(output.front() == '|') {
+      mpPipe = openPipe(gFrameOutput + 1);
+      if(mpPipe == nullptr) {
+        std::cerr << "Can not run \"" << output.substr(1) << "\"\n";
+        return;
+      }
+    } else if(!parseFileName(output)) {
+      std::cerr << "FRAME_OUTPUT \"" << output << "\" needs one frame number, %d or %0Nd\n";
+      return;
+    }
+    mbPng = output.size() > 4 && output.substr(output.size() - 4) == ".png";
+    const auto *pQueue = std::getenv("FRAME_QUEUE");
+    const auto buffers = pQueue != nullptr ? static_cast<std::size_t>(std::max(1, std::atoi(pQueue))) : 3U;
+    mBuffers.assign(buffers, std::vector<std::uint32_t>(mWidth * mHeight));
+    gMemoryLedger.allocate(MemoryCategory::STAGING, queueBytes());
+    for(std::size_t i = 0; i < buffers; ++i) {
+      mFree.push_back(i);
+    }
+    mWriter = std::thread([this] { run(); });
+  }
+
+  // Writes the frames still queued.
+  ~FrameOutput() {
+    if(!enabled()) {
+      return;
+    }
+    {
+      std::lock_guard lock(mMutex);
+      mbStopping = true;
+    }
+    mQueued.notify_one();
+    mWriter.join();
+    if(mpPipe != nullptr) {
+      closePipe(mpPipe);
+    }
+    gMemoryLedger.release(MemoryCategory::STAGING, queueBytes());
+    std::cout << "Frame output: " << mWritten << " frames to " << gFrameOutput << ", rendering waited "
+              << std::chrono::duration<double, std::milli>(mWaited).count() << " ms for the writer, writing took "
+              << (mWritten > 0 ? std::chrono::duration<double, std::milli>(mWriting).count() / static_cast<double>(mWritten) : 0.)
+              << " ms per frame\n";
+  }
+
+  FrameOutput(const FrameOutput &) = delete;
+  FrameOutput &operator=(const FrameOutput &) = delete;
+
+  [[nodiscard]] auto enabled() const -> bool { return mWriter.joinable(); }
+
+  // Copies a frame of RGBA8 pixels, rows `stride` pixels apart and bottom-up like glReadPixels when `bBottomUp`,
+  // into a free buffer and queues it. Waits only while every buffer is queued.
+  void push(const std::uint32_t *pPixels, std::size_t stride, bool bBottomUp) {
+    if(!enabled()) {
+      return;
+    }
+    std::size_t buffer = 0;
+    {
+      std::unique_lock lock(mMutex);
+      if(mFree.empty()) {
+        const auto start = Clock::now();
+        mFreed.wait(lock, [this] { return !mFree.empty(); });
+        mWaited += Clock::now() - start;
+      }
+      buffer = mFree.front();
+      mFree.pop_front();
+    }
+    auto &frame = mBuffers[buffer];
+    for(std::size_t y = 0; y < mHeight; ++y) {
+      const auto row = bBottomUp ? mHeight - 1 - y : y;
+      std::memcpy(frame.data() + y * mWidth, pPixels + row * stride, mWidth * sizeof(std::uint32_t));
+    }
+    {
+      std::lock_guard lock(mMutex);
+      mQueue.push_back(buffer);
+    }
+    mQueued.notify_one();
+  }
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  [[nodiscard]] auto queueBytes() const -> std::size_t { return mBuffers.size() * mWidth * mHeight * sizeof(std::uint32_t); }
+
+  void run() {
+    for(std::size_t index = 0;; ++index) {
+      std::size_t buffer = 0;
+      {
+        std::unique_lock lock(mMutex);
+        mQueued.wait(lock, [this] { return !mQueue.empty() || mbStopping; });
+        if(mQueue.empty()) {
+          return;
+        }
+        buffer = mQueue.front();
+        mQueue.pop_front();
+      }
+      const auto start = Clock::now();
+      if(write(mBuffers[buffer], index)) {
+        ++mWritten;
+      }
+      mWriting += Clock::now() - start;
+      {
+        std::lock_guard lock(mMutex);
+        mFree.push_back(buffer);
+      }
+      mFreed.notify_one();
+    }
+  }
+
+  auto write(const std::vector<std::uint32_t> &frame, std::size_t index) -> bool {
+    if(mpPipe != nullptr) {
+      return std::fwrite(frame.data(), sizeof(std::uint32_t), frame.size(), mpPipe) == frame.size();
+    }
+    const auto number = std::to_string(index);
+    const auto fileName = mPrefix + std::string(mDigits > number.size() ? mDigits - number.size() : 0, '0') + number + mSuffix;
+    auto *pFile = std::fopen(fileName.c_str(), "wb");
+    if(pFile == nullptr) {
+      std::cerr << "Can not write \"" << fileName << "\"\n";
+      return false;
+    }
+    const auto bytes = mbPng ? png(frame) : ppm(frame);
+    const auto bWritten = std::fwrite(bytes.data(), 1, bytes.size(), pFile) == bytes.size();
+    return std::fclose(pFile) == 0 && bWritten;
+  }
+
+  // Splits `frames/%05d.ppm` around its frame number, which is the only `%` allowed.
+  auto parseFileName(std::string_view fileName) -> bool {
+    const auto percent = fileName.find('%');
+    if(percent == std::string_view::npos) {
+      return false;
+    }
+    auto conversion = fileName.substr(percent + 1);
+    std::size_t digits = 0;
+    if(!conversion.empty() && conversion.front() == '0') {
+      const auto width = conversion.find_first_not_of("0123456789");
+      if(width == std::string_view::npos || width == 1) {
+        return false;
+      }
+      digits = static_cast<std::size_t>(std::atoi(std::string(conversion.substr(1, width - 1)).c_str()));
+      conversion.remove_prefix(width);
+    }
+    if(conversion.empty() || conversion.front() != 'd' || conversion.find('%') != std::string_view::npos) {
+      return false;
+    }
+    mPrefix = fileName.substr(0, percent);
+    mSuffix = conversion.substr(1);
+    mDigits = std::min<std::size_t>(digits, 32);
+    return true;
+  }
+
+  // RGB rows, the alpha of the framebuffer is dropped like the PPM does.
+  void rgb(const std::vector<std::uint32_t> &frame, std::size_t y, std::vector<std::uint8_t> &bytes) const {
+    for(std::size_t x = 0; x < mWidth; ++x) {
+      const auto pixel = frame[y * mWidth + x];
+      bytes.insert(bytes.end(), {static_cast<std::uint8_t>(pixel), static_cast<std::uint8_t>(pixel >> 8U),
+                                 static_cast<std::uint8_t>(pixel >> 16U)});
+    }
+  }
+
+  auto ppm(const std::vector<std::uint32_t> &frame) const -> std::vector<std::uint8_t> {
+    const auto header = "P6\n" + std::to_string(mWidth) + " " + std::to_string(mHeight) + "\n255\n";
+    std::vector<std::uint8_t> bytes(header.begin(), header.end());
+    bytes.reserve(header.size() + frame.size() * 3);
+    for(std::size_t y = 0; y < mHeight; ++y) {
+      rgb(frame, y, bytes);
+    }
+    return bytes;
+  }
+
+  // Stored, not compressed: the writer keeps up with rendering and any PNG reader opens it. Re-encode for size.
+  auto png(const std::vector<std::uint32_t> &frame) const -> std::vector<std::uint8_t> {
+    std::vector<std::uint8_t> rows;
+    rows.reserve(mHeight * (1 + mWidth * 3));
+    for(std::size_t y = 0; y < mHeight; ++y) {
+      rows.push_back(0); // no filter
+      rgb(frame, y, rows);
+    }
+    std::vector<std::uint8_t> zlib = {0x78, 0x01};
+    std::uint32_t a = 1;
+    std::uint32_t b = 0;
+    // Deflate blocks of at most 65535 bytes, stored as they are.
+    for(std::size_t offset = 0; offset < rows.size();) {
+      const auto size = std::min<std::size_t>(rows.size() - offset, 0xFFFF);
+      const auto bLast = offset + size == rows.size();
+      zlib.insert(zlib.end(), {static_cast<std::uint8_t>(bLast ? 1 : 0), static_cast<std::uint8_t>(size),
+                               static_cast<std::uint8_t>(size >> 8U), static_cast<std::uint8_t>(~size),
+                               static_cast<std::uint8_t>(~size >> 8U)});
+      zlib.insert(zlib.end(), rows.begin() + static_cast<std::ptrdiff_t>(offset),
+                  rows.begin() + static_cast<std::ptrdiff_t>(offset + size));
+      offset += size;
+    }
+    for(const auto byte : rows) {
+      a = (a + byte) % 65521U;
+      b = (b + a) % 65521U;
+    }
+    appendBigEndian(zlib, (b << 16U) | a);
+
+    std::vector<std::uint8_t> bytes = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    std::vector<std::uint8_t> header;
+    appendBigEndian(header, static_cast<std::uint32_t>(mWidth));
+    appendBigEndian(header, static_cast<std::uint32_t>(mHeight));
+    header.insert(header.end(), {8, 2, 0, 0, 0}); // 8 bit RGB
+    chunk(bytes, "IHDR", header);
+    chunk(bytes, "IDAT", zlib);
+    chunk(bytes, "IEND", {});
+    return bytes;
+  }
+
+  static auto openPipe(const char *pCommand) -> std::FILE * {
+#if defined(_WIN32)
+    return _popen(pCommand, "wb");
+#else
+    return popen(pCommand, "w");
+#endif
+  }
+
+  static void closePipe(std::FILE *pPipe) {
+#if defined(_WIN32)
+    _pclose(pPipe);
+#else
+    pclose(pPipe);
+#endif
+  }
+
+  static void appendBigEndian(std::vector<std::uint8_t> &bytes, std::uint32_t value) {
+    bytes.insert(bytes.end(), {static_cast<std::uint8_t>(value >> 24U), static_cast<std::uint8_t>(value >> 16U),
+                               static_cast<std::uint8_t>(value >> 8U), static_cast<std::uint8_t>(value)});
+  }
+
+  static void chunk(std::vector<std::uint8_t> &bytes, const char *pType, const std::vector<std::uint8_t> &data) {
+    static const auto table = [] {
+      std::array<std::uint32_t, 256> crcs{};
+      for(std::uint32_t i = 0; i < crcs.size(); ++i) {
+        auto crc = i;
+        for(int bit = 0; bit < 8; ++bit) {
+          crc = (crc & 1U) != 0 ? 0xEDB88320U ^ (crc >> 1U) : crc >> 1U;
+        }
+        crcs[i] = crc;
+      }
+      return crcs;
+    }();
+    appendBigEndian(bytes, static_cast<std::uint32_t>(data.size()));
+    const auto start = bytes.size();
+    bytes.insert(bytes.end(), pType, pType + 4);
+    bytes.insert(bytes.end(), data.begin(), data.end());
+    auto crc = 0xFFFFFFFFU;
+    for(auto i = start; i < bytes.size(); ++i) {
+      crc = table[(crc ^ bytes[i]) & 0xFFU] ^ (crc >> 8U);
+    }
+    appendBigEndian(bytes, crc ^ 0xFFFFFFFFU);
+  }
+
+  std::size_t mWidth;
+  std::size_t mHeight;
+  bool mbPng = false;
+  // The file name around the frame number, zero padded to mDigits.
+  std::string mPrefix;
+  std::string mSuffix;
+  std::size_t mDigits = 0;
+  std::FILE *mpPipe = nullptr;
+  // Buffers are free, queued or owned by one side, the indices move between the lists under the mutex.
+  std::vector<std::vector<std::uint32_t>> mBuffers;
+  std::deque<std::size_t> mFree;
+  std::deque<std::size_t> mQueue;
+  std::mutex mMutex;
+  std::condition_variable mQueued;
+  std::condition_variable mFreed;
+  bool mbStopping = false;
+  std::thread mWriter;
+  // Written by the writer thread, read after joining it.
+  std::size_t mWritten = 0;
+  Clock::duration mWriting{};
+  Clock::duration mWaited{};
+};
@@ -0,0 +1,204 @@
+#pragma once
+// STL
+#include <array>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+#include <ostream>
+#include <iomanip>
+#include <algorithm>
+#include <unordered_map>
+// glbinding
+#include <glbinding/gl/gl.h>
+#include <glbinding/Value.h>
+#include <glbinding/Binding.h>
+#include <glbinding/glbinding.h>
+#include <glbinding/FunctionCall.h>
+#include <glbinding/CallbackMask.h>
+#include <glbinding/AbstractFunction.h>
+
+// Set GL_CALL_STATISTICS=<N> to count every GL call and print the N most frequent ones at exit.
+inline const char *gCallStatistics = std::getenv("GL_CALL_STATISTICS");
+
+class GLCallStatistics final {
+public:
+  GLCallStatistics() {
+    if(gCallStatistics == nullptr) {
+      return;
+    }
+    mTopN = static_cast<std::size_t>(std::max(1, std::atoi(gCallStatistics)));
+    install();
+  }
+
+  ~GLCallStatistics() {
+    if(mbInstalled) {
+      glbinding::setCallbackMask(glbinding::CallbackMask::None);
+      glbinding::setAfterCallback(nullptr);
+    }
+  }
+
+  GLCallStatistics(const GLCallStatistics &) = delete;
+  GLCallStatistics &operator=(const GLCallStatistics &) = delete;
+
+  [[nodiscard]] auto enabled() const -> bool { return mbInstalled; }
+
+  void beginFrame() {
+    mbInFrame = true;
+  }
+
+  void endFrame() {
+    mbInFrame = false;
+    if(!mbInstalled) {
+      return;
+    }
+    ++mFrames;
+    for(auto &[pFunction, entry] : mEntries) {
+      entry.total += entry.frame;
+      entry.peak = std::max(entry.peak, entry.frame);
+      entry.frame = 0;
+    }
+    mUploadedBytes += mFrameUploadedBytes;
+    mPeakFrameUploadedBytes = std::max(mPeakFrameUploadedBytes, mFrameUploadedBytes);
+    mFrameUploadedBytes = 0;
+  }
+
+  void report(std::ostream &output) const {
+    if(!mbInstalled) {
+      return;
+    }
+    const auto frames = std::max<std::size_t>(mFrames, 1);
+
+    std::vector<const Entry *> entries;
+    entries.reserve(mEntries.size());
+    std::size_t callsPerFrame = 0;
+    for(const auto &[pFunction, entry] : mEntries) {
+      entries.push_back(&entry);
+      callsPerFrame += entry.total;
+    }
+    std::sort(std::begin(entries), std::end(entries), [](const Entry *pLeft, const Entry *pRight) {
+      return pLeft->total + pLeft->setup > pRight->total + pRight->setup;
+    });
+
+    output << "\nGL calls: " << mFrames << " frames, " << static_cast<double>(callsPerFrame) / static_cast<double>(frames)
+           << " calls/frame\n";
+    output << std::left << std::setw(36) << "  function" << std::right << std::setw(12) << "calls/frame" << std::setw(12)
+           << "peak" << std::setw(12) << "setup" << '\n';
+    for(std::size_t i = 0; i < std::min(mTopN, entries.size()); ++i) {
+      const auto &entry = *entries[i];
+      output << "  " << std::left << std::setw(34) << entry.pName << std::right << std::setw(12)
+             << static_cast<double>(entry.total) / static_cast<double>(frames) << std::setw(12) << entry.peak << std::setw(12)
+             << entry.setup << '\n';
+    }
+
+    output << "Uploaded: " << mSetupUploadedBytes << " bytes at setup, " << mUploadedBytes / frames
+           << " bytes/frame (peak " << mPeakFrameUploadedBytes << ")\n";
+
+    bool bHeader = false;
+    for(const auto *pEntry : entries) {
+      if(!pEntry->bSynchronous || pEntry->total == 0) {
+        continue;
+      }
+      if(!bHeader) {
+        output << "Synchronous calls inside the frame loop:\n";
+        bHeader = true;
+      }
+      output << "  " << std::left << std::setw(34) << pEntry->pName << std::right << std::setw(12)
+             << static_cast<double>(pEntry->total) / static_cast<double>(frames) << " calls/frame\n";
+    }
+  }
+
+private:
+  struct Entry {
+    const char *pName = nullptr;
+    bool bSynchronous = false;
+    std::size_t frame = 0;
+    std::size_t total = 0;
+    std::size_t peak = 0;
+    std::size_t setup = 0;
+  };
+
+  // Index of the size parameter of every function that uploads into a buffer object.
+  struct Upload {
+    glbinding::AbstractFunction *pFunction;
+    std::size_t sizeIndex;
+    std::size_t dataIndex;
+  };
+
+  void install() {
+    using glbinding::CallbackMask;
+    // Only the upload functions need their parameters, everything else is counted by name.
+    glbinding::setCallbackMask(CallbackMask::After);
+    for(const auto &upload : mUploads) {
+      upload.pFunction->setCallbackMask(CallbackMask::After | CallbackMask::Parameters);
+    }
+    glbinding::setAfterCallback([this](const glbinding::FunctionCall &call) { record(call); });
+    mbInstalled = true;
+  }
+
+  void record(const glbinding::FunctionCall &call) {
+    auto [iterator, bInserted] = mEntries.try_emplace(call.function);
+    auto &entry = iterator->second;
+    if(bInserted) {
+      entry.pName = call.function->name();
+      entry.bSynchronous = isSynchronous(entry.pName);
+    }
+    if(mbInFrame) {
+      ++entry.frame;
+    } else {
+      ++entry.setup;
+    }
+
+    const auto upload = std::find_if(std::cbegin(mUploads), std::cend(mUploads), [&call](const Upload &current) {
+      return current.pFunction == call.function;
+    });
+    if(upload == std::cend(mUploads) || call.parameters.size() <= upload->sizeIndex) {
+      return;
+    }
+    const auto *pSize = dynamic_cast<const glbinding::Value<gl::GLsizeiptr> *>(&*call.parameters[upload->sizeIndex]);
+    const auto *pData = dynamic_cast<const glbinding::Value<const void *> *>(&*call.parameters[upload->dataIndex]);
+    if(pSize == nullptr || (pData != nullptr && pData->value() == nullptr)) {
+      return;
+    }
+    (mbInFrame ? mFrameUploadedBytes : mSetupUploadedBytes) += static_cast<std::size_t>(pSize->value());
+  }
+
+  static auto isSynchronous(const char *pName) -> bool {
+    constexpr std::array synchronousPrefixes = {
+      "glGetQueryObject",
+      "glGetQueryBufferObject",
+      "glGetUniformLocation",
+      "glGetAttribLocation",
+      "glGetUniformBlockIndex",
+      "glGetProgramResource",
+      "glGetError",
+      "glGetBufferSubData",
+      "glGetNamedBufferSubData",
+      "glGetTexImage",
+      "glReadPixels",
+      "glClientWaitSync",
+      "glFinish",
+    };
+    return std::any_of(std::cbegin(synchronousPrefixes), std::cend(synchronousPrefixes), [pName](const char *pPrefix) {
+      return std::strncmp(pName, pPrefix, std::strlen(pPrefix)) == 0;
+    });
+  }
+
+  const std::array<Upload, 6> mUploads = {{
+    {&glbinding::Binding::BufferData, 1, 2},
+    {&glbinding::Binding::BufferSubData, 2, 3},
+    {&glbinding::Binding::BufferStorage, 1, 2},
+    {&glbinding::Binding::NamedBufferData, 1, 2},
+    {&glbinding::Binding::NamedBufferSubData, 2, 3},
+    {&glbinding::Binding::NamedBufferStorage, 1, 2},
+  }};
+
+  std::unordered_map<const glbinding::AbstractFunction *, Entry> mEntries;
+  std::size_t mTopN = 0;
+  std::size_t mFrames = 0;
+  std::size_t mUploadedBytes = 0;
+  std::size_t mFrameUploadedBytes = 0;
+  std::size_t mPeakFrameUploadedBytes = 0;
+  std::size_t mSetupUploadedBytes = 0;
+  bool mbInstalled = false;
+  bool mbInFrame = false;
+};
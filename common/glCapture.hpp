@@ -0,0 +1,158 @@
+#pragma once
+// STL
+#include <array>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+// glbinding
+#include <glbinding/glbinding.h>
+#include <glbinding/CallbackMask.h>
+#include <glbinding/AbstractFunction.h>
+// common
+#include <common/glCaptureFormat.hpp>
+
+// Set GL_CAPTURE=<file> to record the GL command stream, buffer and uniform data included, for tools/glReplay.
+// It replaces the glbinding callback, GL_CALL_STATISTICS is ignored while capturing.
+inline const char *gCapture = std::getenv("GL_CAPTURE");
+
+class GLCapture final {
+public:
+  GLCapture() {
+    if(gCapture == nullptr) {
+      return;
+    }
+    mOutput.open(gCapture, std::ios::binary);
+    if(!mOutput.is_open()) {
+      std::cerr << "Can not write capture \"" << gCapture << "\"\n";
+      return;
+    }
+
+    const auto functions = capture::capturedFunctions();
+    mOutput.write(capture::gMagic.data(), capture::gMagic.size());
+    write(capture::gVersion);
+    write(static_cast<std::uint32_t>(functions.size()));
+    for(std::size_t i = 0; i < functions.size(); ++i) {
+      const auto *pName = functions[i].pFunction->name();
+      const auto length = static_cast<std::uint16_t>(std::strlen(pName));
+      write(length);
+      mOutput.write(pName, length);
+      mFunctions.emplace(functions[i].pFunction, Entry{static_cast<std::uint16_t>(i), functions[i]});
+    }
+
+    glbinding::setCallbackMask(glbinding::CallbackMask::After | glbinding::CallbackMask::ParametersAndReturnValue);
+    glbinding::setAfterCallback([this](const glbinding::FunctionCall &call) { record(call); });
+    mbInstalled = true;
+  }
+
+  ~GLCapture() {
+    if(mbInstalled) {
+      glbinding::setCallbackMask(glbinding::CallbackMask::None);
+      glbinding::setAfterCallback(nullptr);
+      std::cout << "\nCaptured " << mCalls << " calls, " << mFrames << " frames into \"" << gCapture << "\"\n";
+    }
+  }
+
+  GLCapture(const GLCapture &) = delete;
+  GLCapture &operator=(const GLCapture &) = delete;
+
+  [[nodiscard]] auto enabled() const -> bool { return mbInstalled; }
+
+  // Marks the end of a frame, call it right after swapping buffers.
+  void frame() {
+    if(!mbInstalled) {
+      return;
+    }
+    write(capture::Record::FRAME);
+    ++mFrames;
+  }
+
+private:
+  struct Entry {
+    std::uint16_t index;
+    capture::CapturedFunction function;
+  };
+
+  template<typename T>
+  void write(const T &value) {
+    mOutput.write(reinterpret_cast<const char *>(&value), sizeof(T));
+  }
+
+  void writePayload(const void *pData, std::size_t size) {
+    if(pData == nullptr) {
+      write(capture::gNullPayload);
+      return;
+    }
+    write(static_cast<std::uint32_t>(size));
+    mOutput.write(static_cast<const char *>(pData), static_cast<std::streamsize>(size));
+  }
+
+  void record(const glbinding::FunctionCall &call) {
+    const auto found = mFunctions.find(call.function);
+    if(found == std::end(mFunctions)) {
+      skip(call.function->name());
+      return;
+    }
+    const auto &[index, function] = found->second;
+    capture::RawArguments arguments{};
+    std::uint64_t result = 0;
+    const auto count = function.encode(call, arguments, result);
+
+    write(capture::Record::CALL);
+    write(index);
+    write(count);
+    mOutput.write(reinterpret_cast<const char *>(arguments.data()), static_cast<std::streamsize>(count * sizeof(std::uint64_t)));
+    write(result);
+
+    const auto &layout = function.layout;
+    const auto *pPointer = capture::fromRaw<const void *>(arguments[layout.pointer]);
+    switch(layout.payload) {
+    case capture::Payload::NONE: break;
+    case capture::Payload::DATA:
+    case capture::Payload::INPUT_NAMES:
+    case capture::Payload::OUTPUT_NAMES: writePayload(pPointer, capture::payloadBytes(layout, arguments)); break;
+    case capture::Payload::STRING: {
+      const auto *pString = static_cast<const char *>(pPointer);
+      writePayload(pString, pString != nullptr ? std::strlen(pString) + 1 : 0);
+      break;
+    }
+    case capture::Payload::SOURCES: {
+      // glShaderSource(shader, count, strings, lengths) is stored as one concatenated string.
+      const auto *pStrings = static_cast<const char *const *>(pPointer);
+      const auto *pLengths = capture::fromRaw<const gl::GLint *>(arguments[layout.pointer + 1]);
+      const auto count = static_cast<std::size_t>(std::max(capture::fromRaw<gl::GLsizei>(arguments[layout.count]), 0));
+      std::string source;
+      for(std::size_t i = 0; i < count; ++i) {
+        const auto length = pLengths != nullptr && pLengths[i] >= 0 ? static_cast<std::size_t>(pLengths[i]) : std::strlen(pStrings[i]);
+        source.append(pStrings[i], length);
+      }
+      writePayload(source.c_str(), source.size() + 1);
+      break;
+    }
+    }
+    ++mCalls;
+  }
+
+  void skip(const char *pName) {
+    constexpr std::array ignoredPrefixes = {"glGet",          "glIs",          "glDebugMessage", "glPushDebugGroup",
+                                            "glPopDebugGroup", "glObjectLabel", "glFinish",       "glFlush"};
+    const bool bIgnored = std::any_of(std::cbegin(ignoredPrefixes), std::cend(ignoredPrefixes), [pName](const char *pPrefix) {
+      return std::strncmp(pName, pPrefix, std::strlen(pPrefix)) == 0;
+    });
+    if(!bIgnored && mWarned.insert(pName).second) {
+      std::cerr << "GL_CAPTURE: " << pName << " is not captured, the replay may differ\n";
+    }
+  }
+
+  std::ofstream mOutput;
+  std::unordered_map<const glbinding::AbstractFunction *, Entry> mFunctions;
+  std::unordered_set<std::string> mWarned;
+  std::size_t mCalls = 0;
+  std::size_t mFrames = 0;
+  bool mbInstalled = false;
+};
@@ -0,0 +1,249 @@
+#pragma once
+// STL
+#include <array>
+#include <tuple>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <type_traits>
+// glbinding
+#include <glbinding/gl/gl.h>
+#include <glbinding/Value.h>
+#include <glbinding/Binding.h>
+#include <glbinding/Function.h>
+#include <glbinding/FunctionCall.h>
+
+// Binary GL command stream shared by GLCapture (common/glCapture.hpp) and tools/glReplay.cpp.
+//
+// file   := magic version functionCount {u16 length, name}* record*
+// record := CALL u16 function u8 argumentCount u64 argument* u64 result [u32 payloadSize payload]
+//         | FRAME
+//
+// Every argument is stored as the raw bytes of its C type, pointers included. Functions with a
+// pointer to data append the data as payload; object names are remapped by the replayer.
+namespace capture {
+
+constexpr std::array<char, 8> gMagic = {'G', 'L', 'C', 'A', 'P', 'T', 'U', 'R'};
+constexpr std::uint32_t gVersion = 1;
+constexpr std::size_t gMaxArguments = 8;
+constexpr std::uint32_t gNullPayload = 0xFFFFFFFFU;
+constexpr std::size_t gNoCount = gMaxArguments;
+
+enum class Record : std::uint8_t { CALL, FRAME };
+
+// GL object name spaces the replayer has to translate, shaders and programs share one.
+enum class Namespace : std::uint8_t { NONE, BUFFER, VERTEX_ARRAY, PROGRAM, PIPELINE, QUERY, LOCATION, COUNT };
+
+enum class Payload : std::uint8_t { NONE, DATA, STRING, SOURCES, INPUT_NAMES, OUTPUT_NAMES };
+
+using RawArguments = std::array<std::uint64_t, gMaxArguments>;
+
+struct CallLayout {
+  std::array<Namespace, gMaxArguments> arguments{};
+  Payload payload = Payload::NONE;
+  std::size_t pointer = 0;      // argument holding the payload pointer
+  std::size_t count = gNoCount; // argument multiplying `bytes`, gNoCount for a fixed size
+  std::size_t bytes = 0;
+  Namespace payloadNames = Namespace::NONE;
+  Namespace result = Namespace::NONE;
+
+  [[nodiscard]] constexpr auto name(std::size_t argument, Namespace space) const -> CallLayout {
+    auto layout = *this;
+    layout.arguments[argument] = space;
+    return layout;
+  }
+
+  [[nodiscard]] constexpr auto data(std::size_t argument, std::size_t countArgument, std::size_t elementBytes) const -> CallLayout {
+    return with(Payload::DATA, argument, countArgument, elementBytes, Namespace::NONE);
+  }
+
+  [[nodiscard]] constexpr auto string(std::size_t argument) const -> CallLayout {
+    return with(Payload::STRING, argument, gNoCount, 0, Namespace::NONE);
+  }
+
+  [[nodiscard]] constexpr auto sources() const -> CallLayout { return with(Payload::SOURCES, 2, 1, 0, Namespace::NONE); }
+
+  [[nodiscard]] constexpr auto inputNames(std::size_t argument, std::size_t countArgument, Namespace space) const -> CallLayout {
+    return with(Payload::INPUT_NAMES, argument, countArgument, sizeof(gl::GLuint), space);
+  }
+
+  [[nodiscard]] constexpr auto outputNames(std::size_t argument, std::size_t countArgument, Namespace space) const -> CallLayout {
+    return with(Payload::OUTPUT_NAMES, argument, countArgument, sizeof(gl::GLuint), space);
+  }
+
+  [[nodiscard]] constexpr auto returns(Namespace space) const -> CallLayout {
+    auto layout = *this;
+    layout.result = space;
+    return layout;
+  }
+
+private:
+  [[nodiscard]] constexpr auto with(Payload kind, std::size_t argument, std::size_t countArgument, std::size_t elementBytes, Namespace space) const
+    -> CallLayout {
+    auto layout = *this;
+    layout.payload = kind;
+    layout.pointer = argument;
+    layout.count = countArgument;
+    layout.bytes = elementBytes;
+    layout.payloadNames = space;
+    return layout;
+  }
+};
+
+template<typename T>
+auto toRaw(const T &value) -> std::uint64_t {
+  static_assert(sizeof(T) <= sizeof(std::uint64_t) && std::is_trivially_copyable_v<T>, "GL argument does not fit a raw slot");
+  std::uint64_t raw = 0;
+  std::memcpy(&raw, &value, sizeof(T));
+  return raw;
+}
+
+template<typename T>
+auto fromRaw(std::uint64_t raw) -> T {
+  T value{};
+  std::memcpy(&value, &raw, sizeof(T));
+  return value;
+}
+
+// Payload size in bytes of a DATA, INPUT_NAMES or OUTPUT_NAMES call.
+inline auto payloadBytes(const CallLayout &layout, const RawArguments &arguments) -> std::size_t {
+  if(layout.count == gNoCount) {
+    return layout.bytes;
+  }
+  // Counts are GLsizei or GLsizeiptr, only the low 32 bits of a GLsizei slot are meaningful.
+  const auto count = static_cast<std::int64_t>(arguments[layout.count] & 0xFFFFFFFFU);
+  return count > 0 ? static_cast<std::size_t>(count) * layout.bytes : 0;
+}
+
+using Encoder = std::uint8_t (*)(const glbinding::FunctionCall &, RawArguments &, std::uint64_t &);
+using Invoker = std::uint64_t (*)(glbinding::AbstractFunction &, const RawArguments &);
+
+struct CapturedFunction {
+  glbinding::AbstractFunction *pFunction;
+  CallLayout layout;
+  Encoder encode;
+  Invoker invoke;
+};
+
+namespace detail {
+
+template<typename ReturnType, typename... Arguments, std::size_t... Indices>
+auto encode(const glbinding::FunctionCall &call, RawArguments &arguments, std::uint64_t &result, std::index_sequence<Indices...>)
+  -> std::uint8_t {
+  ((arguments[Indices] = toRaw(static_cast<const glbinding::Value<Arguments> &>(*call.parameters[Indices]).value())), ...);
+  if constexpr(!std::is_void_v<ReturnType>) {
+    result = call.returnValue ? toRaw(static_cast<const glbinding::Value<ReturnType> &>(*call.returnValue).value()) : 0;
+  }
+  return static_cast<std::uint8_t>(sizeof...(Arguments));
+}
+
+template<typename ReturnType, typename... Arguments, std::size_t... Indices>
+auto invoke(glbinding::Function<ReturnType, Arguments...> &function, const RawArguments &raw, std::index_sequence<Indices...>)
+  -> std::uint64_t {
+  auto arguments = std::make_tuple(fromRaw<Arguments>(raw[Indices])...);
+  if constexpr(std::is_void_v<ReturnType>) {
+    function(std::get<Indices>(arguments)...);
+    return 0;
+  } else {
+    return toRaw(function(std::get<Indices>(arguments)...));
+  }
+}
+
+} // namespace detail
+
+template<typename ReturnType, typename... Arguments>
+auto entry(glbinding::Function<ReturnType, Arguments...> &function, const CallLayout &layout = {}) -> CapturedFunction {
+  static_assert(sizeof...(Arguments) <= gMaxArguments, "Too many GL arguments");
+  using Indices = std::index_sequence_for<Arguments...>;
+  return {&function,
+          layout,
+          [](const glbinding::FunctionCall &call, RawArguments &arguments, std::uint64_t &result) -> std::uint8_t {
+            if(call.parameters.size() != sizeof...(Arguments)) {
+              return 0;
+            }
+            return detail::encode<ReturnType, Arguments...>(call, arguments, result, Indices{});
+          },
+          [](glbinding::AbstractFunction &abstractFunction, const RawArguments &arguments) -> std::uint64_t {
+            auto &typed = static_cast<glbinding::Function<ReturnType, Arguments...> &>(abstractFunction);
+            return detail::invoke(typed, arguments, Indices{});
+          }};
+}
+
+// The GL subset the demos use. Getters, query results and debug markers are not part of the stream. Timer queries
+// are, so a replay pays for them like the demo did. glProgramBinary replays the binary of the capturing driver, a
+// replay on another driver needs a capture without PROGRAM_CACHE.
+inline auto capturedFunctions() -> std::vector<CapturedFunction> {
+  using glbinding::Binding;
+  constexpr CallLayout plain;
+  return {
+    entry(Binding::GenBuffers, plain.outputNames(1, 0, Namespace::BUFFER)),
+    entry(Binding::CreateBuffers, plain.outputNames(1, 0, Namespace::BUFFER)),
+    entry(Binding::DeleteBuffers, plain.inputNames(1, 0, Namespace::BUFFER)),
+    entry(Binding::BindBuffer, plain.name(1, Namespace::BUFFER)),
+    entry(Binding::BindBufferBase, plain.name(2, Namespace::BUFFER)),
+    entry(Binding::BufferData, plain.data(2, 1, 1)),
+    entry(Binding::BufferSubData, plain.data(3, 2, 1)),
+    entry(Binding::NamedBufferData, plain.name(0, Namespace::BUFFER).data(2, 1, 1)),
+    entry(Binding::NamedBufferStorage, plain.name(0, Namespace::BUFFER).data(2, 1, 1)),
+    entry(Binding::NamedBufferSubData, plain.name(0, Namespace::BUFFER).data(3, 2, 1)),
+
+    entry(Binding::GenVertexArrays, plain.outputNames(1, 0, Namespace::VERTEX_ARRAY)),
+    entry(Binding::CreateVertexArrays, plain.outputNames(1, 0, Namespace::VERTEX_ARRAY)),
+    entry(Binding::DeleteVertexArrays, plain.inputNames(1, 0, Namespace::VERTEX_ARRAY)),
+    entry(Binding::BindVertexArray, plain.name(0, Namespace::VERTEX_ARRAY)),
+    entry(Binding::VertexAttribPointer),
+    entry(Binding::EnableVertexAttribArray),
+    entry(Binding::DisableVertexAttribArray),
+    entry(Binding::VertexArrayVertexBuffer, plain.name(0, Namespace::VERTEX_ARRAY).name(2, Namespace::BUFFER)),
+    entry(Binding::VertexArrayElementBuffer, plain.name(0, Namespace::VERTEX_ARRAY).name(1, Namespace::BUFFER)),
+    entry(Binding::VertexArrayAttribFormat, plain.name(0, Namespace::VERTEX_ARRAY)),
+    entry(Binding::VertexArrayAttribBinding, plain.name(0, Namespace::VERTEX_ARRAY)),
+    entry(Binding::EnableVertexArrayAttrib, plain.name(0, Namespace::VERTEX_ARRAY)),
+
+    entry(Binding::CreateShader, plain.returns(Namespace::PROGRAM)),
+    entry(Binding::ShaderSource, plain.name(0, Namespace::PROGRAM).sources()),
+    entry(Binding::CompileShader, plain.name(0, Namespace::PROGRAM)),
+    entry(Binding::DeleteShader, plain.name(0, Namespace::PROGRAM)),
+    entry(Binding::CreateProgram, plain.returns(Namespace::PROGRAM)),
+    entry(Binding::AttachShader, plain.name(0, Namespace::PROGRAM).name(1, Namespace::PROGRAM)),
+    entry(Binding::ProgramParameteri, plain.name(0, Namespace::PROGRAM)),
+    entry(Binding::ProgramBinary, plain.name(0, Namespace::PROGRAM).data(2, 3, 1)),
+    entry(Binding::LinkProgram, plain.name(0, Namespace::PROGRAM)),
+    entry(Binding::UseProgram, plain.name(0, Namespace::PROGRAM)),
+    entry(Binding::DeleteProgram, plain.name(0, Namespace::PROGRAM)),
+    entry(Binding::UniformBlockBinding, plain.name(0, Namespace::PROGRAM)),
+    entry(Binding::GetUniformLocation, plain.name(0, Namespace::PROGRAM).string(1).returns(Namespace::LOCATION)),
+    entry(Binding::CreateProgramPipelines, plain.outputNames(1, 0, Namespace::PIPELINE)),
+    entry(Binding::DeleteProgramPipelines, plain.inputNames(1, 0, Namespace::PIPELINE)),
+    entry(Binding::UseProgramStages, plain.name(0, Namespace::PIPELINE).name(2, Namespace::PROGRAM)),
+    entry(Binding::BindProgramPipeline, plain.name(0, Namespace::PIPELINE)),
+
+    entry(Binding::GenQueries, plain.outputNames(1, 0, Namespace::QUERY)),
+    entry(Binding::DeleteQueries, plain.inputNames(1, 0, Namespace::QUERY)),
+    entry(Binding::BeginQuery, plain.name(1, Namespace::QUERY)),
+    entry(Binding::EndQuery),
+    entry(Binding::QueryCounter, plain.name(0, Namespace::QUERY)),
+
+    entry(Binding::Uniform1i, plain.name(0, Namespace::LOCATION)),
+    entry(Binding::Uniform1f, plain.name(0, Namespace::LOCATION)),
+    entry(Binding::Uniform3fv, plain.name(0, Namespace::LOCATION).data(2, 1, 3 * sizeof(float))),
+    entry(Binding::Uniform4fv, plain.name(0, Namespace::LOCATION).data(2, 1, 4 * sizeof(float))),
+    entry(Binding::UniformMatrix3fv, plain.name(0, Namespace::LOCATION).data(3, 1, 9 * sizeof(float))),
+    entry(Binding::UniformMatrix4fv, plain.name(0, Namespace::LOCATION).data(3, 1, 16 * sizeof(float))),
+
+    entry(Binding::Enable),
+    entry(Binding::Disable),
+    entry(Binding::DepthFunc),
+    entry(Binding::PolygonMode),
+    entry(Binding::PointSize),
+    entry(Binding::Viewport),
+    entry(Binding::ClearColor),
+    entry(Binding::ClearBufferfv, plain.data(2, gNoCount, 4 * sizeof(float))),
+    entry(Binding::Clear),
+    entry(Binding::DrawArrays),
+    entry(Binding::DrawElements),
+  };
+}
+
+} // namespace capture
@@ -0,0 +1,22 @@
+#pragma once
+// STL
+#include <cstdint>
+#include <string_view>
+
+// FNV-1a 64 of the bytes, continuing from `value`. constexpr so keys of literals can be hashed at compile time.
+constexpr auto fnv1a(std::string_view bytes, std::uint64_t value = 0xCBF29CE484222325ULL) -> std::uint64_t {
+  for(const auto byte : bytes) {
+    value ^= static_cast<unsigned char>(byte);
+    value *= 0x100000001B3ULL;
+  }
+  return value;
+}
+
+// FNV-1a 64 of the eight bytes of `word`, lowest first, continuing from `value`: mixes hashes into a hash.
+constexpr auto fnv1a(std::uint64_t word, std::uint64_t value) -> std::uint64_t {
+  for(unsigned shift = 0; shift < 64; shift += 8) {
+    value ^= (word >> shift) & 0xFFU;
+    value *= 0x100000001B3ULL;
+  }
+  return value;
+}
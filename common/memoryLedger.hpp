@@ -0,0 +1,86 @@
+#pragma once
+// STL
+#include <map>
+#include <array>
+#include <string>
+#include <cstdlib>
+#include <ostream>
+#include <iomanip>
+#include <algorithm>
+
+// Set RELEASE_MESH_SOURCE to drop the CPU copies of the meshes once they live in GL buffers.
+inline const bool gReleaseMeshSource = std::getenv("RELEASE_MESH_SOURCE") != nullptr;
+// Set MEMORY_REPORT to print the ledger at exit, the demos also print it when 'M' is pressed.
+inline const bool gMemoryReport = std::getenv("MEMORY_REPORT") != nullptr;
+
+// MESH_SOURCE: the CPU copies of the meshes, STAGING: frames read back and queued for FRAME_OUTPUT, TRANSIENT: the
+// importer's copy while a file loads.
+enum class MemoryCategory : std::size_t { MESH_SOURCE, STAGING, TRANSIENT, COUNT };
+
+// Book keeping of what the demos allocate, CPU bytes by category and GPU buffer bytes by owner.
+class MemoryLedger final {
+public:
+  void allocate(MemoryCategory category, std::size_t bytes) {
+    auto &counter = mCpu[static_cast<std::size_t>(category)];
+    counter.add(bytes);
+    mCpuTotal.add(bytes);
+  }
+
+  void release(MemoryCategory category, std::size_t bytes) {
+    mCpu[static_cast<std::size_t>(category)].remove(bytes);
+    mCpuTotal.remove(bytes);
+  }
+
+  void allocateGpu(const std::string &owner, std::size_t bytes) {
+    mGpu[owner].add(bytes);
+    mGpuTotal.add(bytes);
+  }
+
+  void releaseGpu(const std::string &owner, std::size_t bytes) {
+    mGpu[owner].remove(bytes);
+    mGpuTotal.remove(bytes);
+  }
+
+  [[nodiscard]] auto cpuBytes() const -> std::size_t { return mCpuTotal.current; }
+  [[nodiscard]] auto gpuBytes() const -> std::size_t { return mGpuTotal.current; }
+
+  void report(std::ostream &output) const {
+    constexpr std::array categories = {"mesh source", "staging", "transient"};
+
+    const auto row = [&output](const char *pIndent, const std::string &label, const Counter &counter, int width) {
+      output << pIndent << std::left << std::setw(width) << label << std::right << std::setw(14) << counter.current << std::setw(14)
+             << counter.peak << '\n';
+    };
+
+    output << '\n' << std::left << std::setw(24) << "Memory" << std::right << std::setw(14) << "current" << std::setw(14) << "peak"
+           << '\n';
+    row("  ", "CPU", mCpuTotal, 22);
+    for(std::size_t i = 0; i < categories.size(); ++i) {
+      row("    ", categories[i], mCpu[i], 20);
+    }
+    row("  ", "GPU", mGpuTotal, 22);
+    for(const auto &[owner, counter] : mGpu) {
+      row("    ", owner, counter, 20);
+    }
+  }
+
+private:
+  struct Counter {
+    std::size_t current = 0;
+    std::size_t peak = 0;
+
+    void add(std::size_t bytes) {
+      current += bytes;
+      peak = std::max(peak, current);
+    }
+
+    void remove(std::size_t bytes) { current -= std::min(current, bytes); }
+  };
+
+  std::array<Counter, static_cast<std::size_t>(MemoryCategory::COUNT)> mCpu{};
+  std::map<std::string, Counter> mGpu;
+  Counter mCpuTotal;
+  Counter mGpuTotal;
+};
+
+inline MemoryLedger gMemoryLedger;
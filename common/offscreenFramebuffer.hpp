@@ -0,0 +1,154 @@
+#pragma once
+// STL
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <optional>
+// glbinding
+#include <glbinding/gl/gl.h>
+// SDL2
+#include <SDL2/SDL.h>
+// common
+#include <common/backend.hpp>
+#include <common/frameOutput.hpp>
+#include <common/memoryLedger.hpp>
+
+// Render target of the headless backend: a framebuffer object with color and depth renderbuffers, bound once after
+// the context is created and never unbound, so the demo draws into it unchanged. swap() reads the frame back into
+// memory instead of presenting it, through two pixel pack buffers so frame N is copied while frame N + 1 renders.
+// Every frame read back goes to FRAME_OUTPUT when it is set. With the window backend it is idle and swap() swaps the
+// window. The memory ledger counts the read back copy as staging and the pack buffers as GPU bytes.
+class OffscreenFramebuffer final {
+public:
+  OffscreenFramebuffer(Backend backend, int width, int height)
+    : mbEnabled(backend == Backend::HEADLESS), mWidth(width), mHeight(height) {
+    if(!mbEnabled) {
+      return;
+    }
+    mFrames = headlessFrames();
+    mPixels.resize(static_cast<std::size_t>(width) * static_cast<std::size_t>(height));
+    gMemoryLedger.allocate(MemoryCategory::STAGING, frameBytes());
+
+    gl::glGenRenderbuffers(static_cast<gl::GLsizei>(mRenderbuffers.size()), mRenderbuffers.data());
+    gl::glBindRenderbuffer(gl::GL_RENDERBUFFER, mRenderbuffers[0]);
+    gl::glRenderbufferStorage(gl::GL_RENDERBUFFER, gl::GL_RGBA8, width, height);
+    gl::glBindRenderbuffer(gl::GL_RENDERBUFFER, mRenderbuffers[1]);
+    gl::glRenderbufferStorage(gl::GL_RENDERBUFFER, gl::GL_DEPTH24_STENCIL8, width, height);
+    gl::glBindRenderbuffer(gl::GL_RENDERBUFFER, 0);
+
+    gl::glGenFramebuffers(1, &mFramebuffer);
+    gl::glBindFramebuffer(gl::GL_FRAMEBUFFER, mFramebuffer);
+    gl::glFramebufferRenderbuffer(gl::GL_FRAMEBUFFER, gl::GL_COLOR_ATTACHMENT0, gl::GL_RENDERBUFFER, mRenderbuffers[0]);
+    gl::glFramebufferRenderbuffer(gl::GL_FRAMEBUFFER, gl::GL_DEPTH_STENCIL_ATTACHMENT, gl::GL_RENDERBUFFER, mRenderbuffers[1]);
+    if(gl::glCheckFramebufferStatus(gl::GL_FRAMEBUFFER) != gl::GL_FRAMEBUFFER_COMPLETE) {
+      std::cerr << "Offscreen framebuffer is incomplete\n";
+    }
+    gl::glViewport(0, 0, width, height);
+
+    gl::glGenBuffers(static_cast<gl::GLsizei>(mPackBuffers.size()), mPackBuffers.data());
+    for(const auto buffer : mPackBuffers) {
+      gl::glBindBuffer(gl::GL_PIXEL_PACK_BUFFER, buffer);
+      gl::glBufferData(gl::GL_PIXEL_PACK_BUFFER, static_cast<gl::GLsizeiptr>(frameBytes()), nullptr, gl::GL_STREAM_READ);
+      gMemoryLedger.allocateGpu(gPackBuffersOwner, frameBytes());
+    }
+    gl::glBindBuffer(gl::GL_PIXEL_PACK_BUFFER, 0);
+    mOutput.emplace(width, height);
+    std::cout << "Rendering " << mFrames << " frames of " << width << "x" << height << " offscreen\n";
+  }
+
+  ~OffscreenFramebuffer() { finish(); }
+
+  OffscreenFramebuffer(const OffscreenFramebuffer &) = delete;
+  OffscreenFramebuffer &operator=(const OffscreenFramebuffer &) = delete;
+
+  [[nodiscard]] auto enabled() const -> bool { return mbEnabled; }
+
+  // Window flags for SDL_CreateWindow, the headless window is never shown.
+  [[nodiscard]] static auto windowFlags(Backend backend) -> Uint32 {
+    Uint32 flags = SDL_WINDOW_OPENGL;
+    if(backend == Backend::HEADLESS) {
+      flags |= SDL_WINDOW_HIDDEN;
+    }
+    return flags;
+  }
+
+  void swap(SDL_Window *pWindow) {
+    if(!mbEnabled) {
+      SDL_GL_SwapWindow(pWindow);
+      return;
+    }
+    const auto current = mPackBuffers[mRendered % mPackBuffers.size()];
+    const auto previous = mPackBuffers[(mRendered + 1) % mPackBuffers.size()];
+    gl::glBindBuffer(gl::GL_PIXEL_PACK_BUFFER, current);
+    gl::glReadPixels(0, 0, mWidth, mHeight, gl::GL_RGBA, gl::GL_UNSIGNED_BYTE, nullptr);
+    if(mRendered > 0) {
+      gl::glBindBuffer(gl::GL_PIXEL_PACK_BUFFER, previous);
+      copy();
+    }
+    gl::glBindBuffer(gl::GL_PIXEL_PACK_BUFFER, 0);
+    ++mRendered;
+  }
+
+  [[nodiscard]] auto finished() const -> bool { return mbEnabled && mRendered >= mFrames; }
+
+  // Writes out the last frame and deletes the GL objects. Call it before SDL_GL_DeleteContext, it needs the context.
+  void finish() {
+    if(!mbEnabled) {
+      return;
+    }
+    // The last frame is still in its pack buffer.
+    if(mOutput->enabled() && mRendered > 0) {
+      (void)pixels();
+    }
+    mOutput.reset();
+    gl::glBindFramebuffer(gl::GL_FRAMEBUFFER, 0);
+    gl::glDeleteFramebuffers(1, &mFramebuffer);
+    gl::glDeleteRenderbuffers(static_cast<gl::GLsizei>(mRenderbuffers.size()), mRenderbuffers.data());
+    gl::glDeleteBuffers(static_cast<gl::GLsizei>(mPackBuffers.size()), mPackBuffers.data());
+    gMemoryLedger.releaseGpu(gPackBuffersOwner, mPackBuffers.size() * frameBytes());
+    gMemoryLedger.release(MemoryCategory::STAGING, frameBytes());
+    mbEnabled = false;
+  }
+
+  // The last frame read back, bottom-up RGBA8 like glReadPixels.
+  [[nodiscard]] auto pixels() -> const std::vector<std::uint32_t> & {
+    if(mbEnabled && mRendered > 0) {
+      gl::glBindBuffer(gl::GL_PIXEL_PACK_BUFFER, mPackBuffers[(mRendered - 1) % mPackBuffers.size()]);
+      copy();
+      gl::glBindBuffer(gl::GL_PIXEL_PACK_BUFFER, 0);
+    }
+    return mPixels;
+  }
+
+private:
+  static constexpr auto gPackBuffersOwner = "pixel pack buffers";
+
+  [[nodiscard]] auto frameBytes() const -> std::size_t { return mPixels.size() * sizeof(std::uint32_t); }
+
+  // Frames go to the output once, when their pack buffer is first copied.
+  void copy() {
+    const auto *pMapped = gl::glMapBuffer(gl::GL_PIXEL_PACK_BUFFER, gl::GL_READ_ONLY);
+    if(pMapped != nullptr) {
+      std::memcpy(mPixels.data(), pMapped, frameBytes());
+      if(mCopied < mRendered) {
+        mOutput->push(mPixels.data(), static_cast<std::size_t>(mWidth), true);
+        mCopied = mRendered;
+      }
+    }
+    gl::glUnmapBuffer(gl::GL_PIXEL_PACK_BUFFER);
+  }
+
+  bool mbEnabled;
+  int mWidth;
+  int mHeight;
+  std::size_t mFrames = 0;
+  std::size_t mRendered = 0;
+  gl::GLuint mFramebuffer = 0;
+  std::array<gl::GLuint, 2> mRenderbuffers = {};
+  std::array<gl::GLuint, 2> mPackBuffers = {};
+  std::vector<std::uint32_t> mPixels;
+  std::size_t mCopied = 0; // frames handed to mOutput
+  std::optional<FrameOutput> mOutput;
+};
@@ -0,0 +1,174 @@
+#pragma once
+// STL
+#include <array>
+#include <cerrno>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <iomanip>
+#include <iostream>
+// Linux
+#if defined(__linux__)
+#  include <unistd.h>
+#  include <sys/ioctl.h>
+#  include <sys/syscall.h>
+#  include <linux/perf_event.h>
+#endif
+
+// Set PERF_COUNTERS to sample cycles, instructions, cache misses and branch misses around the frame phases.
+// Only the calling thread is counted, driver worker threads are not part of the numbers.
+inline const bool gPerfCounters = std::getenv("PERF_COUNTERS") != nullptr;
+
+enum class FramePhase : std::size_t { EVENT_POLL, SCENE_UPDATE, SUBMISSION, SWAP, COUNT };
+
+class PerfCounters final {
+public:
+  PerfCounters() {
+    if(gPerfCounters) {
+      open();
+    }
+  }
+
+  ~PerfCounters() { close(); }
+
+  PerfCounters(const PerfCounters &) = delete;
+  PerfCounters &operator=(const PerfCounters &) = delete;
+
+  [[nodiscard]] auto enabled() const -> bool { return mFds[0] != -1; }
+
+  // Starts `phase`, ending the one that was running.
+  void begin(FramePhase phase) {
+    if(!enabled()) {
+      return;
+    }
+    const auto sample = read();
+    stop(sample);
+    mPhase = phase;
+    mStart = sample;
+  }
+
+  void end() {
+    if(!enabled()) {
+      return;
+    }
+    stop(read());
+  }
+
+  void endFrame() {
+    end();
+    ++mFrames;
+  }
+
+  void report(std::ostream &output) const {
+    if(!enabled() || mFrames == 0) {
+      return;
+    }
+    constexpr std::array phases = {"event poll", "scene update", "submission", "swap"};
+    const auto frames = static_cast<double>(mFrames);
+
+    output << "\nPerf counters per frame (" << mFrames << " frames)\n";
+    output << std::left << std::setw(16) << "  phase" << std::right << std::setw(14) << "cycles" << std::setw(14) << "instructions"
+           << std::setw(8) << "IPC" << std::setw(14) << "cache misses" << std::setw(8) << "MPKI" << std::setw(14) << "branch misses"
+           << '\n';
+    for(std::size_t i = 0; i < phases.size(); ++i) {
+      const auto &total = mTotals[i];
+      const auto cycles = total[CYCLES];
+      const auto instructions = total[INSTRUCTIONS];
+      output << "  " << std::left << std::setw(14) << phases[i] << std::right << std::fixed << std::setprecision(0) << std::setw(14)
+             << cycles / frames << std::setw(14) << instructions / frames << std::setprecision(2) << std::setw(8)
+             << (cycles > 0 ? instructions / cycles : 0) << std::setprecision(0) << std::setw(14) << total[CACHE_MISSES] / frames
+             << std::setprecision(2) << std::setw(8) << (instructions > 0 ? total[CACHE_MISSES] * 1000 / instructions : 0)
+             << std::setprecision(0) << std::setw(14) << total[BRANCH_MISSES] / frames << '\n';
+    }
+    output << std::defaultfloat;
+  }
+
+private:
+  enum Counter : std::size_t { CYCLES, INSTRUCTIONS, CACHE_MISSES, BRANCH_MISSES, COUNTERS };
+
+  struct Sample {
+    std::uint64_t enabled = 0;
+    std::uint64_t running = 0;
+    std::array<std::uint64_t, COUNTERS> values{};
+  };
+
+  void stop(const Sample &sample) {
+    if(mPhase == FramePhase::COUNT) {
+      return;
+    }
+    // Scale by enabled/running time in case the PMU multiplexed the group.
+    const auto enabledTime = static_cast<double>(sample.enabled - mStart.enabled);
+    const auto runningTime = static_cast<double>(sample.running - mStart.running);
+    const auto scale = runningTime > 0 ? enabledTime / runningTime : 1.0;
+    auto &total = mTotals[static_cast<std::size_t>(mPhase)];
+    for(std::size_t i = 0; i < COUNTERS; ++i) {
+      total[i] += static_cast<double>(sample.values[i] - mStart.values[i]) * scale;
+    }
+    mPhase = FramePhase::COUNT;
+  }
+
+#if defined(__linux__)
+  void open() {
+    constexpr std::array<std::uint64_t, COUNTERS> configs = {
+      PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+
+    for(std::size_t i = 0; i < COUNTERS; ++i) {
+      perf_event_attr attribute;
+      std::memset(&attribute, 0, sizeof(attribute));
+      attribute.size = sizeof(attribute);
+      attribute.type = PERF_TYPE_HARDWARE;
+      attribute.config = configs[i];
+      attribute.disabled = i == 0 ? 1 : 0;
+      attribute.exclude_kernel = 1;
+      attribute.exclude_hv = 1;
+      attribute.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+      const auto fd = static_cast<int>(syscall(SYS_perf_event_open, &attribute, 0, -1, mFds[0], 0));
+      if(fd == -1) {
+        std::cerr << "Can not open perf counter " << i << " \"" << std::strerror(errno)
+                  << "\", check /proc/sys/kernel/perf_event_paranoid\n";
+        close();
+        return;
+      }
+      mFds[i] = fd;
+    }
+    ioctl(mFds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(mFds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  }
+
+  void close() {
+    for(auto &fd : mFds) {
+      if(fd != -1) {
+        ::close(fd);
+        fd = -1;
+      }
+    }
+  }
+
+  auto read() const -> Sample {
+    // PERF_FORMAT_GROUP layout: nr, time_enabled, time_running, value[nr]
+    std::array<std::uint64_t, 3 + COUNTERS> buffer{};
+    Sample sample;
+    if(::read(mFds[0], buffer.data(), sizeof(buffer)) != static_cast<ssize_t>(sizeof(buffer))) {
+      return mStart;
+    }
+    sample.enabled = buffer[1];
+    sample.running = buffer[2];
+    for(std::size_t i = 0; i < COUNTERS; ++i) {
+      sample.values[i] = buffer[3 + i];
+    }
+    return sample;
+  }
+#else
+  void open() { std::cerr << "PERF_COUNTERS is only supported on Linux\n"; }
+  void close() {}
+  auto read() const -> Sample { return mStart; }
+#endif
+
+  std::array<int, COUNTERS> mFds = {-1, -1, -1, -1};
+  std::array<std::array<double, COUNTERS>, static_cast<std::size_t>(FramePhase::COUNT)> mTotals{};
+  FramePhase mPhase = FramePhase::COUNT;
+  Sample mStart;
+  std::size_t mFrames = 0;
+};
@@ -0,0 +1,120 @@
+#pragma once
+// STL
+#include <array>
+#include <string>
+#include <cstdint>
+#include <ostream>
+#include <iostream>
+#include <string_view>
+#include <unordered_map>
+// glbinding
+#include <glbinding/gl/gl.h>
+// common
+#include <common/hash.hpp>
+
+// Separable programs of single stages, each built once per source, and the program pipelines of the vertex and fragment
+// stage pairs drawn with, built on first use. Materials that share a vertex stage share its program, and switching
+// between them binds another pipeline instead of another program. Owns everything it built, destroy it while the
+// context is current.
+class PipelineCache final {
+public:
+  PipelineCache() = default;
+
+  ~PipelineCache() {
+    for(const auto &[key, pipeline] : mPipelines) {
+      gl::glDeleteProgramPipelines(1, &pipeline);
+    }
+    for(const auto &[key, program] : mStages) {
+      gl::glDeleteProgram(program);
+    }
+  }
+
+  PipelineCache(const PipelineCache &) = delete;
+  PipelineCache &operator=(const PipelineCache &) = delete;
+
+  // The separable program of a stage, built by `link` the first time the hash of its type and `source` is seen. The
+  // source is whatever the program is built from, GLSL or SPIR-V. A failed build returns 0, which is kept; `link` may
+  // throw instead, then nothing is kept.
+  template<typename Link>
+  auto stage(gl::GLenum type, std::string_view source, Link link) -> gl::GLuint {
+    const auto key = fnv1a(source, static_cast<std::uint64_t>(type));
+    if(const auto found = mStages.find(key); found != mStages.end()) {
+      ++mShared;
+      return found->second;
+    }
+    const auto program = link();
+    mStages.emplace(key, program);
+    return program;
+  }
+
+  // A separable program compiled and linked from GLSL.
+  auto stage(gl::GLenum type, const std::string &source) -> gl::GLuint {
+    return stage(type, source, [type, &source] { return separable(type, source); });
+  }
+
+  // The pipeline of the two stage programs, validated when it is built.
+  auto pipeline(gl::GLuint vertexProgram, gl::GLuint fragmentProgram) -> gl::GLuint {
+    const auto key = (static_cast<std::uint64_t>(vertexProgram) << 32U) | fragmentProgram;
+    if(const auto found = mPipelines.find(key); found != mPipelines.end()) {
+      return found->second;
+    }
+    gl::GLuint pipeline = 0;
+    gl::glCreateProgramPipelines(1, &pipeline);
+    gl::glUseProgramStages(pipeline, gl::GL_VERTEX_SHADER_BIT, vertexProgram);
+    gl::glUseProgramStages(pipeline, gl::GL_FRAGMENT_SHADER_BIT, fragmentProgram);
+    gl::glValidateProgramPipeline(pipeline);
+    gl::GLint status = 0;
+    gl::glGetProgramPipelineiv(pipeline, gl::GL_VALIDATE_STATUS, &status);
+    if(status != 1) {
+      std::array<gl::GLchar, 1024> message{};
+      gl::glGetProgramPipelineInfoLog(pipeline, static_cast<gl::GLsizei>(message.size()), nullptr, message.data());
+      std::cerr << "Pipeline cache: " << message.data() << '\n';
+    }
+    mPipelines.emplace(key, pipeline);
+    return pipeline;
+  }
+
+  // Compiles and links a program of one stage, 0 when it fails.
+  static auto separable(gl::GLenum type, const std::string &source) -> gl::GLuint {
+    const auto *pSource = source.c_str();
+    const auto shader = gl::glCreateShader(type);
+    gl::glShaderSource(shader, 1, &pSource, nullptr);
+    gl::glCompileShader(shader);
+    gl::GLint status = 0;
+    gl::glGetShaderiv(shader, gl::GL_COMPILE_STATUS, &status);
+    if(status != 1) {
+      std::array<gl::GLchar, 1024> message{};
+      gl::glGetShaderInfoLog(shader, static_cast<gl::GLsizei>(message.size()), nullptr, message.data());
+      std::cerr << "ERROR: " << message.data() << '\n';
+      gl::glDeleteShader(shader);
+      return 0;
+    }
+    auto program = gl::glCreateProgram();
+    gl::glAttachShader(program, shader);
+    gl::glProgramParameteri(program, gl::GL_PROGRAM_SEPARABLE, gl::GL_TRUE);
+    gl::glProgramParameteri(program, gl::GL_PROGRAM_BINARY_RETRIEVABLE_HINT, gl::GL_TRUE); // for PROGRAM_CACHE
+    gl::glLinkProgram(program);
+    gl::glDeleteShader(shader);
+    gl::glGetProgramiv(program, gl::GL_LINK_STATUS, &status);
+    if(status != 1) {
+      std::array<gl::GLchar, 1024> message{};
+      gl::glGetProgramInfoLog(program, static_cast<gl::GLsizei>(message.size()), nullptr, message.data());
+      std::cerr << "ERROR: " << message.data() << '\n';
+      gl::glDeleteProgram(program);
+      program = 0;
+    }
+    return program;
+  }
+
+  [[nodiscard]] auto stages() const -> std::size_t { return mStages.size(); }
+
+  void report(std::ostream &output) const {
+    output << "Pipeline cache: " << mStages.size() << " stages built, " << mShared << " shared, " << mPipelines.size()
+           << " pipelines\n";
+  }
+
+private:
+  std::unordered_map<std::uint64_t, gl::GLuint> mStages;
+  std::unordered_map<std::uint64_t, gl::GLuint> mPipelines;
+  std::size_t mShared = 0;
+};
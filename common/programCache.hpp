@@ -0,0 +1,218 @@
+#pragma once
+// STL
+#include <array>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <filesystem>
+#include <string_view>
+#include <system_error>
+#include <initializer_list>
+// glbinding
+#include <glbinding/gl/gl.h>
+// common
+#include <common/hash.hpp>
+
+// Set PROGRAM_CACHE=<directory> to keep linked programs between launches. The first launch links as always and stores
+// the glGetProgramBinary output, named by a hash of the shader sources, the defines and the GL vendor, renderer and
+// version strings. Later launches load it with glProgramBinary and only compile and link again when the driver rejects
+// the binary, after a driver update for example. The programs loaded and linked and the time creating them are printed
+// at exit: run a demo twice with an empty directory to compare the cold and the warm startup.
+inline const char *const gProgramCache = std::getenv("PROGRAM_CACHE");
+
+class ProgramCache final {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  ProgramCache() {
+    if(gProgramCache == nullptr) {
+      return;
+    }
+    gl::GLint formats = 0;
+    gl::glGetIntegerv(gl::GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    if(formats == 0) {
+      std::cerr << "Program cache: the driver has no program binary format\n";
+      return;
+    }
+    std::error_code error;
+    std::filesystem::create_directories(gProgramCache, error);
+    if(error) {
+      std::cerr << "Program cache: can not create \"" << gProgramCache << "\"\n";
+      return;
+    }
+    for(const auto name : {gl::GL_VENDOR, gl::GL_RENDERER, gl::GL_VERSION}) {
+      const auto *pString = gl::glGetString(name);
+      mDriver += pString != nullptr ? reinterpret_cast<const char *>(pString) : "";
+      mDriver += '\n';
+    }
+    mbEnabled = true;
+  }
+
+  ~ProgramCache() {
+    if(mbEnabled) {
+      std::cout << "Program cache: " << mLoaded << " programs loaded, " << mLinked << " linked and stored, "
+                << std::chrono::duration<double, std::milli>(mTime).count() << " ms creating programs\n";
+    }
+  }
+
+  ProgramCache(const ProgramCache &) = delete;
+  ProgramCache &operator=(const ProgramCache &) = delete;
+
+  [[nodiscard]] auto enabled() const -> bool { return mbEnabled; }
+
+  // The program built from `sources` with `defines`, loaded from the cache or else returned by `link`, which compiles and
+  // links it the way the demo always did. Set GL_PROGRAM_BINARY_RETRIEVABLE_HINT before linking so the driver keeps the
+  // binary. Separable programs must say so, the flag is set before the binary is loaded.
+  template<typename Link>
+  auto program(std::initializer_list<std::string_view> sources, std::string_view defines, Link link, bool bSeparable = false)
+    -> gl::GLuint {
+    if(!mbEnabled) {
+      return link();
+    }
+    const auto start = Clock::now();
+    std::vector<std::uint64_t> sourceHashes;
+    for(const auto source : sources) {
+      sourceHashes.push_back(fnv1a(source));
+    }
+    return program(sourceHashes, defines, link, bSeparable, start);
+  }
+
+  // The same with the fnv1a() of every source instead of the source, ShaderIncludes keeps them, so a warm start reads
+  // no source text.
+  template<typename Link>
+  auto program(std::initializer_list<std::uint64_t> sourceHashes, std::string_view defines, Link link, bool bSeparable = false)
+    -> gl::GLuint {
+    if(!mbEnabled) {
+      return link();
+    }
+    return program(std::vector<std::uint64_t>(sourceHashes), defines, link, bSeparable, Clock::now());
+  }
+
+private:
+  static constexpr std::uint32_t gVersion = 1;
+
+  template<typename Link>
+  auto program(const std::vector<std::uint64_t> &sourceHashes, std::string_view defines, Link &link, bool bSeparable,
+               Clock::time_point start) -> gl::GLuint {
+    const auto fileName = path(sourceHashes, defines, bSeparable);
+    auto program = load(fileName, bSeparable);
+    if(program != 0) {
+      ++mLoaded;
+    } else {
+      program = link();
+      if(linked(program)) {
+        store(fileName, program);
+        ++mLinked;
+      }
+    }
+    mTime += Clock::now() - start;
+    return program;
+  }
+
+  // FNV-1a, every string followed by its size so the parts can not run into each other.
+  static void hash(std::uint64_t &value, std::string_view bytes) {
+    const auto add = [&value](unsigned char byte) {
+      value ^= byte;
+      value *= 0x100000001B3ULL;
+    };
+    for(const auto byte : bytes) {
+      add(static_cast<unsigned char>(byte));
+    }
+    const auto size = static_cast<std::uint64_t>(bytes.size());
+    for(std::size_t i = 0; i < sizeof(size); ++i) {
+      add(static_cast<unsigned char>(size >> (8U * i)));
+    }
+  }
+
+  auto path(const std::vector<std::uint64_t> &sourceHashes, std::string_view defines, bool bSeparable) const
+    -> std::filesystem::path {
+    std::uint64_t value = 0xCBF29CE484222325ULL;
+    hash(value, mDriver);
+    hash(value, defines);
+    hash(value, bSeparable ? "separable" : "");
+    for(const auto sourceHash : sourceHashes) {
+      hash(value, std::string_view(reinterpret_cast<const char *>(&sourceHash), sizeof(sourceHash)));
+    }
+    std::array<char, 17> name{};
+    std::snprintf(name.data(), name.size(), "%016llx", static_cast<unsigned long long>(value));
+    return std::filesystem::path(gProgramCache) / (std::string(name.data()) + ".bin");
+  }
+
+  static auto linked(gl::GLuint program) -> bool {
+    gl::GLint status = 0;
+    if(gl::glIsProgram(program) == gl::GL_TRUE) {
+      gl::glGetProgramiv(program, gl::GL_LINK_STATUS, &status);
+    }
+    return status != 0;
+  }
+
+  // A program name, or 0 when there is no usable binary. A rejected binary is overwritten by the next store().
+  static auto load(const std::filesystem::path &fileName, bool bSeparable) -> gl::GLuint {
+    std::ifstream input(fileName, std::ios::binary | std::ios::ate);
+    if(!input.is_open()) {
+      return 0;
+    }
+    const auto size = static_cast<std::size_t>(input.tellg());
+    std::array<std::uint32_t, 2> header{};
+    if(size <= sizeof(header)) {
+      return 0;
+    }
+    std::vector<char> binary(size - sizeof(header));
+    input.seekg(0);
+    input.read(reinterpret_cast<char *>(header.data()), sizeof(header));
+    input.read(binary.data(), static_cast<std::streamsize>(binary.size()));
+    if(!input || header[0] != gVersion) {
+      return 0;
+    }
+    const auto program = gl::glCreateProgram();
+    if(bSeparable) {
+      gl::glProgramParameteri(program, gl::GL_PROGRAM_SEPARABLE, gl::GL_TRUE);
+    }
+    gl::glProgramBinary(program, static_cast<gl::GLenum>(header[1]), binary.data(), static_cast<gl::GLsizei>(binary.size()));
+    if(!linked(program)) {
+      gl::glDeleteProgram(program);
+      return 0;
+    }
+    return program;
+  }
+
+  // Written next to the final name and renamed, so a demo starting meanwhile never reads half a binary.
+  static void store(const std::filesystem::path &fileName, gl::GLuint program) {
+    gl::GLint size = 0;
+    gl::glGetProgramiv(program, gl::GL_PROGRAM_BINARY_LENGTH, &size);
+    if(size <= 0) {
+      std::cerr << "Program cache: the driver returned no binary, is GL_PROGRAM_BINARY_RETRIEVABLE_HINT set?\n";
+      return;
+    }
+    std::vector<char> binary(static_cast<std::size_t>(size));
+    gl::GLsizei length = 0;
+    gl::GLenum format{};
+    gl::glGetProgramBinary(program, size, &length, &format, binary.data());
+    const std::array<std::uint32_t, 2> header = {gVersion, static_cast<std::uint32_t>(format)};
+
+    auto temporary = fileName;
+    temporary += ".tmp";
+    {
+      std::ofstream output(temporary, std::ios::binary);
+      output.write(reinterpret_cast<const char *>(header.data()), sizeof(header));
+      output.write(binary.data(), length);
+      if(!output) {
+        std::cerr << "Program cache: can not write \"" << temporary.string() << "\"\n";
+        return;
+      }
+    }
+    std::error_code error;
+    std::filesystem::rename(temporary, fileName, error);
+  }
+
+  bool mbEnabled = false;
+  std::string mDriver;
+  std::size_t mLoaded = 0;
+  std::size_t mLinked = 0;
+  Clock::duration mTime{};
+};
@@ -0,0 +1,274 @@
+#pragma once
+// STL
+#include <array>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <ostream>
+#include <algorithm>
+#include <string_view>
+#include <unordered_map>
+// glbinding
+#include <glbinding/gl/gl.h>
+// common
+#include <common/hash.hpp>
+
+// Hash of a resource name, constexpr so lookups by a literal name can hash it at compile time.
+constexpr auto resourceHash(std::string_view name) -> std::uint64_t { return fnv1a(name); }
+
+// Offset of a std140 member that follows a member ending at `end`: rounded up to its base alignment, 4 for scalars,
+// 8 for vec2 and 16 for vec3, vec4, matrix columns, array elements and structs. For static_asserts on the C++ mirror
+// of a block.
+constexpr auto std140Offset(std::size_t end, std::size_t alignment) -> std::size_t {
+  return (end + alignment - 1) / alignment * alignment;
+}
+
+// The active uniforms and uniform blocks of a linked program, read once through glGetProgramResource* and looked up
+// by the hash of their name. check() compares a block with the C++ struct that mirrors it, so a layout that does not
+// match fails when the program is built instead of drawing garbage, and declaration() prints the struct that would.
+class ProgramReflection final {
+public:
+  struct Uniform {
+    std::string name;
+    gl::GLenum type;
+    gl::GLint location;     // -1 for block members
+    gl::GLint block;        // index of the block, -1 for the default block
+    gl::GLint offset;       // bytes from the start of the block, -1 outside blocks
+    gl::GLint arraySize;
+    gl::GLint arrayStride;
+    gl::GLint matrixStride;
+  };
+
+  struct Block {
+    std::string name;
+    gl::GLuint index;
+    gl::GLint binding;
+    gl::GLint dataSize;
+  };
+
+  // A member of the C++ mirror of a block: its GLSL name and offsetof().
+  struct Member {
+    std::string_view name;
+    std::size_t offset;
+  };
+
+  explicit ProgramReflection(gl::GLuint program) {
+    gl::GLint uniforms = 0;
+    gl::glGetProgramInterfaceiv(program, gl::GL_UNIFORM, gl::GL_ACTIVE_RESOURCES, &uniforms);
+    const std::array<gl::GLenum, 8> uniformProperties = {gl::GL_NAME_LENGTH, gl::GL_TYPE,         gl::GL_LOCATION,
+                                                         gl::GL_BLOCK_INDEX, gl::GL_OFFSET,       gl::GL_ARRAY_SIZE,
+                                                         gl::GL_ARRAY_STRIDE, gl::GL_MATRIX_STRIDE};
+    for(gl::GLint i = 0; i < uniforms; ++i) {
+      std::array<gl::GLint, uniformProperties.size()> values{};
+      gl::glGetProgramResourceiv(program, gl::GL_UNIFORM, static_cast<gl::GLuint>(i),
+                                 static_cast<gl::GLsizei>(uniformProperties.size()), uniformProperties.data(),
+                                 static_cast<gl::GLsizei>(values.size()), nullptr, values.data());
+      mUniforms.push_back({name(program, gl::GL_UNIFORM, static_cast<gl::GLuint>(i), values[0]),
+                           static_cast<gl::GLenum>(values[1]), values[2], values[3], values[4], values[5], values[6],
+                           values[7]});
+    }
+    gl::GLint blocks = 0;
+    gl::glGetProgramInterfaceiv(program, gl::GL_UNIFORM_BLOCK, gl::GL_ACTIVE_RESOURCES, &blocks);
+    const std::array<gl::GLenum, 3> blockProperties = {gl::GL_NAME_LENGTH, gl::GL_BUFFER_BINDING, gl::GL_BUFFER_DATA_SIZE};
+    for(gl::GLint i = 0; i < blocks; ++i) {
+      std::array<gl::GLint, blockProperties.size()> values{};
+      gl::glGetProgramResourceiv(program, gl::GL_UNIFORM_BLOCK, static_cast<gl::GLuint>(i),
+                                 static_cast<gl::GLsizei>(blockProperties.size()), blockProperties.data(),
+                                 static_cast<gl::GLsizei>(values.size()), nullptr, values.data());
+      mBlocks.push_back({name(program, gl::GL_UNIFORM_BLOCK, static_cast<gl::GLuint>(i), values[0]),
+                         static_cast<gl::GLuint>(i), values[1], values[2]});
+    }
+    for(std::size_t i = 0; i < mUniforms.size(); ++i) {
+      mUniformTable.emplace(resourceHash(mUniforms[i].name), i);
+    }
+    for(std::size_t i = 0; i < mBlocks.size(); ++i) {
+      mBlockTable.emplace(resourceHash(mBlocks[i].name), i);
+    }
+  }
+
+  [[nodiscard]] auto uniforms() const -> const std::vector<Uniform> & { return mUniforms; }
+  [[nodiscard]] auto blocks() const -> const std::vector<Block> & { return mBlocks; }
+
+  // nullptr when the program has no such active uniform, the compiler drops the ones it does not use.
+  [[nodiscard]] auto uniform(std::string_view name) const -> const Uniform * { return find(mUniforms, mUniformTable, name); }
+  [[nodiscard]] auto block(std::string_view name) const -> const Block * { return find(mBlocks, mBlockTable, name); }
+
+  // The block bound to `binding`, for SPIR-V programs whose blocks may have no name.
+  [[nodiscard]] auto blockAt(gl::GLint binding) const -> const Block * {
+    const auto found = std::find_if(mBlocks.begin(), mBlocks.end(), [binding](const Block &block) {
+      return block.binding == binding;
+    });
+    return found == mBlocks.end() ? nullptr : &*found;
+  }
+
+  // True when the block is `size` bytes and its members are exactly `members` at their offsets, else prints what
+  // differs and the declaration of the block to `errors`.
+  template<std::size_t N>
+  auto check(std::string_view blockName, std::size_t size, const std::array<Member, N> &members, std::ostream &errors) const
+    -> bool {
+    const auto *pBlock = block(blockName);
+    if(pBlock == nullptr) {
+      errors << "The program has no uniform block " << blockName << '\n';
+      return false;
+    }
+    return check(*pBlock, size, members, errors);
+  }
+
+  // Drivers may drop the names of programs built from SPIR-V, the members of an unnamed block are compared by their
+  // offsets only.
+  template<std::size_t N>
+  auto check(const Block &block, std::size_t size, const std::array<Member, N> &members, std::ostream &errors) const
+    -> bool {
+    const auto blockMembers = this->members(block);
+    const auto bNamed = std::any_of(blockMembers.begin(), blockMembers.end(), [](const Uniform *pUniform) {
+      return !pUniform->name.empty();
+    });
+    const auto blockName = block.name.empty() ? "The block at binding " + std::to_string(block.binding) : block.name;
+    bool bMatches = true;
+    if(static_cast<std::size_t>(block.dataSize) != size) {
+      errors << blockName << " is " << block.dataSize << " bytes, the C++ struct " << size << '\n';
+      bMatches = false;
+    }
+    if(bNamed) {
+      for(const auto &member : members) {
+        const auto *pUniform = uniform(member.name);
+        if(pUniform == nullptr || pUniform->block != static_cast<gl::GLint>(block.index)) {
+          errors << blockName << " has no member " << member.name << '\n';
+          bMatches = false;
+        } else if(static_cast<std::size_t>(pUniform->offset) != member.offset) {
+          errors << blockName << ": " << member.name << " is at " << pUniform->offset << ", in the C++ struct at "
+                 << member.offset << '\n';
+          bMatches = false;
+        }
+      }
+      for(const auto *pUniform : blockMembers) {
+        const auto bKnown = std::any_of(members.begin(), members.end(), [pUniform](const Member &member) {
+          return member.name == pUniform->name;
+        });
+        if(!bKnown) {
+          errors << blockName << ": " << pUniform->name << " is missing in the C++ struct\n";
+          bMatches = false;
+        }
+      }
+    } else {
+      std::vector<std::size_t> expected;
+      for(const auto &member : members) {
+        expected.push_back(member.offset);
+      }
+      std::sort(expected.begin(), expected.end());
+      std::vector<std::size_t> offsets;
+      for(const auto *pUniform : blockMembers) {
+        offsets.push_back(static_cast<std::size_t>(pUniform->offset));
+      }
+      if(offsets != expected) {
+        errors << blockName << " has members at other offsets than the C++ struct\n";
+        bMatches = false;
+      }
+    }
+    if(!bMatches) {
+      errors << "The layout of the program is\n" << declaration(block);
+    }
+    return bMatches;
+  }
+
+  [[nodiscard]] auto declaration(std::string_view blockName) const -> std::string {
+    const auto *pBlock = block(blockName);
+    return pBlock == nullptr ? std::string() : declaration(*pBlock);
+  }
+
+  // A C++ struct with the layout of the block, glm types and explicit padding, members named after the GLSL ones.
+  [[nodiscard]] auto declaration(const Block &block) const -> std::string {
+    const auto structName = block.name.empty() ? "Binding" + std::to_string(block.binding) : block.name;
+    std::string declaration = "struct " + structName + " { // std140, " + std::to_string(block.dataSize) + " bytes\n";
+    std::size_t end = 0;
+    std::size_t pads = 0;
+    const auto pad = [&declaration, &end, &pads](std::size_t offset) {
+      if(offset > end) {
+        const auto floats = (offset - end) / 4;
+        declaration += "  float pad" + std::to_string(pads++) + (floats == 1 ? "" : '[' + std::to_string(floats) + ']') + ";\n";
+      }
+    };
+    for(const auto *pUniform : members(block)) {
+      const auto offset = static_cast<std::size_t>(pUniform->offset);
+      const auto [pType, elementSize] = cppType(pUniform->type);
+      pad(offset);
+      auto name = pUniform->name.empty() ? "member" + std::to_string(offset) : pUniform->name.substr(0, pUniform->name.find('['));
+      std::replace(name.begin(), name.end(), '.', '_');
+      const auto count = static_cast<std::size_t>(std::max(pUniform->arraySize, 1));
+      if(count == 1) {
+        declaration += std::string("  ") + pType + ' ' + name + "; // " + std::to_string(offset) + '\n';
+        end = offset + elementSize;
+      } else if(static_cast<std::size_t>(pUniform->arrayStride) == elementSize) {
+        declaration += std::string("  ") + pType + ' ' + name + '[' + std::to_string(count) + "]; // " +
+                       std::to_string(offset) + '\n';
+        end = offset + count * elementSize;
+      } else {
+        // std140 rounds the stride of scalar and vector arrays up to a vec4
+        declaration += "  glm::vec4 " + name + '[' + std::to_string(count) + "]; // " + std::to_string(offset) + ", " +
+                       pType + " elements\n";
+        end = offset + count * static_cast<std::size_t>(pUniform->arrayStride);
+      }
+    }
+    pad(static_cast<std::size_t>(block.dataSize));
+    return declaration + "};\n";
+  }
+
+private:
+  // The members of the block by offset.
+  auto members(const Block &block) const -> std::vector<const Uniform *> {
+    std::vector<const Uniform *> members;
+    for(const auto &uniform : mUniforms) {
+      if(uniform.block == static_cast<gl::GLint>(block.index)) {
+        members.push_back(&uniform);
+      }
+    }
+    std::sort(members.begin(), members.end(), [](const Uniform *pLeft, const Uniform *pRight) {
+      return pLeft->offset < pRight->offset;
+    });
+    return members;
+  }
+
+  static auto name(gl::GLuint program, gl::GLenum interface, gl::GLuint index, gl::GLint length) -> std::string {
+    std::string name(static_cast<std::size_t>(std::max(length, 1)), '\0');
+    gl::glGetProgramResourceName(program, interface, index, static_cast<gl::GLsizei>(name.size()), nullptr, name.data());
+    name.resize(name.find('\0') == std::string::npos ? name.size() : name.find('\0'));
+    return name;
+  }
+
+  // glm type with the std140 layout of a GLSL type and its size, matrix columns padded to a vec4.
+  static auto cppType(gl::GLenum type) -> std::pair<const char *, std::size_t> {
+    switch(type) {
+    case gl::GL_FLOAT: return {"float", 4};
+    case gl::GL_FLOAT_VEC2: return {"glm::vec2", 8};
+    case gl::GL_FLOAT_VEC3: return {"glm::vec3", 12};
+    case gl::GL_FLOAT_VEC4: return {"glm::vec4", 16};
+    case gl::GL_INT: return {"int", 4};
+    case gl::GL_INT_VEC2: return {"glm::ivec2", 8};
+    case gl::GL_INT_VEC3: return {"glm::ivec3", 12};
+    case gl::GL_INT_VEC4: return {"glm::ivec4", 16};
+    case gl::GL_UNSIGNED_INT: return {"unsigned int", 4};
+    case gl::GL_BOOL: return {"unsigned int", 4}; // bools are 4 bytes in a block
+    case gl::GL_FLOAT_MAT2: return {"glm::mat2x4", 32};
+    case gl::GL_FLOAT_MAT3: return {"glm::mat3x4", 48};
+    case gl::GL_FLOAT_MAT4: return {"glm::mat4", 64};
+    default: return {"float /* unknown type */", 4};
+    }
+  }
+
+  template<typename T>
+  static auto find(const std::vector<T> &resources, const std::unordered_multimap<std::uint64_t, std::size_t> &table,
+                   std::string_view name) -> const T * {
+    const auto [first, last] = table.equal_range(resourceHash(name));
+    for(auto it = first; it != last; ++it) {
+      if(resources[it->second].name == name) {
+        return &resources[it->second];
+      }
+    }
+    return nullptr;
+  }
+
+  std::vector<Uniform> mUniforms;
+  std::vector<Block> mBlocks;
+  std::unordered_multimap<std::uint64_t, std::size_t> mUniformTable;
+  std::unordered_multimap<std::uint64_t, std::size_t> mBlockTable;
+};
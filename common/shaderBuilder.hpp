@@ -0,0 +1,221 @@
+#pragma once
+// STL
+#include <array>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstring>
+#include <utility>
+#include <iostream>
+#include <string_view>
+// glbinding
+#include <glbinding/gl/gl.h>
+
+// Builds many programs without waiting on each one. add() queues the stages of a program, submit() starts compiling
+// all of them, poll() links the programs whose shaders finished and never blocks with GL_KHR_parallel_shader_compile
+// (or the ARB version): it asks GL_COMPLETION_STATUS_KHR instead of the compile and link status, so the driver compiles
+// on its own threads while the caller does other work. Without the extension poll() queries the statuses of everything
+// submitted, which still lets drivers that compile on a thread of their own overlap the compiles.
+class ShaderBuilder final {
+public:
+  struct Stage {
+    gl::GLenum type;
+    std::string source;
+  };
+
+  enum class ParallelExtension { NONE, KHR, ARB };
+
+  // `bParallel` false ignores the extension, to compare against it. With the extension the compiler threads of the
+  // context are raised to as many as the driver likes, for every later compile.
+  explicit ShaderBuilder(bool bParallel = true) {
+    if(!bParallel) {
+      return;
+    }
+    switch(parallelExtension()) {
+    case ParallelExtension::NONE: return;
+    case ParallelExtension::KHR: gl::glMaxShaderCompilerThreadsKHR(0xFFFFFFFFU); break;
+    case ParallelExtension::ARB: gl::glMaxShaderCompilerThreadsARB(0xFFFFFFFFU); break;
+    }
+    mbParallel = true;
+  }
+
+  ~ShaderBuilder() {
+    for(const auto &program : mPrograms) {
+      for(const auto shader : program.shaders) {
+        gl::glDeleteShader(shader);
+      }
+    }
+  }
+
+  ShaderBuilder(const ShaderBuilder &) = delete;
+  ShaderBuilder &operator=(const ShaderBuilder &) = delete;
+
+  [[nodiscard]] auto parallel() const -> bool { return mbParallel; }
+
+  // The parallel compile extension of the context, KHR before ARB. Unlike the constructor it leaves the thread count
+  // alone.
+  [[nodiscard]] static auto parallelExtension() -> ParallelExtension {
+    auto found = ParallelExtension::NONE;
+    gl::GLint extensions = 0;
+    gl::glGetIntegerv(gl::GL_NUM_EXTENSIONS, &extensions);
+    for(gl::GLint i = 0; i < extensions; ++i) {
+      const auto *pName = reinterpret_cast<const char *>(gl::glGetStringi(gl::GL_EXTENSIONS, static_cast<gl::GLuint>(i)));
+      if(std::strcmp(pName, "GL_KHR_parallel_shader_compile") == 0) {
+        return ParallelExtension::KHR;
+      }
+      if(std::strcmp(pName, "GL_ARB_parallel_shader_compile") == 0) {
+        found = ParallelExtension::ARB;
+      }
+    }
+    return found;
+  }
+
+  // Index of the program for program(), nothing is compiled before submit().
+  auto add(std::vector<Stage> stages) -> std::size_t {
+    Program program;
+    program.stages = std::move(stages);
+    mPrograms.push_back(std::move(program));
+    return mPrograms.size() - 1;
+  }
+
+  // Hands every program added since the last call to the compiler.
+  void submit() {
+    for(; mSubmitted < mPrograms.size(); ++mSubmitted) {
+      auto &program = mPrograms[mSubmitted];
+      for(const auto &stage : program.stages) {
+        const auto *pSource = stage.source.c_str();
+        const auto shader = gl::glCreateShader(stage.type);
+        gl::glShaderSource(shader, 1, &pSource, nullptr);
+        gl::glCompileShader(shader);
+        program.shaders.push_back(shader);
+      }
+      program.state = State::COMPILING;
+    }
+  }
+
+  // Links the programs whose shaders compiled and checks the programs that linked. True once every submitted program is
+  // done, failed ones included.
+  auto poll() -> bool {
+    bool bDone = true;
+    for(std::size_t i = 0; i < mSubmitted; ++i) {
+      auto &program = mPrograms[i];
+      if(program.state == State::COMPILING) {
+        if(!compiled(program)) {
+          bDone = false;
+          continue;
+        }
+        link(program);
+      }
+      if(program.state == State::LINKING) {
+        if(!complete(program.program, true)) {
+          bDone = false;
+          continue;
+        }
+        check(program);
+      }
+    }
+    return bDone;
+  }
+
+  // Polls until every submitted program is done.
+  void finish() {
+    submit();
+    while(!poll()) {
+      std::this_thread::yield();
+    }
+  }
+
+  // The linked program, 0 while it is not done or when it failed. The builder keeps no reference to it.
+  [[nodiscard]] auto program(std::size_t index) const -> gl::GLuint { return mPrograms[index].program; }
+
+  [[nodiscard]] auto failed() const -> std::size_t { return mFailed; }
+
+private:
+  enum class State { QUEUED, COMPILING, LINKING, DONE };
+
+  struct Program {
+    std::vector<Stage> stages;
+    std::vector<gl::GLuint> shaders;
+    gl::GLuint program = 0;
+    State state = State::QUEUED;
+  };
+
+  // Without the extension everything counts as complete and the status queries that follow wait for it.
+  auto complete(gl::GLuint object, bool bProgram) const -> bool {
+    if(!mbParallel) {
+      return true;
+    }
+    gl::GLint status = 0;
+    if(bProgram) {
+      gl::glGetProgramiv(object, gl::GL_COMPLETION_STATUS_KHR, &status);
+    } else {
+      gl::glGetShaderiv(object, gl::GL_COMPLETION_STATUS_KHR, &status);
+    }
+    return status != 0;
+  }
+
+  auto compiled(const Program &program) const -> bool {
+    for(const auto shader : program.shaders) {
+      if(!complete(shader, false)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void link(Program &program) {
+    for(const auto shader : program.shaders) {
+      gl::GLint status = 0;
+      gl::glGetShaderiv(shader, gl::GL_COMPILE_STATUS, &status);
+      if(status != 1) {
+        std::array<gl::GLchar, 1024> message{};
+        gl::glGetShaderInfoLog(shader, static_cast<gl::GLsizei>(message.size()), nullptr, message.data());
+        std::cerr << "ERROR: " << message.data() << '\n';
+        fail(program);
+        return;
+      }
+    }
+    program.program = gl::glCreateProgram();
+    for(const auto shader : program.shaders) {
+      gl::glAttachShader(program.program, shader);
+    }
+    gl::glLinkProgram(program.program);
+    // Flagged for deletion, they go when the program is deleted.
+    for(const auto shader : program.shaders) {
+      gl::glDeleteShader(shader);
+    }
+    program.shaders.clear();
+    program.state = State::LINKING;
+  }
+
+  void check(Program &program) {
+    gl::GLint status = 0;
+    gl::glGetProgramiv(program.program, gl::GL_LINK_STATUS, &status);
+    if(status != 1) {
+      std::array<gl::GLchar, 1024> message{};
+      gl::glGetProgramInfoLog(program.program, static_cast<gl::GLsizei>(message.size()), nullptr, message.data());
+      std::cerr << "ERROR: " << message.data() << '\n';
+      fail(program);
+      return;
+    }
+    program.state = State::DONE;
+  }
+
+  void fail(Program &program) {
+    for(const auto shader : program.shaders) {
+      gl::glDeleteShader(shader);
+    }
+    program.shaders.clear();
+    if(program.program != 0) {
+      gl::glDeleteProgram(program.program);
+      program.program = 0;
+    }
+    program.state = State::DONE;
+    ++mFailed;
+  }
+
+  bool mbParallel = false;
+  std::vector<Program> mPrograms;
+  std::size_t mSubmitted = 0;
+  std::size_t mFailed = 0;
+};
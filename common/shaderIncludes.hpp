@@ -0,0 +1,121 @@
+#pragma once
+// STL
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <iostream>
+#include <algorithm>
+#include <string_view>
+#include <unordered_map>
+// common
+#include <common/hash.hpp>
+
+// `#include "file"` for GLSL, over a file system of named sources the demos add, expanded once per file and kept with
+// the hash of the expansion, the key the program cache stores its binary under. A file is included once per expansion,
+// later includes of it are skipped, so headers need no guards and cycles end. Includes are expanded wherever they are,
+// also inside `#if` blocks. The lines of an included file start at `#line 1 <n>`, n its index in Expansion::files, so
+// the compiler reports its errors as `<n>:<line>`. Replacing a file drops the expansions that included it and only
+// those: the programs built from them get other keys, the others keep their binaries.
+class ShaderIncludes final {
+public:
+  struct Expansion {
+    std::string source;
+    std::uint64_t hash = 0; // fnv1a() of the source
+    std::vector<std::string> files; // the expanded file, then every file it included or tried to, in order
+  };
+
+  // Adds the file or replaces its source, returns the number of expansions dropped.
+  auto add(const std::string &path, std::string source) -> std::size_t {
+    if(const auto found = mFiles.find(path); found != mFiles.end() && found->second == source) {
+      return 0;
+    }
+    mFiles[path] = std::move(source);
+    std::size_t dropped = 0;
+    for(auto expansion = mExpansions.begin(); expansion != mExpansions.end();) {
+      const auto &files = expansion->second.files;
+      if(std::find(files.begin(), files.end(), path) != files.end()) {
+        expansion = mExpansions.erase(expansion);
+        ++dropped;
+      } else {
+        ++expansion;
+      }
+    }
+    return dropped;
+  }
+
+  // The file with its includes expanded, kept until one of its files is replaced. A missing include is reported and its
+  // line left as is, for the compiler to fail on.
+  auto expand(const std::string &path) -> const Expansion & {
+    if(const auto found = mExpansions.find(path); found != mExpansions.end()) {
+      return found->second;
+    }
+    Expansion expansion;
+    include(path, expansion);
+    expansion.hash = fnv1a(expansion.source);
+    return mExpansions.emplace(path, std::move(expansion)).first->second;
+  }
+
+  // The file name of an `#include "file"` or `#include <file>` line, empty for any other line. constexpr for
+  // ShaderRegistry::key().
+  static constexpr auto included(std::string_view line) -> std::string_view {
+    const auto skip = [&line] { line.remove_prefix(std::min(line.find_first_not_of(" \t"), line.size())); };
+    skip();
+    if(line.empty() || line.front() != '#') {
+      return {};
+    }
+    line.remove_prefix(1);
+    skip();
+    constexpr std::string_view directive = "include";
+    if(line.substr(0, directive.size()) != directive) {
+      return {};
+    }
+    line.remove_prefix(directive.size());
+    skip();
+    if(line.empty() || (line.front() != '"' && line.front() != '<')) {
+      return {};
+    }
+    const auto end = line.find(line.front() == '"' ? '"' : '>', 1);
+    return end == std::string_view::npos ? std::string_view() : line.substr(1, end - 1);
+  }
+
+private:
+  void include(const std::string &path, Expansion &expansion) {
+    const auto index = expansion.files.size();
+    expansion.files.push_back(path);
+    const auto file = mFiles.find(path);
+    if(file == mFiles.end()) {
+      std::cerr << "Shader includes: no \"" << path << "\"\n";
+      return;
+    }
+    const std::string_view source = file->second;
+    std::size_t number = 1;
+    for(std::size_t begin = 0; begin < source.size(); ++number) {
+      const auto newline = source.find('\n', begin);
+      const auto end = newline == std::string_view::npos ? source.size() : newline + 1;
+      const auto line = source.substr(begin, end - begin);
+      begin = end;
+      const std::string name(included(line));
+      const auto &files = expansion.files;
+      if(name.empty()) {
+        expansion.source += line;
+      } else if(std::find(files.begin(), files.end(), name) != files.end()) {
+        expansion.source += '\n';
+      } else if(mFiles.count(name) == 0) {
+        std::cerr << "Shader includes: no \"" << name << "\", included by \"" << path << "\" line " << number << '\n';
+        expansion.files.push_back(name);
+        expansion.source += line;
+      } else {
+        expansion.source += "#line 1 " + std::to_string(files.size()) + '\n';
+        include(name, expansion);
+        expansion.source += "#line " + std::to_string(number + 1) + ' ' + std::to_string(index) + '\n';
+      }
+      if(expansion.source.back() != '\n') {
+        expansion.source += '\n';
+      }
+    }
+  }
+
+  std::unordered_map<std::string, std::string> mFiles;
+  std::unordered_map<std::string, Expansion> mExpansions;
+};
@@ -0,0 +1,254 @@
+#pragma once
+// STL
+#include <array>
+#include <chrono>
+#include <deque>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <iomanip>
+#include <ostream>
+#include <iostream>
+#include <algorithm>
+#include <functional>
+#include <unordered_map>
+// glbinding
+#include <glbinding/gl/gl.h>
+// common
+#include <common/hash.hpp>
+#include <common/spirv.hpp>
+#include <common/programCache.hpp>
+
+// Variants of one vertex and fragment shader source, selected by a bitmask of features. Bit i of the key defines
+// features[i] after the #version line. A variant is built the first time it is asked for and kept by its key, through
+// the program cache, from the SPIR-V the build compiled it to when SPIRV_SHADERS is set (common/spirv.hpp) and from
+// GLSL otherwise. The GPU time of the draws between beginTiming() and endTiming() is collected per variant from
+// GL_TIME_ELAPSED queries once they are available, so timing never waits for the GPU. The programs and queries are
+// deleted with it, destroy it while the context is current.
+class ShaderPermutations final {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  // The source of a stage by its type, asked for only when a variant is compiled.
+  using Source = std::function<std::string(gl::GLenum type)>;
+
+  ShaderPermutations(std::string name, const std::string &vertexSource, const std::string &fragmentSource,
+                     std::vector<std::string> features, ProgramCache &programCache)
+    : ShaderPermutations(
+        std::move(name), fnv1a(vertexSource), fnv1a(fragmentSource),
+        [vertexSource, fragmentSource](gl::GLenum type) { return type == gl::GL_VERTEX_SHADER ? vertexSource : fragmentSource; },
+        std::move(features), programCache) {}
+
+  // With the hashes the program cache keys the sources by, ShaderRegistry::key() for example, so the variants it has are
+  // loaded without reading the sources.
+  ShaderPermutations(std::string name, std::uint64_t vertexHash, std::uint64_t fragmentHash, Source source,
+                     std::vector<std::string> features, ProgramCache &programCache)
+    : mName(std::move(name)), mSource(std::move(source)), mVertexHash(vertexHash), mFragmentHash(fragmentHash),
+      mFeatures(std::move(features)), mProgramCache(programCache) {}
+
+  ~ShaderPermutations() {
+    for(const auto &[key, variant] : mVariants) {
+      gl::glDeleteProgram(variant.program);
+    }
+    for(const auto &pending : mPending) {
+      gl::glDeleteQueries(1, &pending.query);
+    }
+    gl::glDeleteQueries(static_cast<gl::GLsizei>(mFreeQueries.size()), mFreeQueries.data());
+  }
+
+  ShaderPermutations(const ShaderPermutations &) = delete;
+  ShaderPermutations &operator=(const ShaderPermutations &) = delete;
+
+  // The program of the variant, built on first use, from the SPIR-V files of the variant when SPIRV_SHADERS has them.
+  // 0 when it does not compile or link, which is not retried.
+  auto program(std::uint32_t key) -> gl::GLuint {
+    if(const auto found = mVariants.find(key); found != mVariants.end()) {
+      return found->second.program;
+    }
+    auto &variant = mVariants[key];
+    const auto start = Clock::now();
+    const auto defines = this->defines(key);
+    const auto vertexModule = loadSpirv(fileName(mName, key, gl::GL_VERTEX_SHADER) + ".spv");
+    const auto fragmentModule =
+      vertexModule.empty() ? std::string() : loadSpirv(fileName(mName, key, gl::GL_FRAGMENT_SHADER) + ".spv");
+    if(!fragmentModule.empty()) {
+      variant.program = mProgramCache.program({vertexModule, fragmentModule}, "SPIR-V\n" + defines, [&] {
+        return link(spirvShader(gl::GL_VERTEX_SHADER, vertexModule), spirvShader(gl::GL_FRAGMENT_SHADER, fragmentModule));
+      });
+      variant.bSpirv = variant.program != 0;
+    }
+    if(variant.program == 0) {
+      // Keyed by the hashes of the sources without the defines, which are part of the key anyway, so a cached variant
+      // neither hashes nor builds its source.
+      variant.program = mProgramCache.program({mVertexHash, mFragmentHash}, defines, [this, &defines] {
+        return link(compile(gl::GL_VERTEX_SHADER, insert(mSource(gl::GL_VERTEX_SHADER), defines)),
+                    compile(gl::GL_FRAGMENT_SHADER, insert(mSource(gl::GL_FRAGMENT_SHADER), defines)));
+      });
+    }
+    variant.compileTime = Clock::now() - start;
+    ++mCompiles;
+    return variant.program;
+  }
+
+  // True when the variant was built from SPIR-V, which carries no names for reflection.
+  [[nodiscard]] auto spirv(std::uint32_t key) const -> bool {
+    const auto found = mVariants.find(key);
+    return found != mVariants.end() && found->second.bSpirv;
+  }
+
+  [[nodiscard]] auto compiles() const -> std::size_t { return mCompiles; }
+
+  // `#define <feature>` lines of the key.
+  [[nodiscard]] auto defines(std::uint32_t key) const -> std::string { return defines(mFeatures, key); }
+
+  [[nodiscard]] static auto defines(const std::vector<std::string> &features, std::uint32_t key) -> std::string {
+    std::string defines;
+    for(std::size_t i = 0; i < features.size(); ++i) {
+      if((key & (1U << i)) != 0) {
+        defines += "#define " + features[i] + '\n';
+      }
+    }
+    return defines;
+  }
+
+  // The source with the defines right after the #version line, which has to stay first.
+  [[nodiscard]] static auto insert(const std::string &source, const std::string &defines) -> std::string {
+    const auto version = source.find("#version");
+    const auto line = version == std::string::npos ? 0 : source.find('\n', version) + 1;
+    return source.substr(0, line) + defines + source.substr(line);
+  }
+
+  // `<name>.<key>.vert` or `.frag`, the GLSL the build exports for glslang, its SPIR-V has `.spv` appended.
+  [[nodiscard]] static auto fileName(const std::string &name, std::uint32_t key, gl::GLenum type) -> std::string {
+    return name + '.' + std::to_string(key) + (type == gl::GL_VERTEX_SHADER ? ".vert" : ".frag");
+  }
+
+  void beginTiming(std::uint32_t key) {
+    collect(false);
+    gl::GLuint query = 0;
+    if(mFreeQueries.empty()) {
+      gl::glGenQueries(1, &query);
+    } else {
+      query = mFreeQueries.back();
+      mFreeQueries.pop_back();
+    }
+    gl::glBeginQuery(gl::GL_TIME_ELAPSED, query);
+    mPending.push_back({query, key});
+  }
+
+  void endTiming() { gl::glEndQuery(gl::GL_TIME_ELAPSED); }
+
+  // Waits for the queries still in flight, call it while the context is current.
+  void report(std::ostream &output) {
+    collect(true);
+    output << '\n' << mName << ": " << mCompiles << " variants compiled\n";
+    std::vector<std::uint32_t> keys;
+    for(const auto &[key, variant] : mVariants) {
+      keys.push_back(key);
+    }
+    std::sort(keys.begin(), keys.end());
+    for(const auto key : keys) {
+      const auto &variant = mVariants.at(key);
+      std::string features;
+      for(std::size_t i = 0; i < mFeatures.size(); ++i) {
+        if((key & (1U << i)) != 0) {
+          features += (features.empty() ? "" : "|") + mFeatures[i];
+        }
+      }
+      output << "  " << std::left << std::setw(48) << (features.empty() ? "(none)" : features) << std::right << std::fixed
+             << std::setprecision(3) << " compile " << std::chrono::duration<double, std::milli>(variant.compileTime).count()
+             << " ms" << (variant.bSpirv ? " from SPIR-V" : "");
+      if(variant.program == 0) {
+        output << ", failed\n";
+        continue;
+      }
+      const auto gpuMs = variant.timings > 0 ? variant.gpuMs / static_cast<double>(variant.timings) : 0.;
+      output << ", GPU " << gpuMs << " ms per use over " << variant.timings << " uses\n";
+    }
+  }
+
+private:
+  struct Variant {
+    gl::GLuint program = 0;
+    Clock::duration compileTime{};
+    double gpuMs = 0;
+    std::size_t timings = 0;
+    bool bSpirv = false;
+  };
+
+  struct Pending {
+    gl::GLuint query;
+    std::uint32_t key;
+  };
+
+  static auto compile(gl::GLenum type, const std::string &source) -> gl::GLuint {
+    const auto *pSource = source.c_str();
+    const auto shader = gl::glCreateShader(type);
+    gl::glShaderSource(shader, 1, &pSource, nullptr);
+    gl::glCompileShader(shader);
+    gl::GLint status = 0;
+    gl::glGetShaderiv(shader, gl::GL_COMPILE_STATUS, &status);
+    if(status != 1) {
+      std::array<gl::GLchar, 1024> message{};
+      gl::glGetShaderInfoLog(shader, static_cast<gl::GLsizei>(message.size()), nullptr, message.data());
+      std::cerr << "ERROR: " << message.data() << '\n';
+      gl::glDeleteShader(shader);
+      return 0;
+    }
+    return shader;
+  }
+
+  static auto link(gl::GLuint vertexShader, gl::GLuint fragmentShader) -> gl::GLuint {
+    gl::GLuint program = 0;
+    if(vertexShader != 0 && fragmentShader != 0) {
+      program = gl::glCreateProgram();
+      gl::glAttachShader(program, vertexShader);
+      gl::glAttachShader(program, fragmentShader);
+      gl::glProgramParameteri(program, gl::GL_PROGRAM_BINARY_RETRIEVABLE_HINT, gl::GL_TRUE); // for PROGRAM_CACHE
+      gl::glLinkProgram(program);
+      gl::GLint status = 0;
+      gl::glGetProgramiv(program, gl::GL_LINK_STATUS, &status);
+      if(status != 1) {
+        std::array<gl::GLchar, 1024> message{};
+        gl::glGetProgramInfoLog(program, static_cast<gl::GLsizei>(message.size()), nullptr, message.data());
+        std::cerr << "ERROR: " << message.data() << '\n';
+        gl::glDeleteProgram(program);
+        program = 0;
+      }
+    }
+    gl::glDeleteShader(vertexShader);
+    gl::glDeleteShader(fragmentShader);
+    return program;
+  }
+
+  // Queries finish in order, so only the oldest ones are asked for.
+  void collect(bool bWait) {
+    while(!mPending.empty()) {
+      const auto pending = mPending.front();
+      gl::GLint available = 0;
+      gl::glGetQueryObjectiv(pending.query, gl::GL_QUERY_RESULT_AVAILABLE, &available);
+      if(available == 0 && !bWait) {
+        return;
+      }
+      gl::GLuint64 elapsed = 0;
+      gl::glGetQueryObjectui64v(pending.query, gl::GL_QUERY_RESULT, &elapsed);
+      auto &variant = mVariants[pending.key];
+      variant.gpuMs += static_cast<double>(elapsed) / 1e6;
+      ++variant.timings;
+      mFreeQueries.push_back(pending.query);
+      mPending.pop_front();
+    }
+  }
+
+  std::string mName;
+  Source mSource;
+  std::uint64_t mVertexHash;
+  std::uint64_t mFragmentHash;
+  std::vector<std::string> mFeatures;
+  ProgramCache &mProgramCache;
+  std::unordered_map<std::uint32_t, Variant> mVariants;
+  std::size_t mCompiles = 0;
+  std::deque<Pending> mPending;
+  std::vector<gl::GLuint> mFreeQueries;
+};
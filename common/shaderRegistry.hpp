@@ -0,0 +1,113 @@
+#pragma once
+// STL
+#include <array>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+// common
+#include <common/hash.hpp>
+#include <common/shaderIncludes.hpp>
+
+// The id of a shader source, the fnv1a() of its name. Ids of literals are constants, so a lookup compares integers.
+constexpr auto shaderId(std::string_view name) -> std::uint64_t { return fnv1a(name); }
+
+// A GLSL source compiled into the executable, with the hashes of its name and its text computed by the compiler. The
+// source views a whole string literal, so source.data() is null terminated.
+struct ShaderSource {
+  std::string_view name;
+  std::string_view source;
+  std::uint64_t id = 0;
+  std::uint64_t hash = 0;
+
+  constexpr ShaderSource() = default;
+  constexpr ShaderSource(std::string_view shaderName, const char *pSource)
+    : name(shaderName), source(pSource), id(shaderId(shaderName)), hash(fnv1a(source)) {}
+};
+
+// Named shader sources sorted by id at compile time. find() is a binary search over the ids, and key() hashes the hashes
+// of a source and of the sources it includes, for the program cache: a warm start loads the binaries of the programs
+// without reading, expanding or hashing any source text, and a changed include gives new keys to the programs that
+// include it and to no others. Check unique() and that the keys are not 0 with static_assert where they are defined,
+// so a duplicate name or a missing include fails the build.
+template<std::size_t N>
+class ShaderRegistry final {
+public:
+  constexpr explicit ShaderRegistry(const std::array<ShaderSource, N> &sources) : mSources(sources) {
+    for(std::size_t i = 1; i < N; ++i) {
+      for(auto j = i; j > 0 && mSources[j].id < mSources[j - 1].id; --j) {
+        const auto source = mSources[j];
+        mSources[j] = mSources[j - 1];
+        mSources[j - 1] = source;
+      }
+    }
+  }
+
+  // False when two sources have the same name or names of the same hash, or a source has no name, which is what the
+  // array holds when N is larger than the sources listed.
+  [[nodiscard]] constexpr auto unique() const -> bool {
+    for(std::size_t i = 0; i < N; ++i) {
+      if(mSources[i].name.empty() || (i > 0 && mSources[i].id == mSources[i - 1].id)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // The source of the id, nullptr when there is none.
+  [[nodiscard]] constexpr auto find(std::uint64_t id) const -> const ShaderSource * {
+    std::size_t first = 0;
+    std::size_t last = N;
+    while(first < last) {
+      const auto middle = first + (last - first) / 2;
+      if(mSources[middle].id < id) {
+        first = middle + 1;
+      } else {
+        last = middle;
+      }
+    }
+    return first < N && mSources[first].id == id ? &mSources[first] : nullptr;
+  }
+
+  // The program cache key of the source with its includes, every file once as ShaderIncludes expands them, 0 when the
+  // source or one of its includes is missing.
+  [[nodiscard]] constexpr auto key(std::uint64_t id) const -> std::uint64_t {
+    std::array<bool, N> included{};
+    auto value = fnv1a(std::string_view());
+    return combine(id, included, value) ? value : 0;
+  }
+
+  // Adds every source to the file system of `includes`, for compiling the sources that were not in the program cache.
+  void add(ShaderIncludes &includes) const {
+    for(const auto &source : mSources) {
+      includes.add(std::string(source.name), std::string(source.source));
+    }
+  }
+
+private:
+  constexpr auto combine(std::uint64_t id, std::array<bool, N> &included, std::uint64_t &value) const -> bool {
+    const auto *pSource = find(id);
+    if(pSource == nullptr) {
+      return false;
+    }
+    const auto index = static_cast<std::size_t>(pSource - mSources.data());
+    if(included[index]) {
+      return true;
+    }
+    included[index] = true;
+    value = fnv1a(pSource->hash, value);
+    const auto source = pSource->source;
+    for(std::size_t begin = 0; begin < source.size();) {
+      const auto newline = source.find('\n', begin);
+      const auto end = newline == std::string_view::npos ? source.size() : newline + 1;
+      const auto name = ShaderIncludes::included(source.substr(begin, end - begin));
+      if(!name.empty() && !combine(shaderId(name), included, value)) {
+        return false;
+      }
+      begin = end;
+    }
+    return true;
+  }
+
+  std::array<ShaderSource, N> mSources;
+};
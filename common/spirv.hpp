@@ -0,0 +1,75 @@
+#pragma once
+// STL
+#include <array>
+#include <string>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+// glbinding
+#include <glbinding/gl/gl.h>
+
+// Set SPIRV_SHADERS=<directory> to load the shaders a build with ENABLE_SPIRV compiled to SPIR-V with glslang, instead of
+// compiling their GLSL at startup. Needs GL 4.6 or GL_ARB_gl_spirv (Mesa llvmpipe has both), shaders without a SPIR-V
+// file or rejected by the driver are compiled from GLSL as before.
+inline const char *const gSpirvShaders = std::getenv("SPIRV_SHADERS");
+
+// GL 4.6 took glSpecializeShader from GL_ARB_gl_spirv, older contexts only have the ARB entry point.
+enum class SpirvSupport { NONE, ARB, CORE };
+
+inline auto spirvSupport() -> SpirvSupport {
+  static const auto support = [] {
+    if(gSpirvShaders == nullptr) {
+      return SpirvSupport::NONE;
+    }
+    gl::GLint major = 0;
+    gl::GLint minor = 0;
+    gl::glGetIntegerv(gl::GL_MAJOR_VERSION, &major);
+    gl::glGetIntegerv(gl::GL_MINOR_VERSION, &minor);
+    if(major > 4 || (major == 4 && minor >= 6)) {
+      return SpirvSupport::CORE;
+    }
+    gl::GLint extensions = 0;
+    gl::glGetIntegerv(gl::GL_NUM_EXTENSIONS, &extensions);
+    for(gl::GLint i = 0; i < extensions; ++i) {
+      const auto *pName = reinterpret_cast<const char *>(gl::glGetStringi(gl::GL_EXTENSIONS, static_cast<gl::GLuint>(i)));
+      if(std::strcmp(pName, "GL_ARB_gl_spirv") == 0) {
+        return SpirvSupport::ARB;
+      }
+    }
+    std::cerr << "SPIR-V: the driver has neither GL 4.6 nor GL_ARB_gl_spirv, compiling GLSL\n";
+    return SpirvSupport::NONE;
+  }();
+  return support;
+}
+
+// The SPIR-V module `<SPIRV_SHADERS>/<fileName>`, empty when SPIR-V is off or the file is missing.
+inline auto loadSpirv(const std::string &fileName) -> std::string {
+  if(spirvSupport() == SpirvSupport::NONE) {
+    return {};
+  }
+  std::ifstream input(std::string(gSpirvShaders) + '/' + fileName, std::ios::binary);
+  return {std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>()};
+}
+
+// A shader specialized from the `main` entry point of the module, 0 when the driver rejects it.
+inline auto spirvShader(gl::GLenum type, const std::string &module) -> gl::GLuint {
+  const auto shader = gl::glCreateShader(type);
+  gl::glShaderBinary(1, &shader, gl::GL_SHADER_BINARY_FORMAT_SPIR_V_ARB, module.data(), static_cast<gl::GLsizei>(module.size()));
+  if(spirvSupport() == SpirvSupport::CORE) {
+    gl::glSpecializeShader(shader, "main", 0, nullptr, nullptr);
+  } else {
+    gl::glSpecializeShaderARB(shader, "main", 0, nullptr, nullptr);
+  }
+  gl::GLint status = 0;
+  gl::glGetShaderiv(shader, gl::GL_COMPILE_STATUS, &status);
+  if(status != 1) {
+    std::array<gl::GLchar, 1024> message{};
+    gl::glGetShaderInfoLog(shader, static_cast<gl::GLsizei>(message.size()), nullptr, message.data());
+    std::cerr << "SPIR-V: " << message.data() << '\n';
+    gl::glDeleteShader(shader);
+    return 0;
+  }
+  return shader;
+}
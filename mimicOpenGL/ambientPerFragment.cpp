@@ -0,0 +1,114 @@
+// STL
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+// common
+#include <common/benchmark.hpp>
+// mimicOpenGL
+#include <mimicOpenGL/gl.hpp>
+#include <mimicOpenGL/sample.hpp>
+
+// shaders/materials/ambientPerFragment.cpp drawn by the software renderer, no GPU or GL driver involved.
+
+using namespace mimic;
+
+constexpr auto gTitle = "Scene (software)";
+
+namespace {
+
+struct Uniforms {
+  Vec3 materialAmbient;
+  Mat4 modelViewProjection;
+};
+
+void vertexShader(const std::byte *pUniforms, const VertexInput &input, VertexOutput &output) {
+  const auto &u = *reinterpret_cast<const Uniforms *>(pUniforms);
+  const auto position = Vec4{input.attributes[0].x, input.attributes[0].y, input.attributes[0].z, 1};
+  output.position = u.modelViewProjection * position;
+}
+
+auto fragmentShader(const std::byte *pUniforms, const float *) -> Vec4 {
+  const auto &u = *reinterpret_cast<const Uniforms *>(pUniforms);
+  return {u.materialAmbient.x, u.materialAmbient.y, u.materialAmbient.z, 1};
+}
+
+void fragmentShader8(const std::byte *pUniforms, const float *, float *pColor) {
+  const auto &u = *reinterpret_cast<const Uniforms *>(pUniforms);
+  std::fill(pColor, pColor + 8, u.materialAmbient.x);
+  std::fill(pColor + 8, pColor + 16, u.materialAmbient.y);
+  std::fill(pColor + 16, pColor + 24, u.materialAmbient.z);
+  std::fill(pColor + 24, pColor + 32, 1.F);
+}
+
+auto ambientProgram() -> ProgramDescription {
+  ProgramDescription description;
+  description.uniforms = {
+    {"uMatrial.Ambient", offsetof(Uniforms, materialAmbient), sizeof(Vec3)},
+    {"uMatrices.ModelViewProjection", offsetof(Uniforms, modelViewProjection), sizeof(Mat4)},
+  };
+  description.vertex = vertexShader;
+  description.fragment = fragmentShader;
+  description.fragment8 = fragmentShader8;
+  return description;
+}
+
+} // namespace
+
+auto mimic::ambientPerFragmentSample(const SampleOptions &options) -> int {
+  SampleTarget target(gTitle, options);
+  if(!target.valid()) {
+    return EXIT_FAILURE;
+  }
+  BenchmarkRecorder benchmark("mimicAmbientPerFragment");
+
+  benchmark.beginLoad();
+  SampleScene scene = loadSampleScene("sphere.obj");
+  scene.initialize();
+
+  const GLuint program = createProgram(ambientProgram());
+
+  const auto ratio = static_cast<float>(options.width) / static_cast<float>(options.height);
+  const auto prespective = perspective(45.F, ratio, 0.001F, 1000.F);
+  const auto view = lookAt(Vec3{2, 2, 2}, Vec3{}, Vec3{0, 1, 0});
+
+  const auto MVP = prespective * view;
+
+  auto locationMatrialAmbient              = glGetUniformLocation(program, "uMatrial.Ambient");
+  auto locationMatricesModelViewProjection = glGetUniformLocation(program, "uMatrices.ModelViewProjection");
+
+  benchmark.endLoad();
+
+  glEnable(GL_DEPTH_TEST);
+  glDepthFunc(GL_LESS);
+
+  while(target.poll()) {
+    benchmark.beginFrame();
+    const auto start = std::chrono::steady_clock::now();
+
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    glUseProgram(program);
+    {
+      const Vec3 materialAmbient{0.2F, 0.2F, 0.2F};
+      glUniform3fv(locationMatrialAmbient,                    1, &materialAmbient.x);
+      glUniformMatrix4fv(locationMatricesModelViewProjection, 1, GL_FALSE, MVP.data());
+
+      scene.draw();
+    }
+    glUseProgram(0);
+
+    target.present();
+
+    const auto cpuTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    printf("\rCPU: FPS: %.3F, Time: %.3F", 1000. / cpuTime, cpuTime);
+    benchmark.endFrame();
+    if(benchmark.finished()) {
+      break;
+    }
+  }
+
+  glDeleteProgram(program);
+  return EXIT_SUCCESS;
+}
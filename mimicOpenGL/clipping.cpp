@@ -0,0 +1,184 @@
+// STL
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <algorithm>
+// mimicOpenGL
+#include <mimicOpenGL/gl.hpp>
+
+// Watertightness of clipping and setup: the camera looks around from random points inside a closed box with the near
+// plane of loadObj, so that most views clip triangles at the near plane and against the guard band. Every pixel has to
+// be covered exactly once, holes count the pixels not covered and overlaps the fragments beyond one per pixel.
+// Usage: mimicclipping [--size WxH] [--views N]
+
+using namespace mimic;
+
+using Clock = std::chrono::steady_clock;
+
+struct Uniforms {
+  Mat4 modelViewProjection;
+};
+
+static void vertexShader(const std::byte *pUniforms, const VertexInput &input, VertexOutput &output) {
+  const auto &u = *reinterpret_cast<const Uniforms *>(pUniforms);
+  const auto position = Vec4{input.attributes[0].x, input.attributes[0].y, input.attributes[0].z, 1};
+  output.varyings[0] = 0.5F + 0.25F * input.attributes[0].x;
+  output.varyings[1] = 0.5F + 0.25F * input.attributes[0].y;
+  output.varyings[2] = 0.5F + 0.25F * input.attributes[0].z;
+  output.position = u.modelViewProjection * position;
+}
+
+// Never black, a black pixel is a hole.
+static auto fragmentShader(const std::byte *, const float *pVaryings) -> Vec4 {
+  return {pVaryings[0], pVaryings[1], pVaryings[2], 1};
+}
+
+static void fragmentShader8(const std::byte *, const float *pVaryings, float *pColor) {
+  std::copy(pVaryings, pVaryings + 3 * 8, pColor);
+  std::fill(pColor + 3 * 8, pColor + 4 * 8, 1.F);
+}
+
+// The faces of [-1, 1]^3 as `grid` x `grid` quads, the inner vertices jittered so that the edges are not axis aligned.
+// Faces share their border vertices exactly.
+static auto box(int grid) -> std::vector<float> {
+  std::mt19937 random(1);
+  std::uniform_real_distribution<float> jitter(-0.15F, 0.15F);
+  const auto step = 2.F / static_cast<float>(grid);
+  std::vector<float> vertices;
+  std::vector<std::array<float, 2>> points(static_cast<std::size_t>((grid + 1) * (grid + 1)));
+  for(int face = 0; face < 6; ++face) {
+    const auto axis = face / 2;
+    const auto side = face % 2 == 0 ? -1.F : 1.F;
+    for(int i = 0; i <= grid; ++i) {
+      for(int j = 0; j <= grid; ++j) {
+        auto &point = points[static_cast<std::size_t>(i * (grid + 1) + j)];
+        point = {-1 + step * static_cast<float>(i), -1 + step * static_cast<float>(j)};
+        if(i > 0 && i < grid && j > 0 && j < grid) {
+          point[0] += jitter(random) * step;
+          point[1] += jitter(random) * step;
+        }
+      }
+    }
+    const auto vertex = [&](int i, int j) {
+      const auto &point = points[static_cast<std::size_t>(i * (grid + 1) + j)];
+      std::array<float, 3> position{};
+      position[static_cast<std::size_t>(axis)] = side;
+      position[static_cast<std::size_t>((axis + 1) % 3)] = point[0];
+      position[static_cast<std::size_t>((axis + 2) % 3)] = point[1];
+      vertices.insert(vertices.end(), position.begin(), position.end());
+    };
+    for(int i = 0; i < grid; ++i) {
+      for(int j = 0; j < grid; ++j) {
+        for(const auto &[di, dj] : {std::array{0, 0}, {1, 0}, {1, 1}, {0, 0}, {1, 1}, {0, 1}}) {
+          vertex(i + di, j + dj);
+        }
+      }
+    }
+  }
+  return vertices;
+}
+
+int main(int argc, char *argv[]) {
+  GLsizei width = 1280;
+  GLsizei height = 720;
+  int views = 100;
+  for(int i = 1; i + 1 < argc; i += 2) {
+    const std::string option = argv[i];
+    if(option == "--size") {
+      std::sscanf(argv[i + 1], "%dx%d", &width, &height);
+    } else if(option == "--views") {
+      views = std::max(1, std::atoi(argv[i + 1]));
+    } else {
+      std::cerr << "Usage: " << argv[0] << " [--size WxH] [--views N]\n";
+      return EXIT_FAILURE;
+    }
+  }
+
+  auto *pContext = createContext(width, height, 0);
+  if(pContext == nullptr) {
+    std::cerr << "Can not create a " << width << "x" << height << " context\n";
+    return EXIT_FAILURE;
+  }
+  makeCurrent(pContext);
+
+  ProgramDescription description;
+  description.uniforms = {{"uMVP", offsetof(Uniforms, modelViewProjection), sizeof(Mat4)}};
+  description.vertex = vertexShader;
+  description.fragment = fragmentShader;
+  description.fragment8 = fragmentShader8;
+  description.varyings = 3;
+  const auto program = createProgram(description);
+  glUseProgram(program);
+  const auto location = glGetUniformLocation(program, "uMVP");
+
+  const auto vertices = box(32);
+  const auto count = static_cast<GLsizei>(vertices.size() / 3);
+  GLuint vao = 0;
+  GLuint buffer = 0;
+  glGenVertexArrays(1, &vao);
+  glBindVertexArray(vao);
+  glGenBuffers(1, &buffer);
+  glBindBuffer(GL_ARRAY_BUFFER, buffer);
+  glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(vertices.size() * sizeof(float)), vertices.data(), GL_STATIC_DRAW);
+  glVertexAttribPointer(0, 3, GL_FLOAT, false, 0, nullptr);
+  glEnableVertexAttribArray(0);
+
+  const auto aspect = static_cast<float>(width) / static_cast<float>(height);
+  const auto projection = perspective(0.8F, aspect, 0.001F, 1000.F);
+  std::mt19937 random(2);
+  std::uniform_real_distribution<float> position(-0.9F, 0.9F);
+  std::uniform_real_distribution<float> angle(0.F, 6.2831853F);
+  const auto pixels = static_cast<std::uint64_t>(width) * static_cast<std::uint64_t>(height);
+  std::vector<std::uint32_t> image(static_cast<std::size_t>(pixels));
+  std::uint64_t holes = 0;
+  std::uint64_t overlaps = 0;
+  int failed = 0;
+  double milliseconds = 0;
+  for(int i = 0; i < views; ++i) {
+    const Vec3 eye{position(random), position(random), position(random)};
+    const auto yaw = angle(random);
+    const auto pitch = angle(random);
+    const Vec3 direction{std::cos(yaw) * std::cos(pitch), std::sin(pitch), std::sin(yaw) * std::cos(pitch)};
+    const auto modelViewProjection = projection * lookAt(eye, eye + direction, {0, 1, 0});
+    glUniformMatrix4fv(location, 1, GL_FALSE, modelViewProjection.data());
+
+    resetRasterStatistics();
+    const auto start = Clock::now();
+    glClear(GL_COLOR_BUFFER_BIT);
+    glDrawArrays(GL_TRIANGLES, 0, count);
+    glFinish();
+    milliseconds += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, image.data());
+    const auto black = [](std::uint32_t pixel) { return (pixel & 0xFFFFFFU) == 0; };
+    const auto uncovered = static_cast<std::uint64_t>(std::count_if(image.begin(), image.end(), black));
+    const auto fragments = rasterStatistics().fragments;
+    const auto extra = fragments + uncovered - pixels;
+    holes += uncovered;
+    overlaps += extra;
+    failed += uncovered != 0 || extra != 0 ? 1 : 0;
+  }
+
+  std::printf("%dx%d, %d triangles, %d views from inside a box, near plane 0.001\n", width, height, count / 3, views);
+  std::printf("%9s %12s %12s %9s\n", "ms/frame", "holes", "overlaps", "failed");
+  std::printf("%9.2f %12llu %12llu %9d\n", milliseconds / views, static_cast<unsigned long long>(holes),
+              static_cast<unsigned long long>(overlaps), failed);
+
+  glDeleteBuffers(1, &buffer);
+  glDeleteVertexArrays(1, &vao);
+  glDeleteProgram(program);
+  if(glGetError() != GL_NO_ERROR) {
+    std::cerr << "GL error\n";
+    return EXIT_FAILURE;
+  }
+  destroyContext(pContext);
+  return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
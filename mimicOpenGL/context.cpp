@@ -0,0 +1,200 @@
+#include <mimicOpenGL/context.hpp>
+// STL
+#include <limits>
+#include <cstring>
+#include <utility>
+#include <algorithm>
+
+namespace mimic {
+
+// Vertices shaded per task, the unit of parallel work in the vertex stage. A multiple of the batch size.
+constexpr std::size_t gVertexChunk = 1024;
+// Vertices per VertexShader8 call.
+constexpr std::size_t gVertexBatch = 8;
+static_assert(gVertexChunk % gVertexBatch == 0);
+// Index ranges wider than this many slots per index skip the post-transform cache instead of allocating it.
+constexpr std::size_t gMaxSlotsPerIndex = 16;
+
+constexpr auto gNoSlot = std::numeric_limits<std::uint32_t>::max();
+
+// The buffers are allocated before the rasterizer sees the framebuffer, it derives its depth bounds from them.
+static auto framebuffer(GLsizei width, GLsizei height) -> Framebuffer {
+  const auto stride = (width + 7) / 8 * 8;
+  const auto pixels = static_cast<std::size_t>(stride) * static_cast<std::size_t>(height);
+  return {width, height, stride, std::vector<std::uint32_t>(pixels, 0), std::vector<float>(pixels, 1.F)};
+}
+
+Context::Context(GLsizei width, GLsizei height, std::size_t threads)
+  : mPool(threads), mFramebuffer(framebuffer(width, height)), mRasterizer(mPool, mFramebuffer) {
+  mViewport = {0, 0, width, height};
+}
+
+// Resolves the enabled attributes once and checks they stay inside their buffers up to vertex `last`.
+auto Context::resolve(const VertexArray &vertexArray, std::size_t last, Fetches &fetches) -> bool {
+  fetches = {};
+  for(std::size_t i = 0; i < gMaxVertexAttributes; ++i) {
+    const auto &attribute = vertexArray.attributes[i];
+    if(!attribute.bEnabled) {
+      continue;
+    }
+    const auto buffer = mBuffers.find(attribute.buffer);
+    const auto elementBytes = static_cast<std::size_t>(attribute.size) * sizeof(float);
+    const auto stride = attribute.stride != 0 ? static_cast<std::size_t>(attribute.stride) : elementBytes;
+    if(buffer == std::end(mBuffers) || attribute.offset + last * stride + elementBytes > buffer->second.data.size()) {
+      setError(GL_INVALID_OPERATION);
+      return false;
+    }
+    fetches[i] = {buffer->second.data.data() + attribute.offset, stride, attribute.size};
+  }
+  return true;
+}
+
+void Context::shade(const Program &program, const Fetches &fetches, const std::uint32_t *pVertices, std::size_t first, std::size_t count) {
+  const auto &description = program.description;
+  const auto *pUniforms = program.uniforms.data();
+  const auto fetch = [&fetches, pVertices, first](std::size_t i, VertexInput &input) {
+    const auto vertex = pVertices != nullptr ? pVertices[i] : first + i;
+    for(std::size_t a = 0; a < gMaxVertexAttributes; ++a) {
+      auto &value = input.attributes[a];
+      value = {0, 0, 0, 1};
+      if(fetches[a].pData != nullptr) {
+        std::memcpy(&value, fetches[a].pData + vertex * fetches[a].stride, static_cast<std::size_t>(fetches[a].size) * sizeof(float));
+      }
+    }
+  };
+
+  mShaded.resize(count);
+  const auto chunks = (count + gVertexChunk - 1) / gVertexChunk;
+  mPool.parallelFor(chunks, [&](std::size_t chunk, std::size_t) {
+    const auto begin = chunk * gVertexChunk;
+    const auto end = std::min(begin + gVertexChunk, count);
+    VertexInput input;
+    if(description.vertex8 == nullptr) {
+      for(auto i = begin; i < end; ++i) {
+        fetch(i, input);
+        description.vertex(pUniforms, input, mShaded[i]);
+      }
+      return;
+    }
+
+    // Transpose 8 vertices into lanes, shade them together and transpose the result back.
+    VertexInput8 input8;
+    VertexOutput8 output8;
+    for(auto batch = begin; batch < end; batch += gVertexBatch) {
+      const auto lanes = std::min(gVertexBatch, end - batch);
+      for(std::size_t lane = 0; lane < gVertexBatch; ++lane) {
+        fetch(batch + std::min(lane, lanes - 1), input);
+        for(std::size_t a = 0; a < gMaxVertexAttributes; ++a) {
+          const auto &value = input.attributes[a];
+          auto &attribute = input8.attributes[a];
+          attribute[lane] = value.x;
+          attribute[gVertexBatch + lane] = value.y;
+          attribute[2 * gVertexBatch + lane] = value.z;
+          attribute[3 * gVertexBatch + lane] = value.w;
+        }
+      }
+      description.vertex8(pUniforms, input8, output8);
+      for(std::size_t lane = 0; lane < lanes; ++lane) {
+        auto &output = mShaded[batch + lane];
+        const auto &position = output8.position;
+        output.position = {position[lane], position[gVertexBatch + lane], position[2 * gVertexBatch + lane], position[3 * gVertexBatch + lane]};
+        for(std::size_t k = 0; k < description.varyings; ++k) {
+          output.varyings[k] = output8.varyings[k * gVertexBatch + lane];
+        }
+      }
+    }
+  });
+}
+
+void Context::submit(const Program &program, const std::vector<std::uint32_t> *pIndices) {
+  const auto &description = program.description;
+  DrawState state;
+  state.fragment = description.fragment;
+  state.fragment8 = description.fragment8;
+  state.uniforms = program.uniforms;
+  state.varyings = description.varyings;
+  state.bDepthTest = mbDepthTest;
+  state.depthFunc = mDepthFunc;
+  if(pIndices != nullptr) {
+    mRasterizer.submit(std::move(state), mShaded, *pIndices, mViewport);
+  } else {
+    mRasterizer.submit(std::move(state), mShaded, mViewport);
+  }
+}
+
+void Context::drawArrays(GLint first, GLsizei count) {
+  const auto program = mPrograms.find(mProgram);
+  const auto vertexArray = mVertexArrays.find(mVertexArray);
+  if(program == std::end(mPrograms) || vertexArray == std::end(mVertexArrays)) {
+    setError(GL_INVALID_OPERATION);
+    return;
+  }
+  Fetches fetches;
+  if(!resolve(vertexArray->second, static_cast<std::size_t>(first) + static_cast<std::size_t>(count) - 1, fetches)) {
+    return;
+  }
+  shade(program->second, fetches, nullptr, static_cast<std::size_t>(first), static_cast<std::size_t>(count));
+  submit(program->second, nullptr);
+}
+
+void Context::drawElements(GLsizei count, GLenum type, std::size_t offset) {
+  const auto program = mPrograms.find(mProgram);
+  const auto vertexArray = mVertexArrays.find(mVertexArray);
+  if(program == std::end(mPrograms) || vertexArray == std::end(mVertexArrays)) {
+    setError(GL_INVALID_OPERATION);
+    return;
+  }
+  const auto elements = mBuffers.find(vertexArray->second.elementBuffer);
+  const auto indexBytes = type == GL_UNSIGNED_INT ? sizeof(std::uint32_t) : sizeof(std::uint16_t);
+  const auto indices = static_cast<std::size_t>(count);
+  if(elements == std::end(mBuffers) || offset + indices * indexBytes > elements->second.data.size()) {
+    setError(GL_INVALID_OPERATION);
+    return;
+  }
+
+  mIndices.resize(indices);
+  const auto *pData = elements->second.data.data() + offset;
+  if(type == GL_UNSIGNED_INT) {
+    std::memcpy(mIndices.data(), pData, indices * sizeof(std::uint32_t));
+  } else {
+    for(std::size_t i = 0; i < indices; ++i) {
+      std::uint16_t index;
+      std::memcpy(&index, pData + i * sizeof(index), sizeof(index));
+      mIndices[i] = index;
+    }
+  }
+  const auto [minIndex, maxIndex] = std::minmax_element(std::cbegin(mIndices), std::cend(mIndices));
+  const auto lowest = *minIndex;
+  const auto highest = *maxIndex;
+  Fetches fetches;
+  if(!resolve(vertexArray->second, highest, fetches)) {
+    return;
+  }
+
+  // Every referenced vertex is shaded once, the indices are remapped to its slot in mShaded.
+  mUnique.clear();
+  const auto range = static_cast<std::size_t>(highest - lowest) + 1;
+  if(range <= gMaxSlotsPerIndex * indices) {
+    mSlots.assign(range, gNoSlot);
+    for(auto &index : mIndices) {
+      auto &slot = mSlots[index - lowest];
+      if(slot == gNoSlot) {
+        slot = static_cast<std::uint32_t>(mUnique.size());
+        mUnique.push_back(index);
+      }
+      index = slot;
+    }
+  } else {
+    mUnique.swap(mIndices);
+    mIndices.resize(indices);
+    for(std::size_t i = 0; i < indices; ++i) {
+      mIndices[i] = static_cast<std::uint32_t>(i);
+    }
+  }
+  shade(program->second, fetches, mUnique.data(), 0, mUnique.size());
+  submit(program->second, &mIndices);
+}
+
+void Context::clear(GLbitfield mask) { mRasterizer.clear(mask, packColor(mClearColor), std::clamp(mClearDepth, 0.F, 1.F)); }
+
+} // namespace mimic
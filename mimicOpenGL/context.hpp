@@ -0,0 +1,102 @@
+#pragma once
+// STL
+#include <array>
+#include <vector>
+#include <cstddef>
+#include <unordered_map>
+// mimicOpenGL
+#include <mimicOpenGL/gl.hpp>
+#include <mimicOpenGL/rasterizer.hpp>
+#include <mimicOpenGL/threadPool.hpp>
+
+namespace mimic {
+
+struct Buffer {
+  std::vector<std::byte> data;
+};
+
+struct VertexAttribute {
+  bool bEnabled = false;
+  GLint size = 4;
+  GLsizei stride = 0;
+  std::size_t offset = 0;
+  GLuint buffer = 0;
+};
+
+struct VertexArray {
+  std::array<VertexAttribute, gMaxVertexAttributes> attributes;
+  GLuint elementBuffer = 0;
+};
+
+struct Program {
+  ProgramDescription description;
+  std::vector<std::byte> uniforms;
+};
+
+// GL state and objects of one software context. The gl* functions in gl.cpp operate on the current one.
+class Context final {
+public:
+  Context(GLsizei width, GLsizei height, std::size_t threads);
+
+  void setError(GLenum error) {
+    if(mError == GL_NO_ERROR) {
+      mError = error;
+    }
+  }
+
+  void drawArrays(GLint first, GLsizei count);
+  void drawElements(GLsizei count, GLenum type, std::size_t offset);
+  void clear(GLbitfield mask);
+  void finish() { mRasterizer.flush(); }
+
+  template<typename Object>
+  static auto generate(std::unordered_map<GLuint, Object> &objects, GLuint &next) -> GLuint {
+    objects.emplace(next, Object{});
+    return next++;
+  }
+
+  GLenum mError = GL_NO_ERROR;
+
+  std::unordered_map<GLuint, Buffer> mBuffers;
+  std::unordered_map<GLuint, VertexArray> mVertexArrays;
+  std::unordered_map<GLuint, Program> mPrograms;
+  GLuint mNextBuffer = 1;
+  GLuint mNextVertexArray = 1;
+  GLuint mNextProgram = 1;
+
+  GLuint mArrayBuffer = 0;
+  GLuint mVertexArray = 0;
+  GLuint mProgram = 0;
+
+  bool mbDepthTest = false;
+  GLenum mDepthFunc = GL_LESS;
+  Viewport mViewport;
+  Vec4 mClearColor;
+  float mClearDepth = 1.F;
+
+  ThreadPool mPool;
+  Framebuffer mFramebuffer;
+  Rasterizer mRasterizer;
+
+private:
+  struct Fetch {
+    const std::byte *pData = nullptr;
+    std::size_t stride = 0;
+    GLint size = 0;
+  };
+  using Fetches = std::array<Fetch, gMaxVertexAttributes>;
+
+  auto resolve(const VertexArray &vertexArray, std::size_t last, Fetches &fetches) -> bool;
+  // Shades `count` vertices into mShaded, vertex i is pVertices[i] or else first + i.
+  void shade(const Program &program, const Fetches &fetches, const std::uint32_t *pVertices, std::size_t first, std::size_t count);
+  void submit(const Program &program, const std::vector<std::uint32_t> *pIndices);
+
+  std::vector<VertexOutput> mShaded;
+  // Post-transform cache of indexed draws: mShaded holds every referenced vertex once, in order of first use,
+  // mIndices the draw's indices remapped into it.
+  std::vector<std::uint32_t> mIndices;
+  std::vector<std::uint32_t> mUnique;
+  std::vector<std::uint32_t> mSlots;
+};
+
+} // namespace mimic
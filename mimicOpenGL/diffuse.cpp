@@ -0,0 +1,166 @@
+// STL
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+// common
+#include <common/benchmark.hpp>
+// mimicOpenGL
+#include <mimicOpenGL/gl.hpp>
+#include <mimicOpenGL/sample.hpp>
+#include <mimicOpenGL/simdMath.hpp>
+
+// shaders/materials/diffuse.cpp drawn by the software renderer, no GPU or GL driver involved.
+
+using namespace mimic;
+
+constexpr auto gTitle = "Scene (software)";
+
+namespace {
+
+struct Uniforms {
+  Vec3 materialDiffuse;
+  Vec4 lightPosition;
+  Vec3 lightColor;
+  Mat3 normal;
+  Mat4 modelView;
+  Mat4 modelViewProjection;
+};
+
+// Gouraud shading, a line by line port of the GLSL vertex shader of the GL demo.
+void vertexShader(const std::byte *pUniforms, const VertexInput &input, VertexOutput &output) {
+  const auto &u = *reinterpret_cast<const Uniforms *>(pUniforms);
+  const auto position = Vec4{input.attributes[0].x, input.attributes[0].y, input.attributes[0].z, 1};
+  const auto n = normalize(u.normal * xyz(input.attributes[1]));
+  const auto eyeCoord = u.modelView * position;
+  const auto s = normalize(xyz(u.lightPosition - eyeCoord));
+  const auto sn = std::max(dot(s, n), 0.F);
+
+  // L = Ld . Kd . s . n
+  const auto lightIntensity = u.lightColor * u.materialDiffuse * sn;
+  output.varyings[0] = lightIntensity.x;
+  output.varyings[1] = lightIntensity.y;
+  output.varyings[2] = lightIntensity.z;
+
+  output.position = u.modelViewProjection * position;
+}
+
+// The same for 8 vertices, one per lane.
+void vertexShader8(const std::byte *pUniforms, const VertexInput8 &input, VertexOutput8 &output) {
+  using namespace simd;
+  const auto &u = *reinterpret_cast<const Uniforms *>(pUniforms);
+  auto position = attribute(input, 0);
+  position.w = set1(1.F);
+  const auto n = normalize(u.normal * xyz(attribute(input, 1)));
+  const auto eyeCoord = u.modelView * position;
+  const auto s = normalize(xyz(set1(u.lightPosition)) - xyz(eyeCoord));
+  const auto sn = max(dot(s, n), set1(0.F));
+
+  // L = Ld . Kd . s . n
+  const auto lightIntensity = (u.lightColor * u.materialDiffuse) * sn;
+  setVarying(output, 0, lightIntensity.x);
+  setVarying(output, 1, lightIntensity.y);
+  setVarying(output, 2, lightIntensity.z);
+
+  setPosition(output, u.modelViewProjection * position);
+}
+
+auto fragmentShader(const std::byte *, const float *pVaryings) -> Vec4 { return {pVaryings[0], pVaryings[1], pVaryings[2], 1}; }
+
+// The same for 8 fragments, the varyings already are the color channels.
+void fragmentShader8(const std::byte *, const float *pVaryings, float *pColor) {
+  std::copy(pVaryings, pVaryings + 3 * 8, pColor);
+  std::fill(pColor + 3 * 8, pColor + 4 * 8, 1.F);
+}
+
+auto diffuseProgram() -> ProgramDescription {
+  ProgramDescription description;
+  description.uniforms = {
+    {"uMatrial.Diffuse", offsetof(Uniforms, materialDiffuse), sizeof(Vec3)},
+    {"uLight.Pos", offsetof(Uniforms, lightPosition), sizeof(Vec4)},
+    {"uLight.Color", offsetof(Uniforms, lightColor), sizeof(Vec3)},
+    {"uMatrices.Normal", offsetof(Uniforms, normal), sizeof(Mat3)},
+    {"uMatrices.ModelView", offsetof(Uniforms, modelView), sizeof(Mat4)},
+    {"uMatrices.ModelViewProjection", offsetof(Uniforms, modelViewProjection), sizeof(Mat4)},
+  };
+  description.vertex = vertexShader;
+  description.vertex8 = vertexShader8;
+  description.fragment = fragmentShader;
+  description.fragment8 = fragmentShader8;
+  description.varyings = 3;
+  return description;
+}
+
+} // namespace
+
+auto mimic::diffuseSample(const SampleOptions &options) -> int {
+  SampleTarget target(gTitle, options);
+  if(!target.valid()) {
+    return EXIT_FAILURE;
+  }
+  BenchmarkRecorder benchmark("mimicDiffuse");
+
+  benchmark.beginLoad();
+  SampleScene scene = loadSampleScene("sphere.obj");
+  scene.initialize();
+
+  const GLuint program = createProgram(diffuseProgram());
+
+  const auto ratio = static_cast<float>(options.width) / static_cast<float>(options.height);
+  const auto prespective = perspective(45.F, ratio, 0.001F, 1000.F);
+  const auto view = lookAt(Vec3{2, 2, 2}, Vec3{}, Vec3{0, 1, 0});
+
+  const auto MVP = prespective * view;
+
+  const auto N = toMat3(view);
+
+  auto locationMatrialDiffuse              = glGetUniformLocation(program, "uMatrial.Diffuse");
+  auto locationLightPos                    = glGetUniformLocation(program, "uLight.Pos");
+  auto locationLightColor                  = glGetUniformLocation(program, "uLight.Color");
+  auto locationMatricesNormal              = glGetUniformLocation(program, "uMatrices.Normal");
+  auto locationMatricesModelView           = glGetUniformLocation(program, "uMatrices.ModelView");
+  auto locationMatricesModelViewProjection = glGetUniformLocation(program, "uMatrices.ModelViewProjection");
+
+  benchmark.endLoad();
+
+  glEnable(GL_DEPTH_TEST);
+  glDepthFunc(GL_LESS);
+
+  while(target.poll()) {
+    benchmark.beginFrame();
+    const auto start = std::chrono::steady_clock::now();
+
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    glUseProgram(program);
+    {
+      const Vec3 materialDiffuse{1, 1, 1};
+      const Vec3 lightColor{1, 1, 1};
+      const Vec4 lightPosition{10, 10, 10, 1};
+
+      glUniform3fv(locationMatrialDiffuse, 1, &materialDiffuse.x);
+      glUniform3fv(locationLightColor,     1, &lightColor.x);
+      glUniform4fv(locationLightPos,       1, &lightPosition.x);
+
+      glUniformMatrix3fv(locationMatricesNormal,              1, GL_FALSE, &N.columns[0].x);
+      glUniformMatrix4fv(locationMatricesModelView,           1, GL_FALSE, view.data());
+      glUniformMatrix4fv(locationMatricesModelViewProjection, 1, GL_FALSE, MVP.data());
+
+      scene.draw();
+    }
+    glUseProgram(0);
+
+    target.present();
+
+    const auto cpuTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    printf("\rCPU: FPS: %.3F, Time: %.3F", 1000. / cpuTime, cpuTime);
+    benchmark.endFrame();
+    if(benchmark.finished()) {
+      break;
+    }
+  }
+
+  glDeleteProgram(program);
+  return EXIT_SUCCESS;
+}
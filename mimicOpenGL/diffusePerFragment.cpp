@@ -0,0 +1,172 @@
+// STL
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+// common
+#include <common/benchmark.hpp>
+// mimicOpenGL
+#include <mimicOpenGL/gl.hpp>
+#include <mimicOpenGL/sample.hpp>
+#include <mimicOpenGL/simdMath.hpp>
+
+// shaders/materials/diffusePerFragment.cpp and diffusePerFragmentUBO.cpp drawn by the software renderer, no GPU or
+// GL driver involved. Both demos draw the same image, the UBO only changes how the GL demo uploads the matrices.
+
+using namespace mimic;
+
+constexpr auto gTitle = "Scene (software)";
+
+namespace {
+
+struct Uniforms {
+  Vec3 materialAmbient;
+  Vec3 materialDiffuse;
+  Vec3 lightPosition;
+  Vec3 lightColor;
+  Mat3 normal;
+  Mat4 modelView;
+  Mat4 modelViewProjection;
+};
+
+// Eye space normal and position, a line by line port of the GLSL vertex shader of the GL demo.
+void vertexShader(const std::byte *pUniforms, const VertexInput &input, VertexOutput &output) {
+  const auto &u = *reinterpret_cast<const Uniforms *>(pUniforms);
+  const auto position = Vec4{input.attributes[0].x, input.attributes[0].y, input.attributes[0].z, 1};
+  const auto normal = normalize(u.normal * xyz(input.attributes[1]));
+  const auto eyePosition = xyz(u.modelView * position);
+  output.varyings[0] = normal.x;
+  output.varyings[1] = normal.y;
+  output.varyings[2] = normal.z;
+  output.varyings[3] = eyePosition.x;
+  output.varyings[4] = eyePosition.y;
+  output.varyings[5] = eyePosition.z;
+
+  output.position = u.modelViewProjection * position;
+}
+
+// Ambient plus diffuse per fragment, the interpolated normal is used as is like in the GLSL.
+auto fragmentShader(const std::byte *pUniforms, const float *pVaryings) -> Vec4 {
+  const auto &u = *reinterpret_cast<const Uniforms *>(pUniforms);
+  const auto normal = Vec3{pVaryings[0], pVaryings[1], pVaryings[2]};
+  const auto position = Vec3{pVaryings[3], pVaryings[4], pVaryings[5]};
+  const auto s = normalize(u.lightPosition - position);
+
+  const auto ambient = u.materialAmbient;
+  const auto diffuse = u.lightColor * u.materialDiffuse * std::max(dot(s, normal), 0.F);
+
+  const auto color = ambient + diffuse;
+  return {color.x, color.y, color.z, 1};
+}
+
+// The same for 8 fragments, one per lane.
+void fragmentShader8(const std::byte *pUniforms, const float *pVaryings, float *pColor) {
+  using namespace simd;
+  const auto &u = *reinterpret_cast<const Uniforms *>(pUniforms);
+  const auto normal = Vec3x8{load(pVaryings), load(pVaryings + 8), load(pVaryings + 16)};
+  const auto position = Vec3x8{load(pVaryings + 24), load(pVaryings + 32), load(pVaryings + 40)};
+  const auto s = normalize(set1(u.lightPosition) - position);
+
+  const auto diffuse = (u.lightColor * u.materialDiffuse) * max(dot(s, normal), set1(0.F));
+
+  const auto color = set1(u.materialAmbient) + diffuse;
+  store(pColor, color.x);
+  store(pColor + 8, color.y);
+  store(pColor + 16, color.z);
+  store(pColor + 24, set1(1.F));
+}
+
+auto diffuseProgram() -> ProgramDescription {
+  ProgramDescription description;
+  description.uniforms = {
+    {"uMatrial.Ambient", offsetof(Uniforms, materialAmbient), sizeof(Vec3)},
+    {"uMatrial.Diffuse", offsetof(Uniforms, materialDiffuse), sizeof(Vec3)},
+    {"uLight.Pos", offsetof(Uniforms, lightPosition), sizeof(Vec3)},
+    {"uLight.Color", offsetof(Uniforms, lightColor), sizeof(Vec3)},
+    {"uMatrices.Normal", offsetof(Uniforms, normal), sizeof(Mat3)},
+    {"uMatrices.ModelView", offsetof(Uniforms, modelView), sizeof(Mat4)},
+    {"uMatrices.ModelViewProjection", offsetof(Uniforms, modelViewProjection), sizeof(Mat4)},
+  };
+  description.vertex = vertexShader;
+  description.fragment = fragmentShader;
+  description.fragment8 = fragmentShader8;
+  description.varyings = 6;
+  return description;
+}
+
+} // namespace
+
+auto mimic::diffusePerFragmentSample(const SampleOptions &options) -> int {
+  SampleTarget target(gTitle, options);
+  if(!target.valid()) {
+    return EXIT_FAILURE;
+  }
+  BenchmarkRecorder benchmark("mimicDiffusePerFragment");
+
+  benchmark.beginLoad();
+  SampleScene scene = loadSampleScene("sphere.obj");
+  scene.initialize();
+
+  const GLuint program = createProgram(diffuseProgram());
+
+  const auto ratio = static_cast<float>(options.width) / static_cast<float>(options.height);
+  const auto prespective = perspective(45.F, ratio, 0.001F, 1000.F);
+  const auto view = lookAt(Vec3{2, 2, 2}, Vec3{}, Vec3{0, 1, 0});
+
+  const auto MVP = prespective * view;
+
+  const auto N = toMat3(view);
+
+  auto locationMatrialAmbient              = glGetUniformLocation(program, "uMatrial.Ambient");
+  auto locationMatrialDiffuse              = glGetUniformLocation(program, "uMatrial.Diffuse");
+  auto locationLightPos                    = glGetUniformLocation(program, "uLight.Pos");
+  auto locationLightColor                  = glGetUniformLocation(program, "uLight.Color");
+  auto locationMatricesNormal              = glGetUniformLocation(program, "uMatrices.Normal");
+  auto locationMatricesModelView           = glGetUniformLocation(program, "uMatrices.ModelView");
+  auto locationMatricesModelViewProjection = glGetUniformLocation(program, "uMatrices.ModelViewProjection");
+
+  benchmark.endLoad();
+
+  glEnable(GL_DEPTH_TEST);
+  glDepthFunc(GL_LESS);
+
+  while(target.poll()) {
+    benchmark.beginFrame();
+    const auto start = std::chrono::steady_clock::now();
+
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    glUseProgram(program);
+    {
+      const Vec3 materialAmbient{0.2F, 0.2F, 0.2F};
+      const Vec3 materialDiffuse{1, 1, 1};
+      const Vec3 lightColor{1, 1, 1};
+      const Vec3 lightPosition{10, 10, 10};
+
+      glUniform3fv(locationMatrialAmbient, 1, &materialAmbient.x);
+      glUniform3fv(locationMatrialDiffuse, 1, &materialDiffuse.x);
+      glUniform3fv(locationLightColor,     1, &lightColor.x);
+      glUniform3fv(locationLightPos,       1, &lightPosition.x);
+
+      glUniformMatrix3fv(locationMatricesNormal,              1, GL_FALSE, &N.columns[0].x);
+      glUniformMatrix4fv(locationMatricesModelView,           1, GL_FALSE, view.data());
+      glUniformMatrix4fv(locationMatricesModelViewProjection, 1, GL_FALSE, MVP.data());
+
+      scene.draw();
+    }
+    glUseProgram(0);
+
+    target.present();
+
+    const auto cpuTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    printf("\rCPU: FPS: %.3F, Time: %.3F", 1000. / cpuTime, cpuTime);
+    benchmark.endFrame();
+    if(benchmark.finished()) {
+      break;
+    }
+  }
+
+  glDeleteProgram(program);
+  return EXIT_SUCCESS;
+}
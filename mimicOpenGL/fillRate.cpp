@@ -0,0 +1,199 @@
+// STL
+#include <array>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <algorithm>
+// mimicOpenGL
+#include <mimicOpenGL/gl.hpp>
+#include <mimicOpenGL/simd.hpp>
+
+// Fill rate of the scalar and the SIMD rasterizer on one thread, no window involved.
+// Usage: mimicfillRate [--size WxH] [--frames N] [--layers N]
+
+using namespace mimic;
+
+using Clock = std::chrono::steady_clock;
+
+static void vertexShader(const std::byte *, const VertexInput &input, VertexOutput &output) {
+  output.position = input.attributes[0];
+  output.varyings[0] = input.attributes[1].x;
+  output.varyings[1] = input.attributes[1].y;
+  output.varyings[2] = input.attributes[1].z;
+}
+
+static auto fragmentShader(const std::byte *, const float *pVaryings) -> Vec4 { return {pVaryings[0], pVaryings[1], pVaryings[2], 1}; }
+
+static void fragmentShader8(const std::byte *, const float *pVaryings, float *pColor) {
+  std::copy(pVaryings, pVaryings + 3 * 8, pColor);
+  std::fill(pColor + 3 * 8, pColor + 4 * 8, 1.F);
+}
+
+struct Vertex {
+  Vec4 position;
+  Vec4 color;
+};
+
+static void quad(std::vector<Vertex> &vertices, float x0, float y0, float x1, float y1, float z) {
+  const std::array<Vertex, 4> corners = {{
+    {{x0, y0, z, 1}, {1, 0, 0, 1}},
+    {{x1, y0, z, 1}, {0, 1, 0, 1}},
+    {{x1, y1, z, 1}, {0, 0, 1, 1}},
+    {{x0, y1, z, 1}, {1, 1, 1, 1}},
+  }};
+  vertices.insert(vertices.end(), {corners[0], corners[1], corners[2], corners[0], corners[2], corners[3]});
+}
+
+// `layers` full screen quads drawn back to front, every layer passes the depth test.
+static auto fullScreen(int layers) -> std::vector<Vertex> {
+  std::vector<Vertex> vertices;
+  for(int layer = 0; layer < layers; ++layer) {
+    quad(vertices, -1, -1, 1, 1, 0.9F - 1.8F * static_cast<float>(layer) / static_cast<float>(layers));
+  }
+  return vertices;
+}
+
+// `layers` grids of small quads, `cell` pixels wide, mostly partially covered blocks.
+static auto smallQuads(int layers, GLsizei width, GLsizei height, int cell) -> std::vector<Vertex> {
+  std::vector<Vertex> vertices;
+  const auto cellX = 2.F * static_cast<float>(cell) / static_cast<float>(width);
+  const auto cellY = 2.F * static_cast<float>(cell) / static_cast<float>(height);
+  for(int layer = 0; layer < layers; ++layer) {
+    const auto z = 0.9F - 1.8F * static_cast<float>(layer) / static_cast<float>(layers);
+    // Offset every layer so the quad corners do not line up with the 8x8 blocks.
+    const auto offset = static_cast<float>(layer % cell) * cellX / static_cast<float>(cell);
+    for(auto y = -1.F; y < 1.F; y += cellY) {
+      for(auto x = -1.F + offset; x < 1.F; x += cellX) {
+        quad(vertices, x, y, std::min(x + cellX, 1.F), std::min(y + cellY, 1.F), z);
+      }
+    }
+  }
+  return vertices;
+}
+
+struct Result {
+  double milliseconds;
+  std::vector<std::uint32_t> image;
+};
+
+static auto run(RasterMode mode, GLsizei width, GLsizei height, int frames, GLsizei count) -> Result {
+  setRasterMode(mode);
+  const auto frame = [count] {
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glDrawArrays(GL_TRIANGLES, 0, count);
+    glFinish();
+  };
+  frame(); // warm up
+  const auto start = Clock::now();
+  for(int i = 0; i < frames; ++i) {
+    frame();
+  }
+  const auto time = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / frames;
+  Result result{time, std::vector<std::uint32_t>(static_cast<std::size_t>(width * height))};
+  glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, result.image.data());
+  return result;
+}
+
+// Pixels with a channel off by more than rounding. Without a fill rule pixel centers exactly on a shared edge
+// go to whichever triangle the edge function rounds for, so a few differ along quad edges.
+static auto differences(const std::vector<std::uint32_t> &a, const std::vector<std::uint32_t> &b) -> std::size_t {
+  std::size_t result = 0;
+  for(std::size_t i = 0; i < a.size(); ++i) {
+    for(unsigned shift = 0; shift < 32; shift += 8) {
+      const auto channelA = static_cast<int>((a[i] >> shift) & 0xFFU);
+      const auto channelB = static_cast<int>((b[i] >> shift) & 0xFFU);
+      if(std::abs(channelA - channelB) > 1) {
+        ++result;
+        break;
+      }
+    }
+  }
+  return result;
+}
+
+int main(int argc, char *argv[]) {
+  GLsizei width = 1280;
+  GLsizei height = 720;
+  int frames = 20;
+  int layers = 8;
+  for(int i = 1; i + 1 < argc; i += 2) {
+    const std::string option = argv[i];
+    if(option == "--size") {
+      std::sscanf(argv[i + 1], "%dx%d", &width, &height);
+    } else if(option == "--frames") {
+      frames = std::max(1, std::atoi(argv[i + 1]));
+    } else if(option == "--layers") {
+      layers = std::max(1, std::atoi(argv[i + 1]));
+    } else {
+      std::cerr << "Usage: " << argv[0] << " [--size WxH] [--frames N] [--layers N]\n";
+      return EXIT_FAILURE;
+    }
+  }
+
+  auto *pContext = createContext(width, height, 1);
+  if(pContext == nullptr) {
+    std::cerr << "Can not create a " << width << "x" << height << " context\n";
+    return EXIT_FAILURE;
+  }
+  makeCurrent(pContext);
+
+  ProgramDescription description;
+  description.vertex = vertexShader;
+  description.fragment = fragmentShader;
+  description.fragment8 = fragmentShader8;
+  description.varyings = 3;
+  const auto program = createProgram(description);
+  glUseProgram(program);
+  glEnable(GL_DEPTH_TEST);
+  glDepthFunc(GL_LESS);
+  // Every layer is shaded, hierarchical depth would reject all but the nearest one (see mimicoverdraw).
+  glDisable(GL_HIERARCHICAL_DEPTH_MIMIC);
+  glDisable(GL_FRONT_TO_BACK_MIMIC);
+
+  GLuint vao = 0;
+  GLuint vbo = 0;
+  glGenVertexArrays(1, &vao);
+  glBindVertexArray(vao);
+  glGenBuffers(1, &vbo);
+  glBindBuffer(GL_ARRAY_BUFFER, vbo);
+  glVertexAttribPointer(0, 4, GL_FLOAT, false, sizeof(Vertex), nullptr);
+  glEnableVertexAttribArray(0);
+  glVertexAttribPointer(1, 4, GL_FLOAT, false, sizeof(Vertex), reinterpret_cast<const GLvoid *>(offsetof(Vertex, color)));
+  glEnableVertexAttribArray(1);
+
+  struct Case {
+    std::string name;
+    std::vector<Vertex> vertices;
+  };
+  const std::array<Case, 2> cases = {{
+    {"full screen quads", fullScreen(layers)},
+    {"12x12 quads", smallQuads(layers, width, height, 12)},
+  }};
+
+  std::printf("%dx%d, %d layers, one thread, SIMD: %s\n", width, height, layers, simd::gInstructionSet);
+  std::printf("%-20s %14s %14s %9s %9s\n", "", "scalar Mpix/s", "SIMD Mpix/s", "speedup", "differing");
+  auto bFaster = true;
+  for(const auto &test : cases) {
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(test.vertices.size() * sizeof(Vertex)), test.vertices.data(), GL_STATIC_DRAW);
+    const auto count = static_cast<GLsizei>(test.vertices.size());
+    const auto scalar = run(RasterMode::SCALAR, width, height, frames, count);
+    const auto blocks = run(RasterMode::SIMD, width, height, frames, count);
+    const auto megapixels = static_cast<double>(width) * static_cast<double>(height) * layers / 1e6;
+    const auto speedup = scalar.milliseconds / blocks.milliseconds;
+    std::printf("%-20s %14.1f %14.1f %8.2fx %9zu\n", test.name.c_str(), megapixels / scalar.milliseconds * 1e3,
+                megapixels / blocks.milliseconds * 1e3, speedup, differences(scalar.image, blocks.image));
+    bFaster = bFaster && speedup > 1;
+  }
+
+  glDeleteBuffers(1, &vbo);
+  glDeleteVertexArrays(1, &vao);
+  glDeleteProgram(program);
+  destroyContext(pContext);
+  return bFaster ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,441 @@
+#include <mimicOpenGL/gl.hpp>
+// STL
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+// mimicOpenGL
+#include <mimicOpenGL/context.hpp>
+
+namespace mimic {
+
+// MIMIC_THREADS=<N> overrides the thread count of contexts created with `threads` 0.
+static const char *gMimicThreads = std::getenv("MIMIC_THREADS");
+// MIMIC_VISIBILITY_BUFFER=1 enables GL_VISIBILITY_BUFFER_MIMIC on every new context.
+static const char *gMimicVisibilityBuffer = std::getenv("MIMIC_VISIBILITY_BUFFER");
+// MIMIC_MULTISAMPLE=1 enables GL_MULTISAMPLE on every new context.
+static const char *gMimicMultisample = std::getenv("MIMIC_MULTISAMPLE");
+
+// Like GL, calling a gl* function without a current context is undefined.
+static Context *gpCurrent = nullptr;
+
+static auto current() -> Context & { return *gpCurrent; }
+
+auto createContext(GLsizei width, GLsizei height, std::size_t threads) -> Context * {
+  if(width <= 0 || height <= 0) {
+    return nullptr;
+  }
+  if(threads == 0 && gMimicThreads != nullptr) {
+    threads = static_cast<std::size_t>(std::max(0, std::atoi(gMimicThreads)));
+  }
+  auto *pContext = new Context(width, height, threads);
+  if(gMimicVisibilityBuffer != nullptr && std::atoi(gMimicVisibilityBuffer) != 0) {
+    pContext->mRasterizer.setVisibilityBuffer(true);
+  }
+  if(gMimicMultisample != nullptr && std::atoi(gMimicMultisample) != 0) {
+    pContext->mRasterizer.setMultisample(true);
+  }
+  return pContext;
+}
+
+void destroyContext(Context *pContext) {
+  if(gpCurrent == pContext) {
+    gpCurrent = nullptr;
+  }
+  delete pContext;
+}
+
+void makeCurrent(Context *pContext) { gpCurrent = pContext; }
+
+auto colorBuffer() -> const std::uint32_t * {
+  auto &context = current();
+  context.finish();
+  return context.mFramebuffer.color.data();
+}
+
+auto colorStride() -> GLsizei { return current().mFramebuffer.stride; }
+
+void setRasterMode(RasterMode mode) {
+  auto &context = current();
+  context.finish();
+  context.mRasterizer.setMode(mode);
+}
+
+auto rasterStatistics() -> RasterStatistics {
+  auto &context = current();
+  context.finish();
+  return context.mRasterizer.statistics();
+}
+
+void resetRasterStatistics() {
+  auto &context = current();
+  context.finish();
+  context.mRasterizer.resetStatistics();
+}
+
+auto glGetError() -> GLenum {
+  auto &context = current();
+  const auto error = context.mError;
+  context.mError = GL_NO_ERROR;
+  return error;
+}
+
+// Buffers ------------------------------------------------------------------------------------------------
+
+// GL_ELEMENT_ARRAY_BUFFER is vertex array state, as in GL.
+static auto elementBuffer(Context &context) -> GLuint * {
+  const auto vertexArray = context.mVertexArrays.find(context.mVertexArray);
+  return vertexArray != std::end(context.mVertexArrays) ? &vertexArray->second.elementBuffer : nullptr;
+}
+
+void glGenBuffers(GLsizei n, GLuint *pBuffers) {
+  auto &context = current();
+  for(GLsizei i = 0; i < n; ++i) {
+    pBuffers[i] = Context::generate(context.mBuffers, context.mNextBuffer);
+  }
+}
+
+void glDeleteBuffers(GLsizei n, const GLuint *pBuffers) {
+  auto &context = current();
+  for(GLsizei i = 0; i < n; ++i) {
+    context.mBuffers.erase(pBuffers[i]);
+    if(context.mArrayBuffer == pBuffers[i]) {
+      context.mArrayBuffer = 0;
+    }
+    if(auto *pElementBuffer = elementBuffer(context); pElementBuffer != nullptr && *pElementBuffer == pBuffers[i]) {
+      *pElementBuffer = 0;
+    }
+  }
+}
+
+void glBindBuffer(GLenum target, GLuint buffer) {
+  auto &context = current();
+  if(target != GL_ARRAY_BUFFER && target != GL_ELEMENT_ARRAY_BUFFER) {
+    context.setError(GL_INVALID_ENUM);
+    return;
+  }
+  if(buffer != 0 && context.mBuffers.count(buffer) == 0) {
+    context.setError(GL_INVALID_OPERATION);
+    return;
+  }
+  if(target == GL_ARRAY_BUFFER) {
+    context.mArrayBuffer = buffer;
+  } else if(auto *pElementBuffer = elementBuffer(context); pElementBuffer != nullptr) {
+    *pElementBuffer = buffer;
+  } else {
+    context.setError(GL_INVALID_OPERATION);
+  }
+}
+
+void glBufferData(GLenum target, GLsizeiptr size, const GLvoid *pData, GLenum usage) {
+  auto &context = current();
+  (void)usage;
+  if(target != GL_ARRAY_BUFFER && target != GL_ELEMENT_ARRAY_BUFFER) {
+    context.setError(GL_INVALID_ENUM);
+    return;
+  }
+  if(size < 0) {
+    context.setError(GL_INVALID_VALUE);
+    return;
+  }
+  const auto *pElementBuffer = elementBuffer(context);
+  const auto bound = target == GL_ARRAY_BUFFER ? context.mArrayBuffer : (pElementBuffer != nullptr ? *pElementBuffer : 0);
+  const auto buffer = context.mBuffers.find(bound);
+  if(buffer == std::end(context.mBuffers)) {
+    context.setError(GL_INVALID_OPERATION);
+    return;
+  }
+  auto &data = buffer->second.data;
+  data.assign(static_cast<std::size_t>(size), std::byte{0});
+  if(pData != nullptr) {
+    std::memcpy(data.data(), pData, data.size());
+  }
+}
+
+// Vertex arrays ------------------------------------------------------------------------------------------
+
+void glGenVertexArrays(GLsizei n, GLuint *pArrays) {
+  auto &context = current();
+  for(GLsizei i = 0; i < n; ++i) {
+    pArrays[i] = Context::generate(context.mVertexArrays, context.mNextVertexArray);
+  }
+}
+
+void glDeleteVertexArrays(GLsizei n, const GLuint *pArrays) {
+  auto &context = current();
+  for(GLsizei i = 0; i < n; ++i) {
+    context.mVertexArrays.erase(pArrays[i]);
+    if(context.mVertexArray == pArrays[i]) {
+      context.mVertexArray = 0;
+    }
+  }
+}
+
+void glBindVertexArray(GLuint array) {
+  auto &context = current();
+  if(array != 0 && context.mVertexArrays.count(array) == 0) {
+    context.setError(GL_INVALID_OPERATION);
+    return;
+  }
+  context.mVertexArray = array;
+}
+
+static auto boundAttribute(Context &context, GLuint index) -> VertexAttribute * {
+  const auto vertexArray = context.mVertexArrays.find(context.mVertexArray);
+  if(vertexArray == std::end(context.mVertexArrays)) {
+    context.setError(GL_INVALID_OPERATION);
+    return nullptr;
+  }
+  if(index >= gMaxVertexAttributes) {
+    context.setError(GL_INVALID_VALUE);
+    return nullptr;
+  }
+  return &vertexArray->second.attributes[index];
+}
+
+void glVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const GLvoid *pPointer) {
+  auto &context = current();
+  (void)normalized;
+  if(type != GL_FLOAT) {
+    context.setError(GL_INVALID_ENUM);
+    return;
+  }
+  if(size < 1 || size > 4 || stride < 0) {
+    context.setError(GL_INVALID_VALUE);
+    return;
+  }
+  if(context.mArrayBuffer == 0) {
+    context.setError(GL_INVALID_OPERATION);
+    return;
+  }
+  if(auto *pAttribute = boundAttribute(context, index); pAttribute != nullptr) {
+    pAttribute->size = size;
+    pAttribute->stride = stride;
+    pAttribute->offset = reinterpret_cast<std::size_t>(pPointer);
+    pAttribute->buffer = context.mArrayBuffer;
+  }
+}
+
+void glEnableVertexAttribArray(GLuint index) {
+  if(auto *pAttribute = boundAttribute(current(), index); pAttribute != nullptr) {
+    pAttribute->bEnabled = true;
+  }
+}
+
+void glDisableVertexAttribArray(GLuint index) {
+  if(auto *pAttribute = boundAttribute(current(), index); pAttribute != nullptr) {
+    pAttribute->bEnabled = false;
+  }
+}
+
+// Programs -----------------------------------------------------------------------------------------------
+
+auto createProgram(const ProgramDescription &description) -> GLuint {
+  auto &context = current();
+  if((description.vertex == nullptr && description.vertex8 == nullptr) || description.fragment == nullptr || description.varyings > gMaxVaryings) {
+    context.setError(GL_INVALID_VALUE);
+    return 0;
+  }
+  const auto program = Context::generate(context.mPrograms, context.mNextProgram);
+  auto &object = context.mPrograms[program];
+  object.description = description;
+  std::size_t bytes = 0;
+  for(const auto &uniform : description.uniforms) {
+    bytes = std::max(bytes, uniform.offset + uniform.size);
+  }
+  object.uniforms.assign(bytes, std::byte{0});
+  return program;
+}
+
+void glDeleteProgram(GLuint program) {
+  auto &context = current();
+  context.mPrograms.erase(program);
+  if(context.mProgram == program) {
+    context.mProgram = 0;
+  }
+}
+
+void glUseProgram(GLuint program) {
+  auto &context = current();
+  if(program != 0 && context.mPrograms.count(program) == 0) {
+    context.setError(GL_INVALID_OPERATION);
+    return;
+  }
+  context.mProgram = program;
+}
+
+// Locations are indices into ProgramDescription::uniforms.
+auto glGetUniformLocation(GLuint program, const GLchar *pName) -> GLint {
+  auto &context = current();
+  const auto found = context.mPrograms.find(program);
+  if(found == std::end(context.mPrograms)) {
+    context.setError(GL_INVALID_OPERATION);
+    return -1;
+  }
+  const auto &uniforms = found->second.description.uniforms;
+  const auto uniform = std::find_if(std::cbegin(uniforms), std::cend(uniforms), [pName](const UniformDescription &description) {
+    return description.name == pName;
+  });
+  return uniform != std::cend(uniforms) ? static_cast<GLint>(std::distance(std::cbegin(uniforms), uniform)) : -1;
+}
+
+static void setUniform(GLint location, const void *pValue, std::size_t bytes) {
+  auto &context = current();
+  if(location == -1) {
+    return;
+  }
+  const auto program = context.mPrograms.find(context.mProgram);
+  if(program == std::end(context.mPrograms) || location < 0 ||
+     static_cast<std::size_t>(location) >= program->second.description.uniforms.size()) {
+    context.setError(GL_INVALID_OPERATION);
+    return;
+  }
+  const auto &uniform = program->second.description.uniforms[static_cast<std::size_t>(location)];
+  std::memcpy(program->second.uniforms.data() + uniform.offset, pValue, std::min(bytes, uniform.size));
+}
+
+void glUniform1i(GLint location, GLint value) { setUniform(location, &value, sizeof(value)); }
+
+void glUniform1f(GLint location, GLfloat value) { setUniform(location, &value, sizeof(value)); }
+
+void glUniform3fv(GLint location, GLsizei count, const GLfloat *pValue) {
+  setUniform(location, pValue, static_cast<std::size_t>(std::max(count, 0)) * 3 * sizeof(GLfloat));
+}
+
+void glUniform4fv(GLint location, GLsizei count, const GLfloat *pValue) {
+  setUniform(location, pValue, static_cast<std::size_t>(std::max(count, 0)) * 4 * sizeof(GLfloat));
+}
+
+void glUniformMatrix3fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat *pValue) {
+  if(transpose) {
+    current().setError(GL_INVALID_VALUE);
+    return;
+  }
+  setUniform(location, pValue, static_cast<std::size_t>(std::max(count, 0)) * 9 * sizeof(GLfloat));
+}
+
+void glUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat *pValue) {
+  if(transpose) {
+    current().setError(GL_INVALID_VALUE);
+    return;
+  }
+  setUniform(location, pValue, static_cast<std::size_t>(std::max(count, 0)) * 16 * sizeof(GLfloat));
+}
+
+// Fixed function state -----------------------------------------------------------------------------------
+
+static void setCapability(GLenum capability, bool bEnabled) {
+  auto &context = current();
+  switch(capability) {
+  case GL_DEPTH_TEST:
+    context.mbDepthTest = bEnabled;
+    break;
+  case GL_HIERARCHICAL_DEPTH_MIMIC:
+    context.finish();
+    context.mRasterizer.setHierarchicalDepth(bEnabled);
+    break;
+  case GL_FRONT_TO_BACK_MIMIC:
+    context.finish();
+    context.mRasterizer.setFrontToBack(bEnabled);
+    break;
+  case GL_VISIBILITY_BUFFER_MIMIC:
+    context.finish();
+    context.mRasterizer.setVisibilityBuffer(bEnabled);
+    break;
+  case GL_MULTISAMPLE:
+    context.finish();
+    context.mRasterizer.setMultisample(bEnabled);
+    break;
+  default:
+    context.setError(GL_INVALID_ENUM);
+  }
+}
+
+void glEnable(GLenum capability) { setCapability(capability, true); }
+
+void glDisable(GLenum capability) { setCapability(capability, false); }
+
+void glDepthFunc(GLenum function) {
+  auto &context = current();
+  if(function != GL_LESS && function != GL_ALWAYS) {
+    context.setError(GL_INVALID_ENUM);
+    return;
+  }
+  context.mDepthFunc = function;
+}
+
+void glViewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+  auto &context = current();
+  if(width < 0 || height < 0) {
+    context.setError(GL_INVALID_VALUE);
+    return;
+  }
+  context.mViewport = {x, y, width, height};
+}
+
+void glClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha) { current().mClearColor = {red, green, blue, alpha}; }
+
+void glClearDepthf(GLfloat depth) { current().mClearDepth = depth; }
+
+void glClear(GLbitfield mask) {
+  auto &context = current();
+  if((mask & ~(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT)) != 0) {
+    context.setError(GL_INVALID_VALUE);
+    return;
+  }
+  context.clear(mask);
+}
+
+// Drawing ------------------------------------------------------------------------------------------------
+
+void glDrawArrays(GLenum mode, GLint first, GLsizei count) {
+  auto &context = current();
+  if(mode != GL_TRIANGLES) {
+    context.setError(GL_INVALID_ENUM);
+    return;
+  }
+  if(first < 0 || count < 0) {
+    context.setError(GL_INVALID_VALUE);
+    return;
+  }
+  if(count >= 3) {
+    context.drawArrays(first, count - count % 3);
+  }
+}
+
+void glDrawElements(GLenum mode, GLsizei count, GLenum type, const GLvoid *pIndices) {
+  auto &context = current();
+  if(mode != GL_TRIANGLES || (type != GL_UNSIGNED_INT && type != GL_UNSIGNED_SHORT)) {
+    context.setError(GL_INVALID_ENUM);
+    return;
+  }
+  if(count < 0) {
+    context.setError(GL_INVALID_VALUE);
+    return;
+  }
+  if(count >= 3) {
+    context.drawElements(count - count % 3, type, reinterpret_cast<std::size_t>(pIndices));
+  }
+}
+
+void glFinish() { current().finish(); }
+
+void glReadPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, GLvoid *pPixels) {
+  auto &context = current();
+  if(format != GL_RGBA || type != GL_UNSIGNED_BYTE) {
+    context.setError(GL_INVALID_ENUM);
+    return;
+  }
+  const auto &framebuffer = context.mFramebuffer;
+  if(x < 0 || y < 0 || width < 0 || height < 0 || x + width > framebuffer.width || y + height > framebuffer.height) {
+    context.setError(GL_INVALID_VALUE);
+    return;
+  }
+  context.finish();
+  auto *pOutput = static_cast<std::uint32_t *>(pPixels);
+  for(GLsizei row = 0; row < height; ++row) {
+    const auto *pRow = framebuffer.color.data() + static_cast<std::size_t>((y + row) * framebuffer.stride + x);
+    std::memcpy(pOutput + static_cast<std::size_t>(row * width), pRow, static_cast<std::size_t>(width) * sizeof(std::uint32_t));
+  }
+}
+
+} // namespace mimic
@@ -0,0 +1,191 @@
+#pragma once
+// STL
+#include <array>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+// mimicOpenGL
+#include <mimicOpenGL/math.hpp>
+
+// The GL subset the demos use, implemented on the CPU. Names, enums and semantics follow OpenGL so the
+// demo code reads the same; the only departure is the program object, GLSL is replaced by C++ shaders.
+namespace mimic {
+
+using GLenum = std::uint32_t;
+using GLbitfield = std::uint32_t;
+using GLuint = std::uint32_t;
+using GLint = std::int32_t;
+using GLsizei = std::int32_t;
+using GLsizeiptr = std::ptrdiff_t;
+using GLfloat = float;
+using GLboolean = bool;
+using GLchar = char;
+using GLvoid = void;
+
+constexpr GLboolean GL_FALSE = false;
+constexpr GLboolean GL_TRUE = true;
+
+constexpr GLenum GL_NO_ERROR = 0;
+constexpr GLenum GL_INVALID_ENUM = 0x0500;
+constexpr GLenum GL_INVALID_VALUE = 0x0501;
+constexpr GLenum GL_INVALID_OPERATION = 0x0502;
+
+constexpr GLenum GL_TRIANGLES = 0x0004;
+constexpr GLenum GL_ARRAY_BUFFER = 0x8892;
+constexpr GLenum GL_ELEMENT_ARRAY_BUFFER = 0x8893;
+constexpr GLenum GL_STATIC_DRAW = 0x88E4;
+constexpr GLenum GL_DYNAMIC_DRAW = 0x88E8;
+constexpr GLenum GL_FLOAT = 0x1406;
+constexpr GLenum GL_UNSIGNED_BYTE = 0x1401;
+constexpr GLenum GL_UNSIGNED_SHORT = 0x1403;
+constexpr GLenum GL_UNSIGNED_INT = 0x1405;
+constexpr GLenum GL_RGBA = 0x1908;
+
+constexpr GLenum GL_DEPTH_TEST = 0x0B71;
+constexpr GLenum GL_LESS = 0x0201;
+constexpr GLenum GL_ALWAYS = 0x0207;
+
+// Capabilities of the software renderer for glEnable/glDisable, both enabled by default. They only apply to
+// RasterMode::SIMD and change no pixel except where depths are exactly equal:
+// hierarchical depth skips triangles and 8x8 blocks behind the farthest depth already in a tile or block,
+// front to back sorts the GL_LESS triangles of every tile by their nearest depth before rasterizing.
+constexpr GLenum GL_HIERARCHICAL_DEPTH_MIMIC = 0x1F100;
+constexpr GLenum GL_FRONT_TO_BACK_MIMIC = 0x1F101;
+// Disabled by default: rasterization only stores the triangle and its barycentrics per pixel, the fragment shader
+// runs once per visible pixel in a separate pass when the tiles are flushed instead of once per fragment passing
+// the depth test. The image differs from forward shading by rounding only.
+constexpr GLenum GL_VISIBILITY_BUFFER_MIMIC = 0x1F102;
+// Disabled by default, unlike GL where the framebuffer decides: 4 samples per pixel, depth tested per sample, with the
+// fragment shader run once per pixel. It takes precedence over GL_VISIBILITY_BUFFER_MIMIC, which has no effect while
+// multisampling.
+constexpr GLenum GL_MULTISAMPLE = 0x809D;
+
+constexpr GLbitfield GL_DEPTH_BUFFER_BIT = 0x00000100;
+constexpr GLbitfield GL_COLOR_BUFFER_BIT = 0x00004000;
+
+// Programs -------------------------------------------------------------------------------------------------
+
+constexpr std::size_t gMaxVertexAttributes = 4;
+constexpr std::size_t gMaxVaryings = 8;
+
+struct VertexInput {
+  std::array<Vec4, gMaxVertexAttributes> attributes;
+};
+
+struct VertexOutput {
+  Vec4 position; // gl_Position
+  std::array<float, gMaxVaryings> varyings;
+};
+
+// 8 vertices as structure of arrays, `attributes[attribute][component * 8 + lane]`.
+struct VertexInput8 {
+  std::array<std::array<float, 4 * 8>, gMaxVertexAttributes> attributes;
+};
+
+// `position[component * 8 + lane]`, `varyings[varying * 8 + lane]`.
+struct VertexOutput8 {
+  std::array<float, 4 * 8> position;
+  std::array<float, gMaxVaryings * 8> varyings;
+};
+
+// `pUniforms` points at the program's uniform storage, laid out as declared in ProgramDescription::uniforms.
+using VertexShader = void (*)(const std::byte *pUniforms, const VertexInput &input, VertexOutput &output);
+using FragmentShader = Vec4 (*)(const std::byte *pUniforms, const float *pVaryings);
+// Optional vertex shader for 8 vertices at once, see simdMath.hpp. Short batches repeat their last vertex.
+using VertexShader8 = void (*)(const std::byte *pUniforms, const VertexInput8 &input, VertexOutput8 &output);
+// Optional fragment shader for 8 fragments at once, structure of arrays: `pVaryings[varying * 8 + lane]` in,
+// `pColor[channel * 8 + lane]` out. Lanes outside the triangle hold finite garbage and are discarded.
+using FragmentShader8 = void (*)(const std::byte *pUniforms, const float *pVaryings, float *pColor);
+
+struct UniformDescription {
+  std::string name;
+  std::size_t offset;
+  std::size_t size;
+};
+
+// Stands in for glCreateShader/glShaderSource/glLinkProgram: the uniforms keep their GLSL names so
+// glGetUniformLocation and glUniform* work as with a GL program.
+struct ProgramDescription {
+  std::vector<UniformDescription> uniforms;
+  VertexShader vertex = nullptr;
+  VertexShader8 vertex8 = nullptr; // used instead of `vertex` when set
+  FragmentShader fragment = nullptr;
+  FragmentShader8 fragment8 = nullptr; // used by the SIMD rasterizer when set
+  std::size_t varyings = 0;
+};
+
+// The reference loop testing one pixel at a time, or 8x8 pixel blocks evaluated 8 pixels at a time with the
+// instruction set mimicOpenGL was compiled for (MIMIC_SIMD), the default.
+enum class RasterMode { SCALAR, SIMD };
+
+// Rasterizer counters, summed over all threads since the last resetRasterStatistics().
+struct RasterStatistics {
+  std::uint64_t triangles = 0;         // triangle and tile pairs
+  std::uint64_t trianglesRejected = 0; // of them behind the tile by hierarchical depth
+  std::uint64_t blocks = 0;            // 8x8 blocks overlapping a triangle
+  std::uint64_t blocksRejected = 0;    // of them behind the block by hierarchical depth
+  std::uint64_t fragments = 0;         // covered pixels reaching the per-pixel depth test
+  std::uint64_t fragmentsPassed = 0;   // of them passing it
+  std::uint64_t fragmentsShaded = 0;   // fragment shader invocations, fragmentsPassed without the visibility buffer
+  std::uint64_t pixelsResolved = 0;    // multisampled pixels whose samples differ, averaged when flushing
+};
+
+// Context --------------------------------------------------------------------------------------------------
+
+class Context;
+
+// `threads` 0 uses MIMIC_THREADS or else every hardware thread.
+// The context draws into its own RGBA8 color and float depth buffer. MIMIC_VISIBILITY_BUFFER=1 enables
+// GL_VISIBILITY_BUFFER_MIMIC on it, MIMIC_MULTISAMPLE=1 GL_MULTISAMPLE.
+auto createContext(GLsizei width, GLsizei height, std::size_t threads = 0) -> Context *;
+void destroyContext(Context *pContext);
+void makeCurrent(Context *pContext);
+// Rows bottom-up like glReadPixels, colorStride() pixels apart, valid until the next draw call; finishes pending work.
+auto colorBuffer() -> const std::uint32_t *;
+auto colorStride() -> GLsizei;
+void setRasterMode(RasterMode mode);
+auto rasterStatistics() -> RasterStatistics;
+void resetRasterStatistics();
+
+auto glGetError() -> GLenum;
+
+void glGenBuffers(GLsizei n, GLuint *pBuffers);
+void glDeleteBuffers(GLsizei n, const GLuint *pBuffers);
+void glBindBuffer(GLenum target, GLuint buffer);
+void glBufferData(GLenum target, GLsizeiptr size, const GLvoid *pData, GLenum usage);
+
+void glGenVertexArrays(GLsizei n, GLuint *pArrays);
+void glDeleteVertexArrays(GLsizei n, const GLuint *pArrays);
+void glBindVertexArray(GLuint array);
+void glVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const GLvoid *pPointer);
+void glEnableVertexAttribArray(GLuint index);
+void glDisableVertexAttribArray(GLuint index);
+
+auto createProgram(const ProgramDescription &description) -> GLuint;
+void glDeleteProgram(GLuint program);
+void glUseProgram(GLuint program);
+auto glGetUniformLocation(GLuint program, const GLchar *pName) -> GLint;
+void glUniform1i(GLint location, GLint value);
+void glUniform1f(GLint location, GLfloat value);
+void glUniform3fv(GLint location, GLsizei count, const GLfloat *pValue);
+void glUniform4fv(GLint location, GLsizei count, const GLfloat *pValue);
+void glUniformMatrix3fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat *pValue);
+void glUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat *pValue);
+
+void glEnable(GLenum capability);
+void glDisable(GLenum capability);
+void glDepthFunc(GLenum function);
+void glViewport(GLint x, GLint y, GLsizei width, GLsizei height);
+void glClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha);
+void glClearDepthf(GLfloat depth);
+void glClear(GLbitfield mask);
+
+void glDrawArrays(GLenum mode, GLint first, GLsizei count);
+// `pIndices` is an offset into the GL_ELEMENT_ARRAY_BUFFER of the bound vertex array.
+void glDrawElements(GLenum mode, GLsizei count, GLenum type, const GLvoid *pIndices);
+
+void glFinish();
+void glReadPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, GLvoid *pPixels);
+
+} // namespace mimic
@@ -0,0 +1,169 @@
+// STL
+#include <array>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <algorithm>
+// assimp
+#include <assimp/scene.h>
+#include <assimp/Importer.hpp>
+// common
+#include <common/benchmark.hpp>
+// mimicOpenGL
+#include <mimicOpenGL/gl.hpp>
+#include <mimicOpenGL/sample.hpp>
+
+// shaders/materials/loadObj.cpp drawn by the software renderer, no GPU or GL driver involved.
+
+using namespace mimic;
+
+constexpr auto gTitle = "Scene (software)";
+
+namespace {
+
+struct Uniforms {
+  Mat4 MVP;
+};
+
+void vertexShader(const std::byte *pUniforms, const VertexInput &input, VertexOutput &output) {
+  const auto &u = *reinterpret_cast<const Uniforms *>(pUniforms);
+  output.position = u.MVP * input.attributes[0];
+}
+
+auto fragmentShader(const std::byte *, const float *) -> Vec4 { return {1, 0, 0, 1}; }
+
+void fragmentShader8(const std::byte *, const float *, float *pColor) {
+  const std::array<float, 4> red = {1, 0, 0, 1};
+  for(std::size_t channel = 0; channel < red.size(); ++channel) {
+    std::fill(pColor + channel * 8, pColor + (channel + 1) * 8, red[channel]);
+  }
+}
+
+auto redProgram() -> ProgramDescription {
+  ProgramDescription description;
+  description.uniforms = {{"MVP", offsetof(Uniforms, MVP), sizeof(Mat4)}};
+  description.vertex = vertexShader;
+  description.fragment = fragmentShader;
+  description.fragment8 = fragmentShader8;
+  return description;
+}
+
+struct Model {
+  GLuint vao = 0;
+  std::array<GLuint, 1> vbo = {};
+  void draw() const {
+    glBindVertexArray(vao);
+    { glDrawArrays(GL_TRIANGLES, 0, count); }
+    glBindVertexArray(0);
+  }
+  GLsizei count = 0;
+  std::vector<float> mVertices;
+};
+
+struct Scene {
+  std::vector<Model> mModels;
+
+  void initialize() {
+    for(auto &model : mModels) {
+      model.count = static_cast<GLsizei>(model.mVertices.size() / 3);
+      glGenVertexArrays(1, &model.vao);
+      glBindVertexArray(model.vao);
+      {
+        glGenBuffers(1, model.vbo.data());
+        glBindBuffer(GL_ARRAY_BUFFER, model.vbo[0]);
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(model.mVertices.size() * sizeof(float)), model.mVertices.data(), GL_STATIC_DRAW);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, false, 0, nullptr);
+      }
+      glBindVertexArray(0);
+    }
+  }
+
+  void draw() const {
+    for(const auto &model : mModels) {
+      model.draw();
+    }
+  }
+};
+
+auto LoadMesh(const aiMesh *pMesh) -> Model {
+  Model model;
+  model.mVertices.reserve(pMesh->mNumVertices * 3);
+  for(auto i = 0U; i < pMesh->mNumVertices; i++) {
+    const auto &position = pMesh->mVertices[i];
+    model.mVertices.insert(model.mVertices.end(), {position.x, position.y, position.z});
+  }
+  return model;
+}
+
+auto LoadFile(const std::string &fileName) -> Scene {
+  Assimp::Importer importer;
+  const auto pScene = importer.ReadFile(fileName, 0);
+  if(pScene == nullptr) {
+    std::cerr << "Can not load \"" << fileName << "\"!\n";
+    std::exit(EXIT_FAILURE);
+  }
+  Scene scene;
+  for(auto i = 0U; i < pScene->mNumMeshes; ++i) {
+    scene.mModels.push_back(LoadMesh(pScene->mMeshes[i]));
+  }
+  return scene;
+}
+
+} // namespace
+
+auto mimic::loadObjSample(const SampleOptions &options) -> int {
+  SampleTarget target(gTitle, options);
+  if(!target.valid()) {
+    return EXIT_FAILURE;
+  }
+  BenchmarkRecorder benchmark("mimicLoadObj");
+
+  benchmark.beginLoad();
+  Scene scene = LoadFile("sphere.obj");
+  scene.initialize();
+
+  const GLuint program = createProgram(redProgram());
+
+  const auto ratio = static_cast<float>(options.width) / static_cast<float>(options.height);
+  const auto prespective = perspective(45.F, ratio, 0.001F, 1000.F);
+  const auto view = lookAt(Vec3{0, 0, -10}, Vec3{}, Vec3{0, 1, 0});
+
+  const auto MVP = prespective * view;
+
+  benchmark.endLoad();
+
+  glEnable(GL_DEPTH_TEST);
+  glDepthFunc(GL_ALWAYS);
+
+  while(target.poll()) {
+    benchmark.beginFrame();
+    const auto start = std::chrono::steady_clock::now();
+
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    glUseProgram(program);
+    {
+      glUniformMatrix4fv(0, 1, GL_FALSE, MVP.data());
+      scene.draw();
+    }
+    glUseProgram(0);
+
+    target.present();
+
+    const auto cpuTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    printf("\rCPU: FPS: %.3F, Time: %.3F", 1000. / cpuTime, cpuTime);
+    benchmark.endFrame();
+    if(benchmark.finished()) {
+      break;
+    }
+  }
+
+  glDeleteProgram(program);
+  return EXIT_SUCCESS;
+}
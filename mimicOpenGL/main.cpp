@@ -0,0 +1,14 @@
+// STL
+#include <cstdlib>
+// SDL2
+#include <SDL2/SDL.h>
+// common
+#include <common/backend.hpp>
+// mimicOpenGL
+#include <mimicOpenGL/samples.hpp>
+
+// mimic<sample>: the software port of a GL demo on its own, MIMIC_SAMPLE is the name of the demo.
+int main(int argc, char *argv[]) {
+  const auto backend = selectBackend(argc, argv);
+  return mimic::runSample(MIMIC_SAMPLE, backend, argc, argv);
+}
@@ -0,0 +1,107 @@
+#pragma once
+// STL
+#include <array>
+#include <cmath>
+#include <algorithm>
+
+// Just the vector math the software renderer and its samples need. Matrices are column-major like GL,
+// so a Mat4 can be passed straight to glUniformMatrix4fv.
+namespace mimic {
+
+struct Vec2 {
+  float x = 0;
+  float y = 0;
+};
+
+struct Vec3 {
+  float x = 0;
+  float y = 0;
+  float z = 0;
+};
+
+struct Vec4 {
+  float x = 0;
+  float y = 0;
+  float z = 0;
+  float w = 0;
+};
+
+inline auto operator+(Vec3 a, Vec3 b) -> Vec3 { return {a.x + b.x, a.y + b.y, a.z + b.z}; }
+inline auto operator-(Vec3 a, Vec3 b) -> Vec3 { return {a.x - b.x, a.y - b.y, a.z - b.z}; }
+inline auto operator-(Vec3 a) -> Vec3 { return {-a.x, -a.y, -a.z}; }
+inline auto operator*(Vec3 a, Vec3 b) -> Vec3 { return {a.x * b.x, a.y * b.y, a.z * b.z}; }
+inline auto operator*(Vec3 a, float s) -> Vec3 { return {a.x * s, a.y * s, a.z * s}; }
+inline auto operator*(float s, Vec3 a) -> Vec3 { return a * s; }
+
+inline auto operator+(Vec4 a, Vec4 b) -> Vec4 { return {a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w}; }
+inline auto operator-(Vec4 a, Vec4 b) -> Vec4 { return {a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w}; }
+inline auto operator*(Vec4 a, float s) -> Vec4 { return {a.x * s, a.y * s, a.z * s, a.w * s}; }
+
+inline auto xyz(Vec4 a) -> Vec3 { return {a.x, a.y, a.z}; }
+
+inline auto dot(Vec3 a, Vec3 b) -> float { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+inline auto cross(Vec3 a, Vec3 b) -> Vec3 { return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x}; }
+
+inline auto length(Vec3 a) -> float { return std::sqrt(dot(a, a)); }
+
+inline auto normalize(Vec3 a) -> Vec3 {
+  const auto size = length(a);
+  return size > 0 ? a * (1.F / size) : a;
+}
+
+// GLSL reflect(): `incident` points towards the surface.
+inline auto reflect(Vec3 incident, Vec3 normal) -> Vec3 { return incident - normal * (2.F * dot(normal, incident)); }
+
+struct Mat3 {
+  std::array<Vec3, 3> columns = {Vec3{1, 0, 0}, Vec3{0, 1, 0}, Vec3{0, 0, 1}};
+};
+
+struct Mat4 {
+  std::array<Vec4, 4> columns = {Vec4{1, 0, 0, 0}, Vec4{0, 1, 0, 0}, Vec4{0, 0, 1, 0}, Vec4{0, 0, 0, 1}};
+
+  [[nodiscard]] auto data() const -> const float * { return &columns[0].x; }
+};
+
+inline auto operator*(const Mat3 &m, Vec3 v) -> Vec3 { return m.columns[0] * v.x + m.columns[1] * v.y + m.columns[2] * v.z; }
+
+inline auto operator*(const Mat4 &m, Vec4 v) -> Vec4 {
+  return m.columns[0] * v.x + m.columns[1] * v.y + m.columns[2] * v.z + m.columns[3] * v.w;
+}
+
+inline auto operator*(const Mat4 &a, const Mat4 &b) -> Mat4 {
+  Mat4 result;
+  for(std::size_t i = 0; i < 4; ++i) {
+    result.columns[i] = a * b.columns[i];
+  }
+  return result;
+}
+
+// Upper left 3x3, the normal matrix of a view matrix without scaling.
+inline auto toMat3(const Mat4 &m) -> Mat3 { return {{xyz(m.columns[0]), xyz(m.columns[1]), xyz(m.columns[2])}}; }
+
+// Same conventions as glm::perspective, `fovy` in radians.
+inline auto perspective(float fovy, float aspect, float zNear, float zFar) -> Mat4 {
+  const auto f = 1.F / std::tan(fovy / 2.F);
+  Mat4 result;
+  result.columns[0] = {f / aspect, 0, 0, 0};
+  result.columns[1] = {0, f, 0, 0};
+  result.columns[2] = {0, 0, -(zFar + zNear) / (zFar - zNear), -1};
+  result.columns[3] = {0, 0, -(2.F * zFar * zNear) / (zFar - zNear), 0};
+  return result;
+}
+
+// Same conventions as glm::lookAt.
+inline auto lookAt(Vec3 eye, Vec3 center, Vec3 up) -> Mat4 {
+  const auto f = normalize(center - eye);
+  const auto s = normalize(cross(f, up));
+  const auto u = cross(s, f);
+  Mat4 result;
+  result.columns[0] = {s.x, u.x, -f.x, 0};
+  result.columns[1] = {s.y, u.y, -f.y, 0};
+  result.columns[2] = {s.z, u.z, -f.z, 0};
+  result.columns[3] = {-dot(s, eye), -dot(u, eye), dot(f, eye), 1};
+  return result;
+}
+
+} // namespace mimic
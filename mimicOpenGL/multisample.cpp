@@ -0,0 +1,254 @@
+// STL
+#include <array>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <algorithm>
+// mimicOpenGL
+#include <mimicOpenGL/gl.hpp>
+#include <mimicOpenGL/simd.hpp>
+#include <mimicOpenGL/sphere.hpp>
+#include <mimicOpenGL/simdMath.hpp>
+
+// 4x multisampling against single sampling, on a lit sphere, a grid of small spheres with edges everywhere and a
+// stress scene of spheres stacked along the view axis. Shaded counts the fragment shader invocations per frame,
+// resolved the pixels whose samples differ and compressed the share of pixels left with one color for their
+// samples. Bytes per pixel adds the sample depths, the slot per pixel and the sample colors of the resolved pixels to
+// the color buffer. The SIMD image is compared to the scalar reference: more than 0.1% of the pixels differing by more
+// than one step in a channel is an error.
+// Usage: mimicmultisample [--size WxH] [--frames N] [--layers N]
+
+using namespace mimic;
+
+using Clock = std::chrono::steady_clock;
+
+struct Uniforms {
+  Mat4 modelView;
+  Mat4 modelViewProjection;
+  Vec3 lightPosition;
+};
+
+// Eye space normal and position, normals are in world space and the view has no rotation worth correcting.
+static void vertexShader(const std::byte *pUniforms, const VertexInput &input, VertexOutput &output) {
+  const auto &u = *reinterpret_cast<const Uniforms *>(pUniforms);
+  const auto position = Vec4{input.attributes[0].x, input.attributes[0].y, input.attributes[0].z, 1};
+  const auto eyePosition = xyz(u.modelView * position);
+  output.varyings[0] = input.attributes[1].x;
+  output.varyings[1] = input.attributes[1].y;
+  output.varyings[2] = input.attributes[1].z;
+  output.varyings[3] = eyePosition.x;
+  output.varyings[4] = eyePosition.y;
+  output.varyings[5] = eyePosition.z;
+  output.position = u.modelViewProjection * position;
+}
+
+// Ambient, diffuse and specular per fragment, like the materials demos.
+static auto fragmentShader(const std::byte *pUniforms, const float *pVaryings) -> Vec4 {
+  const auto &u = *reinterpret_cast<const Uniforms *>(pUniforms);
+  const auto n = normalize(Vec3{pVaryings[0], pVaryings[1], pVaryings[2]});
+  const auto position = Vec3{pVaryings[3], pVaryings[4], pVaryings[5]};
+  const auto s = normalize(u.lightPosition - position);
+  const auto v = normalize(-position);
+  const auto r = reflect(-s, n);
+  const auto sDotN = std::max(dot(s, n), 0.F);
+  const auto specular = sDotN > 0 ? std::pow(std::max(dot(r, v), 0.F), 32.F) : 0.F;
+  const auto color = 0.1F + 0.7F * sDotN + 0.5F * specular;
+  return {color, color, color, 1};
+}
+
+static void fragmentShader8(const std::byte *pUniforms, const float *pVaryings, float *pColor) {
+  using namespace simd;
+  const auto &u = *reinterpret_cast<const Uniforms *>(pUniforms);
+  const auto n = normalize(Vec3x8{load(pVaryings), load(pVaryings + 8), load(pVaryings + 16)});
+  const auto position = Vec3x8{load(pVaryings + 24), load(pVaryings + 32), load(pVaryings + 40)};
+  const auto s = normalize(set1(u.lightPosition) - position);
+  const auto v = normalize(-position);
+  const auto r = reflect(-s, n);
+  const auto sDotN = max(dot(s, n), set1(0.F));
+  const auto specular = select(sDotN > set1(0.F), set1(0.F), pow(max(dot(r, v), set1(0.F)), set1(32.F)));
+  const auto color = fma(sDotN, set1(0.7F), fma(specular, set1(0.5F), set1(0.1F)));
+  store(pColor, color);
+  store(pColor + 8, color);
+  store(pColor + 16, color);
+  store(pColor + 24, set1(1.F));
+}
+
+struct Result {
+  double milliseconds;
+  RasterStatistics statistics;
+  std::vector<std::uint32_t> image;
+};
+
+static auto run(GLsizei width, GLsizei height, int frames, GLsizei count, RasterMode mode, bool bMultisample) -> Result {
+  setRasterMode(mode);
+  bMultisample ? glEnable(GL_MULTISAMPLE) : glDisable(GL_MULTISAMPLE);
+  const auto frame = [count] {
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, nullptr);
+    glFinish();
+  };
+  frame(); // warm up
+  resetRasterStatistics();
+  const auto start = Clock::now();
+  for(int i = 0; i < frames; ++i) {
+    frame();
+  }
+  const auto time = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / frames;
+  Result result{time, rasterStatistics(), std::vector<std::uint32_t>(static_cast<std::size_t>(width * height))};
+  glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, result.image.data());
+  return result;
+}
+
+// Pixels with a channel more than one step apart.
+static auto differing(const std::vector<std::uint32_t> &a, const std::vector<std::uint32_t> &b) -> std::size_t {
+  std::size_t count = 0;
+  for(std::size_t i = 0; i < a.size(); ++i) {
+    for(std::uint32_t shift = 0; shift < 32; shift += 8) {
+      const auto x = static_cast<int>((a[i] >> shift) & 0xFFU);
+      const auto y = static_cast<int>((b[i] >> shift) & 0xFFU);
+      if(std::abs(x - y) > 1) {
+        ++count;
+        break;
+      }
+    }
+  }
+  return count;
+}
+
+int main(int argc, char *argv[]) {
+  GLsizei width = 1280;
+  GLsizei height = 720;
+  int frames = 10;
+  int layers = 16;
+  for(int i = 1; i + 1 < argc; i += 2) {
+    const std::string option = argv[i];
+    if(option == "--size") {
+      std::sscanf(argv[i + 1], "%dx%d", &width, &height);
+    } else if(option == "--frames") {
+      frames = std::max(1, std::atoi(argv[i + 1]));
+    } else if(option == "--layers") {
+      layers = std::max(1, std::atoi(argv[i + 1]));
+    } else {
+      std::cerr << "Usage: " << argv[0] << " [--size WxH] [--frames N] [--layers N]\n";
+      return EXIT_FAILURE;
+    }
+  }
+
+  auto *pContext = createContext(width, height, 0);
+  if(pContext == nullptr) {
+    std::cerr << "Can not create a " << width << "x" << height << " context\n";
+    return EXIT_FAILURE;
+  }
+  makeCurrent(pContext);
+
+  ProgramDescription description;
+  description.uniforms = {
+    {"uMatrices.ModelView", offsetof(Uniforms, modelView), sizeof(Mat4)},
+    {"uMatrices.ModelViewProjection", offsetof(Uniforms, modelViewProjection), sizeof(Mat4)},
+    {"uLight.Pos", offsetof(Uniforms, lightPosition), sizeof(Vec3)},
+  };
+  description.vertex = vertexShader;
+  description.fragment = fragmentShader;
+  description.fragment8 = fragmentShader8;
+  description.varyings = 6;
+  const auto program = createProgram(description);
+  glUseProgram(program);
+  const auto aspect = static_cast<float>(width) / static_cast<float>(height);
+  const auto modelView = lookAt({0, 0, 6}, {0, 0, 0}, {0, 1, 0});
+  const auto modelViewProjection = perspective(0.8F, aspect, 0.1F, 100) * modelView;
+  const Vec3 lightPosition{5, 5, 5};
+  glUniformMatrix4fv(glGetUniformLocation(program, "uMatrices.ModelView"), 1, GL_FALSE, modelView.data());
+  glUniformMatrix4fv(glGetUniformLocation(program, "uMatrices.ModelViewProjection"), 1, GL_FALSE, modelViewProjection.data());
+  glUniform3fv(glGetUniformLocation(program, "uLight.Pos"), 1, &lightPosition.x);
+  glEnable(GL_DEPTH_TEST);
+  glDepthFunc(GL_LESS);
+
+  GLuint vao = 0;
+  std::array<GLuint, 2> buffers = {};
+  glGenVertexArrays(1, &vao);
+  glBindVertexArray(vao);
+  glGenBuffers(2, buffers.data());
+  glBindBuffer(GL_ARRAY_BUFFER, buffers[0]);
+  glVertexAttribPointer(0, 3, GL_FLOAT, false, 6 * sizeof(float), nullptr);
+  glEnableVertexAttribArray(0);
+  glVertexAttribPointer(1, 3, GL_FLOAT, false, 6 * sizeof(float), reinterpret_cast<const GLvoid *>(3 * sizeof(float)));
+  glEnableVertexAttribArray(1);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers[1]);
+
+  struct Scene {
+    std::string name;
+    Mesh mesh;
+  };
+  std::vector<Vec3> grid;
+  for(int y = 0; y < 12; ++y) {
+    for(int x = 0; x < 20; ++x) {
+      grid.push_back({0.4F * static_cast<float>(x) - 3.8F, 0.4F * static_cast<float>(y) - 2.2F, 0});
+    }
+  }
+  const std::array<Scene, 3> scenes = {{
+    {"sphere", instances(sphere(64), {{0, 0, 0}}, 2.5F)},
+    {"grid of 240 spheres", instances(sphere(16), grid, 0.15F)},
+    {std::to_string(layers) + " layers of spheres", stack(sphere(32), layers)},
+  }};
+  struct Config {
+    const char *pName;
+    RasterMode mode;
+    bool bMultisample;
+  };
+  // The scalar reference runs before the SIMD path it checks.
+  const std::array<Config, 3> configs = {{
+    {"1x", RasterMode::SIMD, false},
+    {"4x, scalar", RasterMode::SCALAR, true},
+    {"4x", RasterMode::SIMD, true},
+  }};
+
+  std::printf("%dx%d, SIMD: %s\n", width, height, simd::gInstructionSet);
+  auto bSame = true;
+  const auto pixels = static_cast<std::uint64_t>(width) * static_cast<std::uint64_t>(height);
+  const auto tolerance = static_cast<std::size_t>(pixels / 1000);
+  for(const auto &scene : scenes) {
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(scene.mesh.vertices.size() * sizeof(float)), scene.mesh.vertices.data(),
+                 GL_STATIC_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(scene.mesh.indices.size() * sizeof(std::uint32_t)),
+                 scene.mesh.indices.data(), GL_STATIC_DRAW);
+    const auto count = static_cast<GLsizei>(scene.mesh.indices.size());
+    std::printf("\n%s, %d triangles\n", scene.name.c_str(), count / 3);
+    std::printf("%-12s %9s %12s %12s %12s %9s\n", "", "ms/frame", "shaded", "resolved", "compressed %", "bytes/px");
+    Result reference;
+    for(const auto &config : configs) {
+      auto result = run(width, height, frames, count, config.mode, config.bMultisample);
+      const auto resolved = result.statistics.pixelsResolved / static_cast<std::uint64_t>(frames);
+      const auto compressed = 100. - 100. * static_cast<double>(resolved) / static_cast<double>(pixels);
+      auto bytes = 4. + 4.; // color and depth
+      if(config.bMultisample) {
+        bytes = 4. + 4. * 4. + 4. + 4. * 4. * static_cast<double>(resolved) / static_cast<double>(pixels);
+      }
+      std::printf("%-12s %9.2f %12llu %12llu %12.1f %9.1f", config.pName, result.milliseconds,
+                  static_cast<unsigned long long>(result.statistics.fragmentsShaded / static_cast<std::uint64_t>(frames)),
+                  static_cast<unsigned long long>(resolved), compressed, bytes);
+      if(config.mode == RasterMode::SCALAR) {
+        reference = result;
+      } else if(config.bMultisample) {
+        const auto different = differing(result.image, reference.image);
+        std::printf("  %zu differing from the scalar reference", different);
+        bSame = bSame && different <= tolerance;
+      }
+      std::printf("\n");
+    }
+  }
+
+  glDeleteBuffers(2, buffers.data());
+  glDeleteVertexArrays(1, &vao);
+  glDeleteProgram(program);
+  if(glGetError() != GL_NO_ERROR) {
+    std::cerr << "GL error\n";
+    return EXIT_FAILURE;
+  }
+  destroyContext(pContext);
+  return bSame ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,190 @@
+// STL
+#include <array>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <numeric>
+#include <iostream>
+#include <algorithm>
+#include <functional>
+// mimicOpenGL
+#include <mimicOpenGL/gl.hpp>
+#include <mimicOpenGL/simd.hpp>
+#include <mimicOpenGL/sphere.hpp>
+
+// Hierarchical depth and front to back sorting on a lit sphere and on a stress scene of spheres stacked along
+// the view axis in random order. Fragments are the covered pixels reaching the per-pixel depth test, the
+// rejected ratio is relative to the run with both disabled. Every image is compared to that run too: front to back
+// may flip a few pixels where two triangles have the same depth, more than 0.1% differing is an error.
+// Usage: mimicoverdraw [--size WxH] [--frames N] [--layers N]
+
+using namespace mimic;
+
+using Clock = std::chrono::steady_clock;
+
+struct Uniforms {
+  Mat4 modelViewProjection;
+};
+
+// Diffuse light from the camera side, normals are in world space.
+static void vertexShader(const std::byte *pUniforms, const VertexInput &input, VertexOutput &output) {
+  const auto &u = *reinterpret_cast<const Uniforms *>(pUniforms);
+  const auto position = Vec4{input.attributes[0].x, input.attributes[0].y, input.attributes[0].z, 1};
+  const auto diffuse = std::max(dot(xyz(input.attributes[1]), normalize(Vec3{0.3F, 0.5F, 1})), 0.F);
+  output.varyings[0] = 0.1F + 0.9F * diffuse;
+  output.position = u.modelViewProjection * position;
+}
+
+static auto fragmentShader(const std::byte *, const float *pVaryings) -> Vec4 { return {pVaryings[0], pVaryings[0], pVaryings[0], 1}; }
+
+static void fragmentShader8(const std::byte *, const float *pVaryings, float *pColor) {
+  std::copy(pVaryings, pVaryings + 8, pColor);
+  std::copy(pVaryings, pVaryings + 8, pColor + 8);
+  std::copy(pVaryings, pVaryings + 8, pColor + 16);
+  std::fill(pColor + 24, pColor + 32, 1.F);
+}
+
+struct Result {
+  double milliseconds;
+  RasterStatistics statistics;
+  std::vector<std::uint32_t> image;
+};
+
+static auto run(GLsizei width, GLsizei height, int frames, GLsizei count, bool bHierarchical, bool bFrontToBack) -> Result {
+  const auto set = [](GLenum capability, bool bEnabled) { bEnabled ? glEnable(capability) : glDisable(capability); };
+  set(GL_HIERARCHICAL_DEPTH_MIMIC, bHierarchical);
+  set(GL_FRONT_TO_BACK_MIMIC, bFrontToBack);
+  const auto frame = [count] {
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, nullptr);
+    glFinish();
+  };
+  frame(); // warm up
+  resetRasterStatistics();
+  const auto start = Clock::now();
+  for(int i = 0; i < frames; ++i) {
+    frame();
+  }
+  const auto time = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / frames;
+  Result result{time, rasterStatistics(), std::vector<std::uint32_t>(static_cast<std::size_t>(width * height))};
+  glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, result.image.data());
+  return result;
+}
+
+static auto ratio(std::uint64_t part, std::uint64_t whole) -> double {
+  return whole == 0 ? 0. : 100. * static_cast<double>(part) / static_cast<double>(whole);
+}
+
+int main(int argc, char *argv[]) {
+  GLsizei width = 1280;
+  GLsizei height = 720;
+  int frames = 10;
+  int layers = 16;
+  for(int i = 1; i + 1 < argc; i += 2) {
+    const std::string option = argv[i];
+    if(option == "--size") {
+      std::sscanf(argv[i + 1], "%dx%d", &width, &height);
+    } else if(option == "--frames") {
+      frames = std::max(1, std::atoi(argv[i + 1]));
+    } else if(option == "--layers") {
+      layers = std::max(1, std::atoi(argv[i + 1]));
+    } else {
+      std::cerr << "Usage: " << argv[0] << " [--size WxH] [--frames N] [--layers N]\n";
+      return EXIT_FAILURE;
+    }
+  }
+
+  auto *pContext = createContext(width, height, 0);
+  if(pContext == nullptr) {
+    std::cerr << "Can not create a " << width << "x" << height << " context\n";
+    return EXIT_FAILURE;
+  }
+  makeCurrent(pContext);
+
+  ProgramDescription description;
+  description.uniforms = {{"uMatrices.ModelViewProjection", offsetof(Uniforms, modelViewProjection), sizeof(Mat4)}};
+  description.vertex = vertexShader;
+  description.fragment = fragmentShader;
+  description.fragment8 = fragmentShader8;
+  description.varyings = 1;
+  const auto program = createProgram(description);
+  glUseProgram(program);
+  const auto aspect = static_cast<float>(width) / static_cast<float>(height);
+  const auto modelViewProjection = perspective(0.8F, aspect, 0.1F, 100) * lookAt({0, 0, 6}, {0, 0, 0}, {0, 1, 0});
+  glUniformMatrix4fv(glGetUniformLocation(program, "uMatrices.ModelViewProjection"), 1, GL_FALSE, modelViewProjection.data());
+  glEnable(GL_DEPTH_TEST);
+  glDepthFunc(GL_LESS);
+
+  GLuint vao = 0;
+  std::array<GLuint, 2> buffers = {};
+  glGenVertexArrays(1, &vao);
+  glBindVertexArray(vao);
+  glGenBuffers(2, buffers.data());
+  glBindBuffer(GL_ARRAY_BUFFER, buffers[0]);
+  glVertexAttribPointer(0, 3, GL_FLOAT, false, 6 * sizeof(float), nullptr);
+  glEnableVertexAttribArray(0);
+  glVertexAttribPointer(1, 3, GL_FLOAT, false, 6 * sizeof(float), reinterpret_cast<const GLvoid *>(3 * sizeof(float)));
+  glEnableVertexAttribArray(1);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers[1]);
+
+  struct Scene {
+    std::string name;
+    Mesh mesh;
+  };
+  const auto unit = sphere(64);
+  const std::array<Scene, 2> scenes = {{
+    {"sphere", instances(unit, {{0, 0, 0}}, 2.5F)},
+    {std::to_string(layers) + " layers of spheres", stack(sphere(32), layers)},
+  }};
+  struct Config {
+    const char *pName;
+    bool bHierarchical;
+    bool bFrontToBack;
+  };
+  const std::array<Config, 3> configs = {{{"off", false, false}, {"hierarchical", true, false}, {"+ front to back", true, true}}};
+
+  std::printf("%dx%d, SIMD: %s\n", width, height, simd::gInstructionSet);
+  auto bSame = true;
+  const auto tolerance = static_cast<std::size_t>(width) * static_cast<std::size_t>(height) / 1000;
+  for(const auto &scene : scenes) {
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(scene.mesh.vertices.size() * sizeof(float)), scene.mesh.vertices.data(),
+                 GL_STATIC_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(scene.mesh.indices.size() * sizeof(std::uint32_t)),
+                 scene.mesh.indices.data(), GL_STATIC_DRAW);
+    const auto count = static_cast<GLsizei>(scene.mesh.indices.size());
+    std::printf("\n%s, %d triangles\n", scene.name.c_str(), count / 3);
+    std::printf("%-16s %9s %10s %10s %12s %10s %10s %9s\n", "", "ms/frame", "tri rej %", "block rej %", "fragments", "frag rej %",
+                "shaded %", "differing");
+    Result reference;
+    for(const auto &config : configs) {
+      auto result = run(width, height, frames, count, config.bHierarchical, config.bFrontToBack);
+      if(!config.bHierarchical && !config.bFrontToBack) {
+        reference = result;
+      }
+      const auto &statistics = result.statistics;
+      const auto &off = reference.statistics;
+      const auto differing = static_cast<std::size_t>(
+        std::inner_product(result.image.cbegin(), result.image.cend(), reference.image.cbegin(), std::size_t{0}, std::plus<>(),
+                           std::not_equal_to<>()));
+      std::printf("%-16s %9.2f %10.1f %10.1f %12llu %10.1f %10.1f %9zu\n", config.pName, result.milliseconds,
+                  ratio(statistics.trianglesRejected, statistics.triangles), ratio(statistics.blocksRejected, statistics.blocks),
+                  static_cast<unsigned long long>(statistics.fragments / static_cast<std::uint64_t>(frames)),
+                  100. - ratio(statistics.fragments, off.fragments), ratio(statistics.fragmentsShaded, statistics.fragments), differing);
+      bSame = bSame && differing <= tolerance;
+    }
+  }
+
+  glDeleteBuffers(2, buffers.data());
+  glDeleteVertexArrays(1, &vao);
+  glDeleteProgram(program);
+  if(glGetError() != GL_NO_ERROR) {
+    std::cerr << "GL error\n";
+    return EXIT_FAILURE;
+  }
+  destroyContext(pContext);
+  return bSame ? EXIT_SUCCESS : EXIT_FAILURE;
+}
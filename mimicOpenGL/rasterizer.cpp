@@ -0,0 +1,1342 @@
+#include <mimicOpenGL/rasterizer.hpp>
+// STL
+#include <cmath>
+#include <tuple>
+#include <bitset>
+#include <limits>
+#include <numeric>
+#include <utility>
+#include <type_traits>
+#include <algorithm>
+// mimicOpenGL
+#include <mimicOpenGL/simd.hpp>
+
+namespace mimic {
+
+// Side of the pixel blocks of the SIMD path, one row of a block is one 8 lane vector.
+constexpr GLint gBlockSize = 8;
+static_assert(simd::gLanes == gBlockSize && gTileSize % gBlockSize == 0);
+// Triangles set up and binned per task.
+constexpr std::size_t gSetupChunk = 256;
+
+constexpr auto gNoTriangle = std::numeric_limits<std::uint32_t>::max();
+
+// Vertices snap to 1/16 pixel. The edge functions are exact integers, the SIMD path evaluates them as floats
+// relative to each block, which stays exact while the guard band spans at most 4096 pixels.
+constexpr std::int32_t gSubpixels = 16;
+// Half the guard band in pixels, around the viewport center. It grows with viewports wider than 4096 pixels,
+// the edges of their triangles only stay exact up to a float's precision.
+constexpr float gGuardBand = 2048.F;
+
+// 4x multisampling on the standard rotated grid, the sample offsets from the pixel center in sub-pixels.
+constexpr std::size_t gSamples = 4;
+constexpr std::array<std::array<std::int32_t, 2>, gSamples> gSampleOffsets = {{{-2, -6}, {6, -2}, {-6, 2}, {2, 6}}};
+// Largest sample offset on either axis.
+constexpr std::int32_t gSampleReach = 6;
+constexpr std::uint32_t gAllSamples = (1U << gSamples) - 1;
+constexpr auto gCompressed = std::numeric_limits<std::uint32_t>::max();
+constexpr auto gNoPixel = std::numeric_limits<std::uint32_t>::max();
+
+// Sample `sample` of pixel or slot i: groups of 8 store their samples one after the other, one vector per sample.
+static auto sampleIndex(std::size_t i, std::size_t sample) -> std::size_t {
+  return (i / simd::gLanes * gSamples + sample) * simd::gLanes + i % simd::gLanes;
+}
+
+// Outcodes of a vertex. Triangles are clipped against the near plane and the guard band only, the other planes
+// only reject triangles entirely outside, the bounding box and the depth test do the rest.
+constexpr std::uint32_t gClipNear = 1U << 0U;
+constexpr std::uint32_t gClipGuardLeft = 1U << 1U;
+constexpr std::uint32_t gClipGuardRight = 1U << 2U;
+constexpr std::uint32_t gClipGuardBottom = 1U << 3U;
+constexpr std::uint32_t gClipGuardTop = 1U << 4U;
+constexpr std::uint32_t gClipPlanes = (1U << 5U) - 1;
+constexpr std::uint32_t gCullFar = 1U << 5U;
+constexpr std::uint32_t gCullLeft = 1U << 6U;
+constexpr std::uint32_t gCullRight = 1U << 7U;
+constexpr std::uint32_t gCullBottom = 1U << 8U;
+constexpr std::uint32_t gCullTop = 1U << 9U;
+// A clipped triangle has at most one more vertex per plane.
+constexpr std::size_t gMaxClipVertices = 3 + 5;
+
+// Clip codes of the submitted triangles, besides the planes to clip against.
+constexpr std::uint32_t gCodeCulled = 1U << 31U;
+
+// Half extents of the guard band in clip space: -x * w <= x <= x * w, the same for y.
+struct GuardBand {
+  float x;
+  float y;
+};
+
+static auto guardBand(const Viewport &viewport) -> GuardBand {
+  const auto extent = [](GLsizei size) {
+    return 2.F * std::max(gGuardBand, 0.5F * static_cast<float>(size)) / static_cast<float>(std::max(size, 1));
+  };
+  return {extent(viewport.width), extent(viewport.height)};
+}
+
+static auto outcode(const Vec4 &p, const GuardBand &guard) -> std::uint32_t {
+  std::uint32_t code = 0;
+  code |= p.z < -p.w ? gClipNear : 0;
+  code |= p.x < -guard.x * p.w ? gClipGuardLeft : 0;
+  code |= p.x > guard.x * p.w ? gClipGuardRight : 0;
+  code |= p.y < -guard.y * p.w ? gClipGuardBottom : 0;
+  code |= p.y > guard.y * p.w ? gClipGuardTop : 0;
+  code |= p.z > p.w ? gCullFar : 0;
+  code |= p.x < -p.w ? gCullLeft : 0;
+  code |= p.x > p.w ? gCullRight : 0;
+  code |= p.y < -p.w ? gCullBottom : 0;
+  code |= p.y > p.w ? gCullTop : 0;
+  return code;
+}
+
+// 0 when the triangle needs no clipping, gCodeCulled when it is entirely outside one plane, else the planes it crosses.
+static auto clipCode(const std::array<const VertexOutput *, 3> &vertices, const GuardBand &guard) -> std::uint32_t {
+  const auto a = outcode(vertices[0]->position, guard);
+  const auto b = outcode(vertices[1]->position, guard);
+  const auto c = outcode(vertices[2]->position, guard);
+  if((a & b & c) != 0) {
+    return gCodeCulled;
+  }
+  return (a | b | c) & gClipPlanes;
+}
+
+using Polygon = std::array<VertexOutput, gMaxClipVertices>;
+
+// Sutherland-Hodgman in clip space against the planes in `code`, returns the vertex count of the convex polygon left.
+static auto clip(const std::array<const VertexOutput *, 3> &vertices, std::uint32_t code, const GuardBand &guard,
+                 std::size_t varyings, Polygon &polygon) -> std::size_t {
+  Polygon input;
+  std::size_t count = 3;
+  for(std::size_t i = 0; i < 3; ++i) {
+    polygon[i] = *vertices[i];
+  }
+  for(std::uint32_t plane = 1; plane <= code; plane <<= 1U) {
+    if((code & plane) == 0) {
+      continue;
+    }
+    // Signed distance, positive inside.
+    const auto distance = [plane, &guard](const Vec4 &p) {
+      switch(plane) {
+      case gClipNear:
+        return p.z + p.w;
+      case gClipGuardLeft:
+        return p.x + guard.x * p.w;
+      case gClipGuardRight:
+        return guard.x * p.w - p.x;
+      case gClipGuardBottom:
+        return p.y + guard.y * p.w;
+      default:
+        return guard.y * p.w - p.y;
+      }
+    };
+    std::swap(input, polygon);
+    const auto inputCount = count;
+    count = 0;
+    for(std::size_t i = 0; i < inputCount; ++i) {
+      const auto &current = input[i];
+      const auto &next = input[(i + 1) % inputCount];
+      const auto dCurrent = distance(current.position);
+      const auto dNext = distance(next.position);
+      if(dCurrent >= 0) {
+        polygon[count++] = current;
+      }
+      if((dCurrent >= 0) != (dNext >= 0)) {
+        // From the inside vertex, so that the triangles sharing the edge compute the same vertex and stay watertight.
+        const auto bInside = dCurrent >= 0;
+        const auto &from = bInside ? current : next;
+        const auto &to = bInside ? next : current;
+        const auto dFrom = bInside ? dCurrent : dNext;
+        const auto dTo = bInside ? dNext : dCurrent;
+        const auto t = dFrom / (dFrom - dTo);
+        auto &vertex = polygon[count++];
+        vertex.position = from.position + (to.position - from.position) * t;
+        for(std::size_t k = 0; k < varyings; ++k) {
+          vertex.varyings[k] = from.varyings[k] + (to.varyings[k] - from.varyings[k]) * t;
+        }
+      }
+    }
+    if(count < 3) {
+      return 0;
+    }
+  }
+  return count;
+}
+
+auto packColor(Vec4 color) -> std::uint32_t {
+  const auto channel = [](float value) -> std::uint32_t {
+    return static_cast<std::uint32_t>(std::clamp(value, 0.F, 1.F) * 255.F + 0.5F);
+  };
+  // GL_RGBA / GL_UNSIGNED_BYTE byte order on a little endian host.
+  return channel(color.x) | (channel(color.y) << 8U) | (channel(color.z) << 16U) | (channel(color.w) << 24U);
+}
+
+Rasterizer::Rasterizer(ThreadPool &pool, Framebuffer &framebuffer) : mPool(pool), mFramebuffer(framebuffer) { resize(); }
+
+void Rasterizer::resize() {
+  mTilesX = (mFramebuffer.width + gTileSize - 1) / gTileSize;
+  mTilesY = (mFramebuffer.height + gTileSize - 1) / gTileSize;
+  mTiles.clear();
+  mTiles.resize(static_cast<std::size_t>(mTilesX * mTilesY));
+  for(GLint ty = 0; ty < mTilesY; ++ty) {
+    for(GLint tx = 0; tx < mTilesX; ++tx) {
+      auto &tile = mTiles[static_cast<std::size_t>(ty * mTilesX + tx)];
+      tile.x0 = tx * gTileSize;
+      tile.y0 = ty * gTileSize;
+      tile.x1 = std::min(tile.x0 + gTileSize, mFramebuffer.width);
+      tile.y1 = std::min(tile.y0 + gTileSize, mFramebuffer.height);
+    }
+  }
+  mBins.assign(mPool.size() * mTiles.size(), {});
+  mTriangles.clear();
+  mDraws.clear();
+  mBlocksX = mFramebuffer.stride / gBlockSize;
+  const auto blocks = static_cast<std::size_t>(mBlocksX * ((mFramebuffer.height + gBlockSize - 1) / gBlockSize));
+  mDepthMin.assign(blocks, 0.F);
+  mDepthMax.assign(blocks, 1.F);
+  mStatistics.assign(mPool.size(), {});
+  setVisibilityBuffer(mbVisibilityBuffer);
+  setMultisample(mbMultisample);
+  refreshDepthBounds();
+}
+
+void Rasterizer::setMode(RasterMode mode) {
+  mMode = mode;
+  refreshDepthBounds();
+}
+
+void Rasterizer::setHierarchicalDepth(bool bEnabled) {
+  mbHierarchicalDepth = bEnabled;
+  refreshDepthBounds();
+}
+
+void Rasterizer::setVisibilityBuffer(bool bEnabled) {
+  flush();
+  mbVisibilityBuffer = bEnabled;
+  const auto pixels = bEnabled ? static_cast<std::size_t>(mFramebuffer.stride) * static_cast<std::size_t>(mFramebuffer.height) : 0;
+  mVisibility.assign(pixels, gNoTriangle);
+  mBarycentrics[0].assign(pixels, 0.F);
+  mBarycentrics[1].assign(pixels, 0.F);
+}
+
+// The samples start out as the single sampled buffers, which keep the depth of the first sample when it ends.
+void Rasterizer::setMultisample(bool bEnabled) {
+  flush();
+  if(mbMultisample && !bEnabled) {
+    for(std::size_t pixel = 0; pixel < mFramebuffer.depth.size(); ++pixel) {
+      mFramebuffer.depth[pixel] = mSampleDepth[sampleIndex(pixel, 0)];
+    }
+  }
+  mbMultisample = bEnabled;
+  const auto pixels = bEnabled ? mFramebuffer.depth.size() : 0;
+  mSampleDepth.resize(pixels * gSamples);
+  for(std::size_t pixel = 0; pixel < pixels; ++pixel) {
+    for(std::size_t sample = 0; sample < gSamples; ++sample) {
+      mSampleDepth[sampleIndex(pixel, sample)] = mFramebuffer.depth[pixel];
+    }
+  }
+  mSlots.assign(pixels, gCompressed);
+  for(auto &tile : mTiles) {
+    tile.samples.clear();
+    tile.slotPixels.clear();
+    tile.freeSlots.clear();
+  }
+  refreshDepthBounds();
+}
+
+auto Rasterizer::statistics() const -> RasterStatistics {
+  RasterStatistics result;
+  for(const auto &statistics : mStatistics) {
+    result.triangles += statistics.triangles;
+    result.trianglesRejected += statistics.trianglesRejected;
+    result.blocks += statistics.blocks;
+    result.blocksRejected += statistics.blocksRejected;
+    result.fragments += statistics.fragments;
+    result.fragmentsPassed += statistics.fragmentsPassed;
+    result.fragmentsShaded += statistics.fragmentsShaded;
+    result.pixelsResolved += statistics.pixelsResolved;
+  }
+  return result;
+}
+
+void Rasterizer::resetStatistics() { mStatistics.assign(mPool.size(), {}); }
+
+auto Rasterizer::block(GLint x, GLint y) const -> std::size_t { return static_cast<std::size_t>((y / gBlockSize) * mBlocksX + x / gBlockSize); }
+
+void Rasterizer::updateDepthBounds(GLint x, GLint y) {
+  using namespace simd;
+  // A multisampled row holds one vector per sample.
+  const auto pixel = static_cast<std::size_t>(y * mFramebuffer.stride + x);
+  const auto samples = mbMultisample ? gSamples : 1;
+  const auto *pDepth = mbMultisample ? mSampleDepth.data() + sampleIndex(pixel, 0) : mFramebuffer.depth.data() + pixel;
+  auto low = load(pDepth);
+  auto high = low;
+  const auto rows = std::min(gBlockSize, mFramebuffer.height - y);
+  for(GLint row = 0; row < rows; ++row) {
+    for(std::size_t sample = 0; sample < samples; ++sample) {
+      const auto depth = load(pDepth + static_cast<std::size_t>(row * mFramebuffer.stride) * samples + sample * gLanes);
+      low = min(low, depth);
+      high = max(high, depth);
+    }
+  }
+  const auto index = block(x, y);
+  mDepthMin[index] = reduceMin(low);
+  mDepthMax[index] = reduceMax(high);
+}
+
+void Rasterizer::updateDepthBounds(Tile &tile) {
+  tile.depthMax = 0;
+  for(auto y = tile.y0; y < tile.y1; y += gBlockSize) {
+    for(auto x = tile.x0; x < tile.x1; x += gBlockSize) {
+      tile.depthMax = std::max(tile.depthMax, mDepthMax[block(x, y)]);
+    }
+  }
+}
+
+void Rasterizer::refreshDepthBounds() {
+  mbDepthBounds = mMode == RasterMode::SIMD && mbHierarchicalDepth;
+  if(!mbDepthBounds) {
+    return;
+  }
+  flush();
+  mPool.parallelFor(mTiles.size(), [this](std::size_t index, std::size_t) {
+    auto &tile = mTiles[index];
+    for(auto y = tile.y0; y < tile.y1; y += gBlockSize) {
+      for(auto x = tile.x0; x < tile.x1; x += gBlockSize) {
+        updateDepthBounds(x, y);
+      }
+    }
+    updateDepthBounds(tile);
+  });
+}
+
+// Setup and binning run in parallel chunks. A chunk bins its triangles in submission order, merge() restores the order
+// across the chunks a worker ran.
+// Clipping turns a triangle into none or several, so a first pass classifies the triangles and counts the output
+// of every chunk, which then sets up its triangles from its offset in the submission.
+template<typename Assemble>
+void Rasterizer::submit(DrawState state, std::size_t triangles, const Viewport &viewport, const Assemble &assemble) {
+  const auto draw = static_cast<std::uint32_t>(mDraws.size());
+  const auto varyings = state.varyings;
+  mDraws.push_back(std::move(state));
+  const auto guard = guardBand(viewport);
+  const auto chunks = (triangles + gSetupChunk - 1) / gSetupChunk;
+  mClipCodes.resize(triangles);
+  mChunkTriangles.assign(chunks + 1, 0);
+  mPool.parallelFor(chunks, [&](std::size_t chunk, std::size_t) {
+    const auto end = std::min((chunk + 1) * gSetupChunk, triangles);
+    Polygon polygon;
+    std::size_t count = 0;
+    for(auto i = chunk * gSetupChunk; i < end; ++i) {
+      const auto code = clipCode(assemble(i), guard);
+      mClipCodes[i] = code;
+      if(code == 0) {
+        ++count;
+      } else if(code != gCodeCulled) {
+        count += std::max<std::size_t>(clip(assemble(i), code, guard, varyings, polygon), 2) - 2;
+      }
+    }
+    mChunkTriangles[chunk + 1] = count;
+  });
+  std::partial_sum(mChunkTriangles.cbegin(), mChunkTriangles.cend(), mChunkTriangles.begin());
+
+  const auto first = mTriangles.size();
+  mTriangles.resize(first + mChunkTriangles.back());
+  mPool.parallelFor(chunks, [&](std::size_t chunk, std::size_t worker) {
+    const auto end = std::min((chunk + 1) * gSetupChunk, triangles);
+    auto index = static_cast<std::uint32_t>(first + mChunkTriangles[chunk]);
+    Polygon polygon;
+    for(auto i = chunk * gSetupChunk; i < end; ++i) {
+      const auto code = mClipCodes[i];
+      if(code == gCodeCulled) {
+        continue;
+      }
+      const auto vertices = assemble(i);
+      if(code == 0) {
+        if(setup(*vertices[0], *vertices[1], *vertices[2], viewport, draw, mTriangles[index])) {
+          bin(index, worker);
+        }
+        ++index;
+        continue;
+      }
+      // The clipped polygon is convex, a fan covers it.
+      const auto count = clip(vertices, code, guard, varyings, polygon);
+      for(std::size_t k = 2; k < count; ++k) {
+        if(setup(polygon[0], polygon[k - 1], polygon[k], viewport, draw, mTriangles[index])) {
+          bin(index, worker);
+        }
+        ++index;
+      }
+    }
+  });
+}
+
+void Rasterizer::submit(DrawState state, const std::vector<VertexOutput> &vertices, const Viewport &viewport) {
+  submit(std::move(state), vertices.size() / 3, viewport, [&vertices](std::size_t i) {
+    return std::array<const VertexOutput *, 3>{&vertices[3 * i], &vertices[3 * i + 1], &vertices[3 * i + 2]};
+  });
+}
+
+void Rasterizer::submit(DrawState state, const std::vector<VertexOutput> &vertices, const std::vector<std::uint32_t> &indices,
+                        const Viewport &viewport) {
+  submit(std::move(state), indices.size() / 3, viewport, [&vertices, &indices](std::size_t i) {
+    return std::array<const VertexOutput *, 3>{&vertices[indices[3 * i]], &vertices[indices[3 * i + 1]], &vertices[indices[3 * i + 2]]};
+  });
+}
+
+// Top-left fill rule: a pixel center exactly on an edge belongs to the triangle when the edge is a left edge
+// (inside to its right) or a top edge (horizontal, inside below), so triangles sharing an edge never both draw it.
+// Setup takes the bias off the other edges, interpolating from edge values adds it back.
+static auto fillBias(const Triangle &triangle, std::size_t i) -> std::int64_t {
+  return triangle.edgeA[i] > 0 || (triangle.edgeA[i] == 0 && triangle.edgeB[i] < 0) ? 0 : 1;
+}
+
+auto Rasterizer::setup(const VertexOutput &v0, const VertexOutput &v1, const VertexOutput &v2, const Viewport &viewport, std::uint32_t draw,
+                       Triangle &triangle) const -> bool {
+  const std::array<const VertexOutput *, 3> vertices = {&v0, &v1, &v2};
+
+  // Clipping at the near plane leaves w positive for every usual projection, the others are dropped.
+  for(const auto *pVertex : vertices) {
+    if(!(pVertex->position.w > 0)) {
+      return false;
+    }
+  }
+
+  // Window coordinates snapped to sub-pixels.
+  std::array<std::int64_t, 3> x;
+  std::array<std::int64_t, 3> y;
+  const auto &state = mDraws[draw];
+  for(std::size_t i = 0; i < 3; ++i) {
+    const auto &position = vertices[i]->position;
+    const auto invW = 1.F / position.w;
+    const auto windowX = (position.x * invW * 0.5F + 0.5F) * static_cast<float>(viewport.width) + static_cast<float>(viewport.x);
+    const auto windowY = (position.y * invW * 0.5F + 0.5F) * static_cast<float>(viewport.height) + static_cast<float>(viewport.y);
+    x[i] = std::lround(windowX * static_cast<float>(gSubpixels));
+    y[i] = std::lround(windowY * static_cast<float>(gSubpixels));
+    triangle.z[i] = position.z * invW * 0.5F + 0.5F;
+    triangle.invW[i] = invW;
+    for(std::size_t k = 0; k < state.varyings; ++k) {
+      triangle.varyings[i][k] = vertices[i]->varyings[k] * invW;
+    }
+  }
+
+  // edge(a, b) = (b - a) x (p - a), the weight of the vertex opposite to ab.
+  for(std::size_t i = 0; i < 3; ++i) {
+    const auto a = (i + 1) % 3;
+    const auto b = (i + 2) % 3;
+    triangle.edgeA[i] = static_cast<std::int32_t>(y[a] - y[b]);
+    triangle.edgeB[i] = static_cast<std::int32_t>(x[b] - x[a]);
+    triangle.edgeC[i] = -(triangle.edgeA[i] * x[a] + triangle.edgeB[i] * y[a]);
+  }
+  auto area = triangle.edgeA[2] * x[2] + triangle.edgeB[2] * y[2] + triangle.edgeC[2];
+  if(area == 0) {
+    return false;
+  }
+  // Both windings are drawn, face culling is not part of the subset.
+  if(area < 0) {
+    for(std::size_t i = 0; i < 3; ++i) {
+      triangle.edgeA[i] = -triangle.edgeA[i];
+      triangle.edgeB[i] = -triangle.edgeB[i];
+      triangle.edgeC[i] = -triangle.edgeC[i];
+    }
+    area = -area;
+  }
+  for(std::size_t i = 0; i < 3; ++i) {
+    triangle.edgeC[i] -= fillBias(triangle, i);
+  }
+  triangle.invArea = 1.F / static_cast<float>(area);
+  std::tie(triangle.zMin, triangle.zMax) = std::minmax({triangle.z[0], triangle.z[1], triangle.z[2]});
+
+  // li = (ai * x + bi * y + ci) / area, so sum(li * value[i]) is linear in x and y. The planes step per pixel.
+  constexpr auto pixel = static_cast<float>(gSubpixels);
+  triangle.originX = static_cast<float>(x[0]) / pixel;
+  triangle.originY = static_cast<float>(y[0]) / pixel;
+  const auto plane = [&triangle, pixel](const std::array<float, 3> &values) {
+    const auto a = [&triangle, pixel](std::size_t i) { return static_cast<float>(triangle.edgeA[i]) * pixel; };
+    const auto b = [&triangle, pixel](std::size_t i) { return static_cast<float>(triangle.edgeB[i]) * pixel; };
+    return Plane{values[0], (a(0) * values[0] + a(1) * values[1] + a(2) * values[2]) * triangle.invArea,
+                 (b(0) * values[0] + b(1) * values[1] + b(2) * values[2]) * triangle.invArea};
+  };
+  triangle.zPlane = plane(triangle.z);
+  triangle.invWPlane = plane(triangle.invW);
+  for(std::size_t k = 0; k < state.varyings; ++k) {
+    triangle.varyingPlanes[k] = plane({triangle.varyings[0][k], triangle.varyings[1][k], triangle.varyings[2][k]});
+  }
+
+  const auto [minX, maxX] = std::minmax({x[0], x[1], x[2]});
+  const auto [minY, maxY] = std::minmax({y[0], y[1], y[2]});
+  const auto clipX0 = std::max(viewport.x, 0);
+  const auto clipY0 = std::max(viewport.y, 0);
+  const auto clipX1 = std::min(viewport.x + viewport.width, mFramebuffer.width);
+  const auto clipY1 = std::min(viewport.y + viewport.height, mFramebuffer.height);
+  // The pixels whose centers lie inside the snapped bounds, the guard band keeps them in range.
+  // Multisampled, the pixels with a sample inside them.
+  constexpr auto half = gSubpixels / 2;
+  const auto reach = mbMultisample ? gSampleReach : 0;
+  const auto firstPixel = [reach](std::int64_t low) {
+    return static_cast<GLint>(std::ceil(static_cast<double>(low - half - reach) / gSubpixels));
+  };
+  const auto lastPixel = [reach](std::int64_t high) {
+    return static_cast<GLint>(std::floor(static_cast<double>(high - half + reach) / gSubpixels));
+  };
+  triangle.minX = std::max(firstPixel(minX), clipX0);
+  triangle.minY = std::max(firstPixel(minY), clipY0);
+  triangle.maxX = std::min(lastPixel(maxX) + 1, clipX1);
+  triangle.maxY = std::min(lastPixel(maxY) + 1, clipY1);
+  if(triangle.minX >= triangle.maxX || triangle.minY >= triangle.maxY) {
+    return false;
+  }
+  triangle.draw = draw;
+  return true;
+}
+
+// Edge i of `triangle` at the center of pixel (x, y).
+static auto edge(const Triangle &triangle, std::size_t i, GLint x, GLint y) -> std::int64_t {
+  const auto px = static_cast<std::int64_t>(x) * gSubpixels + gSubpixels / 2;
+  const auto py = static_cast<std::int64_t>(y) * gSubpixels + gSubpixels / 2;
+  return triangle.edgeA[i] * px + triangle.edgeB[i] * py + triangle.edgeC[i];
+}
+
+void Rasterizer::bin(std::uint32_t index, std::size_t worker) {
+  const auto &triangle = mTriangles[index];
+  const auto tx0 = triangle.minX / gTileSize;
+  const auto ty0 = triangle.minY / gTileSize;
+  const auto tx1 = (triangle.maxX - 1) / gTileSize;
+  const auto ty1 = (triangle.maxY - 1) / gTileSize;
+  for(auto ty = ty0; ty <= ty1; ++ty) {
+    for(auto tx = tx0; tx <= tx1; ++tx) {
+      mBins[worker * mTiles.size() + static_cast<std::size_t>(ty * mTilesX + tx)].push_back(index);
+    }
+  }
+}
+
+void Rasterizer::flush() {
+  if(mTriangles.empty()) {
+    mDraws.clear();
+    return;
+  }
+  mPool.parallelFor(mTiles.size(), [this](std::size_t index, std::size_t worker) {
+    merge(index);
+    auto &tile = mTiles[index];
+    const auto bDrawn = !tile.triangles.empty();
+    rasterize(tile, mStatistics[worker]);
+    // Right away, while the tile's samples are in cache.
+    if(mbMultisample && bDrawn) {
+      resolve(tile, mStatistics[worker]);
+    }
+  });
+  // Shading is a pass of its own, its cost follows the visible pixels of a tile rather than its triangles.
+  if(mbVisibilityBuffer) {
+    mPool.parallelFor(mTiles.size(), [this](std::size_t index, std::size_t worker) { shade(mTiles[index], mStatistics[worker]); });
+  }
+  mTriangles.clear();
+  mDraws.clear();
+}
+
+// Concatenates the worker bins of a tile and merges their sorted runs pairwise, tile.triangles ends up in submission
+// order. A bin is sorted within every chunk range its worker took, but a worker that stole a range below the chunks it
+// ran before starts a new run there, so runs are split wherever the indices decrease.
+void Rasterizer::merge(std::size_t index) {
+  auto &triangles = mTiles[index].triangles;
+  std::vector<std::size_t> runs = {0};
+  for(std::size_t worker = 0; worker < mPool.size(); ++worker) {
+    auto &bin = mBins[worker * mTiles.size() + index];
+    for(std::size_t i = 0; i < bin.size(); ++i) {
+      if(i > 0 && bin[i] < bin[i - 1]) {
+        runs.push_back(triangles.size());
+      }
+      triangles.push_back(bin[i]);
+    }
+    if(!bin.empty()) {
+      runs.push_back(triangles.size());
+      bin.clear();
+    }
+  }
+  while(runs.size() > 2) {
+    std::size_t merged = 1;
+    for(std::size_t i = 2; i < runs.size(); i += 2) {
+      const auto begin = triangles.begin();
+      std::inplace_merge(begin + static_cast<std::ptrdiff_t>(runs[i - 2]), begin + static_cast<std::ptrdiff_t>(runs[i - 1]),
+                         begin + static_cast<std::ptrdiff_t>(runs[i]));
+      runs[merged++] = runs[i];
+    }
+    if(runs.size() % 2 == 0) {
+      runs[merged++] = runs.back();
+    }
+    runs.resize(merged);
+  }
+}
+
+void Rasterizer::clear(GLbitfield mask, std::uint32_t color, float depth) {
+  flush();
+  mPool.parallelFor(mTiles.size(), [this, mask, color, depth](std::size_t index, std::size_t) {
+    auto &tile = mTiles[index];
+    // The last tile of a row also clears the padding, so whole blocks hold the cleared depth.
+    const auto x1 = tile.x1 == mFramebuffer.width ? mFramebuffer.stride : tile.x1;
+    for(auto y = tile.y0; y < tile.y1; ++y) {
+      const auto row = static_cast<std::ptrdiff_t>(y * mFramebuffer.stride);
+      const auto begin = row + tile.x0;
+      const auto end = row + x1;
+      if((mask & GL_COLOR_BUFFER_BIT) != 0) {
+        std::fill(mFramebuffer.color.begin() + begin, mFramebuffer.color.begin() + end, color);
+        if(mbMultisample) {
+          std::fill(mSlots.begin() + begin, mSlots.begin() + end, gCompressed);
+        }
+      }
+      if((mask & GL_DEPTH_BUFFER_BIT) != 0) {
+        if(mbMultisample) {
+          // Whole groups of samples, the tile starts and ends on a block.
+          const auto samples = static_cast<std::ptrdiff_t>(gSamples);
+          std::fill(mSampleDepth.begin() + begin * samples, mSampleDepth.begin() + end * samples, depth);
+        } else {
+          std::fill(mFramebuffer.depth.begin() + begin, mFramebuffer.depth.begin() + end, depth);
+        }
+      }
+    }
+    if((mask & GL_COLOR_BUFFER_BIT) != 0) {
+      tile.samples.clear();
+      tile.slotPixels.clear();
+      tile.freeSlots.clear();
+    }
+    if((mask & GL_DEPTH_BUFFER_BIT) != 0 && mbDepthBounds) {
+      for(auto y = tile.y0; y < tile.y1; y += gBlockSize) {
+        for(auto x = tile.x0; x < tile.x1; x += gBlockSize) {
+          mDepthMin[block(x, y)] = depth;
+          mDepthMax[block(x, y)] = depth;
+        }
+      }
+      tile.depthMax = depth;
+    }
+  });
+}
+
+void Rasterizer::rasterize(Tile &tile, RasterStatistics &statistics) {
+  if(mMode == RasterMode::SIMD && mbFrontToBack) {
+    sortFrontToBack(tile);
+  }
+  tile.bDeferred = mbVisibilityBuffer && !mbMultisample && !tile.triangles.empty();
+  for(const auto index : tile.triangles) {
+    const auto &state = mDraws[mTriangles[index].draw];
+    // The depth state as template arguments: no test, GL_LESS, or always passing and writing depth.
+    const auto draw = [this, &tile, index, &statistics](auto depthTest, auto depthLess) {
+      constexpr bool DepthTest = decltype(depthTest)::value;
+      constexpr bool DepthLess = decltype(depthLess)::value;
+      const auto bSimd = mMode == RasterMode::SIMD;
+      if(mbMultisample && bSimd) {
+        rasterizeSampleBlocks<DepthTest, DepthLess>(tile, index, statistics);
+      } else if(mbMultisample) {
+        rasterizeSamples<DepthTest, DepthLess>(tile, index, statistics);
+      } else if(bSimd) {
+        rasterizeBlocks<DepthTest, DepthLess>(tile, index, statistics);
+      } else {
+        rasterize<DepthTest, DepthLess>(tile, index, statistics);
+      }
+    };
+    if(!state.bDepthTest) {
+      draw(std::false_type{}, std::false_type{});
+    } else if(state.depthFunc == GL_LESS) {
+      draw(std::true_type{}, std::true_type{});
+    } else {
+      draw(std::true_type{}, std::false_type{});
+    }
+  }
+  tile.triangles.clear();
+}
+
+// Without blending the order of GL_LESS triangles only matters where their depths are equal, so every run of
+// them can be reordered nearest first, letting hierarchical depth reject what lies behind.
+void Rasterizer::sortFrontToBack(Tile &tile) {
+  const auto bLess = [this](std::uint32_t index) {
+    const auto &state = mDraws[mTriangles[index].draw];
+    return state.bDepthTest && state.depthFunc == GL_LESS;
+  };
+  const auto nearer = [this](std::uint32_t a, std::uint32_t b) { return mTriangles[a].zMin < mTriangles[b].zMin; };
+  auto begin = tile.triangles.begin();
+  while(begin != tile.triangles.end()) {
+    begin = std::find_if(begin, tile.triangles.end(), bLess);
+    const auto end = std::find_if_not(begin, tile.triangles.end(), bLess);
+    std::stable_sort(begin, end, nearer);
+    begin = end;
+  }
+}
+
+template<bool DepthTest, bool DepthLess>
+void Rasterizer::rasterize(const Tile &tile, std::uint32_t index, RasterStatistics &statistics) {
+  const auto &triangle = mTriangles[index];
+  const auto &state = mDraws[triangle.draw];
+  ++statistics.triangles;
+  const auto x0 = std::max(triangle.minX, tile.x0);
+  const auto y0 = std::max(triangle.minY, tile.y0);
+  const auto x1 = std::min(triangle.maxX, tile.x1);
+  const auto y1 = std::min(triangle.maxY, tile.y1);
+  // Steps per pixel.
+  const std::array<std::int64_t, 3> a = {triangle.edgeA[0] * gSubpixels, triangle.edgeA[1] * gSubpixels,
+                                         triangle.edgeA[2] * gSubpixels};
+  const std::array<std::int64_t, 3> bias = {fillBias(triangle, 0), fillBias(triangle, 1), fillBias(triangle, 2)};
+  std::array<float, gMaxVaryings> varyings{};
+
+  for(auto y = y0; y < y1; ++y) {
+    auto e0 = edge(triangle, 0, x0, y);
+    auto e1 = edge(triangle, 1, x0, y);
+    auto e2 = edge(triangle, 2, x0, y);
+    const auto row = static_cast<std::size_t>(y * mFramebuffer.stride);
+
+    for(auto x = x0; x < x1; ++x, e0 += a[0], e1 += a[1], e2 += a[2]) {
+      if(e0 < 0 || e1 < 0 || e2 < 0) {
+        continue;
+      }
+      ++statistics.fragments;
+      const auto l0 = static_cast<float>(e0 + bias[0]) * triangle.invArea;
+      const auto l1 = static_cast<float>(e1 + bias[1]) * triangle.invArea;
+      const auto l2 = static_cast<float>(e2 + bias[2]) * triangle.invArea;
+      const auto pixel = row + static_cast<std::size_t>(x);
+
+      const auto z = l0 * triangle.z[0] + l1 * triangle.z[1] + l2 * triangle.z[2];
+      if constexpr(DepthTest) {
+        if constexpr(DepthLess) {
+          if(!(z < mFramebuffer.depth[pixel])) {
+            continue;
+          }
+        }
+        mFramebuffer.depth[pixel] = z;
+      }
+      ++statistics.fragmentsPassed;
+      if(mbVisibilityBuffer) {
+        mVisibility[pixel] = index;
+        mBarycentrics[0][pixel] = l1;
+        mBarycentrics[1][pixel] = l2;
+        continue;
+      }
+
+      const auto w = 1.F / (l0 * triangle.invW[0] + l1 * triangle.invW[1] + l2 * triangle.invW[2]);
+      for(std::size_t k = 0; k < state.varyings; ++k) {
+        varyings[k] = (l0 * triangle.varyings[0][k] + l1 * triangle.varyings[1][k] + l2 * triangle.varyings[2][k]) * w;
+      }
+      ++statistics.fragmentsShaded;
+      mFramebuffer.color[pixel] = packColor(state.fragment(state.uniforms.data(), varyings.data()));
+    }
+  }
+}
+
+template<bool DepthTest, bool DepthLess>
+void Rasterizer::rasterizeBlocks(Tile &tile, std::uint32_t index, RasterStatistics &statistics) {
+  using namespace simd;
+  const auto &triangle = mTriangles[index];
+  const auto &state = mDraws[triangle.draw];
+  constexpr auto bDepthBounds = DepthTest && DepthLess;
+  ++statistics.triangles;
+  if constexpr(bDepthBounds) {
+    if(mbDepthBounds && triangle.zMin >= tile.depthMax) {
+      ++statistics.trianglesRejected;
+      return;
+    }
+  }
+
+  const auto x0 = std::max(triangle.minX, tile.x0);
+  const auto y0 = std::max(triangle.minY, tile.y0);
+  const auto x1 = std::min(triangle.maxX, tile.x1);
+  const auto y1 = std::min(triangle.maxY, tile.y1);
+  // Steps per pixel, exact in a float with the guard band.
+  std::array<float, 3> a;
+  std::array<float, 3> b;
+  for(std::size_t i = 0; i < 3; ++i) {
+    a[i] = static_cast<float>(triangle.edgeA[i] * gSubpixels);
+    b[i] = static_cast<float>(triangle.edgeB[i] * gSubpixels);
+  }
+  const auto ramp8 = ramp();
+  const std::array<Float8, 3> edgeSteps = {ramp8 * a[0], ramp8 * a[1], ramp8 * a[2]};
+  // Offsets from the pixel center at the block origin to the smallest / largest edge value and depth inside the block.
+  constexpr auto span = static_cast<float>(gBlockSize - 1);
+  std::array<float, 3> edgeMin;
+  std::array<float, 3> edgeMax;
+  for(std::size_t i = 0; i < 3; ++i) {
+    edgeMin[i] = span * (std::min(a[i], 0.F) + std::min(b[i], 0.F));
+    edgeMax[i] = span * (std::max(a[i], 0.F) + std::max(b[i], 0.F));
+  }
+  const auto &zPlane = triangle.zPlane;
+  const auto zMinOffset = span * (std::min(zPlane.dx, 0.F) + std::min(zPlane.dy, 0.F));
+  const auto zMaxOffset = span * (std::max(zPlane.dx, 0.F) + std::max(zPlane.dy, 0.F));
+  const auto zStep = ramp8 * zPlane.dx;
+  const auto invWStep = ramp8 * triangle.invWPlane.dx;
+  const auto *pUniforms = state.uniforms.data();
+
+  alignas(32) std::array<float, gMaxVaryings * gLanes> varyings{};
+  alignas(32) std::array<float, 4 * gLanes> colors{};
+  std::array<float, gMaxVaryings> fragmentVaryings{};
+  auto bTileWritten = false;
+
+  for(auto by = y0 & ~(gBlockSize - 1); by < y1; by += gBlockSize) {
+    for(auto bx = x0 & ~(gBlockSize - 1); bx < x1; bx += gBlockSize) {
+      const auto px = static_cast<float>(bx) + 0.5F;
+      const auto py = static_cast<float>(by) + 0.5F;
+      // Exact where the sign matters: an edge crossing the block is small at its corner.
+      const std::array<float, 3> corner = {static_cast<float>(edge(triangle, 0, bx, by)),
+                                           static_cast<float>(edge(triangle, 1, bx, by)),
+                                           static_cast<float>(edge(triangle, 2, bx, by))};
+      // Empty: one edge is negative on the whole block. Full: every edge is positive on the whole block.
+      if(corner[0] + edgeMax[0] < 0 || corner[1] + edgeMax[1] < 0 || corner[2] + edgeMax[2] < 0) {
+        continue;
+      }
+      ++statistics.blocks;
+      const auto dx = px - triangle.originX;
+
+      // Occluded: the triangle's nearest depth in the block is behind the farthest one stored there.
+      // Visible: its farthest depth is in front of the nearest one stored, the per-pixel test always passes.
+      auto bVisible = false;
+      if constexpr(bDepthBounds) {
+        if(mbDepthBounds) {
+          const auto z = zPlane.origin + zPlane.dx * dx + zPlane.dy * (py - triangle.originY);
+          const auto bounds = block(bx, by);
+          if(std::max(z + zMinOffset, triangle.zMin) >= mDepthMax[bounds]) {
+            ++statistics.blocksRejected;
+            continue;
+          }
+          bVisible = std::min(z + zMaxOffset, triangle.zMax) < mDepthMin[bounds];
+        }
+      }
+
+      const auto bInsideClip = bx >= x0 && by >= y0 && bx + gBlockSize <= x1 && by + gBlockSize <= y1;
+      const auto bFull = bInsideClip && corner[0] + edgeMin[0] >= 0 && corner[1] + edgeMin[1] >= 0 && corner[2] + edgeMin[2] >= 0;
+
+      auto columns = allTrue();
+      if(!bInsideClip) {
+        const auto laneX = ramp8 + static_cast<float>(bx);
+        columns = (laneX >= set1(static_cast<float>(x0))) & (laneX < set1(static_cast<float>(x1)));
+      }
+
+      auto bBlockWritten = false;
+      const auto rowBegin = std::max(by, y0);
+      const auto rowEnd = std::min(by + gBlockSize, y1);
+      for(auto y = rowBegin; y < rowEnd; ++y) {
+        const auto rowOffset = static_cast<float>(y - by);
+        auto mask = columns;
+        if(!bFull) {
+          for(std::size_t i = 0; i < 3; ++i) {
+            mask = mask & (edgeSteps[i] + (corner[i] + b[i] * rowOffset) >= set1(0.F));
+          }
+          if(bits(mask) == 0) {
+            continue;
+          }
+        }
+        statistics.fragments += std::bitset<gLanes>(bits(mask)).count();
+        const auto pixel = static_cast<std::size_t>(y * mFramebuffer.stride + bx);
+        const auto dy = static_cast<float>(y) + 0.5F - triangle.originY;
+        const auto plane = [dx, dy](const Plane &p) { return p.origin + p.dx * dx + p.dy * dy; };
+
+        if constexpr(DepthTest) {
+          const auto z = zStep + plane(zPlane);
+          auto *pDepth = mFramebuffer.depth.data() + pixel;
+          const auto depth = load(pDepth);
+          if constexpr(DepthLess) {
+            if(!bVisible) {
+              mask = mask & (z < depth);
+              if(bits(mask) == 0) {
+                continue;
+              }
+            }
+          }
+          store(pDepth, select(mask, depth, z));
+          bBlockWritten = true;
+        }
+        const auto passed = std::bitset<gLanes>(bits(mask)).count();
+        statistics.fragmentsPassed += passed;
+        if(mbVisibilityBuffer) {
+          auto *pTriangle = mVisibility.data() + pixel;
+          storeInt(pTriangle, select(mask, loadInt(pTriangle), setInt(index)));
+          for(std::size_t i = 0; i < 2; ++i) {
+            auto *pBarycentric = mBarycentrics[i].data() + pixel;
+            const auto edge = edgeSteps[i + 1] + (corner[i + 1] + b[i + 1] * rowOffset);
+            const auto bias = static_cast<float>(fillBias(triangle, i + 1));
+            store(pBarycentric, select(mask, load(pBarycentric), (edge + bias) * triangle.invArea));
+          }
+          continue;
+        }
+        statistics.fragmentsShaded += passed;
+
+        const auto w = set1(1.F) / (invWStep + plane(triangle.invWPlane));
+        for(std::size_t k = 0; k < state.varyings; ++k) {
+          const auto &p = triangle.varyingPlanes[k];
+          store(varyings.data() + k * gLanes, (ramp8 * p.dx + plane(p)) * w);
+        }
+
+        auto *pColor = mFramebuffer.color.data() + pixel;
+        if(state.fragment8 != nullptr) {
+          state.fragment8(pUniforms, varyings.data(), colors.data());
+          const auto packed = packColors(load(colors.data()), load(colors.data() + gLanes), load(colors.data() + 2 * gLanes),
+                                         load(colors.data() + 3 * gLanes));
+          storeInt(pColor, select(mask, loadInt(pColor), packed));
+        } else {
+          // Shaders without a SIMD version run once per covered lane.
+          const auto laneBits = bits(mask);
+          for(std::size_t lane = 0; lane < gLanes; ++lane) {
+            if((laneBits & (1U << lane)) == 0) {
+              continue;
+            }
+            for(std::size_t k = 0; k < state.varyings; ++k) {
+              fragmentVaryings[k] = varyings[k * gLanes + lane];
+            }
+            pColor[lane] = packColor(state.fragment(pUniforms, fragmentVaryings.data()));
+          }
+        }
+      }
+      if(mbDepthBounds && bBlockWritten) {
+        updateDepthBounds(bx, by);
+        bTileWritten = true;
+      }
+    }
+  }
+  if(bTileWritten) {
+    updateDepthBounds(tile);
+  }
+}
+
+// Shades every pixel the tile's triangles left in the visibility buffer, once. The lanes of a block row drawn by the
+// same draw call share a fragment shader call: their varyings are interpolated from the barycentrics with the vertex
+// values broadcast when the lanes also share the triangle, and gathered lane by lane otherwise.
+void Rasterizer::shade(Tile &tile, RasterStatistics &statistics) {
+  using namespace simd;
+  if(!tile.bDeferred) {
+    return;
+  }
+  tile.bDeferred = false;
+
+  alignas(32) std::array<float, gMaxVaryings * gLanes> varyings{};
+  alignas(32) std::array<float, 4 * gLanes> colors{};
+  std::array<float, gMaxVaryings> fragmentVaryings{};
+
+  for(auto y = tile.y0; y < tile.y1; ++y) {
+    for(auto x = tile.x0; x < tile.x1; x += gBlockSize) {
+      const auto pixel = static_cast<std::size_t>(y * mFramebuffer.stride + x);
+      auto *pTriangles = mVisibility.data() + pixel;
+      const auto *pL1 = mBarycentrics[0].data() + pixel;
+      const auto *pL2 = mBarycentrics[1].data() + pixel;
+      std::uint32_t pending = 0;
+      for(std::size_t lane = 0; lane < gLanes; ++lane) {
+        pending |= static_cast<std::uint32_t>(pTriangles[lane] != gNoTriangle) << lane;
+      }
+
+      while(pending != 0) {
+        std::size_t first = 0;
+        while((pending & (1U << first)) == 0) {
+          ++first;
+        }
+        const auto &triangle = mTriangles[pTriangles[first]];
+        const auto &state = mDraws[triangle.draw];
+        std::uint32_t laneBits = 0;
+        auto bOneTriangle = true;
+        for(auto lane = first; lane < gLanes; ++lane) {
+          if((pending & (1U << lane)) != 0 && mTriangles[pTriangles[lane]].draw == triangle.draw) {
+            laneBits |= 1U << lane;
+            bOneTriangle = bOneTriangle && pTriangles[lane] == pTriangles[first];
+          }
+        }
+        pending &= ~laneBits;
+
+        if(bOneTriangle) {
+          const auto l1 = load(pL1);
+          const auto l2 = load(pL2);
+          const auto l0 = set1(1.F) - l1 - l2;
+          const auto interpolate = [&l0, &l1, &l2](const std::array<float, 3> &values) {
+            return fma(l0, set1(values[0]), fma(l1, set1(values[1]), l2 * values[2]));
+          };
+          const auto w = set1(1.F) / interpolate(triangle.invW);
+          for(std::size_t k = 0; k < state.varyings; ++k) {
+            store(varyings.data() + k * gLanes, interpolate({triangle.varyings[0][k], triangle.varyings[1][k], triangle.varyings[2][k]}) * w);
+          }
+        } else {
+          for(std::size_t lane = 0; lane < gLanes; ++lane) {
+            if((laneBits & (1U << lane)) == 0) {
+              continue;
+            }
+            const auto &current = mTriangles[pTriangles[lane]];
+            const auto l1 = pL1[lane];
+            const auto l2 = pL2[lane];
+            const auto l0 = 1.F - l1 - l2;
+            const auto w = 1.F / (l0 * current.invW[0] + l1 * current.invW[1] + l2 * current.invW[2]);
+            for(std::size_t k = 0; k < state.varyings; ++k) {
+              varyings[k * gLanes + lane] = (l0 * current.varyings[0][k] + l1 * current.varyings[1][k] + l2 * current.varyings[2][k]) * w;
+            }
+          }
+        }
+
+        statistics.fragmentsShaded += std::bitset<gLanes>(laneBits).count();
+        auto *pColor = mFramebuffer.color.data() + pixel;
+        if(mMode == RasterMode::SIMD && state.fragment8 != nullptr) {
+          state.fragment8(state.uniforms.data(), varyings.data(), colors.data());
+          const auto packed = packColors(load(colors.data()), load(colors.data() + gLanes), load(colors.data() + 2 * gLanes),
+                                         load(colors.data() + 3 * gLanes));
+          storeInt(pColor, select(fromBits(laneBits), loadInt(pColor), packed));
+        } else {
+          for(std::size_t lane = 0; lane < gLanes; ++lane) {
+            if((laneBits & (1U << lane)) == 0) {
+              continue;
+            }
+            for(std::size_t k = 0; k < state.varyings; ++k) {
+              fragmentVaryings[k] = varyings[k * gLanes + lane];
+            }
+            pColor[lane] = packColor(state.fragment(state.uniforms.data(), fragmentVaryings.data()));
+          }
+        }
+      }
+      std::fill(pTriangles, pTriangles + gLanes, gNoTriangle);
+    }
+  }
+}
+
+// The per-pixel reference of multisampling: coverage and depth per sample, the fragment shader once per pixel at its
+// center, its color written to the samples that passed.
+template<bool DepthTest, bool DepthLess>
+void Rasterizer::rasterizeSamples(Tile &tile, std::uint32_t index, RasterStatistics &statistics) {
+  const auto &triangle = mTriangles[index];
+  const auto &state = mDraws[triangle.draw];
+  ++statistics.triangles;
+  const auto x0 = std::max(triangle.minX, tile.x0);
+  const auto y0 = std::max(triangle.minY, tile.y0);
+  const auto x1 = std::min(triangle.maxX, tile.x1);
+  const auto y1 = std::min(triangle.maxY, tile.y1);
+  // Steps per pixel and from the pixel center to every sample.
+  std::array<std::int64_t, 3> a;
+  std::array<std::array<std::int64_t, gSamples>, 3> offsets;
+  for(std::size_t i = 0; i < 3; ++i) {
+    a[i] = triangle.edgeA[i] * gSubpixels;
+    for(std::size_t sample = 0; sample < gSamples; ++sample) {
+      offsets[i][sample] = triangle.edgeA[i] * gSampleOffsets[sample][0] + triangle.edgeB[i] * gSampleOffsets[sample][1];
+    }
+  }
+  const std::array<std::int64_t, 3> bias = {fillBias(triangle, 0), fillBias(triangle, 1), fillBias(triangle, 2)};
+  std::array<float, gMaxVaryings> varyings{};
+
+  for(auto y = y0; y < y1; ++y) {
+    std::array<std::int64_t, 3> e = {edge(triangle, 0, x0, y), edge(triangle, 1, x0, y), edge(triangle, 2, x0, y)};
+    const auto row = static_cast<std::size_t>(y * mFramebuffer.stride);
+
+    for(auto x = x0; x < x1; ++x, e[0] += a[0], e[1] += a[1], e[2] += a[2]) {
+      std::uint32_t samples = 0;
+      for(std::size_t sample = 0; sample < gSamples; ++sample) {
+        if(e[0] + offsets[0][sample] >= 0 && e[1] + offsets[1][sample] >= 0 && e[2] + offsets[2][sample] >= 0) {
+          samples |= 1U << sample;
+        }
+      }
+      if(samples == 0) {
+        continue;
+      }
+      ++statistics.fragments;
+      const auto pixel = row + static_cast<std::size_t>(x);
+
+      if constexpr(DepthTest) {
+        for(std::size_t sample = 0; sample < gSamples; ++sample) {
+          if((samples & (1U << sample)) == 0) {
+            continue;
+          }
+          const auto l0 = static_cast<float>(e[0] + offsets[0][sample] + bias[0]) * triangle.invArea;
+          const auto l1 = static_cast<float>(e[1] + offsets[1][sample] + bias[1]) * triangle.invArea;
+          const auto l2 = static_cast<float>(e[2] + offsets[2][sample] + bias[2]) * triangle.invArea;
+          const auto z = l0 * triangle.z[0] + l1 * triangle.z[1] + l2 * triangle.z[2];
+          auto &depth = mSampleDepth[sampleIndex(pixel, sample)];
+          if constexpr(DepthLess) {
+            if(!(z < depth)) {
+              samples &= ~(1U << sample);
+              continue;
+            }
+          }
+          depth = z;
+        }
+        if(samples == 0) {
+          continue;
+        }
+      }
+      ++statistics.fragmentsPassed;
+
+      // Once per pixel at its center like GL, which may lie outside the triangle.
+      const auto l0 = static_cast<float>(e[0] + bias[0]) * triangle.invArea;
+      const auto l1 = static_cast<float>(e[1] + bias[1]) * triangle.invArea;
+      const auto l2 = static_cast<float>(e[2] + bias[2]) * triangle.invArea;
+      const auto w = 1.F / (l0 * triangle.invW[0] + l1 * triangle.invW[1] + l2 * triangle.invW[2]);
+      for(std::size_t k = 0; k < state.varyings; ++k) {
+        varyings[k] = (l0 * triangle.varyings[0][k] + l1 * triangle.varyings[1][k] + l2 * triangle.varyings[2][k]) * w;
+      }
+      ++statistics.fragmentsShaded;
+      writeSamples(tile, pixel, samples, packColor(state.fragment(state.uniforms.data(), varyings.data())));
+    }
+  }
+}
+
+// rasterizeBlocks() with 4 samples per pixel: the lanes of a row test coverage and depth one sample at a time and
+// run the fragment shader once for every pixel with a sample passing. Pixels with all their samples passing take the
+// fast path, their color goes straight to the framebuffer and they stay compressed.
+template<bool DepthTest, bool DepthLess>
+void Rasterizer::rasterizeSampleBlocks(Tile &tile, std::uint32_t index, RasterStatistics &statistics) {
+  using namespace simd;
+  const auto &triangle = mTriangles[index];
+  const auto &state = mDraws[triangle.draw];
+  constexpr auto bDepthBounds = DepthTest && DepthLess;
+  ++statistics.triangles;
+  if constexpr(bDepthBounds) {
+    if(mbDepthBounds && triangle.zMin >= tile.depthMax) {
+      ++statistics.trianglesRejected;
+      return;
+    }
+  }
+
+  const auto x0 = std::max(triangle.minX, tile.x0);
+  const auto y0 = std::max(triangle.minY, tile.y0);
+  const auto x1 = std::min(triangle.maxX, tile.x1);
+  const auto y1 = std::min(triangle.maxY, tile.y1);
+  // Steps per pixel and from the pixel center to every sample, exact in a float with the guard band.
+  std::array<float, 3> a;
+  std::array<float, 3> b;
+  std::array<std::array<float, gSamples>, 3> sampleEdges;
+  for(std::size_t i = 0; i < 3; ++i) {
+    a[i] = static_cast<float>(triangle.edgeA[i] * gSubpixels);
+    b[i] = static_cast<float>(triangle.edgeB[i] * gSubpixels);
+    for(std::size_t sample = 0; sample < gSamples; ++sample) {
+      sampleEdges[i][sample] =
+        static_cast<float>(triangle.edgeA[i] * gSampleOffsets[sample][0] + triangle.edgeB[i] * gSampleOffsets[sample][1]);
+    }
+  }
+  const auto &zPlane = triangle.zPlane;
+  std::array<float, gSamples> sampleDepths;
+  for(std::size_t sample = 0; sample < gSamples; ++sample) {
+    const auto sx = static_cast<float>(gSampleOffsets[sample][0]);
+    const auto sy = static_cast<float>(gSampleOffsets[sample][1]);
+    sampleDepths[sample] = (zPlane.dx * sx + zPlane.dy * sy) / static_cast<float>(gSubpixels);
+  }
+  const auto ramp8 = ramp();
+  const std::array<Float8, 3> edgeSteps = {ramp8 * a[0], ramp8 * a[1], ramp8 * a[2]};
+  // Offsets from the pixel center at the block origin to the smallest / largest edge value and depth of any sample
+  // inside the block.
+  constexpr auto span = static_cast<float>(gBlockSize - 1);
+  constexpr auto reach = static_cast<float>(gSampleReach);
+  std::array<float, 3> edgeMin;
+  std::array<float, 3> edgeMax;
+  for(std::size_t i = 0; i < 3; ++i) {
+    const auto sampleReach = reach * static_cast<float>(std::abs(triangle.edgeA[i]) + std::abs(triangle.edgeB[i]));
+    edgeMin[i] = span * (std::min(a[i], 0.F) + std::min(b[i], 0.F)) - sampleReach;
+    edgeMax[i] = span * (std::max(a[i], 0.F) + std::max(b[i], 0.F)) + sampleReach;
+  }
+  const auto zReach = reach / static_cast<float>(gSubpixels) * (std::abs(zPlane.dx) + std::abs(zPlane.dy));
+  const auto zMinOffset = span * (std::min(zPlane.dx, 0.F) + std::min(zPlane.dy, 0.F)) - zReach;
+  const auto zMaxOffset = span * (std::max(zPlane.dx, 0.F) + std::max(zPlane.dy, 0.F)) + zReach;
+  const auto zStep = ramp8 * zPlane.dx;
+  const auto invWStep = ramp8 * triangle.invWPlane.dx;
+  const auto *pUniforms = state.uniforms.data();
+
+  alignas(32) std::array<float, gMaxVaryings * gLanes> varyings{};
+  alignas(32) std::array<float, 4 * gLanes> colors{};
+  alignas(32) std::array<std::uint32_t, gLanes> packed{};
+  std::array<float, gMaxVaryings> fragmentVaryings{};
+  auto bTileWritten = false;
+
+  for(auto by = y0 & ~(gBlockSize - 1); by < y1; by += gBlockSize) {
+    for(auto bx = x0 & ~(gBlockSize - 1); bx < x1; bx += gBlockSize) {
+      const auto px = static_cast<float>(bx) + 0.5F;
+      const auto py = static_cast<float>(by) + 0.5F;
+      const std::array<float, 3> corner = {static_cast<float>(edge(triangle, 0, bx, by)),
+                                           static_cast<float>(edge(triangle, 1, bx, by)),
+                                           static_cast<float>(edge(triangle, 2, bx, by))};
+      if(corner[0] + edgeMax[0] < 0 || corner[1] + edgeMax[1] < 0 || corner[2] + edgeMax[2] < 0) {
+        continue;
+      }
+      ++statistics.blocks;
+      const auto dx = px - triangle.originX;
+
+      auto bVisible = false;
+      if constexpr(bDepthBounds) {
+        if(mbDepthBounds) {
+          const auto z = zPlane.origin + zPlane.dx * dx + zPlane.dy * (py - triangle.originY);
+          const auto bounds = block(bx, by);
+          if(std::max(z + zMinOffset, triangle.zMin) >= mDepthMax[bounds]) {
+            ++statistics.blocksRejected;
+            continue;
+          }
+          bVisible = std::min(z + zMaxOffset, triangle.zMax) < mDepthMin[bounds];
+        }
+      }
+
+      const auto bInsideClip = bx >= x0 && by >= y0 && bx + gBlockSize <= x1 && by + gBlockSize <= y1;
+      const auto bFull = bInsideClip && corner[0] + edgeMin[0] >= 0 && corner[1] + edgeMin[1] >= 0 && corner[2] + edgeMin[2] >= 0;
+
+      auto columns = allTrue();
+      if(!bInsideClip) {
+        const auto laneX = ramp8 + static_cast<float>(bx);
+        columns = (laneX >= set1(static_cast<float>(x0))) & (laneX < set1(static_cast<float>(x1)));
+      }
+
+      auto bBlockWritten = false;
+      const auto rowBegin = std::max(by, y0);
+      const auto rowEnd = std::min(by + gBlockSize, y1);
+      for(auto y = rowBegin; y < rowEnd; ++y) {
+        const auto rowOffset = static_cast<float>(y - by);
+        std::array<Mask8, gSamples> samples;
+        samples.fill(columns);
+        if(!bFull) {
+          std::array<Float8, 3> edges;
+          for(std::size_t i = 0; i < 3; ++i) {
+            edges[i] = edgeSteps[i] + (corner[i] + b[i] * rowOffset);
+          }
+          for(std::size_t sample = 0; sample < gSamples; ++sample) {
+            for(std::size_t i = 0; i < 3; ++i) {
+              samples[sample] = samples[sample] & (edges[i] + sampleEdges[i][sample] >= set1(0.F));
+            }
+          }
+        }
+        const auto covered = bits(samples[0] | samples[1] | samples[2] | samples[3]);
+        if(covered == 0) {
+          continue;
+        }
+        statistics.fragments += std::bitset<gLanes>(covered).count();
+        const auto pixel = static_cast<std::size_t>(y * mFramebuffer.stride + bx);
+        const auto dy = static_cast<float>(y) + 0.5F - triangle.originY;
+        const auto plane = [dx, dy](const Plane &p) { return p.origin + p.dx * dx + p.dy * dy; };
+
+        if constexpr(DepthTest) {
+          const auto z = zStep + plane(zPlane);
+          for(std::size_t sample = 0; sample < gSamples; ++sample) {
+            auto *pDepth = mSampleDepth.data() + sampleIndex(pixel, sample);
+            const auto depth = load(pDepth);
+            const auto sampleZ = z + sampleDepths[sample];
+            if constexpr(DepthLess) {
+              if(!bVisible) {
+                samples[sample] = samples[sample] & (sampleZ < depth);
+              }
+            }
+            store(pDepth, select(samples[sample], depth, sampleZ));
+          }
+          bBlockWritten = true;
+        }
+        const auto passed = bits(samples[0] | samples[1] | samples[2] | samples[3]);
+        if(passed == 0) {
+          continue;
+        }
+        const auto shaded = std::bitset<gLanes>(passed).count();
+        statistics.fragmentsPassed += shaded;
+        statistics.fragmentsShaded += shaded;
+
+        const auto w = set1(1.F) / (invWStep + plane(triangle.invWPlane));
+        for(std::size_t k = 0; k < state.varyings; ++k) {
+          const auto &p = triangle.varyingPlanes[k];
+          store(varyings.data() + k * gLanes, (ramp8 * p.dx + plane(p)) * w);
+        }
+        if(state.fragment8 != nullptr) {
+          state.fragment8(pUniforms, varyings.data(), colors.data());
+          storeInt(packed.data(), packColors(load(colors.data()), load(colors.data() + gLanes), load(colors.data() + 2 * gLanes),
+                                             load(colors.data() + 3 * gLanes)));
+        } else {
+          for(std::size_t lane = 0; lane < gLanes; ++lane) {
+            if((passed & (1U << lane)) == 0) {
+              continue;
+            }
+            for(std::size_t k = 0; k < state.varyings; ++k) {
+              fragmentVaryings[k] = varyings[k * gLanes + lane];
+            }
+            packed[lane] = packColor(state.fragment(pUniforms, fragmentVaryings.data()));
+          }
+        }
+
+        // Fast path for the pixels with all their samples passing, the others write sample by sample.
+        std::array<std::uint32_t, gSamples> sampleBits;
+        for(std::size_t sample = 0; sample < gSamples; ++sample) {
+          sampleBits[sample] = bits(samples[sample]);
+        }
+        const auto full = sampleBits[0] & sampleBits[1] & sampleBits[2] & sampleBits[3];
+        auto *pColor = mFramebuffer.color.data() + pixel;
+        storeInt(pColor, select(fromBits(full), loadInt(pColor), loadInt(packed.data())));
+        const auto bSlots = tile.freeSlots.size() != tile.slotPixels.size();
+        for(std::size_t lane = 0; lane < gLanes; ++lane) {
+          const auto bit = 1U << lane;
+          if((full & bit) != 0) {
+            if(bSlots) {
+              compress(tile, pixel + lane);
+            }
+          } else if((passed & bit) != 0) {
+            std::uint32_t laneSamples = 0;
+            for(std::size_t sample = 0; sample < gSamples; ++sample) {
+              laneSamples |= ((sampleBits[sample] >> lane) & 1U) << sample;
+            }
+            writeSamples(tile, pixel + lane, laneSamples, packed[lane]);
+          }
+        }
+      }
+      if(mbDepthBounds && bBlockWritten) {
+        updateDepthBounds(bx, by);
+        bTileWritten = true;
+      }
+    }
+  }
+  if(bTileWritten) {
+    updateDepthBounds(tile);
+  }
+}
+
+// Writes `color` to the samples of `pixel` in the mask `samples`. A pixel left with one color for all its samples is
+// compressed, the others keep them in a slot of the tile.
+void Rasterizer::writeSamples(Tile &tile, std::size_t pixel, std::uint32_t samples, std::uint32_t color) {
+  auto &slot = mSlots[pixel];
+  if(samples == gAllSamples) {
+    compress(tile, pixel);
+    mFramebuffer.color[pixel] = color;
+    return;
+  }
+  if(slot == gCompressed) {
+    const auto previous = mFramebuffer.color[pixel];
+    if(previous == color) {
+      return;
+    }
+    if(tile.freeSlots.empty()) {
+      slot = static_cast<std::uint32_t>(tile.slotPixels.size());
+      tile.slotPixels.push_back(gNoPixel);
+      tile.samples.resize(sampleIndex(slot + simd::gLanes - 1, gSamples - 1) + 1);
+    } else {
+      slot = tile.freeSlots.back();
+      tile.freeSlots.pop_back();
+    }
+    tile.slotPixels[slot] = static_cast<std::uint32_t>(pixel);
+    for(std::size_t sample = 0; sample < gSamples; ++sample) {
+      tile.samples[sampleIndex(slot, sample)] = previous;
+    }
+  }
+  auto bSame = true;
+  for(std::size_t sample = 0; sample < gSamples; ++sample) {
+    auto &value = tile.samples[sampleIndex(slot, sample)];
+    if((samples & (1U << sample)) != 0) {
+      value = color;
+    }
+    bSame = bSame && value == color;
+  }
+  if(bSame) {
+    compress(tile, pixel);
+    mFramebuffer.color[pixel] = color;
+  }
+}
+
+// Frees the slot of `pixel`, its color in the framebuffer stands for all its samples.
+void Rasterizer::compress(Tile &tile, std::size_t pixel) {
+  auto &slot = mSlots[pixel];
+  if(slot == gCompressed) {
+    return;
+  }
+  tile.slotPixels[slot] = gNoPixel;
+  tile.freeSlots.push_back(slot);
+  slot = gCompressed;
+}
+
+// Averages the samples of the tile's slots into the framebuffer, 8 slots at a time. Compressed pixels already hold
+// their color.
+void Rasterizer::resolve(const Tile &tile, RasterStatistics &statistics) {
+  using namespace simd;
+  alignas(32) std::array<std::uint32_t, gLanes> colors;
+  for(std::size_t first = 0; first < tile.slotPixels.size(); first += gLanes) {
+    const auto *pSamples = tile.samples.data() + sampleIndex(first, 0);
+    storeInt(colors.data(), averageColors(loadInt(pSamples), loadInt(pSamples + gLanes), loadInt(pSamples + 2 * gLanes),
+                                          loadInt(pSamples + 3 * gLanes)));
+    const auto count = std::min(gLanes, tile.slotPixels.size() - first);
+    for(std::size_t lane = 0; lane < count; ++lane) {
+      const auto pixel = tile.slotPixels[first + lane];
+      if(pixel != gNoPixel) {
+        mFramebuffer.color[pixel] = colors[lane];
+        ++statistics.pixelsResolved;
+      }
+    }
+  }
+}
+
+} // namespace mimic
@@ -0,0 +1,188 @@
+#pragma once
+// STL
+#include <array>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+// mimicOpenGL
+#include <mimicOpenGL/gl.hpp>
+#include <mimicOpenGL/threadPool.hpp>
+
+namespace mimic {
+
+constexpr GLsizei gTileSize = 64;
+
+// Rows are stored bottom-up, the GL window convention, `stride` pixels apart. The stride rounds the width up
+// to whole 8 pixel blocks so the SIMD path can load and store full rows of a block.
+struct Framebuffer {
+  GLsizei width = 0;
+  GLsizei height = 0;
+  GLsizei stride = 0;
+  std::vector<std::uint32_t> color;
+  std::vector<float> depth;
+};
+
+struct Viewport {
+  GLint x = 0;
+  GLint y = 0;
+  GLsizei width = 0;
+  GLsizei height = 0;
+};
+
+// What the fragment stage needs of a draw call, captured when the draw is submitted.
+struct DrawState {
+  FragmentShader fragment = nullptr;
+  FragmentShader8 fragment8 = nullptr;
+  std::vector<std::byte> uniforms;
+  std::size_t varyings = 0;
+  bool bDepthTest = false;
+  GLenum depthFunc = GL_LESS;
+};
+
+// value(x, y) = value at the origin + dx * (x - originX) + dy * (y - originY)
+struct Plane {
+  float origin;
+  float dx;
+  float dy;
+};
+
+// A triangle after setup, in window coordinates. Edge i is positive inside and weights vertex i.
+// The edges are exact integers on the sub-pixel grid the vertices snapped to: a * x + b * y + c at (x, y) in sub-pixels,
+// biased by the fill rule. The scalar path interpolates with barycentrics, the SIMD path with the planes.
+struct Triangle {
+  std::array<std::int32_t, 3> edgeA;
+  std::array<std::int32_t, 3> edgeB;
+  std::array<std::int64_t, 3> edgeC;
+  std::array<float, 3> z;
+  std::array<float, 3> invW;
+  std::array<std::array<float, gMaxVaryings>, 3> varyings; // divided by w for perspective correct interpolation
+  float invArea;
+  float zMin;
+  float zMax;
+  float originX; // vertex 0
+  float originY;
+  Plane zPlane;
+  Plane invWPlane;
+  std::array<Plane, gMaxVaryings> varyingPlanes;
+  GLint minX;
+  GLint minY;
+  GLint maxX; // exclusive
+  GLint maxY; // exclusive
+  std::uint32_t draw;
+};
+
+// Sort-middle tiled rasterizer: submitted triangles are set up and binned into screen tiles in parallel, flush()
+// rasterizes the tiles in parallel, each tile walking its bin in submission order.
+// Every worker appends to its own bin of each tile without any locking, triangles are indexed by their position in
+// the submission, and a tile merges the sorted runs of its bins before rasterizing. Work stealing hands a worker
+// chunks out of order, so a bin is made of several runs.
+class Rasterizer final {
+public:
+  Rasterizer(ThreadPool &pool, Framebuffer &framebuffer);
+
+  // Call after the framebuffer changed size, drops pending work.
+  void resize();
+
+  // `vertices` is a triangle list straight out of the vertex stage.
+  void submit(DrawState state, const std::vector<VertexOutput> &vertices, const Viewport &viewport);
+  // `indices` is a triangle list of indices into `vertices`.
+  void submit(DrawState state, const std::vector<VertexOutput> &vertices, const std::vector<std::uint32_t> &indices, const Viewport &viewport);
+
+  void clear(GLbitfield mask, std::uint32_t color, float depth);
+
+  void flush();
+
+  void setMode(RasterMode mode);
+  // Both only apply to RasterMode::SIMD, see gl.hpp.
+  void setHierarchicalDepth(bool bEnabled);
+  void setFrontToBack(bool bEnabled) { mbFrontToBack = bEnabled; }
+  void setVisibilityBuffer(bool bEnabled);
+  void setMultisample(bool bEnabled);
+
+  [[nodiscard]] auto statistics() const -> RasterStatistics;
+  void resetStatistics();
+
+  [[nodiscard]] auto pending() const -> bool { return !mTriangles.empty(); }
+
+private:
+  struct Tile {
+    GLint x0;
+    GLint y0;
+    GLint x1;
+    GLint y1;
+    std::vector<std::uint32_t> triangles; // merged from the worker bins by flush()
+    float depthMax; // farthest depth in the tile, while mbDepthBounds
+    bool bDeferred; // has pixels in the visibility buffer left to shade
+    // While mbMultisample: the sample colors of the tile's pixels that are not compressed, by slot in groups of 8
+    // like the depth samples, the pixel of every slot or gNoPixel, and the slots free for reuse.
+    std::vector<std::uint32_t> samples;
+    std::vector<std::uint32_t> slotPixels;
+    std::vector<std::uint32_t> freeSlots;
+  };
+
+  template<typename Assemble>
+  void submit(DrawState state, std::size_t triangles, const Viewport &viewport, const Assemble &assemble);
+  auto setup(const VertexOutput &v0, const VertexOutput &v1, const VertexOutput &v2, const Viewport &viewport, std::uint32_t draw,
+             Triangle &triangle) const -> bool;
+  void bin(std::uint32_t triangle, std::size_t worker);
+  void merge(std::size_t tile);
+  void rasterize(Tile &tile, RasterStatistics &statistics);
+  void sortFrontToBack(Tile &tile);
+
+  template<bool DepthTest, bool DepthLess>
+  void rasterize(const Tile &tile, std::uint32_t index, RasterStatistics &statistics);
+  template<bool DepthTest, bool DepthLess>
+  void rasterizeBlocks(Tile &tile, std::uint32_t index, RasterStatistics &statistics);
+  void shade(Tile &tile, RasterStatistics &statistics);
+  template<bool DepthTest, bool DepthLess>
+  void rasterizeSamples(Tile &tile, std::uint32_t index, RasterStatistics &statistics);
+  template<bool DepthTest, bool DepthLess>
+  void rasterizeSampleBlocks(Tile &tile, std::uint32_t index, RasterStatistics &statistics);
+  void writeSamples(Tile &tile, std::size_t pixel, std::uint32_t samples, std::uint32_t color);
+  void compress(Tile &tile, std::size_t pixel);
+  void resolve(const Tile &tile, RasterStatistics &statistics);
+
+  // Depth bounds of the 8x8 blocks and the tiles, recomputed from the depth buffer.
+  [[nodiscard]] auto block(GLint x, GLint y) const -> std::size_t;
+  void updateDepthBounds(GLint x, GLint y);
+  void updateDepthBounds(Tile &tile);
+  void refreshDepthBounds();
+
+  ThreadPool &mPool;
+  Framebuffer &mFramebuffer;
+  GLsizei mTilesX = 0;
+  GLsizei mTilesY = 0;
+  std::vector<Tile> mTiles;
+  std::vector<std::vector<std::uint32_t>> mBins; // [worker * tiles + tile], runs of triangles in submission order
+  // Indexed by position in the submission, culled triangles leave their slot unused.
+  std::vector<Triangle> mTriangles;
+  std::vector<DrawState> mDraws;
+  RasterMode mMode = RasterMode::SIMD;
+  bool mbHierarchicalDepth = true;
+  bool mbFrontToBack = true;
+  // The depth bounds are maintained by the SIMD path with the hierarchical depth test enabled and
+  // recomputed whenever that starts.
+  bool mbDepthBounds = true;
+  GLsizei mBlocksX = 0;
+  std::vector<float> mDepthMin;
+  std::vector<float> mDepthMax;
+  // While mbVisibilityBuffer: the triangle and its barycentrics l1 and l2 of the last fragment written to every
+  // pixel since the last flush, gNoTriangle where none was. shade() turns them into colors and resets them.
+  bool mbVisibilityBuffer = false;
+  std::vector<std::uint32_t> mVisibility;
+  std::array<std::vector<float>, 2> mBarycentrics;
+  // While mbMultisample: the depth of the 4 samples of every pixel, sample by sample for groups of 8 pixels, and the
+  // slot of every pixel in the samples of its tile, or gCompressed when its samples share the color in the framebuffer.
+  // Fully covered pixels stay compressed, only pixels on edges take a slot. flush() resolves the slots.
+  bool mbMultisample = false;
+  std::vector<float> mSampleDepth;
+  std::vector<std::uint32_t> mSlots;
+  std::vector<RasterStatistics> mStatistics; // per worker
+  // Clip codes of the triangles of the draw being submitted and the triangle count of every setup chunk.
+  std::vector<std::uint32_t> mClipCodes;
+  std::vector<std::size_t> mChunkTriangles;
+};
+
+auto packColor(Vec4 color) -> std::uint32_t;
+
+} // namespace mimic
@@ -0,0 +1,207 @@
+#include <mimicOpenGL/sample.hpp>
+// STL
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <algorithm>
+#include <string_view>
+// SDL2
+#include <SDL2/SDL.h>
+// assimp
+#include <assimp/scene.h>
+#include <assimp/Importer.hpp>
+#include <assimp/postprocess.h>
+// mimicOpenGL
+#include <mimicOpenGL/samples.hpp>
+
+namespace mimic {
+
+constexpr auto SDL_SUCCESS = 0;
+
+SampleTarget::SampleTarget(const char *pTitle, const SampleOptions &options)
+  : mWidth(options.width), mHeight(options.height),
+    mPixels(static_cast<std::size_t>(options.width) * static_cast<std::size_t>(options.height)) {
+  if(options.backend == Backend::WINDOW) {
+    if(SDL_Init(SDL_INIT_VIDEO) != SDL_SUCCESS) {
+      std::cerr << "Can not initialize \"" << SDL_GetError() << "\"\n";
+      return;
+    }
+    mpWindow = SDL_CreateWindow(pTitle, SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, mWidth, mHeight, 0);
+    if(mpWindow == nullptr) {
+      std::cerr << "Can not create window \"" << SDL_GetError() << "\"\n";
+      return;
+    }
+  } else {
+    mFrames = headlessFrames();
+    mOutput.emplace(mWidth, mHeight);
+    std::cout << "Rendering " << mFrames << " frames of " << mWidth << "x" << mHeight << " in software\n";
+  }
+
+  mpContext = createContext(mWidth, mHeight);
+  if(mpContext == nullptr) {
+    std::cerr << "Can not create a " << mWidth << "x" << mHeight << " context\n";
+    return;
+  }
+  makeCurrent(mpContext);
+}
+
+SampleTarget::~SampleTarget() {
+  destroyContext(mpContext);
+  if(mpWindow != nullptr) {
+    SDL_DestroyWindow(mpWindow);
+    SDL_Quit();
+  }
+}
+
+auto SampleTarget::poll() -> bool {
+  if(mpWindow == nullptr) {
+    return mPresented < mFrames;
+  }
+  auto bRunning = true;
+  SDL_Event event;
+  while(SDL_PollEvent(&event) != 0) {
+    if(event.type == SDL_QUIT) {
+      bRunning = false;
+    }
+  }
+  return bRunning;
+}
+
+// Copies the bottom-up color buffer into memory, and from there into the window surface.
+void SampleTarget::present() {
+  const auto *pPixels = colorBuffer();
+  const auto stride = colorStride();
+  const auto width = static_cast<std::size_t>(mWidth);
+  for(auto y = 0; y < mHeight; ++y) {
+    std::memcpy(mPixels.data() + static_cast<std::size_t>(y) * width, pPixels + (mHeight - 1 - y) * stride,
+                width * sizeof(std::uint32_t));
+  }
+  ++mPresented;
+  if(mpWindow == nullptr) {
+    mOutput->push(mPixels.data(), width, false);
+    return;
+  }
+  auto *pFrame = SDL_CreateRGBSurfaceWithFormatFrom(mPixels.data(), mWidth, mHeight, 32, mWidth * 4, SDL_PIXELFORMAT_ABGR8888);
+  SDL_BlitSurface(pFrame, nullptr, SDL_GetWindowSurface(mpWindow), nullptr);
+  SDL_FreeSurface(pFrame);
+  SDL_UpdateWindowSurface(mpWindow);
+}
+
+void SampleModel::draw() const {
+  glBindVertexArray(vao);
+  { glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, nullptr); }
+  glBindVertexArray(0);
+}
+
+void SampleScene::initialize() {
+  for(auto &model : mModels) {
+    model.count = static_cast<GLsizei>(model.mIndices.size());
+    glGenVertexArrays(1, &model.vao);
+    glBindVertexArray(model.vao);
+    {
+      glGenBuffers(2, model.vbo.data());
+      {
+        constexpr auto VERTEX_ATTRIBUTE = 0U;
+        glBindBuffer(GL_ARRAY_BUFFER, model.vbo[VERTEX_ATTRIBUTE]);
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(model.mVertices.size() * sizeof(float)), model.mVertices.data(), GL_STATIC_DRAW);
+        glVertexAttribPointer(VERTEX_ATTRIBUTE, 3, GL_FLOAT, false, 0, nullptr);
+        glEnableVertexAttribArray(VERTEX_ATTRIBUTE);
+      }
+
+      {
+        constexpr auto NORMAL_ATTRIBUTE = 1U;
+        glBindBuffer(GL_ARRAY_BUFFER, model.vbo[NORMAL_ATTRIBUTE]);
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(model.mNormals.size() * sizeof(float)), model.mNormals.data(), GL_STATIC_DRAW);
+        glVertexAttribPointer(NORMAL_ATTRIBUTE, 3, GL_FLOAT, false, 0, nullptr);
+        glEnableVertexAttribArray(NORMAL_ATTRIBUTE);
+      }
+
+      glGenBuffers(1, &model.ebo);
+      glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, model.ebo);
+      glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(model.mIndices.size() * sizeof(std::uint32_t)), model.mIndices.data(), GL_STATIC_DRAW);
+    }
+    glBindVertexArray(0);
+  }
+}
+
+void SampleScene::draw() const {
+  for(const auto &model : mModels) {
+    model.draw();
+  }
+}
+
+static auto LoadMesh(const aiMesh *pMesh) -> SampleModel {
+  SampleModel model;
+  model.mVertices.reserve(pMesh->mNumVertices * 3);
+  model.mNormals.reserve(pMesh->mNumVertices * 3);
+  for(auto i = 0U; i < pMesh->mNumVertices; i++) {
+    const auto &position = pMesh->mVertices[i];
+    const auto &normal = pMesh->mNormals[i];
+    model.mVertices.insert(model.mVertices.end(), {position.x, position.y, position.z});
+    model.mNormals.insert(model.mNormals.end(), {normal.x, normal.y, normal.z});
+  }
+  model.mIndices.reserve(pMesh->mNumFaces * 3);
+  for(auto i = 0U; i < pMesh->mNumFaces; i++) {
+    const auto &face = pMesh->mFaces[i];
+    model.mIndices.insert(model.mIndices.end(), face.mIndices, face.mIndices + face.mNumIndices);
+  }
+  return model;
+}
+
+auto loadSampleScene(const std::string &fileName) -> SampleScene {
+  Assimp::Importer importer;
+  const auto pScene = importer.ReadFile(fileName, aiProcess_Triangulate | aiProcess_JoinIdenticalVertices);
+  if(pScene == nullptr) {
+    std::cerr << "Can not load \"" << fileName << "\"!\n";
+    std::exit(EXIT_FAILURE);
+  }
+  SampleScene scene;
+  for(auto i = 0U; i < pScene->mNumMeshes; ++i) {
+    scene.mModels.push_back(LoadMesh(pScene->mMeshes[i]));
+  }
+  return scene;
+}
+
+struct Port {
+  std::string_view name;
+  int (*pMain)(const SampleOptions &options);
+};
+
+// drawRedPointShader has no port, the software renderer only rasterizes triangles.
+// drawCubeWithPerspectiveUBO fills its UBO but its vertex shader never reads it, the cube is drawn like drawCube.
+static const std::array gPorts = {
+  Port{"loadObj", loadObjSample},
+  Port{"ambientPerFragment", ambientPerFragmentSample},
+  Port{"diffuse", diffuseSample},
+  Port{"diffusePerFragment", diffusePerFragmentSample},
+  Port{"diffusePerFragmentUBO", diffusePerFragmentSample},
+  Port{"specular", specularSample},
+  Port{"drawRedTriangleShader", redTriangleSample},
+  Port{"controlTriangleColorWithMousePosition", redTriangleSample},
+  Port{"drawTriangleUsingAttributes", redTriangleSample},
+  Port{"drawTriangleUsingAttributesDSA", redTriangleSample},
+  Port{"drawTrianglePositionAndColorUsingAttributes", colorTriangleSample},
+  Port{"drawTrianglePositionAndColorUsingAttributesDSA", colorTriangleSample},
+  Port{"drawTrianglePositionAndColorUsingAttributesDSAOneVBO", colorTriangleSample},
+  Port{"drawCube", cubeSample},
+  Port{"drawCubeWithPerspective", perspectiveCubeSample},
+  Port{"drawCubeWithPerspectiveUBO", cubeSample},
+};
+
+auto runSample(std::string_view name, Backend backend, int argc, char *argv[]) -> int {
+  const auto port = std::find_if(gPorts.cbegin(), gPorts.cend(), [name](const Port &current) { return current.name == name; });
+  if(port == gPorts.cend()) {
+    std::cerr << "\"" << name << "\" has no software port\n";
+    return EXIT_FAILURE;
+  }
+  SampleOptions options;
+  options.backend = backend;
+  if(argc == 3) {
+    options.width = std::stoi(argv[1]);
+    options.height = std::stoi(argv[2]);
+  }
+  return port->pMain(options);
+}
+
+} // namespace mimic
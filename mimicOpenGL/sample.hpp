@@ -0,0 +1,88 @@
+#pragma once
+// STL
+#include <array>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <optional>
+// common
+#include <common/backend.hpp>
+#include <common/frameOutput.hpp>
+// mimicOpenGL
+#include <mimicOpenGL/gl.hpp>
+
+struct SDL_Window;
+
+// What the software ports of the GL demos share, see samples.hpp for how they are started.
+namespace mimic {
+
+struct SampleOptions {
+  Backend backend = Backend::WINDOW;
+  GLsizei width = 640;
+  GLsizei height = 480;
+};
+
+// Creates the software context and presents its color buffer: into an SDL window with the window backend, otherwise
+// into memory only, stopping after headlessFrames() frames, and handing every frame to FRAME_OUTPUT when it is set.
+class SampleTarget final {
+public:
+  SampleTarget(const char *pTitle, const SampleOptions &options);
+  ~SampleTarget();
+
+  SampleTarget(const SampleTarget &) = delete;
+  SampleTarget &operator=(const SampleTarget &) = delete;
+
+  [[nodiscard]] auto valid() const -> bool { return mpContext != nullptr; }
+
+  // Handles the window events, false once the demo should stop.
+  auto poll() -> bool;
+
+  void present();
+
+  // The last presented frame, top-down RGBA8.
+  [[nodiscard]] auto pixels() const -> const std::vector<std::uint32_t> & { return mPixels; }
+
+private:
+  GLsizei mWidth;
+  GLsizei mHeight;
+  SDL_Window *mpWindow = nullptr;
+  Context *mpContext = nullptr;
+  std::size_t mFrames = 0;
+  std::size_t mPresented = 0;
+  std::vector<std::uint32_t> mPixels;
+  std::optional<FrameOutput> mOutput;
+};
+
+// A mesh of sphere.obj with normals, indexed so the software renderer shades every shared vertex once.
+struct SampleModel {
+  GLuint vao = 0;
+  std::array<GLuint, 2> vbo = {};
+  GLuint ebo = 0;
+  GLsizei count = 0;
+  std::vector<float> mVertices;
+  std::vector<float> mNormals;
+  std::vector<std::uint32_t> mIndices;
+
+  void draw() const;
+};
+
+struct SampleScene {
+  std::vector<SampleModel> mModels;
+
+  void initialize();
+  void draw() const;
+};
+
+auto loadSampleScene(const std::string &fileName) -> SampleScene;
+
+auto loadObjSample(const SampleOptions &options) -> int;
+auto ambientPerFragmentSample(const SampleOptions &options) -> int;
+auto diffuseSample(const SampleOptions &options) -> int;
+auto diffusePerFragmentSample(const SampleOptions &options) -> int;
+auto specularSample(const SampleOptions &options) -> int;
+auto redTriangleSample(const SampleOptions &options) -> int;
+auto colorTriangleSample(const SampleOptions &options) -> int;
+auto cubeSample(const SampleOptions &options) -> int;
+auto perspectiveCubeSample(const SampleOptions &options) -> int;
+
+} // namespace mimic
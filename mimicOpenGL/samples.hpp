@@ -0,0 +1,24 @@
+#pragma once
+// STL
+#include <cstdlib>
+#include <iostream>
+#include <string_view>
+// common
+#include <common/backend.hpp>
+
+namespace mimic {
+
+// Runs the software port of the GL demo `name` ("specular", "drawCube", ...), how the GL demos implement
+// DEMO_BACKEND=software. The window backend presents into an SDL window, the others render into memory only.
+// `argv` are the arguments of the demo, width and height like opengl/shaders. Fails for demos without a port.
+#if defined(ENABLE_SOFTWARE_BACKEND)
+auto runSample(std::string_view name, Backend backend, int argc, char *argv[]) -> int;
+#else
+// The demos are built without the software renderer, see ENABLE_SOFTWARE_BACKEND.
+inline auto runSample(std::string_view name, Backend /*backend*/, int /*argc*/, char * /*argv*/[]) -> int {
+  std::cerr << "\"" << name << "\" is built without the software backend, configure with -DENABLE_SOFTWARE_BACKEND=ON\n";
+  return EXIT_FAILURE;
+}
+#endif
+
+} // namespace mimic
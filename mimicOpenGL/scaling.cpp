@@ -0,0 +1,218 @@
+// STL
+#include <array>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <algorithm>
+// mimicOpenGL
+#include <mimicOpenGL/gl.hpp>
+#include <mimicOpenGL/simd.hpp>
+#include <mimicOpenGL/sphere.hpp>
+
+// Thread scaling of the software pipeline from one thread up to --threads (64), doubling each step, on the
+// overdraw stress scene. The geometry phase is glDrawElements (vertex shading, setup and binning), the raster
+// phase is glFinish (merging the bins and rasterizing the tiles). Efficiency is speedup / threads.
+// At every thread count a stack of overlapping triangles drawn without depth test checks that the tiles rasterize
+// in submission order, the run fails when the last triangle is not the one left in every pixel.
+// Usage: mimicscaling [--size WxH] [--frames N] [--layers N] [--threads N]
+
+using namespace mimic;
+
+using Clock = std::chrono::steady_clock;
+
+struct Uniforms {
+  Mat4 modelViewProjection;
+};
+
+static void vertexShader(const std::byte *pUniforms, const VertexInput &input, VertexOutput &output) {
+  const auto &u = *reinterpret_cast<const Uniforms *>(pUniforms);
+  const auto position = Vec4{input.attributes[0].x, input.attributes[0].y, input.attributes[0].z, 1};
+  const auto diffuse = std::max(dot(xyz(input.attributes[1]), normalize(Vec3{0.3F, 0.5F, 1})), 0.F);
+  output.varyings[0] = 0.1F + 0.9F * diffuse;
+  output.position = u.modelViewProjection * position;
+}
+
+// The draw order check passes the brightness of attribute 1 through.
+static void orderVertexShader(const std::byte *, const VertexInput &input, VertexOutput &output) {
+  output.varyings[0] = input.attributes[1].x;
+  output.position = Vec4{input.attributes[0].x, input.attributes[0].y, input.attributes[0].z, 1};
+}
+
+static auto fragmentShader(const std::byte *, const float *pVaryings) -> Vec4 { return {pVaryings[0], pVaryings[0], pVaryings[0], 1}; }
+
+static void fragmentShader8(const std::byte *, const float *pVaryings, float *pColor) {
+  std::copy(pVaryings, pVaryings + 8, pColor);
+  std::copy(pVaryings, pVaryings + 8, pColor + 8);
+  std::copy(pVaryings, pVaryings + 8, pColor + 16);
+  std::fill(pColor + 24, pColor + 32, 1.F);
+}
+
+struct Result {
+  double geometry; // milliseconds per frame
+  double raster;
+};
+
+static auto run(const Mesh &mesh, GLsizei width, GLsizei height, std::size_t threads, int frames) -> Result {
+  auto *pContext = createContext(width, height, threads);
+  makeCurrent(pContext);
+
+  ProgramDescription description;
+  description.uniforms = {{"uMatrices.ModelViewProjection", offsetof(Uniforms, modelViewProjection), sizeof(Mat4)}};
+  description.vertex = vertexShader;
+  description.fragment = fragmentShader;
+  description.fragment8 = fragmentShader8;
+  description.varyings = 1;
+  const auto program = createProgram(description);
+  glUseProgram(program);
+  const auto aspect = static_cast<float>(width) / static_cast<float>(height);
+  const auto modelViewProjection = perspective(0.8F, aspect, 0.1F, 100) * lookAt({0, 0, 6}, {0, 0, 0}, {0, 1, 0});
+  glUniformMatrix4fv(glGetUniformLocation(program, "uMatrices.ModelViewProjection"), 1, GL_FALSE, modelViewProjection.data());
+  glEnable(GL_DEPTH_TEST);
+  glDepthFunc(GL_LESS);
+
+  GLuint vao = 0;
+  std::array<GLuint, 2> buffers = {};
+  glGenVertexArrays(1, &vao);
+  glBindVertexArray(vao);
+  glGenBuffers(2, buffers.data());
+  glBindBuffer(GL_ARRAY_BUFFER, buffers[0]);
+  glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(mesh.vertices.size() * sizeof(float)), mesh.vertices.data(), GL_STATIC_DRAW);
+  glVertexAttribPointer(0, 3, GL_FLOAT, false, 6 * sizeof(float), nullptr);
+  glEnableVertexAttribArray(0);
+  glVertexAttribPointer(1, 3, GL_FLOAT, false, 6 * sizeof(float), reinterpret_cast<const GLvoid *>(3 * sizeof(float)));
+  glEnableVertexAttribArray(1);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers[1]);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(mesh.indices.size() * sizeof(std::uint32_t)), mesh.indices.data(),
+               GL_STATIC_DRAW);
+
+  const auto count = static_cast<GLsizei>(mesh.indices.size());
+  Result result{0, 0};
+  for(int frame = -1; frame < frames; ++frame) { // frame -1 warms up
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    const auto start = Clock::now();
+    glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, nullptr);
+    const auto drawn = Clock::now();
+    glFinish();
+    if(frame >= 0) {
+      result.geometry += std::chrono::duration<double, std::milli>(drawn - start).count() / frames;
+      result.raster += std::chrono::duration<double, std::milli>(Clock::now() - drawn).count() / frames;
+    }
+  }
+
+  glDeleteBuffers(2, buffers.data());
+  glDeleteVertexArrays(1, &vao);
+  glDeleteProgram(program);
+  destroyContext(pContext);
+  return result;
+}
+
+// Draws enough triangles covering the viewport for every worker to set up and bin several chunks, the last one white and
+// the others darker, and checks that every pixel is white.
+static auto drawsInOrder(std::size_t threads) -> bool {
+  constexpr GLsizei size = 128;
+  constexpr std::size_t triangles = 8192;
+  auto *pContext = createContext(size, size, threads);
+  makeCurrent(pContext);
+
+  ProgramDescription description;
+  description.vertex = orderVertexShader;
+  description.fragment = fragmentShader;
+  description.fragment8 = fragmentShader8;
+  description.varyings = 1;
+  const auto program = createProgram(description);
+  glUseProgram(program);
+  glDisable(GL_DEPTH_TEST);
+
+  constexpr std::array<std::array<float, 2>, 3> corners = {{{-1, -1}, {3, -1}, {-1, 3}}};
+  std::vector<float> vertices;
+  for(std::size_t i = 0; i < triangles; ++i) {
+    const auto brightness = i + 1 == triangles ? 1.F : 0.5F * static_cast<float>(i % 64) / 64;
+    for(const auto &[x, y] : corners) {
+      vertices.insert(vertices.end(), {x, y, 0, brightness, 0, 0});
+    }
+  }
+  GLuint vao = 0;
+  GLuint buffer = 0;
+  glGenVertexArrays(1, &vao);
+  glBindVertexArray(vao);
+  glGenBuffers(1, &buffer);
+  glBindBuffer(GL_ARRAY_BUFFER, buffer);
+  glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(vertices.size() * sizeof(float)), vertices.data(), GL_STATIC_DRAW);
+  glVertexAttribPointer(0, 3, GL_FLOAT, false, 6 * sizeof(float), nullptr);
+  glEnableVertexAttribArray(0);
+  glVertexAttribPointer(1, 3, GL_FLOAT, false, 6 * sizeof(float), reinterpret_cast<const GLvoid *>(3 * sizeof(float)));
+  glEnableVertexAttribArray(1);
+
+  bool bInOrder = true;
+  std::vector<std::uint32_t> pixels(static_cast<std::size_t>(size * size));
+  for(int frame = 0; frame < 4 && bInOrder; ++frame) {
+    glClear(GL_COLOR_BUFFER_BIT);
+    glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(3 * triangles));
+    glReadPixels(0, 0, size, size, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    bInOrder = std::all_of(pixels.cbegin(), pixels.cend(), [](std::uint32_t pixel) { return pixel == 0xFFFFFFFFU; });
+  }
+
+  glDeleteBuffers(1, &buffer);
+  glDeleteVertexArrays(1, &vao);
+  glDeleteProgram(program);
+  destroyContext(pContext);
+  return bInOrder;
+}
+
+int main(int argc, char *argv[]) {
+  GLsizei width = 1920;
+  GLsizei height = 1080;
+  int frames = 5;
+  int layers = 16;
+  std::size_t maxThreads = 64;
+  for(int i = 1; i + 1 < argc; i += 2) {
+    const std::string option = argv[i];
+    if(option == "--size") {
+      std::sscanf(argv[i + 1], "%dx%d", &width, &height);
+    } else if(option == "--frames") {
+      frames = std::max(1, std::atoi(argv[i + 1]));
+    } else if(option == "--layers") {
+      layers = std::max(1, std::atoi(argv[i + 1]));
+    } else if(option == "--threads") {
+      maxThreads = static_cast<std::size_t>(std::max(1, std::atoi(argv[i + 1])));
+    } else {
+      std::cerr << "Usage: " << argv[0] << " [--size WxH] [--frames N] [--layers N] [--threads N]\n";
+      return EXIT_FAILURE;
+    }
+  }
+  if(width <= 0 || height <= 0) {
+    std::cerr << "Can not create a " << width << "x" << height << " context\n";
+    return EXIT_FAILURE;
+  }
+
+  const auto mesh = stack(sphere(32), layers);
+  std::printf("%dx%d, %zu triangles, %u hardware threads, SIMD: %s\n", width, height, mesh.indices.size() / 3,
+              std::thread::hardware_concurrency(), simd::gInstructionSet);
+  std::printf("%-8s %12s %12s %12s %9s %11s %6s\n", "threads", "geometry ms", "raster ms", "frame ms", "speedup", "efficiency",
+              "order");
+  double single = 0;
+  bool bInOrder = true;
+  for(std::size_t threads = 1; threads <= maxThreads; threads *= 2) {
+    const auto result = run(mesh, width, height, threads, frames);
+    const auto frame = result.geometry + result.raster;
+    if(threads == 1) {
+      single = frame;
+    }
+    const auto speedup = single / frame;
+    const auto bOrdered = drawsInOrder(threads);
+    bInOrder = bInOrder && bOrdered;
+    std::printf("%-8zu %12.2f %12.2f %12.2f %8.2fx %10.1f%% %6s\n", threads, result.geometry, result.raster, frame, speedup,
+                100. * speedup / static_cast<double>(threads), bOrdered ? "ok" : "FAILED");
+  }
+  if(!bInOrder) {
+    std::cerr << "Triangles were rasterized out of submission order\n";
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
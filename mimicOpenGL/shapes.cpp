@@ -0,0 +1,173 @@
+// STL
+#include <array>
+#include <chrono>
+#include <vector>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+// common
+#include <common/benchmark.hpp>
+// mimicOpenGL
+#include <mimicOpenGL/gl.hpp>
+#include <mimicOpenGL/sample.hpp>
+
+// The triangles and cubes of opengl/shaders drawn by the software renderer, no GPU or GL driver involved.
+
+using namespace mimic;
+
+constexpr auto gTitle = "RedTriangle (software)";
+
+namespace {
+
+// clang-format off
+constexpr std::array gTriangle = {
+  -0.5F,-0.5F, 0.0F,
+   0.5F,-0.5F, 0.0F,
+   0.0F, 0.5F, 0.0F,
+};
+
+constexpr std::array gTriangleColors = {
+  1.0F, 0.0F, 0.0F,
+  0.0F, 1.0F, 0.0F,
+  0.0F, 0.0F, 1.0F,
+};
+
+// The 12 triangles of drawCube.cpp, including its degenerate 9th.
+constexpr std::array gCube = {
+  -0.5F,-0.5F, 0.5F,   0.5F,-0.5F, 0.5F,   0.5F, 0.5F, 0.5F,
+  -0.5F,-0.5F, 0.5F,   0.5F, 0.5F, 0.5F,  -0.5F, 0.5F, 0.5F,
+   0.5F,-0.5F, 0.5F,   0.5F,-0.5F,-0.5F,   0.5F, 0.5F,-0.5F,
+   0.5F,-0.5F, 0.5F,   0.5F, 0.5F,-0.5F,   0.5F, 0.5F, 0.5F,
+   0.5F,-0.5F,-0.5F,  -0.5F,-0.5F,-0.5F,  -0.5F, 0.5F,-0.5F,
+   0.5F,-0.5F,-0.5F,  -0.5F, 0.5F,-0.5F,   0.5F, 0.5F,-0.5F,
+  -0.5F,-0.5F, 0.5F,  -0.5F,-0.5F,-0.5F,  -0.5F, 0.5F,-0.5F,
+  -0.5F,-0.5F, 0.5F,  -0.5F, 0.5F,-0.5F,  -0.5F, 0.5F, 0.5F,
+  -0.5F, 0.5F, 0.5F,  -0.5F, 0.5F, 0.5F,   0.5F, 0.5F,-0.5F,
+  -0.5F, 0.5F, 0.5F,   0.5F, 0.5F,-0.5F,  -0.5F, 0.5F,-0.5F,
+  -0.5F,-0.5F, 0.5F,   0.5F,-0.5F,-0.5F,   0.5F,-0.5F, 0.5F,
+  -0.5F,-0.5F, 0.5F,  -0.5F,-0.5F,-0.5F,   0.5F,-0.5F,-0.5F,
+};
+// clang-format on
+
+struct Uniforms {
+  Mat4 MVP;
+};
+
+// cPerspective * cView of drawCubeWithPerspective.cpp, the identity for the other demos.
+auto perspectiveView() -> Mat4 {
+  Mat4 perspective;
+  perspective.columns = {Vec4{1.81066F, 0, 0, 0}, Vec4{0, 2.41421F, 0, 0}, Vec4{0, 0, -1.002F, -1}, Vec4{0, 0, -0.2002F, 0}};
+  Mat4 view;
+  view.columns = {Vec4{-1, 0, 0, 0}, Vec4{0, 1, 0, 0}, Vec4{0, 0, -1, 0}, Vec4{0, 0, -1, 1}};
+  return perspective * view;
+}
+
+void vertexShader(const std::byte *pUniforms, const VertexInput &input, VertexOutput &output) {
+  const auto &u = *reinterpret_cast<const Uniforms *>(pUniforms);
+  output.varyings[0] = input.attributes[1].x;
+  output.varyings[1] = input.attributes[1].y;
+  output.varyings[2] = input.attributes[1].z;
+  output.position = u.MVP * input.attributes[0];
+}
+
+auto fragmentShader(const std::byte *, const float *pVaryings) -> Vec4 { return {pVaryings[0], pVaryings[1], pVaryings[2], 1}; }
+
+void fragmentShader8(const std::byte *, const float *pVaryings, float *pColor) {
+  std::copy(pVaryings, pVaryings + 3 * 8, pColor);
+  std::fill(pColor + 3 * 8, pColor + 4 * 8, 1.F);
+}
+
+auto colorProgram() -> ProgramDescription {
+  ProgramDescription description;
+  description.uniforms = {{"uMVP", offsetof(Uniforms, MVP), sizeof(Mat4)}};
+  description.vertex = vertexShader;
+  description.fragment = fragmentShader;
+  description.fragment8 = fragmentShader8;
+  description.varyings = 3;
+  return description;
+}
+
+// Draws `positions` with per-vertex `colors`, or in red without, like the frame loop of the GL demos.
+auto draw(const SampleOptions &options, const char *pName, const float *pPositions, const float *pColors, GLsizei count, const Mat4 &MVP)
+  -> int {
+  SampleTarget target(gTitle, options);
+  if(!target.valid()) {
+    return EXIT_FAILURE;
+  }
+  BenchmarkRecorder benchmark(pName);
+
+  benchmark.beginLoad();
+  const GLuint program = createProgram(colorProgram());
+
+  GLuint vao = 0;
+  glGenVertexArrays(1, &vao);
+  glBindVertexArray(vao);
+
+  constexpr auto positionAttribute = 0U;
+  constexpr auto colorAttribute    = 1U;
+  std::array<GLuint, 2> vbos = {};
+  glGenBuffers(2, vbos.data());
+  glBindBuffer(GL_ARRAY_BUFFER, vbos[positionAttribute]);
+  glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(static_cast<std::size_t>(count) * 3 * sizeof(float)), pPositions, GL_STATIC_DRAW);
+  glVertexAttribPointer(positionAttribute, 3, GL_FLOAT, false, 0, nullptr);
+  glEnableVertexAttribArray(positionAttribute);
+  std::vector<float> red;
+  if(pColors == nullptr) {
+    for(GLsizei i = 0; i < count; ++i) {
+      red.insert(red.end(), {1, 0, 0});
+    }
+    pColors = red.data();
+  }
+  glBindBuffer(GL_ARRAY_BUFFER, vbos[colorAttribute]);
+  glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(static_cast<std::size_t>(count) * 3 * sizeof(float)), pColors, GL_STATIC_DRAW);
+  glVertexAttribPointer(colorAttribute, 3, GL_FLOAT, false, 0, nullptr);
+  glEnableVertexAttribArray(colorAttribute);
+  benchmark.endLoad();
+
+  while(target.poll()) {
+    benchmark.beginFrame();
+    const auto start = std::chrono::steady_clock::now();
+
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    glUseProgram(program);
+    {
+      glUniformMatrix4fv(0, 1, GL_FALSE, MVP.data());
+      glDrawArrays(GL_TRIANGLES, 0, count);
+    }
+    glUseProgram(0);
+
+    target.present();
+
+    const auto cpuTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    printf("\rCPU: FPS: %.3F, Time: %.3F", 1000. / cpuTime, cpuTime);
+    benchmark.endFrame();
+    if(benchmark.finished()) {
+      break;
+    }
+  }
+
+  glDeleteBuffers(2, vbos.data());
+  glDeleteVertexArrays(1, &vao);
+  glDeleteProgram(program);
+  return EXIT_SUCCESS;
+}
+
+} // namespace
+
+auto mimic::redTriangleSample(const SampleOptions &options) -> int {
+  return draw(options, "mimicRedTriangle", gTriangle.data(), nullptr, static_cast<GLsizei>(gTriangle.size() / 3), Mat4{});
+}
+
+auto mimic::colorTriangleSample(const SampleOptions &options) -> int {
+  return draw(options, "mimicColorTriangle", gTriangle.data(), gTriangleColors.data(), static_cast<GLsizei>(gTriangle.size() / 3), Mat4{});
+}
+
+auto mimic::cubeSample(const SampleOptions &options) -> int {
+  return draw(options, "mimicCube", gCube.data(), nullptr, static_cast<GLsizei>(gCube.size() / 3), Mat4{});
+}
+
+auto mimic::perspectiveCubeSample(const SampleOptions &options) -> int {
+  return draw(options, "mimicPerspectiveCube", gCube.data(), nullptr, static_cast<GLsizei>(gCube.size() / 3), perspectiveView());
+}
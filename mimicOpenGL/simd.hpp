@@ -0,0 +1,355 @@
+#pragma once
+// STL
+#include <array>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+// Intrinsics
+#if defined(__AVX2__)
+#  include <immintrin.h>
+#elif defined(__SSE4_1__)
+#  include <smmintrin.h>
+#endif
+
+// Eight float lanes for the rasterizer and the shaders. AVX2 uses one 256 bit register, SSE4 two 128 bit
+// halves and anything else a plain array, the instruction set is picked at compile time (MIMIC_SIMD in CMake).
+namespace mimic::simd {
+
+#if defined(__AVX2__)
+constexpr auto gInstructionSet = "AVX2";
+#elif defined(__SSE4_1__)
+constexpr auto gInstructionSet = "SSE4.1";
+#else
+constexpr auto gInstructionSet = "scalar";
+#endif
+
+constexpr std::size_t gLanes = 8;
+
+#if defined(__AVX2__)
+
+struct Float8 {
+  __m256 v;
+};
+
+struct Int8 {
+  __m256i v;
+};
+
+// All bits set in the lanes that are true.
+struct Mask8 {
+  __m256 v;
+};
+
+inline auto set1(float value) -> Float8 { return {_mm256_set1_ps(value)}; }
+inline auto load(const float *pValues) -> Float8 { return {_mm256_loadu_ps(pValues)}; }
+inline void store(float *pValues, Float8 a) { _mm256_storeu_ps(pValues, a.v); }
+// 0, 1, ... 7
+inline auto ramp() -> Float8 { return {_mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7)}; }
+
+inline auto operator+(Float8 a, Float8 b) -> Float8 { return {_mm256_add_ps(a.v, b.v)}; }
+inline auto operator-(Float8 a, Float8 b) -> Float8 { return {_mm256_sub_ps(a.v, b.v)}; }
+inline auto operator*(Float8 a, Float8 b) -> Float8 { return {_mm256_mul_ps(a.v, b.v)}; }
+inline auto operator/(Float8 a, Float8 b) -> Float8 { return {_mm256_div_ps(a.v, b.v)}; }
+inline auto min(Float8 a, Float8 b) -> Float8 { return {_mm256_min_ps(a.v, b.v)}; }
+inline auto max(Float8 a, Float8 b) -> Float8 { return {_mm256_max_ps(a.v, b.v)}; }
+inline auto sqrt(Float8 a) -> Float8 { return {_mm256_sqrt_ps(a.v)}; }
+// a * b + c
+inline auto fma(Float8 a, Float8 b, Float8 c) -> Float8 {
+#  if defined(__FMA__)
+  return {_mm256_fmadd_ps(a.v, b.v, c.v)};
+#  else
+  return {_mm256_add_ps(_mm256_mul_ps(a.v, b.v), c.v)};
+#  endif
+}
+
+inline auto operator>=(Float8 a, Float8 b) -> Mask8 { return {_mm256_cmp_ps(a.v, b.v, _CMP_GE_OQ)}; }
+inline auto operator<(Float8 a, Float8 b) -> Mask8 { return {_mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ)}; }
+inline auto operator>(Float8 a, Float8 b) -> Mask8 { return {_mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ)}; }
+inline auto operator&(Mask8 a, Mask8 b) -> Mask8 { return {_mm256_and_ps(a.v, b.v)}; }
+inline auto operator|(Mask8 a, Mask8 b) -> Mask8 { return {_mm256_or_ps(a.v, b.v)}; }
+inline auto allTrue() -> Mask8 { return {_mm256_castsi256_ps(_mm256_set1_epi32(-1))}; }
+// Bit i set when lane i is true.
+inline auto bits(Mask8 a) -> std::uint32_t { return static_cast<std::uint32_t>(_mm256_movemask_ps(a.v)); }
+// Lanes of `b` where `mask` is true, of `a` elsewhere.
+inline auto select(Mask8 mask, Float8 a, Float8 b) -> Float8 { return {_mm256_blendv_ps(a.v, b.v, mask.v)}; }
+
+inline auto loadInt(const std::uint32_t *pValues) -> Int8 { return {_mm256_loadu_si256(reinterpret_cast<const __m256i *>(pValues))}; }
+inline void storeInt(std::uint32_t *pValues, Int8 a) { _mm256_storeu_si256(reinterpret_cast<__m256i *>(pValues), a.v); }
+inline auto toInt(Float8 a) -> Int8 { return {_mm256_cvttps_epi32(a.v)}; }
+inline auto operator|(Int8 a, Int8 b) -> Int8 { return {_mm256_or_si256(a.v, b.v)}; }
+template<int Shift>
+inline auto shiftLeft(Int8 a) -> Int8 {
+  return {_mm256_slli_epi32(a.v, Shift)};
+}
+inline auto select(Mask8 mask, Int8 a, Int8 b) -> Int8 {
+  return {_mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(a.v), _mm256_castsi256_ps(b.v), mask.v))};
+}
+inline auto floor(Float8 a) -> Float8 { return {_mm256_floor_ps(a.v)}; }
+inline auto setInt(std::uint32_t value) -> Int8 { return {_mm256_set1_epi32(static_cast<int>(value))}; }
+inline auto toFloat(Int8 a) -> Float8 { return {_mm256_cvtepi32_ps(a.v)}; }
+// Bit casts.
+inline auto asInt(Float8 a) -> Int8 { return {_mm256_castps_si256(a.v)}; }
+inline auto asFloat(Int8 a) -> Float8 { return {_mm256_castsi256_ps(a.v)}; }
+inline auto operator&(Int8 a, Int8 b) -> Int8 { return {_mm256_and_si256(a.v, b.v)}; }
+inline auto operator+(Int8 a, Int8 b) -> Int8 { return {_mm256_add_epi32(a.v, b.v)}; }
+template<int Shift>
+inline auto shiftRight(Int8 a) -> Int8 {
+  return {_mm256_srli_epi32(a.v, Shift)};
+}
+
+#elif defined(__SSE4_1__)
+
+struct Float8 {
+  __m128 lo;
+  __m128 hi;
+};
+
+struct Int8 {
+  __m128i lo;
+  __m128i hi;
+};
+
+struct Mask8 {
+  __m128 lo;
+  __m128 hi;
+};
+
+inline auto set1(float value) -> Float8 { return {_mm_set1_ps(value), _mm_set1_ps(value)}; }
+inline auto load(const float *pValues) -> Float8 { return {_mm_loadu_ps(pValues), _mm_loadu_ps(pValues + 4)}; }
+inline void store(float *pValues, Float8 a) {
+  _mm_storeu_ps(pValues, a.lo);
+  _mm_storeu_ps(pValues + 4, a.hi);
+}
+inline auto ramp() -> Float8 { return {_mm_setr_ps(0, 1, 2, 3), _mm_setr_ps(4, 5, 6, 7)}; }
+
+inline auto operator+(Float8 a, Float8 b) -> Float8 { return {_mm_add_ps(a.lo, b.lo), _mm_add_ps(a.hi, b.hi)}; }
+inline auto operator-(Float8 a, Float8 b) -> Float8 { return {_mm_sub_ps(a.lo, b.lo), _mm_sub_ps(a.hi, b.hi)}; }
+inline auto operator*(Float8 a, Float8 b) -> Float8 { return {_mm_mul_ps(a.lo, b.lo), _mm_mul_ps(a.hi, b.hi)}; }
+inline auto operator/(Float8 a, Float8 b) -> Float8 { return {_mm_div_ps(a.lo, b.lo), _mm_div_ps(a.hi, b.hi)}; }
+inline auto min(Float8 a, Float8 b) -> Float8 { return {_mm_min_ps(a.lo, b.lo), _mm_min_ps(a.hi, b.hi)}; }
+inline auto max(Float8 a, Float8 b) -> Float8 { return {_mm_max_ps(a.lo, b.lo), _mm_max_ps(a.hi, b.hi)}; }
+inline auto sqrt(Float8 a) -> Float8 { return {_mm_sqrt_ps(a.lo), _mm_sqrt_ps(a.hi)}; }
+inline auto fma(Float8 a, Float8 b, Float8 c) -> Float8 { return a * b + c; }
+
+inline auto operator>=(Float8 a, Float8 b) -> Mask8 { return {_mm_cmpge_ps(a.lo, b.lo), _mm_cmpge_ps(a.hi, b.hi)}; }
+inline auto operator<(Float8 a, Float8 b) -> Mask8 { return {_mm_cmplt_ps(a.lo, b.lo), _mm_cmplt_ps(a.hi, b.hi)}; }
+inline auto operator>(Float8 a, Float8 b) -> Mask8 { return {_mm_cmpgt_ps(a.lo, b.lo), _mm_cmpgt_ps(a.hi, b.hi)}; }
+inline auto operator&(Mask8 a, Mask8 b) -> Mask8 { return {_mm_and_ps(a.lo, b.lo), _mm_and_ps(a.hi, b.hi)}; }
+inline auto operator|(Mask8 a, Mask8 b) -> Mask8 { return {_mm_or_ps(a.lo, b.lo), _mm_or_ps(a.hi, b.hi)}; }
+inline auto allTrue() -> Mask8 {
+  const auto ones = _mm_castsi128_ps(_mm_set1_epi32(-1));
+  return {ones, ones};
+}
+inline auto bits(Mask8 a) -> std::uint32_t {
+  return static_cast<std::uint32_t>(_mm_movemask_ps(a.lo) | (_mm_movemask_ps(a.hi) << 4));
+}
+inline auto select(Mask8 mask, Float8 a, Float8 b) -> Float8 {
+  return {_mm_blendv_ps(a.lo, b.lo, mask.lo), _mm_blendv_ps(a.hi, b.hi, mask.hi)};
+}
+
+inline auto loadInt(const std::uint32_t *pValues) -> Int8 {
+  return {_mm_loadu_si128(reinterpret_cast<const __m128i *>(pValues)), _mm_loadu_si128(reinterpret_cast<const __m128i *>(pValues + 4))};
+}
+inline void storeInt(std::uint32_t *pValues, Int8 a) {
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(pValues), a.lo);
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(pValues + 4), a.hi);
+}
+inline auto toInt(Float8 a) -> Int8 { return {_mm_cvttps_epi32(a.lo), _mm_cvttps_epi32(a.hi)}; }
+inline auto operator|(Int8 a, Int8 b) -> Int8 { return {_mm_or_si128(a.lo, b.lo), _mm_or_si128(a.hi, b.hi)}; }
+template<int Shift>
+inline auto shiftLeft(Int8 a) -> Int8 {
+  return {_mm_slli_epi32(a.lo, Shift), _mm_slli_epi32(a.hi, Shift)};
+}
+inline auto select(Mask8 mask, Int8 a, Int8 b) -> Int8 {
+  return {_mm_castps_si128(_mm_blendv_ps(_mm_castsi128_ps(a.lo), _mm_castsi128_ps(b.lo), mask.lo)),
+          _mm_castps_si128(_mm_blendv_ps(_mm_castsi128_ps(a.hi), _mm_castsi128_ps(b.hi), mask.hi))};
+}
+inline auto floor(Float8 a) -> Float8 { return {_mm_floor_ps(a.lo), _mm_floor_ps(a.hi)}; }
+inline auto setInt(std::uint32_t value) -> Int8 {
+  const auto v = _mm_set1_epi32(static_cast<int>(value));
+  return {v, v};
+}
+inline auto toFloat(Int8 a) -> Float8 { return {_mm_cvtepi32_ps(a.lo), _mm_cvtepi32_ps(a.hi)}; }
+inline auto asInt(Float8 a) -> Int8 { return {_mm_castps_si128(a.lo), _mm_castps_si128(a.hi)}; }
+inline auto asFloat(Int8 a) -> Float8 { return {_mm_castsi128_ps(a.lo), _mm_castsi128_ps(a.hi)}; }
+inline auto operator&(Int8 a, Int8 b) -> Int8 { return {_mm_and_si128(a.lo, b.lo), _mm_and_si128(a.hi, b.hi)}; }
+inline auto operator+(Int8 a, Int8 b) -> Int8 { return {_mm_add_epi32(a.lo, b.lo), _mm_add_epi32(a.hi, b.hi)}; }
+template<int Shift>
+inline auto shiftRight(Int8 a) -> Int8 {
+  return {_mm_srli_epi32(a.lo, Shift), _mm_srli_epi32(a.hi, Shift)};
+}
+
+#else
+
+struct Float8 {
+  std::array<float, gLanes> v;
+};
+
+struct Int8 {
+  std::array<std::uint32_t, gLanes> v;
+};
+
+struct Mask8 {
+  std::array<bool, gLanes> v;
+};
+
+template<typename Result, typename Function>
+inline auto lanes(Function &&function) -> Result {
+  Result result{};
+  for(std::size_t i = 0; i < gLanes; ++i) {
+    result.v[i] = function(i);
+  }
+  return result;
+}
+
+inline auto set1(float value) -> Float8 { return lanes<Float8>([value](std::size_t) { return value; }); }
+inline auto load(const float *pValues) -> Float8 { return lanes<Float8>([pValues](std::size_t i) { return pValues[i]; }); }
+inline void store(float *pValues, Float8 a) {
+  for(std::size_t i = 0; i < gLanes; ++i) {
+    pValues[i] = a.v[i];
+  }
+}
+inline auto ramp() -> Float8 { return lanes<Float8>([](std::size_t i) { return static_cast<float>(i); }); }
+
+inline auto operator+(Float8 a, Float8 b) -> Float8 { return lanes<Float8>([&](std::size_t i) { return a.v[i] + b.v[i]; }); }
+inline auto operator-(Float8 a, Float8 b) -> Float8 { return lanes<Float8>([&](std::size_t i) { return a.v[i] - b.v[i]; }); }
+inline auto operator*(Float8 a, Float8 b) -> Float8 { return lanes<Float8>([&](std::size_t i) { return a.v[i] * b.v[i]; }); }
+inline auto operator/(Float8 a, Float8 b) -> Float8 { return lanes<Float8>([&](std::size_t i) { return a.v[i] / b.v[i]; }); }
+inline auto min(Float8 a, Float8 b) -> Float8 { return lanes<Float8>([&](std::size_t i) { return b.v[i] < a.v[i] ? b.v[i] : a.v[i]; }); }
+inline auto max(Float8 a, Float8 b) -> Float8 { return lanes<Float8>([&](std::size_t i) { return a.v[i] < b.v[i] ? b.v[i] : a.v[i]; }); }
+inline auto sqrt(Float8 a) -> Float8 { return lanes<Float8>([&](std::size_t i) { return std::sqrt(a.v[i]); }); }
+inline auto fma(Float8 a, Float8 b, Float8 c) -> Float8 { return a * b + c; }
+
+inline auto operator>=(Float8 a, Float8 b) -> Mask8 { return lanes<Mask8>([&](std::size_t i) { return a.v[i] >= b.v[i]; }); }
+inline auto operator<(Float8 a, Float8 b) -> Mask8 { return lanes<Mask8>([&](std::size_t i) { return a.v[i] < b.v[i]; }); }
+inline auto operator>(Float8 a, Float8 b) -> Mask8 { return lanes<Mask8>([&](std::size_t i) { return a.v[i] > b.v[i]; }); }
+inline auto operator&(Mask8 a, Mask8 b) -> Mask8 { return lanes<Mask8>([&](std::size_t i) { return a.v[i] && b.v[i]; }); }
+inline auto operator|(Mask8 a, Mask8 b) -> Mask8 { return lanes<Mask8>([&](std::size_t i) { return a.v[i] || b.v[i]; }); }
+inline auto allTrue() -> Mask8 { return lanes<Mask8>([](std::size_t) { return true; }); }
+inline auto bits(Mask8 a) -> std::uint32_t {
+  std::uint32_t result = 0;
+  for(std::size_t i = 0; i < gLanes; ++i) {
+    result |= static_cast<std::uint32_t>(a.v[i]) << i;
+  }
+  return result;
+}
+inline auto select(Mask8 mask, Float8 a, Float8 b) -> Float8 {
+  return lanes<Float8>([&](std::size_t i) { return mask.v[i] ? b.v[i] : a.v[i]; });
+}
+
+inline auto loadInt(const std::uint32_t *pValues) -> Int8 { return lanes<Int8>([pValues](std::size_t i) { return pValues[i]; }); }
+inline void storeInt(std::uint32_t *pValues, Int8 a) {
+  for(std::size_t i = 0; i < gLanes; ++i) {
+    pValues[i] = a.v[i];
+  }
+}
+inline auto toInt(Float8 a) -> Int8 { return lanes<Int8>([&](std::size_t i) { return static_cast<std::uint32_t>(a.v[i]); }); }
+inline auto operator|(Int8 a, Int8 b) -> Int8 { return lanes<Int8>([&](std::size_t i) { return a.v[i] | b.v[i]; }); }
+template<int Shift>
+inline auto shiftLeft(Int8 a) -> Int8 {
+  return lanes<Int8>([&](std::size_t i) { return a.v[i] << Shift; });
+}
+inline auto select(Mask8 mask, Int8 a, Int8 b) -> Int8 {
+  return lanes<Int8>([&](std::size_t i) { return mask.v[i] ? b.v[i] : a.v[i]; });
+}
+inline auto floor(Float8 a) -> Float8 { return lanes<Float8>([&](std::size_t i) { return std::floor(a.v[i]); }); }
+inline auto setInt(std::uint32_t value) -> Int8 { return lanes<Int8>([value](std::size_t) { return value; }); }
+inline auto toFloat(Int8 a) -> Float8 { return lanes<Float8>([&](std::size_t i) { return static_cast<float>(static_cast<std::int32_t>(a.v[i])); }); }
+inline auto asInt(Float8 a) -> Int8 {
+  return lanes<Int8>([&](std::size_t i) {
+    std::uint32_t bits;
+    std::memcpy(&bits, &a.v[i], sizeof(bits));
+    return bits;
+  });
+}
+inline auto asFloat(Int8 a) -> Float8 {
+  return lanes<Float8>([&](std::size_t i) {
+    float value;
+    std::memcpy(&value, &a.v[i], sizeof(value));
+    return value;
+  });
+}
+inline auto operator&(Int8 a, Int8 b) -> Int8 { return lanes<Int8>([&](std::size_t i) { return a.v[i] & b.v[i]; }); }
+inline auto operator+(Int8 a, Int8 b) -> Int8 { return lanes<Int8>([&](std::size_t i) { return a.v[i] + b.v[i]; }); }
+template<int Shift>
+inline auto shiftRight(Int8 a) -> Int8 {
+  return lanes<Int8>([&](std::size_t i) { return a.v[i] >> Shift; });
+}
+
+#endif
+
+inline auto operator+(Float8 a, float b) -> Float8 { return a + set1(b); }
+inline auto operator-(Float8 a, float b) -> Float8 { return a - set1(b); }
+inline auto operator*(Float8 a, float b) -> Float8 { return a * set1(b); }
+inline auto operator-(Float8 a) -> Float8 { return set1(0.F) - a; }
+inline auto clamp(Float8 a, float low, float high) -> Float8 { return min(max(a, set1(low)), set1(high)); }
+
+// Lane i is true when bit i of `laneBits` is set, the inverse of bits().
+inline auto fromBits(std::uint32_t laneBits) -> Mask8 {
+  alignas(32) static constexpr std::array<std::uint32_t, gLanes> laneBit = {1, 2, 4, 8, 16, 32, 64, 128};
+  return toFloat(setInt(laneBits) & loadInt(laneBit.data())) > set1(0.F);
+}
+
+inline auto reduceMin(Float8 a) -> float {
+  alignas(32) std::array<float, gLanes> values;
+  store(values.data(), a);
+  return *std::min_element(values.cbegin(), values.cend());
+}
+
+inline auto reduceMax(Float8 a) -> float {
+  alignas(32) std::array<float, gLanes> values;
+  store(values.data(), a);
+  return *std::max_element(values.cbegin(), values.cend());
+}
+
+// log2 of positive normal numbers, about 2e-6 absolute error.
+inline auto log2(Float8 x) -> Float8 {
+  const auto bits = asInt(x);
+  const auto exponent = toFloat(shiftRight<23>(bits)) - 127.F;
+  // x = 2^exponent * m with m in [1, 2), log2(m) = 2 / ln(2) * atanh((m - 1) / (m + 1)) as a series in t.
+  const auto m = asFloat((bits & setInt(0x007FFFFFU)) | setInt(0x3F800000U));
+  const auto t = (m - 1.F) / (m + 1.F);
+  const auto t2 = t * t;
+  auto series = fma(t2, set1(1.F / 9.F), set1(1.F / 7.F));
+  series = fma(series, t2, set1(1.F / 5.F));
+  series = fma(series, t2, set1(1.F / 3.F));
+  series = fma(series, t2, set1(1.F));
+  return fma(series * t, set1(2.F / 0.69314718F), exponent);
+}
+
+// 2^x, about 1e-6 relative error; x is clamped to the normal range.
+inline auto exp2(Float8 x) -> Float8 {
+  x = clamp(x, -126.F, 126.F);
+  const auto whole = floor(x);
+  const auto f = (x - whole) * 0.69314718F;
+  // e^f for f in [0, ln 2), Taylor series.
+  auto series = fma(f, set1(1.F / 5040.F), set1(1.F / 720.F));
+  series = fma(series, f, set1(1.F / 120.F));
+  series = fma(series, f, set1(1.F / 24.F));
+  series = fma(series, f, set1(1.F / 6.F));
+  series = fma(series, f, set1(0.5F));
+  series = fma(series, f, set1(1.F));
+  series = fma(series, f, set1(1.F));
+  return series * asFloat(shiftLeft<23>(toInt(whole + 127.F)));
+}
+
+// GLSL pow(), 0 where x <= 0.
+inline auto pow(Float8 x, Float8 y) -> Float8 { return select(x > set1(0.F), set1(0.F), exp2(y * log2(x))); }
+
+// RGBA8 in GL_RGBA / GL_UNSIGNED_BYTE byte order, the vector form of packColor().
+inline auto packColors(Float8 r, Float8 g, Float8 b, Float8 a) -> Int8 {
+  const auto channel = [](Float8 value) { return toInt(clamp(value, 0.F, 1.F) * 255.F + 0.5F); };
+  return channel(r) | shiftLeft<8>(channel(g)) | shiftLeft<16>(channel(b)) | shiftLeft<24>(channel(a));
+}
+
+// Channel by channel average of four RGBA8 colors, rounded. Two channels at a time, 16 bits each hold their sum.
+inline auto averageColors(Int8 a, Int8 b, Int8 c, Int8 d) -> Int8 {
+  const auto low = setInt(0x00FF00FFU);
+  const auto half = setInt(0x00020002U);
+  const auto even = (a & low) + (b & low) + (c & low) + (d & low) + half;
+  const auto odd = (shiftRight<8>(a) & low) + (shiftRight<8>(b) & low) + (shiftRight<8>(c) & low) + (shiftRight<8>(d) & low) + half;
+  return (shiftRight<2>(even) & low) | shiftLeft<8>(shiftRight<2>(odd) & low);
+}
+
+} // namespace mimic::simd
@@ -0,0 +1,77 @@
+#pragma once
+// mimicOpenGL
+#include <mimicOpenGL/gl.hpp>
+#include <mimicOpenGL/math.hpp>
+#include <mimicOpenGL/simd.hpp>
+
+// math.hpp for 8 vertices or fragments at once, one lane each, for VertexShader8 and FragmentShader8.
+namespace mimic::simd {
+
+struct Vec3x8 {
+  Float8 x;
+  Float8 y;
+  Float8 z;
+};
+
+struct Vec4x8 {
+  Float8 x;
+  Float8 y;
+  Float8 z;
+  Float8 w;
+};
+
+inline auto set1(Vec3 a) -> Vec3x8 { return {set1(a.x), set1(a.y), set1(a.z)}; }
+inline auto set1(Vec4 a) -> Vec4x8 { return {set1(a.x), set1(a.y), set1(a.z), set1(a.w)}; }
+
+inline auto operator+(const Vec3x8 &a, const Vec3x8 &b) -> Vec3x8 { return {a.x + b.x, a.y + b.y, a.z + b.z}; }
+inline auto operator-(const Vec3x8 &a, const Vec3x8 &b) -> Vec3x8 { return {a.x - b.x, a.y - b.y, a.z - b.z}; }
+inline auto operator-(const Vec3x8 &a) -> Vec3x8 { return {-a.x, -a.y, -a.z}; }
+inline auto operator*(const Vec3x8 &a, Float8 s) -> Vec3x8 { return {a.x * s, a.y * s, a.z * s}; }
+inline auto operator*(Vec3 a, Float8 s) -> Vec3x8 { return {s * a.x, s * a.y, s * a.z}; }
+
+inline auto xyz(const Vec4x8 &a) -> Vec3x8 { return {a.x, a.y, a.z}; }
+
+inline auto dot(const Vec3x8 &a, const Vec3x8 &b) -> Float8 { return fma(a.x, b.x, fma(a.y, b.y, a.z * b.z)); }
+
+// Zero vectors stay zero like math.hpp normalize().
+inline auto normalize(const Vec3x8 &a) -> Vec3x8 {
+  const auto size = sqrt(dot(a, a));
+  return a * select(size > set1(0.F), set1(1.F), set1(1.F) / size);
+}
+
+inline auto reflect(const Vec3x8 &incident, const Vec3x8 &normal) -> Vec3x8 {
+  return incident - normal * (dot(normal, incident) * 2.F);
+}
+
+// The matrix is the same for all lanes: every column is broadcast once, the lanes are multiplied in one go.
+inline auto operator*(const Mat3 &m, const Vec3x8 &v) -> Vec3x8 {
+  const auto &c = m.columns;
+  return {fma(set1(c[0].x), v.x, fma(set1(c[1].x), v.y, set1(c[2].x) * v.z)),
+          fma(set1(c[0].y), v.x, fma(set1(c[1].y), v.y, set1(c[2].y) * v.z)),
+          fma(set1(c[0].z), v.x, fma(set1(c[1].z), v.y, set1(c[2].z) * v.z))};
+}
+
+inline auto operator*(const Mat4 &m, const Vec4x8 &v) -> Vec4x8 {
+  const auto &c = m.columns;
+  const auto row = [&c, &v](float Vec4::*component) {
+    return fma(set1(c[0].*component), v.x, fma(set1(c[1].*component), v.y, fma(set1(c[2].*component), v.z, set1(c[3].*component) * v.w)));
+  };
+  return {row(&Vec4::x), row(&Vec4::y), row(&Vec4::z), row(&Vec4::w)};
+}
+
+// VertexInput8 / VertexOutput8 access.
+inline auto attribute(const VertexInput8 &input, std::size_t index) -> Vec4x8 {
+  const auto *pValues = input.attributes[index].data();
+  return {load(pValues), load(pValues + gLanes), load(pValues + 2 * gLanes), load(pValues + 3 * gLanes)};
+}
+
+inline void setPosition(VertexOutput8 &output, const Vec4x8 &position) {
+  store(output.position.data(), position.x);
+  store(output.position.data() + gLanes, position.y);
+  store(output.position.data() + 2 * gLanes, position.z);
+  store(output.position.data() + 3 * gLanes, position.w);
+}
+
+inline void setVarying(VertexOutput8 &output, std::size_t index, Float8 value) { store(output.varyings.data() + index * gLanes, value); }
+
+} // namespace mimic::simd
@@ -0,0 +1,221 @@
+// STL
+#include <array>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <algorithm>
+// common
+#include <common/benchmark.hpp>
+// mimicOpenGL
+#include <mimicOpenGL/gl.hpp>
+#include <mimicOpenGL/sample.hpp>
+#include <mimicOpenGL/simdMath.hpp>
+
+// shaders/materials/specular.cpp drawn by the software renderer, no GPU or GL driver involved.
+
+using namespace mimic;
+
+constexpr auto gTitle = "Scene (software)";
+
+namespace {
+
+struct Uniforms {
+  Vec3 materialAmbient;
+  Vec3 materialDiffuse;
+  Vec3 materialSpecular;
+  float materialShininess;
+  Vec4 lightPosition;
+  Vec3 lightAmbient;
+  Vec3 lightDiffuse;
+  Vec3 lightSpecular;
+  Mat3 normal;
+  Mat4 modelView;
+  Mat4 modelViewProjection;
+};
+
+// Gouraud shading, a line by line port of the GLSL vertex shader of the GL demo.
+void vertexShader(const std::byte *pUniforms, const VertexInput &input, VertexOutput &output) {
+  const auto &u = *reinterpret_cast<const Uniforms *>(pUniforms);
+  const auto position = Vec4{input.attributes[0].x, input.attributes[0].y, input.attributes[0].z, 1};
+  const auto normal = xyz(input.attributes[1]);
+
+  // La = Ka * La
+  const auto La = u.materialAmbient * u.lightAmbient;
+  // Ld = Kd * Ld * dot(s, n)
+  const auto n = normalize(u.normal * normal);
+  const auto eyeCoords = u.modelView * position;
+  const auto s = normalize(xyz(u.lightPosition - eyeCoords));
+  const auto sDotN = std::max(dot(s, n), 0.F);
+  const auto Ld = u.materialDiffuse * u.lightDiffuse * sDotN;
+  // Ls = Kd * Ls * pow(dot(r, v), f)
+  const auto v = normalize(-xyz(eyeCoords));
+  const auto r = reflect(-s, n);
+  auto Ls = Vec3{};
+  if(sDotN > 0) {
+    Ls = u.materialSpecular * u.lightSpecular * std::pow(std::max(dot(r, v), 0.F), u.materialShininess);
+  }
+  // Color = La + Ld + Ls
+  const auto color = La + Ld + Ls;
+  output.varyings[0] = color.x;
+  output.varyings[1] = color.y;
+  output.varyings[2] = color.z;
+
+  output.position = u.modelViewProjection * position;
+}
+
+// The same for 8 vertices, one per lane.
+void vertexShader8(const std::byte *pUniforms, const VertexInput8 &input, VertexOutput8 &output) {
+  using namespace simd;
+  const auto &u = *reinterpret_cast<const Uniforms *>(pUniforms);
+  auto position = attribute(input, 0);
+  position.w = set1(1.F);
+  const auto normal = xyz(attribute(input, 1));
+
+  // La = Ka * La
+  const auto La = u.materialAmbient * u.lightAmbient;
+  // Ld = Kd * Ld * dot(s, n)
+  const auto n = normalize(u.normal * normal);
+  const auto eyeCoords = u.modelView * position;
+  const auto s = normalize(xyz(set1(u.lightPosition)) - xyz(eyeCoords));
+  const auto sDotN = max(dot(s, n), set1(0.F));
+  const auto Ld = (u.materialDiffuse * u.lightDiffuse) * sDotN;
+  // Ls = Kd * Ls * pow(dot(r, v), f)
+  const auto v = normalize(-xyz(eyeCoords));
+  const auto r = reflect(-s, n);
+  const auto specular = select(sDotN > set1(0.F), set1(0.F), pow(max(dot(r, v), set1(0.F)), set1(u.materialShininess)));
+  const auto Ls = (u.materialSpecular * u.lightSpecular) * specular;
+  // Color = La + Ld + Ls
+  const auto color = set1(La) + Ld + Ls;
+  setVarying(output, 0, color.x);
+  setVarying(output, 1, color.y);
+  setVarying(output, 2, color.z);
+
+  setPosition(output, u.modelViewProjection * position);
+}
+
+auto fragmentShader(const std::byte *, const float *pVaryings) -> Vec4 { return {pVaryings[0], pVaryings[1], pVaryings[2], 1}; }
+
+// The same for 8 fragments, the varyings already are the color channels.
+void fragmentShader8(const std::byte *, const float *pVaryings, float *pColor) {
+  std::copy(pVaryings, pVaryings + 3 * 8, pColor);
+  std::fill(pColor + 3 * 8, pColor + 4 * 8, 1.F);
+}
+
+auto specularProgram() -> ProgramDescription {
+  ProgramDescription description;
+  description.uniforms = {
+    {"uMaterial.Ambient", offsetof(Uniforms, materialAmbient), sizeof(Vec3)},
+    {"uMaterial.Diffuse", offsetof(Uniforms, materialDiffuse), sizeof(Vec3)},
+    {"uMaterial.Specular", offsetof(Uniforms, materialSpecular), sizeof(Vec3)},
+    {"uMaterial.Shininess", offsetof(Uniforms, materialShininess), sizeof(float)},
+    {"uLight.Position", offsetof(Uniforms, lightPosition), sizeof(Vec4)},
+    {"uLight.Ambient", offsetof(Uniforms, lightAmbient), sizeof(Vec3)},
+    {"uLight.Diffuse", offsetof(Uniforms, lightDiffuse), sizeof(Vec3)},
+    {"uLight.Specular", offsetof(Uniforms, lightSpecular), sizeof(Vec3)},
+    {"uMatrices.Normal", offsetof(Uniforms, normal), sizeof(Mat3)},
+    {"uMatrices.ModelView", offsetof(Uniforms, modelView), sizeof(Mat4)},
+    {"uMatrices.ModelViewProjection", offsetof(Uniforms, modelViewProjection), sizeof(Mat4)},
+  };
+  description.vertex = vertexShader;
+  description.vertex8 = vertexShader8;
+  description.fragment = fragmentShader;
+  description.fragment8 = fragmentShader8;
+  description.varyings = 3;
+  return description;
+}
+
+} // namespace
+
+auto mimic::specularSample(const SampleOptions &options) -> int {
+  SampleTarget target(gTitle, options);
+  if(!target.valid()) {
+    return EXIT_FAILURE;
+  }
+  BenchmarkRecorder benchmark("mimicSpecular");
+
+  benchmark.beginLoad();
+  SampleScene scene = loadSampleScene("sphere.obj");
+  scene.initialize();
+
+  const GLuint program = createProgram(specularProgram());
+
+  const auto ratio = static_cast<float>(options.width) / static_cast<float>(options.height);
+  const auto prespective = perspective(45.F, ratio, 0.001F, 1000.F);
+  const auto view = lookAt(Vec3{2, 2, 2}, Vec3{}, Vec3{0, 1, 0});
+
+  const auto MVP = prespective * view;
+
+  const auto N = toMat3(view);
+
+  auto locationMatrialAmbient              = glGetUniformLocation(program, "uMaterial.Ambient");
+  auto locationMatrialDiffuse              = glGetUniformLocation(program, "uMaterial.Diffuse");
+  auto locationMatrialSpecular             = glGetUniformLocation(program, "uMaterial.Specular");
+  auto locationMatrialShinness             = glGetUniformLocation(program, "uMaterial.Shininess");
+
+  auto locationLightPos                    = glGetUniformLocation(program, "uLight.Position");
+  auto locationLightAmbient                = glGetUniformLocation(program, "uLight.Ambient");
+  auto locationLightDiffuse                = glGetUniformLocation(program, "uLight.Diffuse");
+  auto locationLightSpecular               = glGetUniformLocation(program, "uLight.Specular");
+
+  auto locationMatricesNormal              = glGetUniformLocation(program, "uMatrices.Normal");
+  auto locationMatricesModelView           = glGetUniformLocation(program, "uMatrices.ModelView");
+  auto locationMatricesModelViewProjection = glGetUniformLocation(program, "uMatrices.ModelViewProjection");
+
+  benchmark.endLoad();
+
+  glEnable(GL_DEPTH_TEST);
+  glDepthFunc(GL_LESS);
+
+  while(target.poll()) {
+    benchmark.beginFrame();
+    const auto start = std::chrono::steady_clock::now();
+
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    glUseProgram(program);
+    {
+      const Vec3 materialAmbient{0.1F, 0.1F, 0.1F};
+      const Vec3 materialDiffuse{1, 0, 0};
+      const Vec3 materialSpecular{1, 1, 1};
+      const Vec3 lightAmbient{0.1F, 0.1F, 0.1F};
+      const Vec3 lightDiffuse{1, 1, 1};
+      const Vec3 lightSpecular{1, 1, 1};
+      const Vec4 lightPosition{10, 10, 10, 1};
+
+      glUniform3fv(locationMatrialAmbient, 1, &materialAmbient.x);
+      glUniform3fv(locationMatrialDiffuse, 1, &materialDiffuse.x);
+      glUniform3fv(locationMatrialSpecular, 1, &materialSpecular.x);
+      glUniform1f(locationMatrialShinness, 1);
+
+      glUniform3fv(locationLightAmbient,   1, &lightAmbient.x);
+      glUniform3fv(locationLightDiffuse,   1, &lightDiffuse.x);
+      glUniform3fv(locationLightSpecular,  1, &lightSpecular.x);
+
+      glUniform4fv(locationLightPos,       1, &lightPosition.x);
+
+      glUniformMatrix3fv(locationMatricesNormal,              1, GL_FALSE, &N.columns[0].x);
+      glUniformMatrix4fv(locationMatricesModelView,           1, GL_FALSE, view.data());
+      glUniformMatrix4fv(locationMatricesModelViewProjection, 1, GL_FALSE, MVP.data());
+
+      scene.draw();
+    }
+    glUseProgram(0);
+
+    target.present();
+
+    const auto cpuTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    printf("\rCPU: FPS: %.3F, Time: %.3F", 1000. / cpuTime, cpuTime);
+    benchmark.endFrame();
+    if(benchmark.finished()) {
+      break;
+    }
+  }
+
+  glDeleteProgram(program);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,73 @@
+#pragma once
+// STL
+#include <random>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+// mimicOpenGL
+#include <mimicOpenGL/math.hpp>
+
+namespace mimic {
+
+struct Mesh {
+  std::vector<float> vertices; // position and normal
+  std::vector<std::uint32_t> indices;
+};
+
+// Unit sphere of `grid` x `grid` shared vertices, for the benchmarks.
+inline auto sphere(std::uint32_t grid) -> Mesh {
+  Mesh mesh;
+  constexpr auto pi = 3.14159265F;
+  for(std::uint32_t i = 0; i < grid; ++i) {
+    const auto theta = pi * static_cast<float>(i) / static_cast<float>(grid - 1);
+    for(std::uint32_t j = 0; j < grid; ++j) {
+      const auto phi = 2.F * pi * static_cast<float>(j) / static_cast<float>(grid - 1);
+      const auto x = std::sin(theta) * std::cos(phi);
+      const auto y = std::cos(theta);
+      const auto z = std::sin(theta) * std::sin(phi);
+      mesh.vertices.insert(mesh.vertices.end(), {x, y, z, x, y, z});
+    }
+  }
+  for(std::uint32_t i = 0; i + 1 < grid; ++i) {
+    for(std::uint32_t j = 0; j + 1 < grid; ++j) {
+      const auto a = i * grid + j;
+      const auto b = a + grid;
+      mesh.indices.insert(mesh.indices.end(), {a, b, a + 1, a + 1, b, b + 1});
+    }
+  }
+  return mesh;
+}
+
+// Copies of `mesh` scaled by `radius` around every center, in the order given.
+inline auto instances(const Mesh &mesh, const std::vector<Vec3> &centers, float radius) -> Mesh {
+  Mesh result;
+  for(const auto &center : centers) {
+    const auto first = static_cast<std::uint32_t>(result.vertices.size() / 6);
+    for(std::size_t i = 0; i < mesh.vertices.size(); i += 6) {
+      const auto *pVertex = mesh.vertices.data() + i;
+      result.vertices.insert(result.vertices.end(), {center.x + radius * pVertex[0], center.y + radius * pVertex[1],
+                                                     center.z + radius * pVertex[2], pVertex[3], pVertex[4], pVertex[5]});
+    }
+    for(const auto index : mesh.indices) {
+      result.indices.push_back(first + index);
+    }
+  }
+  return result;
+}
+
+// `layers` slabs of 4x4 overlapping spheres one behind the other, drawn in a fixed random order.
+inline auto stack(const Mesh &mesh, int layers) -> Mesh {
+  std::vector<Vec3> centers;
+  for(int layer = 0; layer < layers; ++layer) {
+    for(int y = 0; y < 4; ++y) {
+      for(int x = 0; x < 4; ++x) {
+        centers.push_back({static_cast<float>(x) - 1.5F, static_cast<float>(y) - 1.5F, -0.5F * static_cast<float>(layer)});
+      }
+    }
+  }
+  std::shuffle(centers.begin(), centers.end(), std::mt19937(42));
+  return instances(mesh, centers, 0.8F);
+}
+
+} // namespace mimic
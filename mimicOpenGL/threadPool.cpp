@@ -0,0 +1,123 @@
+#include <mimicOpenGL/threadPool.hpp>
+// STL
+#include <algorithm>
+
+namespace mimic {
+
+static auto pack(std::uint64_t begin, std::uint64_t end) -> std::uint64_t { return begin | (end << 32U); }
+static auto begin(std::uint64_t range) -> std::uint64_t { return range & 0xFFFFFFFFU; }
+static auto end(std::uint64_t range) -> std::uint64_t { return range >> 32U; }
+
+ThreadPool::ThreadPool(std::size_t threads) {
+  if(threads == 0) {
+    threads = std::max(1U, std::thread::hardware_concurrency());
+  }
+  mDeques = std::vector<Deque>(threads);
+  mWorkers.reserve(threads - 1);
+  for(std::size_t i = 1; i < threads; ++i) {
+    mWorkers.emplace_back([this, i] { work(i); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard lock(mMutex);
+    mbStop = true;
+  }
+  mWake.notify_all();
+  for(auto &worker : mWorkers) {
+    worker.join();
+  }
+}
+
+void ThreadPool::parallelFor(std::size_t count, const Task &task) {
+  if(count == 0) {
+    return;
+  }
+  if(mWorkers.empty() || count == 1) {
+    for(std::size_t i = 0; i < count; ++i) {
+      task(i, 0);
+    }
+    return;
+  }
+
+  {
+    std::lock_guard lock(mMutex);
+    mpTask = &task;
+    const auto workers = size();
+    for(std::size_t worker = 0; worker < workers; ++worker) {
+      mDeques[worker].range.store(pack(count * worker / workers, count * (worker + 1) / workers), std::memory_order_relaxed);
+    }
+    mBusy = mWorkers.size();
+    ++mGeneration;
+  }
+  mWake.notify_all();
+
+  drain(0);
+
+  std::unique_lock lock(mMutex);
+  mDone.wait(lock, [this] { return mBusy == 0; });
+  mpTask = nullptr;
+}
+
+void ThreadPool::work(std::size_t worker) {
+  std::size_t generation = 0;
+  for(;;) {
+    {
+      std::unique_lock lock(mMutex);
+      mWake.wait(lock, [this, generation] { return mbStop || mGeneration != generation; });
+      if(mbStop) {
+        return;
+      }
+      generation = mGeneration;
+    }
+
+    drain(worker);
+
+    std::lock_guard lock(mMutex);
+    if(--mBusy == 0) {
+      mDone.notify_one();
+    }
+  }
+}
+
+void ThreadPool::drain(std::size_t worker) {
+  std::size_t index = 0;
+  while(pop(worker, index) || steal(worker, index)) {
+    (*mpTask)(index, worker);
+  }
+}
+
+auto ThreadPool::pop(std::size_t worker, std::size_t &index) -> bool {
+  auto &range = mDeques[worker].range;
+  auto current = range.load(std::memory_order_acquire);
+  while(begin(current) < end(current)) {
+    if(range.compare_exchange_weak(current, pack(begin(current) + 1, end(current)), std::memory_order_acq_rel)) {
+      index = static_cast<std::size_t>(begin(current));
+      return true;
+    }
+  }
+  return false;
+}
+
+// Only called with an empty deque, so nobody else takes from it until the stolen half is stored there.
+// Finding every deque empty once is final: work only moves between deques, the thief runs what it took.
+auto ThreadPool::steal(std::size_t worker, std::size_t &index) -> bool {
+  const auto workers = size();
+  for(std::size_t i = 1; i < workers; ++i) {
+    auto &victim = mDeques[(worker + i) % workers].range;
+    auto current = victim.load(std::memory_order_acquire);
+    while(begin(current) < end(current)) {
+      const auto middle = begin(current) + (end(current) - begin(current)) / 2;
+      if(victim.compare_exchange_weak(current, pack(begin(current), middle), std::memory_order_acq_rel)) {
+        // [middle, end) is ours now, run its first index and keep the rest where others can steal it.
+        index = static_cast<std::size_t>(middle);
+        mDeques[worker].range.store(pack(middle + 1, end(current)), std::memory_order_release);
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+} // namespace mimic
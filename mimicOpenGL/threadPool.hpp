@@ -0,0 +1,56 @@
+#pragma once
+// STL
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <condition_variable>
+
+namespace mimic {
+
+// Fixed set of workers for data parallel loops. The calling thread takes part as worker 0.
+class ThreadPool final {
+public:
+  using Task = std::function<void(std::size_t index, std::size_t worker)>;
+
+  // 0 uses every hardware thread.
+  explicit ThreadPool(std::size_t threads);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  [[nodiscard]] auto size() const -> std::size_t { return mWorkers.size() + 1; }
+
+  // Runs `task` for every index in [0, count) and returns when all of them are done.
+  // Every worker starts on its own contiguous share of the indices and takes them one by one from the front,
+  // a worker running out steals the back half of another one's share, so uneven work (tiles, chunks) balances itself.
+  void parallelFor(std::size_t count, const Task &task);
+
+private:
+  // The indices [begin, end) left to a worker, packed as begin | end << 32 so taking from the front and
+  // stealing from the back are both one compare and swap.
+  struct alignas(64) Deque {
+    std::atomic<std::uint64_t> range{0};
+  };
+
+  void work(std::size_t worker);
+  void drain(std::size_t worker);
+  auto pop(std::size_t worker, std::size_t &index) -> bool;
+  auto steal(std::size_t worker, std::size_t &index) -> bool;
+
+  std::vector<std::thread> mWorkers;
+  std::mutex mMutex;
+  std::condition_variable mWake;
+  std::condition_variable mDone;
+  const Task *mpTask = nullptr;
+  std::size_t mGeneration = 0;
+  std::size_t mBusy = 0;
+  std::vector<Deque> mDeques;
+  bool mbStop = false;
+};
+
+} // namespace mimic
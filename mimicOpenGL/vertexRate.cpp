@@ -0,0 +1,192 @@
+// STL
+#include <array>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <algorithm>
+// mimicOpenGL
+#include <mimicOpenGL/gl.hpp>
+#include <mimicOpenGL/sphere.hpp>
+#include <mimicOpenGL/simdMath.hpp>
+
+// Vertex throughput of the software pipeline on an indexed sphere, with and without the post-transform cache,
+// per vertex and 8 wide shaders, on one and on all threads. The viewport is empty so nothing is rasterized.
+// Usage: mimicvertexRate [--grid N] [--frames N]
+
+using namespace mimic;
+
+using Clock = std::chrono::steady_clock;
+
+struct Uniforms {
+  Vec4 lightPosition;
+  float shininess;
+  Mat3 normal;
+  Mat4 modelView;
+  Mat4 modelViewProjection;
+};
+
+// Diffuse and specular Gouraud lighting as in specular.cpp.
+static void vertexShader(const std::byte *pUniforms, const VertexInput &input, VertexOutput &output) {
+  const auto &u = *reinterpret_cast<const Uniforms *>(pUniforms);
+  const auto position = Vec4{input.attributes[0].x, input.attributes[0].y, input.attributes[0].z, 1};
+  const auto n = normalize(u.normal * xyz(input.attributes[1]));
+  const auto eyeCoords = u.modelView * position;
+  const auto s = normalize(xyz(u.lightPosition - eyeCoords));
+  const auto sDotN = std::max(dot(s, n), 0.F);
+  const auto v = normalize(-xyz(eyeCoords));
+  const auto r = reflect(-s, n);
+  const auto specular = sDotN > 0 ? std::pow(std::max(dot(r, v), 0.F), u.shininess) : 0.F;
+  output.varyings[0] = sDotN + specular;
+  output.position = u.modelViewProjection * position;
+}
+
+static void vertexShader8(const std::byte *pUniforms, const VertexInput8 &input, VertexOutput8 &output) {
+  using namespace simd;
+  const auto &u = *reinterpret_cast<const Uniforms *>(pUniforms);
+  auto position = attribute(input, 0);
+  position.w = set1(1.F);
+  const auto n = normalize(u.normal * xyz(attribute(input, 1)));
+  const auto eyeCoords = u.modelView * position;
+  const auto s = normalize(xyz(set1(u.lightPosition)) - xyz(eyeCoords));
+  const auto sDotN = max(dot(s, n), set1(0.F));
+  const auto v = normalize(-xyz(eyeCoords));
+  const auto r = reflect(-s, n);
+  const auto specular = select(sDotN > set1(0.F), set1(0.F), pow(max(dot(r, v), set1(0.F)), set1(u.shininess)));
+  setVarying(output, 0, sDotN + specular);
+  setPosition(output, u.modelViewProjection * position);
+}
+
+static auto fragmentShader(const std::byte *, const float *pVaryings) -> Vec4 { return {pVaryings[0], pVaryings[0], pVaryings[0], 1}; }
+
+// The same triangles without sharing, what glDrawArrays needs.
+static auto expand(const Mesh &mesh) -> std::vector<float> {
+  std::vector<float> vertices;
+  vertices.reserve(mesh.indices.size() * 6);
+  for(const auto index : mesh.indices) {
+    const auto *pVertex = mesh.vertices.data() + static_cast<std::size_t>(index) * 6;
+    vertices.insert(vertices.end(), pVertex, pVertex + 6);
+  }
+  return vertices;
+}
+
+static auto program(bool bBatched) -> GLuint {
+  ProgramDescription description;
+  description.uniforms = {
+    {"uLight.Position", offsetof(Uniforms, lightPosition), sizeof(Vec4)},
+    {"uMaterial.Shininess", offsetof(Uniforms, shininess), sizeof(float)},
+    {"uMatrices.Normal", offsetof(Uniforms, normal), sizeof(Mat3)},
+    {"uMatrices.ModelView", offsetof(Uniforms, modelView), sizeof(Mat4)},
+    {"uMatrices.ModelViewProjection", offsetof(Uniforms, modelViewProjection), sizeof(Mat4)},
+  };
+  description.vertex = vertexShader;
+  description.vertex8 = bBatched ? vertexShader8 : nullptr;
+  description.fragment = fragmentShader;
+  description.varyings = 1;
+  const auto result = createProgram(description);
+
+  const auto view = lookAt({0, 0, 3}, {0, 0, 0}, {0, 1, 0});
+  const auto normal = toMat3(view);
+  const auto modelViewProjection = perspective(0.8F, 1, 0.1F, 100) * view;
+  const auto lightPosition = Vec4{5, 5, 2, 1};
+  glUseProgram(result);
+  glUniform4fv(glGetUniformLocation(result, "uLight.Position"), 1, &lightPosition.x);
+  glUniform1f(glGetUniformLocation(result, "uMaterial.Shininess"), 100);
+  glUniformMatrix3fv(glGetUniformLocation(result, "uMatrices.Normal"), 1, GL_FALSE, &normal.columns[0].x);
+  glUniformMatrix4fv(glGetUniformLocation(result, "uMatrices.ModelView"), 1, GL_FALSE, view.data());
+  glUniformMatrix4fv(glGetUniformLocation(result, "uMatrices.ModelViewProjection"), 1, GL_FALSE, modelViewProjection.data());
+  return result;
+}
+
+static auto vertexArray(const std::vector<float> &vertices, const std::vector<std::uint32_t> *pIndices) -> GLuint {
+  GLuint vao = 0;
+  std::array<GLuint, 2> buffers = {};
+  glGenVertexArrays(1, &vao);
+  glBindVertexArray(vao);
+  glGenBuffers(2, buffers.data());
+  glBindBuffer(GL_ARRAY_BUFFER, buffers[0]);
+  glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(vertices.size() * sizeof(float)), vertices.data(), GL_STATIC_DRAW);
+  glVertexAttribPointer(0, 3, GL_FLOAT, false, 6 * sizeof(float), nullptr);
+  glEnableVertexAttribArray(0);
+  glVertexAttribPointer(1, 3, GL_FLOAT, false, 6 * sizeof(float), reinterpret_cast<const GLvoid *>(3 * sizeof(float)));
+  glEnableVertexAttribArray(1);
+  if(pIndices != nullptr) {
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers[1]);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(pIndices->size() * sizeof(std::uint32_t)), pIndices->data(), GL_STATIC_DRAW);
+  }
+  glBindVertexArray(0);
+  return vao;
+}
+
+int main(int argc, char *argv[]) {
+  std::uint32_t grid = 512;
+  int frames = 10;
+  for(int i = 1; i + 1 < argc; i += 2) {
+    const std::string option = argv[i];
+    if(option == "--grid") {
+      grid = static_cast<std::uint32_t>(std::max(2, std::atoi(argv[i + 1])));
+    } else if(option == "--frames") {
+      frames = std::max(1, std::atoi(argv[i + 1]));
+    } else {
+      std::cerr << "Usage: " << argv[0] << " [--grid N] [--frames N]\n";
+      return EXIT_FAILURE;
+    }
+  }
+
+  const auto mesh = sphere(grid);
+  const auto expanded = expand(mesh);
+  const auto indices = static_cast<GLsizei>(mesh.indices.size());
+  std::printf("%u vertices, %d indices, SIMD: %s\n", grid * grid, indices, simd::gInstructionSet);
+  std::printf("%-8s %-30s %12s\n", "threads", "", "Mindices/s");
+
+  std::vector<std::size_t> threadCounts = {1};
+  if(const auto hardware = std::thread::hardware_concurrency(); hardware > 1) {
+    threadCounts.push_back(hardware);
+  }
+  for(const auto threads : threadCounts) {
+    auto *pContext = createContext(64, 64, threads);
+    makeCurrent(pContext);
+    glViewport(0, 0, 0, 0);
+    const auto arrays = vertexArray(expanded, nullptr);
+    const auto elements = vertexArray(mesh.vertices, &mesh.indices);
+
+    struct Case {
+      const char *pName;
+      bool bBatched;
+      bool bIndexed;
+    };
+    for(const auto &test : {Case{"glDrawArrays, per vertex", false, false}, Case{"glDrawElements, per vertex", false, true},
+                            Case{"glDrawArrays, 8 wide", true, false}, Case{"glDrawElements, 8 wide", true, true}}) {
+      const auto shader = program(test.bBatched);
+      glBindVertexArray(test.bIndexed ? elements : arrays);
+      const auto draw = [&test, indices] {
+        if(test.bIndexed) {
+          glDrawElements(GL_TRIANGLES, indices, GL_UNSIGNED_INT, nullptr);
+        } else {
+          glDrawArrays(GL_TRIANGLES, 0, indices);
+        }
+        glFinish();
+      };
+      draw();
+      const auto start = Clock::now();
+      for(int frame = 0; frame < frames; ++frame) {
+        draw();
+      }
+      const auto seconds = std::chrono::duration<double>(Clock::now() - start).count() / frames;
+      std::printf("%-8zu %-30s %12.1f\n", threads, test.pName, static_cast<double>(indices) / seconds / 1e6);
+      glDeleteProgram(shader);
+    }
+    if(glGetError() != GL_NO_ERROR) {
+      std::cerr << "GL error\n";
+      return EXIT_FAILURE;
+    }
+    destroyContext(pContext);
+  }
+  return EXIT_SUCCESS;
+}
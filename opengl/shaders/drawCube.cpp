@@ -15,6 +15,11 @@
 #include <glbinding/glbinding.h>
 // SDL
 #include <SDL2/SDL.h>
+// common
+#include <common/backend.hpp>
+#include <common/offscreenFramebuffer.hpp>
+// mimicOpenGL
+#include <mimicOpenGL/samples.hpp>
 
 using namespace gl;
 
@@ -102,6 +107,11 @@ static auto createProgram(GLuint vertexShader, GLuint fragmentShader) -> GLuint
 }
 
 auto main(int argc, char *argv[]) -> int {
+  const auto backend = selectBackend(argc, argv);
+  if(backend == Backend::SOFTWARE) {
+    return mimic::runSample("drawCube", backend, argc, argv);
+  }
+
   if(SDL_Init(SDL_INIT_VIDEO) != 0) {
     std::cerr << "Can not initialize SDL2\n";
     return EXIT_FAILURE;
@@ -119,7 +129,7 @@ auto main(int argc, char *argv[]) -> int {
   }
 
   constexpr std::string_view sWindowTitle = "RedTriangle";
-  auto pWindow = SDL_CreateWindow(sWindowTitle.data(), SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, width, height, SDL_WINDOW_OPENGL);
+  auto pWindow = SDL_CreateWindow(sWindowTitle.data(), SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, width, height, OffscreenFramebuffer::windowFlags(backend));
   if(pWindow == nullptr) {
     std::cerr << "Can not create SDL2 window\n";
     return EXIT_FAILURE;
@@ -145,6 +155,7 @@ auto main(int argc, char *argv[]) -> int {
   SDL_GL_SetSwapInterval(SDL_SWAP_SYNCHRONIZED);
 
   glbinding::initialize(nullptr, false);
+  OffscreenFramebuffer offscreen(backend, width, height);
 
   // Set OpenGL Debug Callback
   if(glDebugMessageCallback) {
@@ -278,13 +289,18 @@ auto main(int argc, char *argv[]) -> int {
     }
     glUseProgram(0);
 
-    SDL_GL_SwapWindow(pWindow);
+    offscreen.swap(pWindow);
+    if(offscreen.finished()) {
+      bRunning = false;
+    }
   }
 
   glDeleteVertexArrays(1, &vao);
 
   glDeleteProgram(program);
 
+  offscreen.finish();
+
   SDL_GL_DeleteContext(context);
   SDL_DestroyWindow(pWindow);
   SDL_Quit();
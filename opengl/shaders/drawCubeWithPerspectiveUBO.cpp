@@ -16,6 +16,11 @@
 #include <glbinding/glbinding.h>
 // SDL
 #include <SDL2/SDL.h>
+// common
+#include <common/backend.hpp>
+#include <common/offscreenFramebuffer.hpp>
+// mimicOpenGL
+#include <mimicOpenGL/samples.hpp>
 
 using namespace gl;
 
@@ -103,6 +108,11 @@ static auto createProgram(GLuint vertexShader, GLuint fragmentShader) -> GLuint
 }
 
 auto main(int argc, char *argv[]) -> int {
+  const auto backend = selectBackend(argc, argv);
+  if(backend == Backend::SOFTWARE) {
+    return mimic::runSample("drawCubeWithPerspectiveUBO", backend, argc, argv);
+  }
+
   if(SDL_Init(SDL_INIT_VIDEO) != 0) {
     std::cerr << "Can not initialize SDL2\n";
     return EXIT_FAILURE;
@@ -120,7 +130,7 @@ auto main(int argc, char *argv[]) -> int {
   }
 
   constexpr std::string_view sWindowTitle = "RedTriangle";
-  auto pWindow = SDL_CreateWindow(sWindowTitle.data(), SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, width, height, SDL_WINDOW_OPENGL);
+  auto pWindow = SDL_CreateWindow(sWindowTitle.data(), SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, width, height, OffscreenFramebuffer::windowFlags(backend));
   if(pWindow == nullptr) {
     std::cerr << "Can not create SDL2 window\n";
     return EXIT_FAILURE;
@@ -146,6 +156,7 @@ auto main(int argc, char *argv[]) -> int {
   SDL_GL_SetSwapInterval(SDL_SWAP_SYNCHRONIZED);
 
   glbinding::initialize(nullptr, false);
+  OffscreenFramebuffer offscreen(backend, width, height);
 
   // Set OpenGL Debug Callback
   if(glDebugMessageCallback) {
@@ -323,7 +334,10 @@ auto main(int argc, char *argv[]) -> int {
 
     glPopDebugGroup();
 
-    SDL_GL_SwapWindow(pWindow);
+    offscreen.swap(pWindow);
+    if(offscreen.finished()) {
+      bRunning = false;
+    }
   }
 
   glDeleteBuffers(1, &ubo);
@@ -332,6 +346,8 @@ auto main(int argc, char *argv[]) -> int {
 
   glDeleteProgram(program);
 
+  offscreen.finish();
+
   SDL_GL_DeleteContext(context);
   SDL_DestroyWindow(pWindow);
   SDL_Quit();
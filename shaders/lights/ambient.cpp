@@ -17,6 +17,21 @@
 // assimp
 #include <assimp/scene.h>
 #include <assimp/Importer.hpp>
+// common
+#include <common/glCallStatistics.hpp>
+#include <common/benchmark.hpp>
+#include <common/memoryLedger.hpp>
+#include <common/perfCounters.hpp>
+#include <common/glCapture.hpp>
+#include <common/backend.hpp>
+#include <common/offscreenFramebuffer.hpp>
+#include <common/programCache.hpp>
+#include <common/shaderIncludes.hpp>
+#include <common/shaderRegistry.hpp>
+// shaders
+#include <shaders/shaderSources.hpp>
+// mimicOpenGL
+#include <mimicOpenGL/samples.hpp>
 
 using namespace gl;
 
@@ -42,31 +57,9 @@ static void DebugCallback(GLenum source, GLenum type, GLuint id, GLenum severity
   std::cout << message << '\n';
 }
 
-static const char *vertexShaderSource = R"GLSL(
-#version 450 core
-
-layout (location = 0) in vec3 iPosition;
-layout (location = 1) in vec3 iNormal;
-
-uniform struct Matrices {
-  mat4 ModelViewProjection;
-};
-layout (location = 2) uniform Matrices uMatrices;
-
-void main() {
-  gl_Position = uMatrices.ModelViewProjection * vec4(iPosition, 1);
-}
-)GLSL";
-
-static const char *fragmentShaderSource = R"GLSL(
-#version 450 core
-
-layout (location = 0) out vec4 oFragmentColor;
-
-void main() {
-  oFragmentColor = vec4(1, 0, 0, 1);
-}
-)GLSL";
+constexpr auto gVertexKey = gShaders.key(shaderId("ambient.vert"));
+constexpr auto gFragmentKey = gShaders.key(shaderId("ambient.frag"));
+static_assert(gVertexKey != 0 && gFragmentKey != 0, "ambient includes a missing shader source");
 
 struct Model {
   GLuint vao;
@@ -76,7 +69,17 @@ struct Model {
     { glDrawArrays(GL_TRIANGLES, 0, count); }
     glBindVertexArray(0);
   }
+  auto sourceBytes() const -> std::size_t {
+    return (mVertices.capacity() + mNormals.capacity() + mTexturesCoords.capacity()) * sizeof(float);
+  }
+  void releaseSource() {
+    gMemoryLedger.release(MemoryCategory::MESH_SOURCE, sourceBytes());
+    mVertices = {};
+    mNormals = {};
+    mTexturesCoords = {};
+  }
   GLuint count;
+  std::string mName;
   std::vector<float> mVertices;
   std::vector<float> mNormals;
   std::vector<float> mTexturesCoords;
@@ -96,6 +99,7 @@ struct Scene {
           constexpr auto VERTEX_ATTRIBUTE = 0U;
           glBindBuffer(GL_ARRAY_BUFFER, model.vbo[VERTEX_ATTRIBUTE]);
           glBufferData(GL_ARRAY_BUFFER, model.mVertices.size() * sizeof(float), model.mVertices.data(), GL_STATIC_DRAW);
+          gMemoryLedger.allocateGpu(model.mName, model.mVertices.size() * sizeof(float));
           glVertexAttribPointer(VERTEX_ATTRIBUTE, 3, GL_FLOAT, false, 0, nullptr);
           glEnableVertexAttribArray(VERTEX_ATTRIBUTE);
         }
@@ -104,11 +108,15 @@ struct Scene {
           constexpr auto NORMAL_ATTRIBUTE = 1U;
           glBindBuffer(GL_ARRAY_BUFFER, model.vbo[NORMAL_ATTRIBUTE]);
           glBufferData(GL_ARRAY_BUFFER, model.mNormals.size() * sizeof(float), model.mNormals.data(), GL_STATIC_DRAW);
+          gMemoryLedger.allocateGpu(model.mName, model.mNormals.size() * sizeof(float));
           glVertexAttribPointer(NORMAL_ATTRIBUTE, 3, GL_FLOAT, false, 0, nullptr);
           glEnableVertexAttribArray(NORMAL_ATTRIBUTE);
         }
       }
       glBindVertexArray(0);
+      if(gReleaseMeshSource) {
+        model.releaseSource();
+      }
     }
   }
 
@@ -123,6 +131,7 @@ static auto LoadMesh(const aiMesh *pMesh) -> Model {
   Model model;
   model.mVertices.resize(pMesh->mNumVertices * 3);
   model.mNormals.resize(pMesh->mNumVertices * 3);
+  gMemoryLedger.allocate(MemoryCategory::MESH_SOURCE, model.sourceBytes());
   //model.mTexturesCoords.reserve(pMesh->mNumVertices * 3);
 
   glm::vec3 *pVertex = reinterpret_cast<glm::vec3 *>(model.mVertices.data());
@@ -146,12 +155,21 @@ static auto LoadFile(const std::string &fileName) -> Scene {
     std::cerr << "Can not load \"" << fileName << "\"!\n";
     std::exit(EXIT_FAILURE);
   }
+  // The importer owns its copy of the meshes until it goes out of scope.
+  std::size_t importerBytes = 0;
+  for(auto i = 0U; i < pScene->mNumMeshes; ++i) {
+    importerBytes += pScene->mMeshes[i]->mNumVertices * 2 * sizeof(aiVector3D);
+  }
+  gMemoryLedger.allocate(MemoryCategory::TRANSIENT, importerBytes);
+
   Scene scene;
   scene.mModels.reserve(pScene->mNumMeshes);
   for(auto i = 0U; i < pScene->mNumMeshes; ++i) {
     const auto &mesh = pScene->mMeshes[i];
     scene.mModels.push_back(LoadMesh(mesh));
+    scene.mModels.back().mName = std::to_string(i) + ':' + mesh->mName.C_Str();
   }
+  gMemoryLedger.release(MemoryCategory::TRANSIENT, importerBytes);
   return scene;
 }
 
@@ -196,6 +214,7 @@ static auto createProgram(GLuint vertexShader, GLuint fragmentShader) -> GLuint
   auto program = glCreateProgram();
   glAttachShader(program, vertexShader);
   glAttachShader(program, fragmentShader);
+  glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE); // for PROGRAM_CACHE
   glLinkProgram(program);
   if(!checkProgramLinkage(program)) {
     return static_cast<std::uint32_t>(ProgramResult::FAILURE);
@@ -265,6 +284,11 @@ constexpr auto gHeight     = 480U;
 constexpr auto SDL_SUCCESS = 0;
 
 int main(int argc, char *argv[]) {
+  const auto backend = selectBackend(argc, argv);
+  if(backend == Backend::SOFTWARE) {
+    return mimic::runSample("ambient", backend, argc, argv);
+  }
+
   if(SDL_Init(SDL_INIT_VIDEO) != SDL_SUCCESS) {
     std::cerr << "Can not initialize \"" << SDL_GetError() << "\"\n";
     return EXIT_FAILURE;
@@ -280,7 +304,7 @@ int main(int argc, char *argv[]) {
   SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 5);
   SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
 
-  auto pWindow = SDL_CreateWindow(gTitle, SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, gWidth, gHeight, SDL_WINDOW_OPENGL);
+  auto pWindow = SDL_CreateWindow(gTitle, SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, gWidth, gHeight, OffscreenFramebuffer::windowFlags(backend));
   if(pWindow == nullptr) {
     std::cerr << "Can not create window \"" << SDL_GetError() << "\"\n";
     return EXIT_FAILURE;
@@ -293,105 +317,143 @@ int main(int argc, char *argv[]) {
   }
 
   glbinding::initialize(nullptr, false);
+  // Scoped so the GL objects of the demo are destroyed while its context is current.
+  {
+    OffscreenFramebuffer offscreen(backend, gWidth, gHeight);
+    GLCallStatistics callStatistics;
+    GLCapture capture;
+    PerfCounters perfCounters;
+    BenchmarkRecorder benchmark("ambient");
+    ProgramCache programCache;
+
+    // Set OpenGL Debug Callback
+    if(glDebugMessageCallback) {
+      std::cout << "Debug is enabled\n";
+      glDebugMessageCallback(DebugCallback, nullptr);
+    }
 
-  // Set OpenGL Debug Callback
-  if(glDebugMessageCallback) {
-    std::cout << "Debug is enabled\n";
-    glDebugMessageCallback(DebugCallback, nullptr);
-  }
-
-  // Enable Immediate update
-  if(SDL_GL_SetSwapInterval(static_cast<int>(SDL_GL::SYNCHRONIZED)) != SDL_SUCCESS) {
-    std::cerr << "Can not set Immediate update!\n";
-  }
-
-  Scene scene = LoadFile("sphere.obj");
-  scene.initialize();
+    // Enable Immediate update
+    if(SDL_GL_SetSwapInterval(benchmark.swapInterval(static_cast<int>(SDL_GL::SYNCHRONIZED))) != SDL_SUCCESS) {
+      std::cerr << "Can not set Immediate update!\n";
+    }
 
-  GLuint program = 0U;
-  {
-    auto vertexShader = createShader(GL_VERTEX_SHADER, vertexShaderSource);
-    auto fragmentShader = createShader(GL_FRAGMENT_SHADER, fragmentShaderSource);
-    if(vertexShader == static_cast<std::uint32_t>(ShaderResult::FAILURE) ||
-       fragmentShader == static_cast<std::uint32_t>(ShaderResult::FAILURE)) {
+    benchmark.beginLoad();
+    Scene scene = LoadFile("sphere.obj");
+    scene.initialize();
+
+    const GLuint program = programCache.program({gVertexKey, gFragmentKey}, {}, [] {
+      ShaderIncludes includes;
+      gShaders.add(includes);
+      auto vertexShader = createShader(GL_VERTEX_SHADER, includes.expand("ambient.vert").source.c_str());
+      auto fragmentShader = createShader(GL_FRAGMENT_SHADER, includes.expand("ambient.frag").source.c_str());
+      if(vertexShader == static_cast<std::uint32_t>(ShaderResult::FAILURE) ||
+         fragmentShader == static_cast<std::uint32_t>(ShaderResult::FAILURE)) {
+        return static_cast<std::uint32_t>(ProgramResult::FAILURE);
+      }
+      const auto linked = createProgram(vertexShader, fragmentShader);
+      glDeleteShader(vertexShader);
+      glDeleteShader(fragmentShader);
+      return linked;
+    });
+    if(program == static_cast<std::uint32_t>(ProgramResult::FAILURE)) {
       return EXIT_FAILURE;
     }
-    program = createProgram(vertexShader, fragmentShader);
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
-  }
 
-  const auto ratio       = static_cast<float>(gWidth) / static_cast<float>(gHeight);
-  const auto prespective = glm::perspective(45.F, ratio, 0.001F, 1000.F);
-  const auto view        = glm::lookAt(glm::vec3{2, 2, 2}, glm::vec3{}, glm::vec3{0, 1, 0});
+    const auto ratio       = static_cast<float>(gWidth) / static_cast<float>(gHeight);
+    const auto prespective = glm::perspective(45.F, ratio, 0.001F, 1000.F);
+    const auto view        = glm::lookAt(glm::vec3{2, 2, 2}, glm::vec3{}, glm::vec3{0, 1, 0});
 
-  const auto MVP = prespective * view;
+    const auto MVP = prespective * view;
 
-  const auto N = glm::mat3(glm::vec3(view[0]), glm::vec3(view[1]), glm::vec3(view[2]));
+    const auto N = glm::mat3(glm::vec3(view[0]), glm::vec3(view[1]), glm::vec3(view[2]));
 
-  auto locationMatrialAmbient              = glGetUniformLocation(program, "uMaterial.Ambient");
-  auto locationMatrialDiffuse              = glGetUniformLocation(program, "uMaterial.Diffuse");
-  auto locationMatrialSpecular             = glGetUniformLocation(program, "uMaterial.Specular");
-  auto locationMatrialShinness             = glGetUniformLocation(program, "uMaterial.Shininess");
+    auto locationMatrialAmbient              = glGetUniformLocation(program, "uMaterial.Ambient");
+    auto locationMatrialDiffuse              = glGetUniformLocation(program, "uMaterial.Diffuse");
+    auto locationMatrialSpecular             = glGetUniformLocation(program, "uMaterial.Specular");
+    auto locationMatrialShinness             = glGetUniformLocation(program, "uMaterial.Shininess");
 
-  auto locationLightPos                    = glGetUniformLocation(program, "uLight.Position");
-  auto locationLightAmbient                = glGetUniformLocation(program, "uLight.Ambient");
-  auto locationLightDiffuse                = glGetUniformLocation(program, "uLight.Diffuse");
-  auto locationLightSpecular               = glGetUniformLocation(program, "uLight.Specular");
+    auto locationLightPos                    = glGetUniformLocation(program, "uLight.Position");
+    auto locationLightAmbient                = glGetUniformLocation(program, "uLight.Ambient");
+    auto locationLightDiffuse                = glGetUniformLocation(program, "uLight.Diffuse");
+    auto locationLightSpecular               = glGetUniformLocation(program, "uLight.Specular");
 
-  auto locationMatricesNormal              = glGetUniformLocation(program, "uMatrices.Normal");
-  auto locationMatricesModelView           = glGetUniformLocation(program, "uMatrices.ModelView");
-  auto locationMatricesModelViewProjection = glGetUniformLocation(program, "uMatrices.ModelViewProjection");
+    auto locationMatricesNormal              = glGetUniformLocation(program, "uMatrices.Normal");
+    auto locationMatricesModelView           = glGetUniformLocation(program, "uMatrices.ModelView");
+    auto locationMatricesModelViewProjection = glGetUniformLocation(program, "uMatrices.ModelViewProjection");
 
-  Timer<TimerType::CPU> cpuTimer;
-  Timer<TimerType::GPU> gpuTimer;
+    benchmark.endLoad();
 
-  glEnable(GL_DEPTH_TEST);
-  glDepthFunc(GL_LESS);
+    Timer<TimerType::CPU> cpuTimer;
+    Timer<TimerType::GPU> gpuTimer;
 
-  bool bRunning = true;
-  while(bRunning) {
-    SDL_Event event;
-    while(SDL_PollEvent(&event) != 0) {
-      if(event.type == SDL_QUIT) {
-        bRunning = false;
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LESS);
+
+    bool bRunning = true;
+    while(bRunning) {
+      perfCounters.begin(FramePhase::EVENT_POLL);
+      SDL_Event event;
+      while(SDL_PollEvent(&event) != 0) {
+        if(event.type == SDL_QUIT) {
+          bRunning = false;
+        }
+        if(event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_m) {
+          gMemoryLedger.report(std::cout);
+        }
       }
-    }
-    cpuTimer.start();
-    gpuTimer.start();
+      perfCounters.begin(FramePhase::SCENE_UPDATE);
+      callStatistics.beginFrame();
+      benchmark.beginFrame();
+      cpuTimer.start();
+      gpuTimer.start();
 
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+      glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    glUseProgram(program);
-    {
-      glUniform3fv(locationMatrialAmbient, 1, glm::value_ptr(glm::vec3(0.1, 0.1, 0.1)));
-      glUniform3fv(locationMatrialDiffuse, 1, glm::value_ptr(glm::vec3(1, 0, 0)));
-      glUniform3fv(locationMatrialSpecular, 1, glm::value_ptr(glm::vec3(1, 1, 1)));
-      glUniform1f(locationMatrialShinness, 1);
+      glUseProgram(program);
+      {
+        glUniform3fv(locationMatrialAmbient, 1, glm::value_ptr(glm::vec3(0.1, 0.1, 0.1)));
+        glUniform3fv(locationMatrialDiffuse, 1, glm::value_ptr(glm::vec3(1, 0, 0)));
+        glUniform3fv(locationMatrialSpecular, 1, glm::value_ptr(glm::vec3(1, 1, 1)));
+        glUniform1f(locationMatrialShinness, 1);
 
-      glUniform3fv(locationLightAmbient,   1, glm::value_ptr(glm::vec3(0.1, 0.1, 0.1)));
-      glUniform3fv(locationLightDiffuse,   1, glm::value_ptr(glm::vec3(1, 1, 1)));
-      glUniform3fv(locationLightSpecular,  1, glm::value_ptr(glm::vec3(1, 1, 1)));
+        glUniform3fv(locationLightAmbient,   1, glm::value_ptr(glm::vec3(0.1, 0.1, 0.1)));
+        glUniform3fv(locationLightDiffuse,   1, glm::value_ptr(glm::vec3(1, 1, 1)));
+        glUniform3fv(locationLightSpecular,  1, glm::value_ptr(glm::vec3(1, 1, 1)));
 
-      glUniform4fv(locationLightPos,       1, glm::value_ptr(glm::vec4(10, 10, 10, 1)));
+        glUniform4fv(locationLightPos,       1, glm::value_ptr(glm::vec4(10, 10, 10, 1)));
 
-      glUniformMatrix3fv(locationMatricesNormal,              1, GL_FALSE, glm::value_ptr(N));
-      glUniformMatrix4fv(locationMatricesModelView,           1, GL_FALSE, glm::value_ptr(view));
-      glUniformMatrix4fv(locationMatricesModelViewProjection, 1, GL_FALSE, glm::value_ptr(MVP));
+        glUniformMatrix3fv(locationMatricesNormal,              1, GL_FALSE, glm::value_ptr(N));
+        glUniformMatrix4fv(locationMatricesModelView,           1, GL_FALSE, glm::value_ptr(view));
+        glUniformMatrix4fv(locationMatricesModelViewProjection, 1, GL_FALSE, glm::value_ptr(MVP));
 
-      scene.draw();
+        perfCounters.begin(FramePhase::SUBMISSION);
+        scene.draw();
+      }
+      glUseProgram(0);
+
+      perfCounters.begin(FramePhase::SWAP);
+      offscreen.swap(pWindow);
+      capture.frame();
+      perfCounters.endFrame();
+
+      const float cpuTime = static_cast<float>(cpuTimer.stop());
+      const float gpuTime = static_cast<float>(gpuTimer.stop());
+      printf("\rCPU: FPS: %.3F, Time: %.3F, GPU: FPS: %.3F, Time: %.3F",
+             static_cast<double>(1000.F / cpuTime),
+             static_cast<double>(cpuTime),
+             static_cast<double>(1000.F / gpuTime),
+             static_cast<double>(gpuTime));
+      callStatistics.endFrame();
+      benchmark.endFrame();
+      if(benchmark.finished() || offscreen.finished()) {
+        bRunning = false;
+      }
+    }
+    callStatistics.report(std::cout);
+    perfCounters.report(std::cout);
+    if(gMemoryReport) {
+      gMemoryLedger.report(std::cout);
     }
-    glUseProgram(0);
-
-    SDL_GL_SwapWindow(pWindow);
-
-    const float cpuTime = static_cast<float>(cpuTimer.stop());
-    const float gpuTime = static_cast<float>(gpuTimer.stop());
-    printf("\rCPU: FPS: %.3F, Time: %.3F, GPU: FPS: %.3F, Time: %.3F",
-           static_cast<double>(1000.F / cpuTime),
-           static_cast<double>(cpuTime),
-           static_cast<double>(1000.F / gpuTime),
-           static_cast<double>(gpuTime));
   }
 
   SDL_GL_DeleteContext(context);
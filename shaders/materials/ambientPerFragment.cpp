@@ -18,12 +18,23 @@
 #include <assimp/scene.h>
 //#include <assimp/Defines.h>
 #include <assimp/Importer.hpp>
+// common
+#include <common/glCallStatistics.hpp>
+#include <common/benchmark.hpp>
+#include <common/memoryLedger.hpp>
+#include <common/perfCounters.hpp>
+#include <common/glCapture.hpp>
+#include <common/backend.hpp>
+#include <common/offscreenFramebuffer.hpp>
+#include <common/programCache.hpp>
+// mimicOpenGL
+#include <mimicOpenGL/samples.hpp>
+// materials
+#include <shaders/materials/materialShader.hpp>
 
 using namespace gl;
 
 enum GL3D { SUCCESS = 0 };
-enum class ShaderResult : std::uint32_t { FAILURE = std::numeric_limits<std::uint32_t>::max() };
-enum class ProgramResult : std::uint32_t { FAILURE = std::numeric_limits<std::uint32_t>::max() };
 enum class SDL_GL : int { ADAPTIVE_VSYNC = -1, IMMEDIATE = 0, SYNCHRONIZED = 1 };
 
 static void DebugCallback(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar *message, const GLvoid *pUserParam) {
@@ -43,38 +54,6 @@ static void DebugCallback(GLenum source, GLenum type, GLuint id, GLenum severity
   std::cout << message << '\n';
 }
 
-static const char *vertexShaderSource = R"GLSL(
-#version 330 core
-
-layout (location = 0) in vec3 iPosition;
-
-struct Matrices {
-mat4 ModelViewProjection;
-};
-uniform Matrices uMatrices;
-
-out vec3 oPosition;
-
-void main() {
-  gl_Position = uMatrices.ModelViewProjection * vec4(iPosition, 1);
-}
-)GLSL";
-
-static const char *fragmentShaderSource = R"GLSL(
-#version 330 core
-
-struct Material {
-vec3 Ambient;
-};
-uniform Material uMatrial;
-
-layout (location = 0) out vec4 oColor;
-
-void main() {
-  oColor = vec4(uMatrial.Ambient, 1.0);
-}
-)GLSL";
-
 struct Model {
   GLuint vao;
   GLuint vbo[3];
@@ -83,7 +62,17 @@ struct Model {
     { glDrawArrays(GL_TRIANGLES, 0, count); }
     glBindVertexArray(0);
   }
+  auto sourceBytes() const -> std::size_t {
+    return (mVertices.capacity() + mNormals.capacity() + mTexturesCoords.capacity()) * sizeof(float);
+  }
+  void releaseSource() {
+    gMemoryLedger.release(MemoryCategory::MESH_SOURCE, sourceBytes());
+    mVertices = {};
+    mNormals = {};
+    mTexturesCoords = {};
+  }
   GLuint count;
+  std::string mName;
   std::vector<float> mVertices;
   std::vector<float> mNormals;
   std::vector<float> mTexturesCoords;
@@ -103,6 +92,7 @@ struct Scene {
           constexpr auto VERTEX_ATTRIBUTE = 0U;
           glBindBuffer(GL_ARRAY_BUFFER, model.vbo[VERTEX_ATTRIBUTE]);
           glBufferData(GL_ARRAY_BUFFER, model.mVertices.size() * sizeof(float), model.mVertices.data(), GL_STATIC_DRAW);
+          gMemoryLedger.allocateGpu(model.mName, model.mVertices.size() * sizeof(float));
           glVertexAttribPointer(VERTEX_ATTRIBUTE, 3, GL_FLOAT, false, 0, nullptr);
           glEnableVertexAttribArray(VERTEX_ATTRIBUTE);
         }
@@ -111,11 +101,15 @@ struct Scene {
           constexpr auto NORMAL_ATTRIBUTE = 1U;
           glBindBuffer(GL_ARRAY_BUFFER, model.vbo[NORMAL_ATTRIBUTE]);
           glBufferData(GL_ARRAY_BUFFER, model.mNormals.size() * sizeof(float), model.mNormals.data(), GL_STATIC_DRAW);
+          gMemoryLedger.allocateGpu(model.mName, model.mNormals.size() * sizeof(float));
           glVertexAttribPointer(NORMAL_ATTRIBUTE, 3, GL_FLOAT, false, 0, nullptr);
           glEnableVertexAttribArray(NORMAL_ATTRIBUTE);
         }
       }
       glBindVertexArray(0);
+      if(gReleaseMeshSource) {
+        model.releaseSource();
+      }
     }
   }
 
@@ -130,6 +124,7 @@ static auto LoadMesh(const aiMesh *pMesh) -> Model {
   Model model;
   model.mVertices.resize(pMesh->mNumVertices * 3);
   model.mNormals.resize(pMesh->mNumVertices * 3);
+  gMemoryLedger.allocate(MemoryCategory::MESH_SOURCE, model.sourceBytes());
   //model.mTexturesCoords.reserve(pMesh->mNumVertices * 3);
 
   glm::vec3 *pVertex = reinterpret_cast<glm::vec3 *>(model.mVertices.data());
@@ -153,64 +148,24 @@ static auto LoadFile(const std::string &fileName) -> Scene {
     std::cerr << "Can not load \"" << fileName << "\"!\n";
     std::exit(EXIT_FAILURE);
   }
+  // The importer owns its copy of the meshes until it goes out of scope.
+  std::size_t importerBytes = 0;
+  for(auto i = 0U; i < pScene->mNumMeshes; ++i) {
+    importerBytes += pScene->mMeshes[i]->mNumVertices * 2 * sizeof(aiVector3D);
+  }
+  gMemoryLedger.allocate(MemoryCategory::TRANSIENT, importerBytes);
+
   Scene scene;
   scene.mModels.reserve(pScene->mNumMeshes);
   for(auto i = 0U; i < pScene->mNumMeshes; ++i) {
     const auto &mesh = pScene->mMeshes[i];
     scene.mModels.push_back(LoadMesh(mesh));
+    scene.mModels.back().mName = std::to_string(i) + ':' + mesh->mName.C_Str();
   }
+  gMemoryLedger.release(MemoryCategory::TRANSIENT, importerBytes);
   return scene;
 }
 
-static auto checkShaderCompilation(GLuint shader) -> bool {
-  GLint compiled;
-  glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
-  if(compiled != 1) {
-    GLsizei log_length = 0;
-    GLchar message[1024];
-    glGetShaderInfoLog(shader, 1024, &log_length, message);
-    std::cerr << "ERROR: " << message << '\n';
-    return false;
-  }
-  return true;
-}
-
-static auto createShader(GLenum shaderType, const char *shaderSource) -> GLuint {
-  auto shader = glCreateShader(shaderType);
-  auto vertexShaderSourcePtr = &shaderSource;
-  glShaderSource(shader, 1, vertexShaderSourcePtr, nullptr);
-  glCompileShader(shader);
-  if(!checkShaderCompilation(shader)) {
-    return static_cast<std::uint32_t>(ShaderResult::FAILURE);
-  }
-  return shader;
-}
-
-static auto checkProgramLinkage(GLuint program) -> bool {
-  GLint program_linked;
-  glGetProgramiv(program, GL_LINK_STATUS, &program_linked);
-  if(program_linked != 1) {
-    GLsizei log_length = 0;
-    GLchar message[1024];
-    glGetProgramInfoLog(program, 1024, &log_length, message);
-    std::cerr << "ERROR: " << message << '\n';
-    return false;
-  }
-  return true;
-}
-
-static auto createProgram(GLuint vertexShader, GLuint fragmentShader) -> GLuint {
-  auto program = glCreateProgram();
-  glAttachShader(program, vertexShader);
-  glAttachShader(program, fragmentShader);
-  glLinkProgram(program);
-  if(!checkProgramLinkage(program)) {
-    return static_cast<std::uint32_t>(ProgramResult::FAILURE);
-  }
-
-  return program;
-}
-
 enum class TimerType { CPU, GPU };
 
 template<TimerType Type>
@@ -272,6 +227,11 @@ constexpr auto gHeight = 480U;
 constexpr auto SDL_SUCCESS = 0;
 
 int main(int argc, char *argv[]) {
+  const auto backend = selectBackend(argc, argv);
+  if(backend == Backend::SOFTWARE) {
+    return mimic::runSample("ambientPerFragment", backend, argc, argv);
+  }
+
   if(SDL_Init(SDL_INIT_VIDEO) != SDL_SUCCESS) {
     std::cerr << "Can not initialize \"" << SDL_GetError() << "\"\n";
     return EXIT_FAILURE;
@@ -287,7 +247,7 @@ int main(int argc, char *argv[]) {
   SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 5);
   SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
 
-  auto pWindow = SDL_CreateWindow(gTitle, SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, gWidth, gHeight, SDL_WINDOW_OPENGL);
+  auto pWindow = SDL_CreateWindow(gTitle, SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, gWidth, gHeight, OffscreenFramebuffer::windowFlags(backend));
   if(pWindow == nullptr) {
     std::cerr << "Can not create window \"" << SDL_GetError() << "\"\n";
     return EXIT_FAILURE;
@@ -300,82 +260,106 @@ int main(int argc, char *argv[]) {
   }
 
   glbinding::initialize(nullptr, false);
+  // Scoped so the GL objects of the demo are destroyed while its context is current.
+  {
+    OffscreenFramebuffer offscreen(backend, gWidth, gHeight);
+    GLCallStatistics callStatistics;
+    GLCapture capture;
+    PerfCounters perfCounters;
+    BenchmarkRecorder benchmark("ambientPerFragment");
+    ProgramCache programCache;
+
+    // Set OpenGL Debug Callback
+    if(glDebugMessageCallback) {
+      std::cout << "Debug is enabled\n";
+      glDebugMessageCallback(DebugCallback, nullptr);
+    }
 
-  // Set OpenGL Debug Callback
-  if(glDebugMessageCallback) {
-    std::cout << "Debug is enabled\n";
-    glDebugMessageCallback(DebugCallback, nullptr);
-  }
-
-  // Enable Immediate update
-  if(SDL_GL_SetSwapInterval(static_cast<int>(SDL_GL::SYNCHRONIZED)) != SDL_SUCCESS) {
-    std::cerr << "Can not set Immediate update!\n";
-  }
+    // Enable Immediate update
+    if(SDL_GL_SetSwapInterval(benchmark.swapInterval(static_cast<int>(SDL_GL::SYNCHRONIZED))) != SDL_SUCCESS) {
+      std::cerr << "Can not set Immediate update!\n";
+    }
 
-  Scene scene = LoadFile("sphere.obj");
-  scene.initialize();
+    benchmark.beginLoad();
+    Scene scene = LoadFile("sphere.obj");
+    scene.initialize();
 
-  GLuint program = 0U;
-  {
-    auto vertexShader = createShader(GL_VERTEX_SHADER, vertexShaderSource);
-    auto fragmentShader = createShader(GL_FRAGMENT_SHADER, fragmentShaderSource);
-    if(vertexShader == static_cast<std::uint32_t>(ShaderResult::FAILURE) ||
-       fragmentShader == static_cast<std::uint32_t>(ShaderResult::FAILURE)) {
+    MaterialShader materialShader(programCache);
+    Material material;
+    material.ambient      = glm::vec3(0.2F);
+    material.bPerFragment = true;
+    const Light light;
+    if(!materialShader.prepare(material)) {
       return EXIT_FAILURE;
     }
-    program = createProgram(vertexShader, fragmentShader);
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
-  }
 
-  const auto ratio       = static_cast<float>(gWidth) / static_cast<float>(gHeight);
-  const auto prespective = glm::perspective(45.F, ratio, 0.001F, 1000.F);
-  const auto view        = glm::lookAt(glm::vec3{2, 2, 2}, glm::vec3{}, glm::vec3{0, 1, 0});
+    const auto ratio       = static_cast<float>(gWidth) / static_cast<float>(gHeight);
+    const auto prespective = glm::perspective(45.F, ratio, 0.001F, 1000.F);
+    const auto view        = glm::lookAt(glm::vec3{2, 2, 2}, glm::vec3{}, glm::vec3{0, 1, 0});
 
-  const auto MVP = prespective * view;
+    const auto MVP = prespective * view;
 
-  const auto N = glm::mat3(glm::vec3(view[0]), glm::vec3(view[1]), glm::vec3(view[2]));
+    const auto N = glm::mat3(glm::vec3(view[0]), glm::vec3(view[1]), glm::vec3(view[2]));
 
-  auto locationMatrialAmbient              = glGetUniformLocation(program, "uMatrial.Ambient");
-  auto locationMatricesModelViewProjection = glGetUniformLocation(program, "uMatrices.ModelViewProjection");
+    const Matrices matrices{N, view, MVP};
 
-  Timer<TimerType::CPU> cpuTimer;
-  Timer<TimerType::GPU> gpuTimer;
+    benchmark.endLoad();
 
-  glEnable(GL_DEPTH_TEST);
-  glDepthFunc(GL_LESS);
+    Timer<TimerType::CPU> cpuTimer;
+    Timer<TimerType::GPU> gpuTimer;
 
-  bool bRunning = true;
-  while(bRunning) {
-    SDL_Event event;
-    while(SDL_PollEvent(&event) != 0) {
-      if(event.type == SDL_QUIT) {
-        bRunning = false;
-      }
-    }
-    cpuTimer.start();
-    gpuTimer.start();
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LESS);
 
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    bool bRunning = true;
+    while(bRunning) {
+      perfCounters.begin(FramePhase::EVENT_POLL);
+      SDL_Event event;
+      while(SDL_PollEvent(&event) != 0) {
+        if(event.type == SDL_QUIT) {
+          bRunning = false;
+        }
+        if(event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_m) {
+          gMemoryLedger.report(std::cout);
+        }
+      }
+      perfCounters.begin(FramePhase::SCENE_UPDATE);
+      callStatistics.beginFrame();
+      benchmark.beginFrame();
+      cpuTimer.start();
+      gpuTimer.start();
 
-    glUseProgram(program);
-    {
-      glUniform3fv(locationMatrialAmbient,                    1, glm::value_ptr(glm::vec3(0.2, 0.2, 0.2)));
-      glUniformMatrix4fv(locationMatricesModelViewProjection, 1, GL_FALSE, glm::value_ptr(MVP));
+      glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+      materialShader.use(material, light, matrices);
+      perfCounters.begin(FramePhase::SUBMISSION);
       scene.draw();
+      materialShader.end();
+
+      perfCounters.begin(FramePhase::SWAP);
+      offscreen.swap(pWindow);
+      capture.frame();
+      perfCounters.endFrame();
+
+      const float cpuTime = static_cast<float>(cpuTimer.stop());
+      const float gpuTime = static_cast<float>(gpuTimer.stop());
+      printf("\rCPU: FPS: %.3F, Time: %.3F, GPU: FPS: %.3F, Time: %.3F",
+             static_cast<double>(1000.F / cpuTime),
+             static_cast<double>(cpuTime),
+             static_cast<double>(1000.F / gpuTime),
+             static_cast<double>(gpuTime));
+      callStatistics.endFrame();
+      benchmark.endFrame();
+      if(benchmark.finished() || offscreen.finished()) {
+        bRunning = false;
+      }
+    }
+    callStatistics.report(std::cout);
+    perfCounters.report(std::cout);
+    materialShader.report(std::cout);
+    if(gMemoryReport) {
+      gMemoryLedger.report(std::cout);
     }
-    glUseProgram(0);
-
-    SDL_GL_SwapWindow(pWindow);
-
-    const float cpuTime = static_cast<float>(cpuTimer.stop());
-    const float gpuTime = static_cast<float>(gpuTimer.stop());
-    printf("\rCPU: FPS: %.3F, Time: %.3F, GPU: FPS: %.3F, Time: %.3F",
-           static_cast<double>(1000.F / cpuTime),
-           static_cast<double>(cpuTime),
-           static_cast<double>(1000.F / gpuTime),
-           static_cast<double>(gpuTime));
   }
 
   SDL_GL_DeleteContext(context);
@@ -3,6 +3,7 @@
 #include <chrono>
 #include <vector>
 #include <cstdlib>
+#include <iostream>
 // glbinding
 #include <glbinding/gl/gl.h>
 #include <glbinding/glbinding.h>
@@ -19,6 +20,20 @@
 // assimp
 #include <assimp/scene.h>
 #include <assimp/Importer.hpp>
+// common
+#include <common/glCallStatistics.hpp>
+#include <common/benchmark.hpp>
+#include <common/memoryLedger.hpp>
+#include <common/perfCounters.hpp>
+#include <common/glCapture.hpp>
+#include <common/backend.hpp>
+#include <common/offscreenFramebuffer.hpp>
+#include <common/programCache.hpp>
+#include <common/shaderRegistry.hpp>
+// shaders
+#include <shaders/shaderSources.hpp>
+// mimicOpenGL
+#include <mimicOpenGL/samples.hpp>
 
 using namespace gl;
 
@@ -55,38 +70,25 @@ static void DebugCallback(GLenum source, GLenum type, GLuint id, GLenum severity
   fmt::print("{}\n", message);
 }
 
-// NOLINTNEXTLINE
-static const char *vertexShaderSource = R"GLSL(
-#version 450 core
-
-layout (location = 0) in vec4 iPosition;
-
-layout (location = 0) uniform mat4 MVP;
-
-void main() {
-  gl_Position = MVP * iPosition;
-}
-)GLSL";
-
-// NOLINTNEXTLINE
-static const char *fragmentShaderSource = R"GLSL(
-#version 450 core
-
-layout (location = 0) out vec4 oColor;
-
-void main() {
-  oColor = vec4(1.0, 0, 0, 1.0);
-}
-)GLSL";
+// No includes, the source hashes are the keys.
+constexpr const auto &gVertexShader = *gShaders.find(shaderId("loadObj.vert"));
+constexpr const auto &gFragmentShader = *gShaders.find(shaderId("loadObj.frag"));
 
 struct Model {
   GLuint vao = 0;
   GLuint vbo[3] = {}; // NOLINT
   void draw() const {
     glBindVertexArray(vao);
-    { glDrawArrays(GL_TRIANGLES, 0, static_cast<int>(mVertices.size() / 3)); }
+    { glDrawArrays(GL_TRIANGLES, 0, count); }
     glBindVertexArray(0);
   }
+  auto sourceBytes() const -> std::size_t { return mVertices.capacity() * sizeof(float); }
+  void releaseSource() {
+    gMemoryLedger.release(MemoryCategory::MESH_SOURCE, sourceBytes());
+    mVertices = {};
+  }
+  GLsizei count = 0;
+  std::string mName;
   std::vector<float> mVertices;
 };
 
@@ -95,16 +97,21 @@ struct Scene {
 
   void initialize() {
     for(auto &model : mModels) {
+      model.count = static_cast<GLsizei>(model.mVertices.size() / 3);
       glGenVertexArrays(1, &model.vao);
       glBindVertexArray(model.vao);
       {
         glGenBuffers(2, model.vbo);
         glBindBuffer(GL_ARRAY_BUFFER, model.vbo[0]);
-        glBufferData(GL_ARRAY_BUFFER, model.mVertices.size() * 3 * sizeof(float), model.mVertices.data(), GL_STATIC_DRAW);
+        glBufferData(GL_ARRAY_BUFFER, model.mVertices.size() * sizeof(float), model.mVertices.data(), GL_STATIC_DRAW);
+        gMemoryLedger.allocateGpu(model.mName, model.mVertices.size() * sizeof(float));
         glEnableVertexAttribArray(0);
         glVertexAttribPointer(0, 3, GL_FLOAT, false, 0, nullptr);
       }
       glBindVertexArray(0);
+      if(gReleaseMeshSource) {
+        model.releaseSource();
+      }
     }
   }
 
@@ -118,6 +125,7 @@ struct Scene {
 static auto LoadMesh(const aiMesh *pMesh) -> Model {
   Model model;
   model.mVertices.resize(pMesh->mNumVertices * 3);
+  gMemoryLedger.allocate(MemoryCategory::MESH_SOURCE, model.sourceBytes());
 
   auto *pVertex = reinterpret_cast<glm::vec3 *>(model.mVertices.data()); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
   for(auto i = 0U; i < pMesh->mNumVertices; i++) {
@@ -135,12 +143,21 @@ static auto LoadFile(const std::string &fileName) -> Scene {
     fmt::print(stderr, fg(fmt::color::red), "Can not load \"{}\"\n", fileName);
     std::exit(EXIT_FAILURE);
   }
+  // The importer owns its copy of the meshes until it goes out of scope.
+  std::size_t importerBytes = 0;
+  for(auto i = 0U; i < pScene->mNumMeshes; ++i) {
+    importerBytes += pScene->mMeshes[i]->mNumVertices * sizeof(aiVector3D); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+  }
+  gMemoryLedger.allocate(MemoryCategory::TRANSIENT, importerBytes);
+
   Scene scene;
   scene.mModels.reserve(pScene->mNumMeshes);
   for(auto i = 0U; i < pScene->mNumMeshes; ++i) {
     const auto &mesh = pScene->mMeshes[i]; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
     scene.mModels.push_back(LoadMesh(mesh));
+    scene.mModels.back().mName = std::to_string(i) + ':' + mesh->mName.C_Str();
   }
+  gMemoryLedger.release(MemoryCategory::TRANSIENT, importerBytes);
   return scene;
 }
 
@@ -185,6 +202,7 @@ static auto createProgram(GLuint vertexShader, GLuint fragmentShader) -> GLuint
   auto program = glCreateProgram();
   glAttachShader(program, vertexShader);
   glAttachShader(program, fragmentShader);
+  glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE); // for PROGRAM_CACHE
   glLinkProgram(program);
   if(!checkProgramLinkage(program)) {
     return static_cast<std::uint32_t>(ProgramResult::FAILURE);
@@ -247,7 +265,12 @@ struct Timer<TimerType::GPU> {
   std::array<GLuint, 2> mQueries = {};
 };
 
-int main([[maybe_unused]] int argc, [[maybe_unused]] char *argv[]) {
+int main(int argc, char *argv[]) {
+  const auto backend = selectBackend(argc, argv);
+  if(backend == Backend::SOFTWARE) {
+    return mimic::runSample("loadObj", backend, argc, argv);
+  }
+
   if(SDL_Init(SDL_INIT_VIDEO) != SDL_SUCCESS) {
     fmt::print(stderr, fg(fmt::color::red), "Can not initialize \"{}\"\n", SDL_GetError());
     return EXIT_FAILURE;
@@ -263,7 +286,7 @@ int main([[maybe_unused]] int argc, [[maybe_unused]] char *argv[]) {
   SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, gOpenGLMajorVersion);
   SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
 
-  auto *pWindow = SDL_CreateWindow(gTitle, SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, gWidth, gHeight, SDL_WINDOW_OPENGL);
+  auto *pWindow = SDL_CreateWindow(gTitle, SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, gWidth, gHeight, OffscreenFramebuffer::windowFlags(backend));
   if(pWindow == nullptr) {
     fmt::print(stderr, fg(fmt::color::red), "Can not create a window \"{}\"\n", SDL_GetError());
     return EXIT_FAILURE;
@@ -276,72 +299,108 @@ int main([[maybe_unused]] int argc, [[maybe_unused]] char *argv[]) {
   }
 
   glbinding::initialize(nullptr, false);
+  // Scoped so the GL objects of the demo are destroyed while its context is current.
+  {
+    OffscreenFramebuffer offscreen(backend, gWidth, gHeight);
+    GLCallStatistics callStatistics;
+    GLCapture capture;
+    PerfCounters perfCounters;
+    BenchmarkRecorder benchmark("loadObj");
+    ProgramCache programCache;
+
+    // Set OpenGL Debug Callback
+    glDebugMessageCallback(DebugCallback, nullptr);
+
+    // Enable Immediate update
+    if(SDL_GL_SetSwapInterval(benchmark.swapInterval(static_cast<int>(SDL_GL::SYNCHRONIZED))) != SDL_SUCCESS) {
+      fmt::print(fg(fmt::color::yellow), "Can not set Immediate update!\n");
+    }
 
-  // Set OpenGL Debug Callback
-  glDebugMessageCallback(DebugCallback, nullptr);
-
-  // Enable Immediate update
-  if(SDL_GL_SetSwapInterval(static_cast<int>(SDL_GL::SYNCHRONIZED)) != SDL_SUCCESS) {
-    fmt::print(fg(fmt::color::yellow), "Can not set Immediate update!\n");
-  }
-
-  Scene scene = LoadFile("sphere.obj");
-  scene.initialize();
+    benchmark.beginLoad();
+    Scene scene = LoadFile("sphere.obj");
+    scene.initialize();
 
-  GLuint program = 0U;
-  {
-    auto vertexShader = createShader(GL_VERTEX_SHADER, vertexShaderSource);
-    auto fragmentShader = createShader(GL_FRAGMENT_SHADER, fragmentShaderSource);
-    if(vertexShader == static_cast<std::uint32_t>(ShaderResult::FAILURE) ||
-       fragmentShader == static_cast<std::uint32_t>(ShaderResult::FAILURE)) {
+    const GLuint program = programCache.program({gVertexShader.hash, gFragmentShader.hash}, {}, [] {
+      auto vertexShader = createShader(GL_VERTEX_SHADER, gVertexShader.source.data());
+      auto fragmentShader = createShader(GL_FRAGMENT_SHADER, gFragmentShader.source.data());
+      if(vertexShader == static_cast<std::uint32_t>(ShaderResult::FAILURE) ||
+         fragmentShader == static_cast<std::uint32_t>(ShaderResult::FAILURE)) {
+        return static_cast<std::uint32_t>(ProgramResult::FAILURE);
+      }
+      const auto linked = createProgram(vertexShader, fragmentShader);
+      glDeleteShader(vertexShader);
+      glDeleteShader(fragmentShader);
+      return linked;
+    });
+    if(program == static_cast<std::uint32_t>(ProgramResult::FAILURE)) {
       return EXIT_FAILURE;
     }
-    program = createProgram(vertexShader, fragmentShader);
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
-  }
 
-  const auto ratio = static_cast<float>(gWidth) / static_cast<float>(gHeight);
-  const auto prespective = glm::perspective(45.F, ratio, 0.001F, 1000.F);
-  const auto view = glm::lookAt(glm::vec3{0, 0,-10}, glm::vec3{}, glm::vec3{0, 1, 0});
+    const auto ratio = static_cast<float>(gWidth) / static_cast<float>(gHeight);
+    const auto prespective = glm::perspective(45.F, ratio, 0.001F, 1000.F);
+    const auto view = glm::lookAt(glm::vec3{0, 0,-10}, glm::vec3{}, glm::vec3{0, 1, 0});
 
-  const auto MVP = prespective * view;
+    const auto MVP = prespective * view;
 
-  Timer<TimerType::CPU> cpuTimer;
-  Timer<TimerType::GPU> gpuTimer;
+    benchmark.endLoad();
 
-  glEnable(GL_DEPTH_TEST);
-  glDepthFunc(GL_ALWAYS);
+    Timer<TimerType::CPU> cpuTimer;
+    Timer<TimerType::GPU> gpuTimer;
 
-  bool bRunning = true;
-  while(bRunning) {
-    SDL_Event event;
-    while(SDL_PollEvent(&event) != 0) {
-      if(event.type == SDL_QUIT) {
-        bRunning = false;
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_ALWAYS);
+
+    bool bRunning = true;
+    while(bRunning) {
+      perfCounters.begin(FramePhase::EVENT_POLL);
+      SDL_Event event;
+      while(SDL_PollEvent(&event) != 0) {
+        if(event.type == SDL_QUIT) {
+          bRunning = false;
+        }
+        if(event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_m) {
+          gMemoryLedger.report(std::cout);
+        }
       }
-    }
-    cpuTimer.start();
-    gpuTimer.start();
+      perfCounters.begin(FramePhase::SCENE_UPDATE);
+      callStatistics.beginFrame();
+      benchmark.beginFrame();
+      cpuTimer.start();
+      gpuTimer.start();
 
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+      glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    glUseProgram(program);
-    {
-      glUniformMatrix4fv(0, 1, GL_FALSE, glm::value_ptr(MVP));
-      scene.draw();
+      glUseProgram(program);
+      {
+        glUniformMatrix4fv(0, 1, GL_FALSE, glm::value_ptr(MVP));
+        perfCounters.begin(FramePhase::SUBMISSION);
+        scene.draw();
+      }
+      glUseProgram(0);
+
+      perfCounters.begin(FramePhase::SWAP);
+      offscreen.swap(pWindow);
+      capture.frame();
+      perfCounters.endFrame();
+
+      const auto cpuTime = static_cast<float>(cpuTimer.stop());
+      const auto gpuTime = static_cast<float>(gpuTimer.stop());
+      fmt::print("\rCPU: FPS: {:.2f}, Time: {:.2f}, GPU: FPS: {:.2f}, Time: {:.2f}",
+             static_cast<double>(gMilisecond / cpuTime),
+             static_cast<double>(cpuTime),
+             static_cast<double>(gMilisecond / gpuTime),
+             static_cast<double>(gpuTime));
+      callStatistics.endFrame();
+      benchmark.endFrame();
+      if(benchmark.finished() || offscreen.finished()) {
+        bRunning = false;
+      }
+    }
+    callStatistics.report(std::cout);
+    perfCounters.report(std::cout);
+    if(gMemoryReport) {
+      gMemoryLedger.report(std::cout);
     }
-    glUseProgram(0);
-
-    SDL_GL_SwapWindow(pWindow);
-
-    const auto cpuTime = static_cast<float>(cpuTimer.stop());
-    const auto gpuTime = static_cast<float>(gpuTimer.stop());
-    fmt::print("\rCPU: FPS: {:.2f}, Time: {:.2f}, GPU: FPS: {:.2f}, Time: {:.2f}",
-           static_cast<double>(gMilisecond / cpuTime),
-           static_cast<double>(cpuTime),
-           static_cast<double>(gMilisecond / gpuTime),
-           static_cast<double>(gpuTime));
   }
 
   SDL_GL_DeleteContext(context);
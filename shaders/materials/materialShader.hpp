@@ -0,0 +1,242 @@
+#pragma once
+// STL
+#include <array>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <iostream>
+#include <unordered_map>
+// glbinding
+#include <glbinding/gl/gl.h>
+// GLM
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/matrix.hpp>
+#include <glm/mat3x4.hpp>
+// common
+#include <common/memoryLedger.hpp>
+#include <common/programCache.hpp>
+#include <common/programReflection.hpp>
+#include <common/shaderPermutations.hpp>
+#include <common/shaderIncludes.hpp>
+#include <common/shaderRegistry.hpp>
+// shaders
+#include <shaders/shaderSources.hpp>
+
+struct Material {
+  glm::vec3 ambient{0};
+  glm::vec3 diffuse{0};
+  glm::vec3 specular{0};
+  float shininess = 1;
+  bool bPerFragment = false;
+};
+
+struct Light {
+  glm::vec4 position{0, 0, 0, 1}; // eye space
+  glm::vec3 ambient{1};
+  glm::vec3 diffuse{1};
+  glm::vec3 specular{1};
+};
+
+struct Matrices {
+  glm::mat3 normal;
+  glm::mat4 modelView;
+  glm::mat4 modelViewProjection;
+};
+
+// std140 mirror of the Shading block, every vec3 padded to a vec4 and the mat3 stored as three vec4 columns.
+struct MatricesBlock {
+  glm::mat3x4 normal;
+  glm::mat4 modelView;
+  glm::mat4 modelViewProjection;
+};
+
+struct LightBlock {
+  glm::vec4 position;
+  glm::vec3 ambient;
+  float pad0;
+  glm::vec3 diffuse;
+  float pad1;
+  glm::vec3 specular;
+  float pad2;
+};
+
+struct MaterialBlock {
+  glm::vec3 ambient;
+  float pad0;
+  glm::vec3 diffuse;
+  float pad1;
+  glm::vec3 specular;
+  float shininess; // a float after a vec3 takes its fourth component
+};
+
+struct ShadingBlock {
+  MatricesBlock matrices;
+  LightBlock light;
+  MaterialBlock material;
+};
+
+static_assert(offsetof(MatricesBlock, modelView) == std140Offset(offsetof(MatricesBlock, normal) + 3 * 16, 16));
+static_assert(offsetof(MatricesBlock, modelViewProjection) == std140Offset(offsetof(MatricesBlock, modelView) + 64, 16));
+static_assert(sizeof(MatricesBlock) == std140Offset(offsetof(MatricesBlock, modelViewProjection) + 64, 16));
+static_assert(offsetof(LightBlock, ambient) == std140Offset(offsetof(LightBlock, position) + 16, 16));
+static_assert(offsetof(LightBlock, diffuse) == std140Offset(offsetof(LightBlock, ambient) + 12, 16));
+static_assert(offsetof(LightBlock, specular) == std140Offset(offsetof(LightBlock, diffuse) + 12, 16));
+static_assert(sizeof(LightBlock) == std140Offset(offsetof(LightBlock, specular) + 12, 16));
+static_assert(offsetof(MaterialBlock, diffuse) == std140Offset(offsetof(MaterialBlock, ambient) + 12, 16));
+static_assert(offsetof(MaterialBlock, specular) == std140Offset(offsetof(MaterialBlock, diffuse) + 12, 16));
+static_assert(offsetof(MaterialBlock, shininess) == std140Offset(offsetof(MaterialBlock, specular) + 12, 4));
+static_assert(sizeof(MaterialBlock) == std140Offset(offsetof(MaterialBlock, shininess) + 4, 16));
+static_assert(offsetof(ShadingBlock, light) == std140Offset(sizeof(MatricesBlock), 16));
+static_assert(offsetof(ShadingBlock, material) == std140Offset(offsetof(ShadingBlock, light) + sizeof(LightBlock), 16));
+
+// Checked against the reflection of every variant when it is built.
+inline constexpr std::array<ProgramReflection::Member, 11> gShadingMembers = {{
+  {"uMatrices.Normal", offsetof(ShadingBlock, matrices) + offsetof(MatricesBlock, normal)},
+  {"uMatrices.ModelView", offsetof(ShadingBlock, matrices) + offsetof(MatricesBlock, modelView)},
+  {"uMatrices.ModelViewProjection", offsetof(ShadingBlock, matrices) + offsetof(MatricesBlock, modelViewProjection)},
+  {"uLight.Position", offsetof(ShadingBlock, light) + offsetof(LightBlock, position)},
+  {"uLight.Ambient", offsetof(ShadingBlock, light) + offsetof(LightBlock, ambient)},
+  {"uLight.Diffuse", offsetof(ShadingBlock, light) + offsetof(LightBlock, diffuse)},
+  {"uLight.Specular", offsetof(ShadingBlock, light) + offsetof(LightBlock, specular)},
+  {"uMaterial.Ambient", offsetof(ShadingBlock, material) + offsetof(MaterialBlock, ambient)},
+  {"uMaterial.Diffuse", offsetof(ShadingBlock, material) + offsetof(MaterialBlock, diffuse)},
+  {"uMaterial.Specular", offsetof(ShadingBlock, material) + offsetof(MaterialBlock, specular)},
+  {"uMaterial.Shininess", offsetof(ShadingBlock, material) + offsetof(MaterialBlock, shininess)},
+}};
+
+// Draws materials with the cheapest variant of the material shader that renders them: terms with a zero coefficient are
+// not compiled in, and a material without diffuse and specular terms is flat, so it is lit per vertex even when it asks
+// for per fragment lighting. Variants are compiled on first use, prepare() compiles them while loading. A variant whose
+// Shading block does not match ShadingBlock fails to build.
+class MaterialShader final {
+public:
+  // The bits of a variant key, every one defines the macro of the same name.
+  enum Feature : std::uint32_t {
+    AMBIENT = 1U << 0U,
+    DIFFUSE = 1U << 1U,
+    SPECULAR = 1U << 2U,
+    PER_FRAGMENT = 1U << 3U // lighting per fragment instead of per vertex
+  };
+
+  // The variants found in the program cache are loaded without expanding or even reading the sources.
+  explicit MaterialShader(ProgramCache &programCache)
+    : mPermutations(gName, gVertexKey, gFragmentKey, source, features(), programCache) {}
+
+  MaterialShader(const MaterialShader &) = delete;
+  MaterialShader &operator=(const MaterialShader &) = delete;
+
+  // The file names of the variants start with it, see ShaderPermutations::fileName().
+  static constexpr auto gName = "material";
+
+  // The macros of the Feature bits, in order.
+  [[nodiscard]] static auto features() -> std::vector<std::string> {
+    return {"AMBIENT", "DIFFUSE", "SPECULAR", "PER_FRAGMENT"};
+  }
+
+  // The source of a stage with every feature and its includes expanded, the variants insert their defines after its
+  // #version line. Also exported by the build for glslang, with ENABLE_SPIRV.
+  [[nodiscard]] static auto source(gl::GLenum type) -> const std::string & {
+    return includes().expand(type == gl::GL_VERTEX_SHADER ? "material.vert" : "material.frag").source;
+  }
+
+  [[nodiscard]] static auto features(const Material &material) -> std::uint32_t {
+    const auto nonZero = [](const glm::vec3 &color) { return color != glm::vec3(0); };
+    std::uint32_t features = 0;
+    features |= nonZero(material.ambient) ? AMBIENT : 0U;
+    features |= nonZero(material.diffuse) ? DIFFUSE : 0U;
+    features |= nonZero(material.specular) ? SPECULAR : 0U;
+    if(material.bPerFragment && (features & (DIFFUSE | SPECULAR)) != 0) {
+      features |= PER_FRAGMENT;
+    }
+    return features;
+  }
+
+  // The contents of the Shading block.
+  [[nodiscard]] static auto shading(const Material &material, const Light &light, const Matrices &matrices) -> ShadingBlock {
+    ShadingBlock block{};
+    block.matrices.normal = glm::mat3x4(matrices.normal);
+    block.matrices.modelView = matrices.modelView;
+    block.matrices.modelViewProjection = matrices.modelViewProjection;
+    block.light.position = light.position;
+    block.light.ambient = light.ambient;
+    block.light.diffuse = light.diffuse;
+    block.light.specular = light.specular;
+    block.material.ambient = material.ambient;
+    block.material.diffuse = material.diffuse;
+    block.material.specular = material.specular;
+    block.material.shininess = material.shininess;
+    return block;
+  }
+
+  // Compiles the variant of the material, false when it fails.
+  auto prepare(const Material &material) -> bool { return program(features(material)) != 0; }
+
+  // Binds the variant of the material and copies the shading state into the uniform buffer, draw and call end().
+  void use(const Material &material, const Light &light, const Matrices &matrices) {
+    const auto key = features(material);
+    gl::glUseProgram(program(key));
+    const auto block = shading(material, light, matrices);
+    gl::glBindBuffer(gl::GL_UNIFORM_BUFFER, mUniformBuffer);
+    gl::glBufferSubData(gl::GL_UNIFORM_BUFFER, 0, sizeof(block), &block);
+    gl::glBindBuffer(gl::GL_UNIFORM_BUFFER, 0);
+    gl::glBindBufferBase(gl::GL_UNIFORM_BUFFER, gShadingBinding, mUniformBuffer);
+    mPermutations.beginTiming(key);
+  }
+
+  void end() {
+    mPermutations.endTiming();
+    gl::glUseProgram(0);
+  }
+
+  void report(std::ostream &output) { mPermutations.report(output); }
+
+private:
+  static constexpr gl::GLuint gShadingBinding = 0;
+  static constexpr auto gVertexKey = gShaders.key(shaderId("material.vert"));
+  static constexpr auto gFragmentKey = gShaders.key(shaderId("material.frag"));
+  static_assert(gVertexKey != 0 && gFragmentKey != 0, "the material shader includes a missing source");
+
+  static auto includes() -> ShaderIncludes & {
+    static ShaderIncludes includes = [] {
+      ShaderIncludes files;
+      gShaders.add(files);
+      return files;
+    }();
+    return includes;
+  }
+
+  // The program of the variant once its Shading block is checked and bound, 0 when it failed.
+  auto program(std::uint32_t key) -> gl::GLuint {
+    if(const auto found = mPrograms.find(key); found != mPrograms.end()) {
+      return found->second;
+    }
+    auto &program = mPrograms[key];
+    program = mPermutations.program(key);
+    if(program == 0) {
+      return 0;
+    }
+    // SPIR-V may carry no names, its block is found by the binding it declares.
+    const ProgramReflection reflection(program);
+    const auto *pBlock = mPermutations.spirv(key) ? reflection.blockAt(gShadingBinding) : reflection.block("Shading");
+    if(pBlock == nullptr || !reflection.check(*pBlock, sizeof(ShadingBlock), gShadingMembers, std::cerr)) {
+      std::cerr << "The material shader with\n" << mPermutations.defines(key) << "does not match ShadingBlock\n";
+      program = 0;
+      return 0;
+    }
+    if(mUniformBuffer == 0) {
+      gl::glGenBuffers(1, &mUniformBuffer);
+      gl::glBindBuffer(gl::GL_UNIFORM_BUFFER, mUniformBuffer);
+      gl::glBufferData(gl::GL_UNIFORM_BUFFER, sizeof(ShadingBlock), nullptr, gl::GL_DYNAMIC_DRAW);
+      gl::glBindBuffer(gl::GL_UNIFORM_BUFFER, 0);
+      gMemoryLedger.allocateGpu("uniforms", sizeof(ShadingBlock));
+    }
+    return program;
+  }
+
+  ShaderPermutations mPermutations;
+  std::unordered_map<std::uint32_t, gl::GLuint> mPrograms;
+  gl::GLuint mUniformBuffer = 0;
+};
@@ -19,6 +19,10 @@
 // assimp
 #include <assimp/scene.h>
 #include <assimp/Importer.hpp>
+// common
+#include <common/shaderRegistry.hpp>
+// shaders
+#include <shaders/shaderSources.hpp>
 
 using namespace gl;
 
@@ -55,35 +59,8 @@ static void DebugCallback(GLenum source, GLenum type, GLuint id, GLenum severity
   fmt::print("{}\n", message);
 }
 
-// NOLINTNEXTLINE
-static const char *vertexShaderSource = R"GLSL(
-#version 450 core
-
-layout (location = 0) in vec4 iPosition;
-
-layout (location = 0) uniform mat4 MVP;
-layout (location = 1) uniform vec4 uColor;
-
-out vec4 vsColor;
-
-void main() {
-  vsColor = uColor;
-  gl_Position = MVP * iPosition;
-}
-)GLSL";
-
-// NOLINTNEXTLINE
-static const char *fragmentShaderSource = R"GLSL(
-#version 450 core
-
-layout (location = 0) out vec4 oColor;
-
-in vec4 vsColor;
-
-void main() {
-  oColor = vsColor;
-}
-)GLSL";
+constexpr const auto &gVertexShader = *gShaders.find(shaderId("wireFrame.vert"));
+constexpr const auto &gFragmentShader = *gShaders.find(shaderId("wireFrame.frag"));
 
 struct Model {
   GLuint vao = 0;
@@ -297,8 +274,8 @@ int main([[maybe_unused]] int argc, [[maybe_unused]] char *argv[]) {
 
   GLuint program = 0U;
   {
-    auto vertexShader = createShader(GL_VERTEX_SHADER, vertexShaderSource);
-    auto fragmentShader = createShader(GL_FRAGMENT_SHADER, fragmentShaderSource);
+    auto vertexShader = createShader(GL_VERTEX_SHADER, gVertexShader.source.data());
+    auto fragmentShader = createShader(GL_FRAGMENT_SHADER, gFragmentShader.source.data());
     if(vertexShader == static_cast<std::uint32_t>(ShaderResult::FAILURE) ||
        fragmentShader == static_cast<std::uint32_t>(ShaderResult::FAILURE)) {
       return EXIT_FAILURE;
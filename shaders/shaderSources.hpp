@@ -0,0 +1,189 @@
+#pragma once
+// STL
+#include <array>
+// common
+#include <common/shaderRegistry.hpp>
+
+// The GLSL of the demos in shaders/, compiled into them with the hashes of every name and source, see
+// common/shaderRegistry.hpp. Sources include others by name with `#include "name"`, see common/shaderIncludes.hpp.
+inline constexpr ShaderRegistry gShaders(std::array<ShaderSource, 11>{{
+  // Material, Light and Matrices in materialShader.hpp mirror them.
+  {"lighting/structs.glsl", R"GLSL(
+struct Matrices {
+  mat3 Normal;
+  mat4 ModelView;
+  mat4 ModelViewProjection;
+};
+
+struct Light {
+  vec4 Position; // eye space
+  vec3 Ambient;
+  vec3 Diffuse;
+  vec3 Specular;
+};
+
+struct Material {
+  vec3  Ambient;
+  vec3  Diffuse;
+  vec3  Specular;
+  float Shininess;
+};
+)GLSL"},
+  // Everything the materials demos draw with, one std140 block for all stages so a frame updates it with a single
+  // copy. ShadingBlock mirrors it.
+  {"lighting/shading.glsl", R"GLSL(
+#include "lighting/structs.glsl"
+
+layout (std140, binding = 0) uniform Shading { // gShadingBinding
+  Matrices uMatrices;
+  Light    uLight;
+  Material uMaterial;
+};
+)GLSL"},
+  // Ambient, Lambert diffuse and Phong specular terms, each compiled in only when its macro is defined.
+  {"lighting/shade.glsl", R"GLSL(
+#include "lighting/shading.glsl"
+
+// position and n in eye space, n normalized
+vec3 shade(vec3 position, vec3 n) {
+  vec3 color = vec3(0);
+#ifdef AMBIENT
+  // La = Ka * La
+  color += uMaterial.Ambient * uLight.Ambient;
+#endif
+#if defined(DIFFUSE) || defined(SPECULAR)
+  vec3 s      = normalize(uLight.Position.xyz - position);
+  float sDotN = max(dot(s, n), 0.0);
+#endif
+#ifdef DIFFUSE
+  // Ld = Kd * Ld * dot(s, n)
+  color += uMaterial.Diffuse * uLight.Diffuse * sDotN;
+#endif
+#ifdef SPECULAR
+  // Ls = Ks * Ls * pow(dot(r, v), f)
+  if(sDotN > 0.0) {
+    vec3 v = normalize(-position);
+    vec3 r = reflect(-s, n);
+    color += uMaterial.Specular * uLight.Specular * pow(max(dot(r, v), 0.0), uMaterial.Shininess);
+  }
+#endif
+  return color;
+}
+)GLSL"},
+  // The stages of the material shader, see MaterialShader.
+  {"material.vert", R"GLSL(#version 450 core
+#include "lighting/shade.glsl"
+
+layout (location = 0) in vec3 iPosition;
+layout (location = 1) in vec3 iNormal;
+
+#ifdef PER_FRAGMENT
+layout (location = 0) smooth out vec3 vPosition;
+layout (location = 1) smooth out vec3 vNormal;
+#else
+layout (location = 0) out vec3 vColor;
+#endif
+
+void main() {
+  vec3 position = vec3(uMatrices.ModelView * vec4(iPosition, 1));
+  vec3 normal   = normalize(uMatrices.Normal * iNormal);
+#ifdef PER_FRAGMENT
+  vPosition = position;
+  vNormal   = normal;
+#else
+  vColor    = shade(position, normal);
+#endif
+  gl_Position = uMatrices.ModelViewProjection * vec4(iPosition, 1);
+}
+)GLSL"},
+  {"material.frag", R"GLSL(#version 450 core
+#include "lighting/shade.glsl"
+
+#ifdef PER_FRAGMENT
+layout (location = 0) in vec3 vPosition;
+layout (location = 1) in vec3 vNormal;
+#else
+layout (location = 0) in vec3 vColor;
+#endif
+layout (location = 0) out vec4 oColor;
+
+void main() {
+#ifdef PER_FRAGMENT
+  oColor = vec4(shade(vPosition, normalize(vNormal)), 1.0);
+#else
+  oColor = vec4(vColor, 1.0);
+#endif
+}
+)GLSL"},
+  // shaders/lights/ambient.cpp
+  {"ambient.vert", R"GLSL(#version 450 core
+#include "lighting/structs.glsl"
+
+layout (location = 0) in vec3 iPosition;
+layout (location = 1) in vec3 iNormal;
+
+layout (location = 2) uniform Matrices uMatrices;
+
+void main() {
+  gl_Position = uMatrices.ModelViewProjection * vec4(iPosition, 1);
+}
+)GLSL"},
+  {"ambient.frag", R"GLSL(#version 450 core
+
+layout (location = 0) out vec4 oFragmentColor;
+
+void main() {
+  oFragmentColor = vec4(1, 0, 0, 1);
+}
+)GLSL"},
+  // shaders/materials/loadObj.cpp
+  {"loadObj.vert", R"GLSL(
+#version 450 core
+
+layout (location = 0) in vec4 iPosition;
+
+layout (location = 0) uniform mat4 MVP;
+
+void main() {
+  gl_Position = MVP * iPosition;
+}
+)GLSL"},
+  {"loadObj.frag", R"GLSL(
+#version 450 core
+
+layout (location = 0) out vec4 oColor;
+
+void main() {
+  oColor = vec4(1.0, 0, 0, 1.0);
+}
+)GLSL"},
+  // shaders/materials/wireFrame.cpp
+  {"wireFrame.vert", R"GLSL(
+#version 450 core
+
+layout (location = 0) in vec4 iPosition;
+
+layout (location = 0) uniform mat4 MVP;
+layout (location = 1) uniform vec4 uColor;
+
+out vec4 vsColor;
+
+void main() {
+  vsColor = uColor;
+  gl_Position = MVP * iPosition;
+}
+)GLSL"},
+  {"wireFrame.frag", R"GLSL(
+#version 450 core
+
+layout (location = 0) out vec4 oColor;
+
+in vec4 vsColor;
+
+void main() {
+  oColor = vsColor;
+}
+)GLSL"},
+}});
+
+static_assert(gShaders.unique(), "two shader sources of the same name");
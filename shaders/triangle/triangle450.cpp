@@ -1,10 +1,13 @@
 // STL
 #include <array>
+#include <chrono>
 #include <cstdlib>
 #include <fstream>
 #include <iostream>
 #include <algorithm>
+#include <optional>
 #include <exception>
+#include <filesystem>
 // FMT
 #include <fmt/color.h>
 #include <fmt/format.h>
@@ -13,6 +16,11 @@
 #include <glbinding/glbinding.h>
 // SDL2
 #include <SDL2/SDL.h>
+// common
+#include <common/spirv.hpp>
+#include <common/fileWatcher.hpp>
+#include <common/pipelineCache.hpp>
+#include <common/programCache.hpp>
 
 using namespace gl;
 
@@ -26,6 +34,13 @@ constexpr auto gMajorVersion = 4;
 constexpr auto gMinorVersion = 5;
 inline const bool gDebugOpenGL = std::getenv("DEBUG_OPENGL") != nullptr;
 constexpr auto SDL_SUCCESS = 0;
+// The build passes the shaders of the source tree, edits there are what SHADER_HOT_RELOAD picks up.
+#if !defined(SHADER_DIRECTORY)
+#  define SHADER_DIRECTORY "shaders"
+#endif
+constexpr auto gShaderDirectory = SHADER_DIRECTORY;
+constexpr auto gVertexShader = SHADER_DIRECTORY "/simple_vertex.glsl";
+constexpr auto gFragmentShader = SHADER_DIRECTORY "/simple_fragment.glsl";
 
 inline auto readTextFile(const std::string& fileName) -> std::string {
   std::ifstream inputStream(fileName, std::ios::ate);
@@ -97,16 +112,64 @@ public:
     if(SDL_GL_SetSwapInterval(static_cast<int>(SDL_GL::SYNCHRONIZED)) != SDL_SUCCESS) {
       std::cerr << "Can not set Immediate update!\n";
     }
+    mProgramCache.emplace();
+    mPipelines.emplace();
   }
 
-  static GLuint CreateProgramFromShader(const std::string& shaderName, GLenum shaderType) {
+  // From the SPIR-V of the stage when SPIRV_SHADERS has it, `spirv/simple_vertex.spv` for `shaders/simple_vertex.glsl`,
+  // else, or when the driver rejects the module, from the GLSL. Reloads pass bSpirv false, the edits are in the GLSL.
+  GLuint CreateProgramFromShader(const std::string& shaderName, GLenum shaderType, bool bSpirv = true) {
+    const auto module = bSpirv ? loadSpirv(std::filesystem::path(shaderName).stem().string() + ".spv") : std::string();
+    if(!module.empty()) {
+      const auto program = mPipelines->stage(shaderType, module, [this, &module, &shaderName, shaderType] {
+        return SpecializeSeparable(module, shaderName, shaderType);
+      });
+      if(program != 0) {
+        return program;
+      }
+    }
     const auto shaderSource = readTextFile(shaderName);
-    const auto *pShaderSource = shaderSource.data();
-    GLuint shader = glCreateShader(shaderType);
-    glShaderSource(shader, 1, &pShaderSource, nullptr);
+    return mPipelines->stage(shaderType, shaderSource, [this, &shaderSource, shaderType] {
+      return CompileSeparable(shaderSource, shaderType);
+    });
+  }
+
+  // 0 when the driver rejects the module.
+  GLuint SpecializeSeparable(const std::string& module, const std::string& shaderName, GLenum shaderType) {
+    return mProgramCache->program({module}, "SPIR-V", [&module, &shaderName, shaderType] {
+      GLuint shader = spirvShader(shaderType, module);
+      if(shader == 0) {
+        std::cerr << "The driver rejects the SPIR-V of \"" << shaderName << "\", compiling its GLSL\n";
+        return 0U;
+      }
+      return LinkSeparable(shader);
+    }, true);
+  }
+
+  GLuint CompileSeparable(const std::string& shaderSource, GLenum shaderType) {
+    return mProgramCache->program({shaderSource}, {}, [&shaderSource, shaderType] {
+      const auto *pShaderSource = shaderSource.data();
+      GLuint shader = glCreateShader(shaderType);
+      glShaderSource(shader, 1, &pShaderSource, nullptr);
+      glCompileShader(shader);
+      GLint shader_compiled = 0;
+      glGetShaderiv(shader, GL_COMPILE_STATUS, &shader_compiled);
+      if (shader_compiled != 1) {
+          GLsizei log_length = 0;
+          std::array<GLchar, gMessageLength> message{};
+          glGetShaderInfoLog(shader, gMessageLength, &log_length, message.data());
+          glDeleteShader(shader);
+          throw std::runtime_error(message.data());
+      }
+      return LinkSeparable(shader);
+    }, true);
+  }
+
+  static GLuint LinkSeparable(GLuint shader) {
     GLuint program = glCreateProgram();
     glAttachShader(program, shader);
     glProgramParameteri(program, GL_PROGRAM_SEPARABLE, GL_TRUE);
+    glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
     glLinkProgram(program);
     glDeleteShader(shader);
 
@@ -116,29 +179,57 @@ public:
         GLsizei log_length = 0;
         std::array<GLchar, gMessageLength> message{};
         glGetProgramInfoLog(program, gMessageLength, &log_length, message.data());
+        glDeleteProgram(program);
         throw std::runtime_error(message.data());
     }
     return program;
   }
 
   void createProgram() {
-    vsProgram = CreateProgramFromShader("shaders/simple_vertex.glsl" , GL_VERTEX_SHADER);
-    fsProgram = CreateProgramFromShader("shaders/simple_fragment.glsl", GL_FRAGMENT_SHADER);
+    vsProgram = CreateProgramFromShader(gVertexShader,   GL_VERTEX_SHADER);
+    fsProgram = CreateProgramFromShader(gFragmentShader, GL_FRAGMENT_SHADER);
+    bindPipeline();
+  }
 
-    glCreateProgramPipelines(1, &mProgram);
-    glUseProgramStages(mProgram, GL_VERTEX_SHADER_BIT,   vsProgram);
-    glUseProgramStages(mProgram, GL_FRAGMENT_SHADER_BIT, fsProgram);
+  void bindPipeline() {
+    mProgram = mPipelines->pipeline(vsProgram, fsProgram);
     glBindProgramPipeline(mProgram);
   }
 
+  // Between two frames: rebuilds the stages whose files changed and binds the pipeline with them. A stage that fails
+  // to compile or link keeps its previous program, the pipeline never holds a broken one. The previous programs stay
+  // in the pipeline cache, undoing an edit binds them again without a compile.
+  void reloadShaders() {
+    for(const auto &fileName : mShaderWatcher.poll()) {
+      if(fileName == gVertexShader) {
+        reloadStage(fileName, GL_VERTEX_SHADER, vsProgram);
+      } else if(fileName == gFragmentShader) {
+        reloadStage(fileName, GL_FRAGMENT_SHADER, fsProgram);
+      }
+    }
+  }
+
+  void reloadStage(const std::string& fileName, GLenum shaderType, GLuint& program) {
+    const auto start = std::chrono::steady_clock::now();
+    try {
+      program = CreateProgramFromShader(fileName, shaderType, false);
+      bindPipeline();
+      fmt::print("Reloaded \"{0}\" in {1:.3f} ms\n", fileName,
+                 std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    } catch(const std::runtime_error& error) {
+      fmt::print(fg(fmt::color::red), "Keeping the previous \"{0}\": {1}\n", fileName, error.what());
+    }
+  }
+
   void createBuffers() {
     glCreateVertexArrays(1, &mVAO);
     glBindVertexArray(mVAO);
   }
 
-  void draw() const {
+  void draw() {
     bool bRunning = true;
     while(bRunning) {
+      reloadShaders();
       SDL_Event event;
       while(SDL_PollEvent(&event) != 0) {
         if(event.type == SDL_QUIT) {
@@ -152,10 +243,10 @@ public:
   }
 
   void cleanup() {
-    glDeleteProgram(vsProgram);
-    glDeleteProgram(fsProgram);
-    glDeleteProgramPipelines(1, &mProgram);
     glDeleteVertexArrays(1, &mVAO);
+    mPipelines->report(std::cout);
+    mPipelines.reset();
+    mProgramCache.reset();
     SDL_GL_DeleteContext(mContext);
     SDL_DestroyWindow(m_pWindow);
     SDL_Quit();
@@ -167,6 +258,9 @@ public:
   GLuint fsProgram = 0;
   GLuint mVAO = 0;
   GLuint mProgram = 0;
+  std::optional<ProgramCache> mProgramCache;
+  std::optional<PipelineCache> mPipelines;
+  FileWatcher mShaderWatcher{gShaderDirectory};
 };
 
 int main([[maybe_unused]] int argc, [[maybe_unused]] char *argv[]) {
@@ -0,0 +1,122 @@
+#pragma once
+// STL
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdlib>
+#include <utility>
+#include <iostream>
+#include <algorithm>
+#include <initializer_list>
+// glbinding
+#include <glbinding/gl/gl.h>
+#include <glbinding/glbinding.h>
+// SDL2
+#include <SDL2/SDL.h>
+
+// What the GL benchmark tools share: a hidden window with a GL 4.5 core context, the timing helpers, their argument
+// parsing and what a mode reports. The tools keep only their scenes and modes.
+
+using BenchmarkClock = std::chrono::steady_clock;
+
+inline auto milliseconds(BenchmarkClock::duration duration) -> double {
+  return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+inline auto median(std::vector<double> values) -> double {
+  std::nth_element(values.begin(), values.begin() + static_cast<std::ptrdiff_t>(values.size() / 2), values.end());
+  return values[values.size() / 2];
+}
+
+// Parses `--name N` into the count of that name, at least 1, and `--name` into the flag of that name. False on any
+// other argument or a count without its value.
+inline auto ParseArguments(int argc, char *argv[], std::initializer_list<std::pair<const char *, std::size_t *>> counts,
+                           std::initializer_list<std::pair<const char *, bool *>> flags = {}) -> bool {
+  for(int i = 1; i < argc; ++i) {
+    const std::string argument = argv[i];
+    const auto named = [&argument](const auto &entry) { return argument == entry.first; };
+    const auto count = std::find_if(counts.begin(), counts.end(), named);
+    const auto flag = std::find_if(flags.begin(), flags.end(), named);
+    if(count != counts.end() && i + 1 < argc) {
+      *count->second = static_cast<std::size_t>(std::max(1, std::atoi(argv[++i])));
+    } else if(flag != flags.end()) {
+      *flag->second = true;
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+// What a mode measured, the fields a tool does not measure stay 0.
+struct BenchmarkResult {
+  std::size_t programs = 0; // built or linked
+  double buildMs = 0;
+  double blockedMs = 0; // of buildMs, inside GL calls
+  double submitMs = 0;  // median CPU time submitting a frame
+  double frameMs = 0;   // median CPU time of a frame up to glFinish
+  double gpuMs = 0;     // median GPU time of a frame
+  std::size_t switches = 0; // program switches per frame
+  std::size_t failed = 0;   // programs or materials that failed to build
+};
+
+// Never shown, the tools draw into its default framebuffer. Destroyed after the GL objects of the tool, declare it
+// first in main().
+class BenchmarkWindow final {
+public:
+  BenchmarkWindow(const char *pTitle, int width, int height) {
+    constexpr auto SDL_SUCCESS = 0;
+    if(SDL_Init(SDL_INIT_VIDEO) != SDL_SUCCESS) {
+      std::cerr << "Can not initialize \"" << SDL_GetError() << "\"\n";
+      return;
+    }
+    mbInitialized = true;
+
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 4);
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 5);
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+
+    mpWindow = SDL_CreateWindow(pTitle, SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, width, height,
+                                SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN);
+    if(mpWindow == nullptr) {
+      std::cerr << "Can not create window \"" << SDL_GetError() << "\"\n";
+      return;
+    }
+
+    mContext = SDL_GL_CreateContext(mpWindow);
+    if(mContext == nullptr) {
+      std::cerr << "Can not create context \"" << SDL_GetError() << "\"\n";
+      return;
+    }
+
+    glbinding::initialize(nullptr, false);
+  }
+
+  ~BenchmarkWindow() {
+    if(mContext != nullptr) {
+      SDL_GL_DeleteContext(mContext);
+    }
+    if(mpWindow != nullptr) {
+      SDL_DestroyWindow(mpWindow);
+    }
+    if(mbInitialized) {
+      SDL_Quit();
+    }
+  }
+
+  BenchmarkWindow(const BenchmarkWindow &) = delete;
+  BenchmarkWindow &operator=(const BenchmarkWindow &) = delete;
+
+  // False when the window or its context could not be created, the reason is printed.
+  [[nodiscard]] auto created() const -> bool { return mContext != nullptr; }
+
+  [[nodiscard]] static auto renderer() -> const char * {
+    return reinterpret_cast<const char *>(gl::glGetString(gl::GL_RENDERER));
+  }
+
+private:
+  bool mbInitialized = false;
+  SDL_Window *mpWindow = nullptr;
+  SDL_GLContext mContext = nullptr;
+};
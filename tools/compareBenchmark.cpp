@@ -0,0 +1,307 @@
+// STL
+#include <cmath>
+#include <cctype>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <iostream>
+#include <utility>
+#include <optional>
+#include <algorithm>
+#include <stdexcept>
+#include <string_view>
+
+// Compares a benchmark JSON written by BenchmarkRecorder (common/benchmark.hpp) against a baseline.
+// Frame times are noisy, so a p95 regression only counts when the Mann-Whitney U test agrees that the
+// current run is slower; load time and peak memory are single samples and use a plain relative tolerance.
+
+struct Benchmark {
+  std::string name;
+  double loadTime = 0;
+  double peakMemory = 0;
+  std::vector<double> frameTimes;
+};
+
+struct Options {
+  std::string baseline;
+  std::string current;
+  double alpha = 0.01;
+  double frameTolerance = 0.05;
+  double loadTolerance = 0.25;
+  double memoryTolerance = 0.10;
+};
+
+// Just enough JSON to read back what BenchmarkRecorder writes.
+class Parser final {
+public:
+  explicit Parser(std::string text) : mText(std::move(text)) {}
+
+  auto parse() -> Benchmark {
+    Benchmark benchmark;
+    expect('{');
+    if(peek() == '}') {
+      ++mPosition;
+      return benchmark;
+    }
+    do {
+      const auto key = parseString();
+      expect(':');
+      if(key == "name") {
+        benchmark.name = parseString();
+      } else if(key == "loadTimeMs") {
+        benchmark.loadTime = parseNumber();
+      } else if(key == "peakMemoryBytes") {
+        benchmark.peakMemory = parseNumber();
+      } else if(key == "frameTimesMs") {
+        benchmark.frameTimes = parseNumbers();
+      } else {
+        skipValue();
+      }
+    } while(accept(','));
+    expect('}');
+    return benchmark;
+  }
+
+private:
+  auto peek() -> char {
+    while(mPosition < mText.size() && std::isspace(static_cast<unsigned char>(mText[mPosition])) != 0) {
+      ++mPosition;
+    }
+    if(mPosition == mText.size()) {
+      throw std::runtime_error("Unexpected end of benchmark file");
+    }
+    return mText[mPosition];
+  }
+
+  auto accept(char token) -> bool {
+    if(peek() != token) {
+      return false;
+    }
+    ++mPosition;
+    return true;
+  }
+
+  void expect(char token) {
+    if(!accept(token)) {
+      throw std::runtime_error(std::string("Expected '") + token + "' at offset " + std::to_string(mPosition));
+    }
+  }
+
+  auto parseString() -> std::string {
+    expect('"');
+    std::string output;
+    while(mPosition < mText.size() && mText[mPosition] != '"') {
+      if(mText[mPosition] == '\\') {
+        ++mPosition;
+      }
+      output.push_back(mText[mPosition++]);
+    }
+    expect('"');
+    return output;
+  }
+
+  auto parseNumber() -> double {
+    peek();
+    std::size_t length = 0;
+    const auto value = std::stod(mText.substr(mPosition, 32), &length);
+    mPosition += length;
+    return value;
+  }
+
+  auto parseNumbers() -> std::vector<double> {
+    std::vector<double> output;
+    expect('[');
+    if(accept(']')) {
+      return output;
+    }
+    do {
+      output.push_back(parseNumber());
+    } while(accept(','));
+    expect(']');
+    return output;
+  }
+
+  void skipValue() {
+    const auto token = peek();
+    if(token == '"') {
+      parseString();
+    } else if(token == '[' || token == '{') {
+      const auto closing = token == '[' ? ']' : '}';
+      ++mPosition;
+      while(!accept(closing)) {
+        skipValue();
+        accept(',');
+        accept(':');
+      }
+    } else {
+      while(mPosition < mText.size() && std::string_view(",}] \n\t\r").find(mText[mPosition]) == std::string_view::npos) {
+        ++mPosition;
+      }
+    }
+  }
+
+  std::string mText;
+  std::size_t mPosition = 0;
+};
+
+static auto readBenchmark(const std::string &fileName) -> Benchmark {
+  std::ifstream input(fileName);
+  if(!input.is_open()) {
+    throw std::runtime_error("Can not read \"" + fileName + "\"");
+  }
+  std::stringstream buffer;
+  buffer << input.rdbuf();
+  return Parser(buffer.str()).parse();
+}
+
+static auto percentile(std::vector<double> samples, double fraction) -> double {
+  if(samples.empty()) {
+    return 0;
+  }
+  std::sort(std::begin(samples), std::end(samples));
+  const auto position = fraction * static_cast<double>(samples.size() - 1);
+  const auto lower = static_cast<std::size_t>(std::floor(position));
+  const auto upper = std::min(lower + 1, samples.size() - 1);
+  return samples[lower] + (samples[upper] - samples[lower]) * (position - static_cast<double>(lower));
+}
+
+// One-sided Mann-Whitney U test, H1: `current` tends to be larger than `baseline`.
+// Normal approximation with tie and continuity correction, fine for the hundreds of frames a run records.
+static auto mannWhitneyGreater(const std::vector<double> &baseline, const std::vector<double> &current) -> double {
+  const auto n1 = static_cast<double>(current.size());
+  const auto n2 = static_cast<double>(baseline.size());
+  if(current.empty() || baseline.empty()) {
+    return 1;
+  }
+
+  struct Sample {
+    double value;
+    bool bCurrent;
+  };
+  std::vector<Sample> samples;
+  samples.reserve(current.size() + baseline.size());
+  for(const auto value : current) {
+    samples.push_back({value, true});
+  }
+  for(const auto value : baseline) {
+    samples.push_back({value, false});
+  }
+  std::sort(std::begin(samples), std::end(samples), [](const Sample &left, const Sample &right) { return left.value < right.value; });
+
+  double rankSum = 0;
+  double tieCorrection = 0;
+  for(std::size_t first = 0; first < samples.size();) {
+    auto last = first;
+    while(last + 1 < samples.size() && samples[last + 1].value == samples[first].value) {
+      ++last;
+    }
+    const auto rank = (static_cast<double>(first + last) / 2.0) + 1.0;
+    for(auto i = first; i <= last; ++i) {
+      rankSum += samples[i].bCurrent ? rank : 0;
+    }
+    const auto ties = static_cast<double>(last - first + 1);
+    tieCorrection += ties * ties * ties - ties;
+    first = last + 1;
+  }
+
+  const auto n = n1 + n2;
+  const auto u = rankSum - n1 * (n1 + 1) / 2;
+  const auto mean = n1 * n2 / 2;
+  const auto variance = n1 * n2 / 12 * ((n + 1) - tieCorrection / (n * (n - 1)));
+  if(variance <= 0) {
+    return u > mean ? 0 : 1;
+  }
+  const auto z = (u - mean - 0.5) / std::sqrt(variance);
+  return 0.5 * std::erfc(z / std::sqrt(2.0));
+}
+
+static auto parseProgramOptions(int argc, char **argv) -> std::optional<Options> {
+  Options options;
+  std::vector<std::string> positional;
+  for(int i = 1; i < argc; ++i) {
+    const std::string_view argument = argv[i];
+    const auto value = [&]() -> double {
+      if(i + 1 >= argc) {
+        throw std::runtime_error(std::string(argument) + " needs a value");
+      }
+      return std::stod(argv[++i]);
+    };
+    if(argument == "--alpha") {
+      options.alpha = value();
+    } else if(argument == "--frame-tolerance") {
+      options.frameTolerance = value();
+    } else if(argument == "--load-tolerance") {
+      options.loadTolerance = value();
+    } else if(argument == "--memory-tolerance") {
+      options.memoryTolerance = value();
+    } else {
+      positional.emplace_back(argument);
+    }
+  }
+  if(positional.size() != 2) {
+    return std::nullopt;
+  }
+  options.baseline = positional[0];
+  options.current = positional[1];
+  return options;
+}
+
+static auto relativeChange(double baseline, double current) -> double {
+  return baseline > 0 ? (current - baseline) / baseline : 0;
+}
+
+int main(int argc, char *argv[]) {
+  try {
+    const auto options = parseProgramOptions(argc, argv);
+    if(!options) {
+      std::cerr << "Usage: " << argv[0]
+                << " <baseline.json> <current.json> [--alpha 0.01] [--frame-tolerance 0.05] [--load-tolerance 0.25]"
+                   " [--memory-tolerance 0.10]\n";
+      return EXIT_FAILURE;
+    }
+
+    const auto baseline = readBenchmark(options->baseline);
+    const auto current = readBenchmark(options->current);
+
+    const auto baselineP95 = percentile(baseline.frameTimes, 0.95);
+    const auto currentP95 = percentile(current.frameTimes, 0.95);
+    const auto pValue = mannWhitneyGreater(baseline.frameTimes, current.frameTimes);
+
+    const auto frameChange = relativeChange(baselineP95, currentP95);
+    const auto loadChange = relativeChange(baseline.loadTime, current.loadTime);
+    const auto memoryChange = relativeChange(baseline.peakMemory, current.peakMemory);
+
+    const bool bFrameRegression = frameChange > options->frameTolerance && pValue < options->alpha;
+    // Startup is a single sample, ignore sub-millisecond jitter on fast loads.
+    constexpr auto loadSlack = 1.0;
+    const bool bLoadRegression = loadChange > options->loadTolerance && current.loadTime - baseline.loadTime > loadSlack;
+    const bool bMemoryRegression = memoryChange > options->memoryTolerance;
+
+    const auto row = [](const char *pName, double before, double after, double change, bool bRegression) {
+      std::cout << "  " << std::left << std::setw(18) << pName << std::right << std::setw(14) << before << std::setw(14) << after
+                << std::setw(10) << std::showpos << change * 100 << std::noshowpos << "%  "
+                << (bRegression ? "REGRESSION" : "ok") << '\n';
+    };
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << current.name << ": " << current.frameTimes.size() << " frames against " << baseline.frameTimes.size()
+              << " baseline frames\n";
+    row("p50 frame (ms)",
+        percentile(baseline.frameTimes, 0.5),
+        percentile(current.frameTimes, 0.5),
+        relativeChange(percentile(baseline.frameTimes, 0.5), percentile(current.frameTimes, 0.5)),
+        false);
+    row("p95 frame (ms)", baselineP95, currentP95, frameChange, bFrameRegression);
+    row("load (ms)", baseline.loadTime, current.loadTime, loadChange, bLoadRegression);
+    row("peak memory (MiB)", baseline.peakMemory / 1048576.0, current.peakMemory / 1048576.0, memoryChange, bMemoryRegression);
+    std::cout << "  Mann-Whitney U p-value (slower): " << pValue << " (alpha " << options->alpha << ")\n";
+
+    return bFrameRegression || bLoadRegression || bMemoryRegression ? EXIT_FAILURE : EXIT_SUCCESS;
+  } catch(const std::exception &error) {
+    std::cerr << error.what() << '\n';
+    return EXIT_FAILURE;
+  }
+}
@@ -0,0 +1,44 @@
+// STL
+#include <string>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <filesystem>
+// glbinding
+#include <glbinding/gl/gl.h>
+// materials
+#include <shaders/materials/materialShader.hpp>
+
+// Writes the GLSL of every variant of the material shader, the embedded sources of the materials demos, for glslang:
+//
+//   exportMaterialShaders <directory>
+//
+// One `material.<key>.vert` and `material.<key>.frag` per key, named by ShaderPermutations::fileName(). Runs at build
+// time with ENABLE_SPIRV, needs no GL context.
+
+int main(int argc, char *argv[]) {
+  if(argc != 2) {
+    std::cerr << "Usage: " << argv[0] << " <directory>\n";
+    return EXIT_FAILURE;
+  }
+  const std::filesystem::path directory = argv[1];
+  std::error_code error;
+  std::filesystem::create_directories(directory, error);
+
+  const auto features = MaterialShader::features();
+  const auto variants = 1U << features.size();
+  for(std::uint32_t key = 0; key < variants; ++key) {
+    const auto defines = ShaderPermutations::defines(features, key);
+    for(const auto type : {gl::GL_VERTEX_SHADER, gl::GL_FRAGMENT_SHADER}) {
+      const auto path = directory / ShaderPermutations::fileName(MaterialShader::gName, key, type);
+      std::ofstream output(path);
+      output << ShaderPermutations::insert(MaterialShader::source(type), defines);
+      if(!output) {
+        std::cerr << "Can not write \"" << path.string() << "\"\n";
+        return EXIT_FAILURE;
+      }
+    }
+  }
+  return EXIT_SUCCESS;
+}
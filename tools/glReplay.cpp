@@ -0,0 +1,367 @@
+// STL
+#include <array>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <algorithm>
+#include <utility>
+#include <stdexcept>
+#include <unordered_map>
+// glbinding
+#include <glbinding/gl/gl.h>
+#include <glbinding/glbinding.h>
+// SDL2
+#include <SDL2/SDL.h>
+// common
+#include <common/benchmark.hpp>
+#include <common/glCaptureFormat.hpp>
+
+// Replays a GL_CAPTURE stream (common/glCapture.hpp) in a hidden window without event handling, so the
+// measured frame time is the GL submission cost of the captured frames alone.
+//
+//   glReplay <capture> [--loops N] [--finish] [--size WxH]
+//
+// The calls before the first clear or draw (resource creation) run once, every captured frame from the first one then
+// runs N times.
+// BENCHMARK_OUTPUT works as in the demos, compareBenchmark can gate replays the same way.
+
+using namespace gl;
+
+constexpr auto SDL_SUCCESS = 0;
+
+struct Options {
+  std::string capture;
+  std::size_t loops = 1;
+  bool bFinish = false;
+  int width = 640;
+  int height = 480;
+};
+
+struct Call {
+  const capture::CapturedFunction *pFunction;
+  capture::RawArguments arguments;
+  std::uint64_t result;
+  std::uint32_t payloadOffset;
+  std::uint32_t payloadSize;
+};
+
+struct Stream {
+  std::vector<capture::CapturedFunction> functions;
+  std::vector<Call> calls;
+  std::size_t setupEnd = 0; // calls[0, setupEnd) are setup, calls[setupEnd, frameEnds[0]) are frame 0
+  std::vector<std::size_t> frameEnds; // calls[frameEnds[i - 1], frameEnds[i]) is frame i
+  std::vector<std::uint8_t> payloads;
+};
+
+class Reader final {
+public:
+  explicit Reader(std::vector<std::uint8_t> bytes) : mBytes(std::move(bytes)) {}
+
+  template<typename T>
+  auto read() -> T {
+    T value{};
+    bytes(&value, sizeof(T));
+    return value;
+  }
+
+  void bytes(void *pOutput, std::size_t size) {
+    if(mPosition + size > mBytes.size()) {
+      throw std::runtime_error("Truncated capture");
+    }
+    std::memcpy(pOutput, mBytes.data() + mPosition, size);
+    mPosition += size;
+  }
+
+  [[nodiscard]] auto finished() const -> bool { return mPosition >= mBytes.size(); }
+
+private:
+  std::vector<std::uint8_t> mBytes;
+  std::size_t mPosition = 0;
+};
+
+static auto Load(const std::string &path) -> Stream {
+  std::ifstream file(path, std::ios::binary);
+  if(!file.is_open()) {
+    throw std::runtime_error("Can not open \"" + path + "\"");
+  }
+  Reader reader({std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()});
+
+  auto magic = capture::gMagic;
+  reader.bytes(magic.data(), magic.size());
+  if(magic != capture::gMagic || reader.read<std::uint32_t>() != capture::gVersion) {
+    throw std::runtime_error("\"" + path + "\" is not a capture of this version");
+  }
+
+  // Captures index functions by name, they stay valid when the table in glCaptureFormat.hpp changes.
+  Stream stream;
+  stream.functions = capture::capturedFunctions();
+  std::vector<std::string> names(reader.read<std::uint32_t>());
+  std::vector<const capture::CapturedFunction *> table(names.size(), nullptr);
+  for(std::size_t i = 0; i < names.size(); ++i) {
+    names[i].resize(reader.read<std::uint16_t>());
+    reader.bytes(names[i].data(), names[i].size());
+    const auto found = std::find_if(std::cbegin(stream.functions), std::cend(stream.functions),
+                                    [&name = names[i]](const capture::CapturedFunction &function) { return name == function.pFunction->name(); });
+    if(found != std::cend(stream.functions)) {
+      table[i] = &*found;
+    }
+  }
+
+  while(!reader.finished()) {
+    if(reader.read<capture::Record>() == capture::Record::FRAME) {
+      stream.frameEnds.push_back(stream.calls.size());
+      continue;
+    }
+    Call call{};
+    const auto index = reader.read<std::uint16_t>();
+    const auto count = reader.read<std::uint8_t>();
+    if(index >= table.size() || count > capture::gMaxArguments) {
+      throw std::runtime_error("Corrupted capture");
+    }
+    call.pFunction = table[index];
+    if(call.pFunction == nullptr) {
+      throw std::runtime_error("The capture calls " + names[index] + ", this replayer does not support it");
+    }
+    reader.bytes(call.arguments.data(), count * sizeof(std::uint64_t));
+    call.result = reader.read<std::uint64_t>();
+    call.payloadSize = capture::gNullPayload;
+    if(call.pFunction->layout.payload != capture::Payload::NONE) {
+      call.payloadSize = reader.read<std::uint32_t>();
+      if(call.payloadSize != capture::gNullPayload) {
+        call.payloadOffset = static_cast<std::uint32_t>(stream.payloads.size());
+        stream.payloads.resize(stream.payloads.size() + call.payloadSize);
+        reader.bytes(stream.payloads.data() + call.payloadOffset, call.payloadSize);
+      }
+    }
+    stream.calls.push_back(call);
+  }
+
+  // The first frame also creates the resources, it starts at its first clear or draw.
+  const auto frameStart = std::find_if(std::cbegin(stream.calls), std::cend(stream.calls), [](const Call &call) {
+    const auto *pFunction = call.pFunction->pFunction;
+    return pFunction == &glbinding::Binding::Clear || pFunction == &glbinding::Binding::ClearBufferfv ||
+           pFunction == &glbinding::Binding::DrawArrays || pFunction == &glbinding::Binding::DrawElements;
+  });
+  stream.setupEnd = static_cast<std::size_t>(std::distance(std::cbegin(stream.calls), frameStart));
+  if(!stream.frameEnds.empty()) {
+    stream.setupEnd = std::min(stream.setupEnd, stream.frameEnds.front());
+  }
+  return stream;
+}
+
+// Translates captured object names and uniform locations to the ones of this context.
+class Replayer final {
+public:
+  explicit Replayer(const Stream &stream) : mStream(stream) {}
+
+  void execute(std::size_t begin, std::size_t end) {
+    for(std::size_t i = begin; i < end; ++i) {
+      execute(mStream.calls[i]);
+    }
+  }
+
+private:
+  void execute(const Call &call) {
+    const auto &function = *call.pFunction;
+    const auto &layout = function.layout;
+    auto arguments = call.arguments;
+    for(std::size_t i = 0; i < capture::gMaxArguments; ++i) {
+      if(layout.arguments[i] != capture::Namespace::NONE) {
+        arguments[i] = translate(layout.arguments[i], call.arguments[i]);
+      }
+    }
+
+    const void *pPayload = call.payloadSize != capture::gNullPayload ? mStream.payloads.data() + call.payloadOffset : nullptr;
+    const auto names = call.payloadSize != capture::gNullPayload ? call.payloadSize / sizeof(GLuint) : 0;
+    switch(layout.payload) {
+    case capture::Payload::NONE: break;
+    case capture::Payload::DATA:
+    case capture::Payload::STRING: arguments[layout.pointer] = capture::toRaw(pPayload); break;
+    case capture::Payload::SOURCES:
+      mSource = static_cast<const GLchar *>(pPayload);
+      arguments[layout.count] = capture::toRaw(GLsizei{1});
+      arguments[layout.pointer] = capture::toRaw(&mSource);
+      arguments[layout.pointer + 1] = capture::toRaw(static_cast<const GLint *>(nullptr));
+      break;
+    case capture::Payload::INPUT_NAMES:
+      mNames.resize(names);
+      std::memcpy(mNames.data(), pPayload, names * sizeof(GLuint));
+      for(auto &name : mNames) {
+        name = capture::fromRaw<GLuint>(translate(layout.payloadNames, name));
+      }
+      arguments[layout.pointer] = capture::toRaw(mNames.data());
+      break;
+    case capture::Payload::OUTPUT_NAMES:
+      mNames.assign(names, 0);
+      arguments[layout.pointer] = capture::toRaw(mNames.data());
+      break;
+    }
+
+    const auto result = function.invoke(*function.pFunction, arguments);
+
+    if(layout.payload == capture::Payload::OUTPUT_NAMES) {
+      for(std::size_t i = 0; i < names; ++i) {
+        GLuint captured = 0;
+        std::memcpy(&captured, static_cast<const GLuint *>(pPayload) + i, sizeof(captured));
+        map(layout.payloadNames, captured, mNames[i]);
+      }
+    }
+    if(layout.result == capture::Namespace::LOCATION) {
+      map(capture::Namespace::LOCATION, location(call.arguments[0], call.result), result);
+    } else if(layout.result != capture::Namespace::NONE) {
+      map(layout.result, call.result, result);
+    }
+    if(function.pFunction == &glbinding::Binding::UseProgram) {
+      mProgram = call.arguments[0];
+    }
+  }
+
+  // Locations are only unique within a program, the current program is part of the key.
+  static auto location(std::uint64_t program, std::uint64_t location) -> std::uint64_t {
+    return (program << 32U) | (location & 0xFFFFFFFFU);
+  }
+
+  auto translate(capture::Namespace space, std::uint64_t captured) const -> std::uint64_t {
+    const auto key = space == capture::Namespace::LOCATION ? location(mProgram, captured) : captured;
+    const auto &names = mMaps[static_cast<std::size_t>(space)];
+    const auto found = names.find(key);
+    return found != std::cend(names) ? found->second : captured;
+  }
+
+  void map(capture::Namespace space, std::uint64_t captured, std::uint64_t replayed) {
+    mMaps[static_cast<std::size_t>(space)][captured] = replayed;
+  }
+
+  const Stream &mStream;
+  std::array<std::unordered_map<std::uint64_t, std::uint64_t>, static_cast<std::size_t>(capture::Namespace::COUNT)> mMaps;
+  std::uint64_t mProgram = 0;
+  std::vector<GLuint> mNames;
+  const GLchar *mSource = nullptr;
+};
+
+static auto ParseOptions(int argc, char *argv[], Options &options) -> bool {
+  for(int i = 1; i < argc; ++i) {
+    const std::string argument = argv[i];
+    const bool bHasValue = i + 1 < argc;
+    if(argument == "--loops" && bHasValue) {
+      options.loops = static_cast<std::size_t>(std::max(1, std::atoi(argv[++i])));
+    } else if(argument == "--finish") {
+      options.bFinish = true;
+    } else if(argument == "--size" && bHasValue) {
+      if(std::sscanf(argv[++i], "%dx%d", &options.width, &options.height) != 2) {
+        return false;
+      }
+    } else if(options.capture.empty() && argument.rfind("--", 0) != 0) {
+      options.capture = argument;
+    } else {
+      return false;
+    }
+  }
+  return !options.capture.empty();
+}
+
+static auto Percentile(std::vector<double> values, double percentile) -> double {
+  if(values.empty()) {
+    return 0;
+  }
+  std::sort(std::begin(values), std::end(values));
+  const auto index = static_cast<std::size_t>(percentile * static_cast<double>(values.size() - 1) + 0.5);
+  return values[index];
+}
+
+int main(int argc, char *argv[]) {
+  Options options;
+  if(!ParseOptions(argc, argv, options)) {
+    std::cerr << "Usage: " << argv[0] << " <capture> [--loops N] [--finish] [--size WxH]\n";
+    return EXIT_FAILURE;
+  }
+
+  if(SDL_Init(SDL_INIT_VIDEO) != SDL_SUCCESS) {
+    std::cerr << "Can not initialize \"" << SDL_GetError() << "\"\n";
+    return EXIT_FAILURE;
+  }
+
+  SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 4);
+  SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 5);
+  SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+
+  auto pWindow = SDL_CreateWindow("glReplay", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, options.width, options.height,
+                                  SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN);
+  if(pWindow == nullptr) {
+    std::cerr << "Can not create window \"" << SDL_GetError() << "\"\n";
+    return EXIT_FAILURE;
+  }
+
+  auto context = SDL_GL_CreateContext(pWindow);
+  if(context == nullptr) {
+    std::cerr << "Can not create context \"" << SDL_GetError() << "\"\n";
+    return EXIT_FAILURE;
+  }
+
+  glbinding::initialize(nullptr, false);
+  BenchmarkRecorder benchmark("glReplay");
+  if(SDL_GL_SetSwapInterval(0) != SDL_SUCCESS) {
+    std::cerr << "Can not set Immediate update!\n";
+  }
+
+  Stream stream;
+  try {
+    stream = Load(options.capture);
+  } catch(const std::exception &error) {
+    std::cerr << error.what() << '\n';
+    return EXIT_FAILURE;
+  }
+  if(stream.frameEnds.empty()) {
+    std::cerr << "\"" << options.capture << "\" has no frames\n";
+    return EXIT_FAILURE;
+  }
+
+  Replayer replayer(stream);
+  benchmark.beginLoad();
+  replayer.execute(0, stream.setupEnd);
+  glFinish();
+  benchmark.endLoad();
+
+  using Clock = std::chrono::steady_clock;
+  std::vector<double> frameTimes;
+  frameTimes.reserve(options.loops * stream.frameEnds.size());
+  for(std::size_t loop = 0; loop < options.loops && !benchmark.finished(); ++loop) {
+    for(std::size_t frame = 0; frame < stream.frameEnds.size() && !benchmark.finished(); ++frame) {
+      benchmark.beginFrame();
+      const auto start = Clock::now();
+      replayer.execute(frame == 0 ? stream.setupEnd : stream.frameEnds[frame - 1], stream.frameEnds[frame]);
+      SDL_GL_SwapWindow(pWindow);
+      if(options.bFinish) {
+        glFinish();
+      }
+      frameTimes.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+      benchmark.endFrame();
+    }
+  }
+
+  const auto frames = frameTimes.size();
+  double total = 0;
+  for(const auto frameTime : frameTimes) {
+    total += frameTime;
+  }
+  std::cout << "Replayed " << stream.calls.size() << " calls, " << stream.frameEnds.size() << " frames x " << options.loops
+            << " loops\n";
+  if(frames != 0) {
+    std::cout << std::fixed << std::setprecision(3) << "frame ms: mean " << total / static_cast<double>(frames) << ", p50 "
+              << Percentile(frameTimes, 0.50) << ", p95 " << Percentile(frameTimes, 0.95) << ", max "
+              << *std::max_element(std::cbegin(frameTimes), std::cend(frameTimes)) << '\n';
+  }
+
+  SDL_GL_DeleteContext(context);
+  SDL_DestroyWindow(pWindow);
+  SDL_Quit();
+
+  return EXIT_SUCCESS;
+}
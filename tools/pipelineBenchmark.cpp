@@ -0,0 +1,187 @@
+// STL
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <algorithm>
+// glbinding
+#include <glbinding/gl/gl.h>
+// common
+#include <common/pipelineCache.hpp>
+// tools
+#include <tools/benchmarkWindow.hpp>
+
+// Materials that share their vertex stages, drawn by switching programs or program pipelines, in a hidden window:
+//
+//   pipelineBenchmark [--materials N] [--vertex N] [--draws N] [--frames N]
+//
+// Material i draws with vertex stage i % vertex and a fragment stage of its own, every draw switches material.
+// - programs: one program linked per material, glUseProgram per draw
+// - pipelines: common/pipelineCache.hpp, one separable program per distinct stage and a pipeline per material,
+//   glBindProgramPipeline per draw
+// The build reports the programs linked and the time to link them, the draws the median CPU time of submitting a
+// frame and of the frame up to glFinish. The triangles cover a few pixels, so the switches dominate.
+
+using namespace gl;
+
+struct Options {
+  std::size_t materials = 256;
+  std::size_t vertex = 4;
+  std::size_t draws = 4096;
+  std::size_t frames = 100;
+};
+
+using Clock = BenchmarkClock;
+
+// A small triangle at a position of its own.
+static auto VertexSource(std::size_t index, std::size_t count) -> std::string {
+  return "#version 450 core\nconst float cIndex = " + std::to_string(index) + ".0;\nconst float cCount = " +
+         std::to_string(count) + ".0;\n" + R"GLSL(
+out gl_PerVertex {
+  vec4 gl_Position;
+};
+layout (location = 0) out vec3 vColor;
+
+const vec2 cCorners[3] = vec2[3](vec2(0, 0), vec2(0.01, 0), vec2(0, 0.01));
+
+void main() {
+  vColor      = vec3(cIndex / cCount, float(gl_VertexID) * 0.5, 1.0);
+  gl_Position = vec4(cCorners[gl_VertexID] + vec2(cIndex / cCount * 1.8 - 0.9, 0), 0, 1);
+}
+)GLSL";
+}
+
+static auto FragmentSource(std::size_t index, std::size_t count) -> std::string {
+  return "#version 450 core\nconst float cTint = " + std::to_string(index) + ".0 / " + std::to_string(count) + ".0;\n" +
+         R"GLSL(
+layout (location = 0) in vec3 vColor;
+layout (location = 0) out vec4 oColor;
+
+void main() {
+  oColor = vec4(vColor * cTint, 1.0);
+}
+)GLSL";
+}
+
+static auto Compile(GLenum type, const std::string &source) -> GLuint {
+  const auto *pSource = source.c_str();
+  const auto shader = glCreateShader(type);
+  glShaderSource(shader, 1, &pSource, nullptr);
+  glCompileShader(shader);
+  return shader;
+}
+
+// Draws every frame and keeps the medians, `bind` selects material i.
+template<typename Bind>
+static void Draw(const Options &options, BenchmarkResult &result, Bind bind) {
+  std::vector<double> submits;
+  std::vector<double> frames;
+  for(std::size_t frame = 0; frame < options.frames; ++frame) {
+    const auto start = Clock::now();
+    glClear(GL_COLOR_BUFFER_BIT);
+    for(std::size_t draw = 0; draw < options.draws; ++draw) {
+      bind(draw % options.materials);
+      glDrawArrays(GL_TRIANGLES, 0, 3);
+    }
+    const auto submitted = Clock::now();
+    glFinish();
+    submits.push_back(milliseconds(submitted - start));
+    frames.push_back(milliseconds(Clock::now() - start));
+  }
+  result.submitMs = median(submits);
+  result.frameMs = median(frames);
+}
+
+static auto Programs(const Options &options) -> BenchmarkResult {
+  BenchmarkResult result;
+  std::vector<GLuint> programs;
+  const auto start = Clock::now();
+  for(std::size_t i = 0; i < options.materials; ++i) {
+    const auto vertexShader = Compile(GL_VERTEX_SHADER, VertexSource(i % options.vertex, options.vertex));
+    const auto fragmentShader = Compile(GL_FRAGMENT_SHADER, FragmentSource(i, options.materials));
+    const auto program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glLinkProgram(program);
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+    GLint status = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &status);
+    result.failed += status == 1 ? 0 : 1;
+    programs.push_back(program);
+  }
+  glFinish();
+  result.buildMs = milliseconds(Clock::now() - start);
+  result.programs = programs.size();
+
+  Draw(options, result, [&programs](std::size_t material) { glUseProgram(programs[material]); });
+  glUseProgram(0);
+  for(const auto program : programs) {
+    glDeleteProgram(program);
+  }
+  return result;
+}
+
+static auto Pipelines(const Options &options) -> BenchmarkResult {
+  BenchmarkResult result;
+  PipelineCache cache;
+  std::vector<GLuint> pipelines;
+  const auto start = Clock::now();
+  for(std::size_t i = 0; i < options.materials; ++i) {
+    const auto vertexProgram = cache.stage(GL_VERTEX_SHADER, VertexSource(i % options.vertex, options.vertex));
+    const auto fragmentProgram = cache.stage(GL_FRAGMENT_SHADER, FragmentSource(i, options.materials));
+    result.failed += vertexProgram != 0 && fragmentProgram != 0 ? 0 : 1;
+    pipelines.push_back(cache.pipeline(vertexProgram, fragmentProgram));
+  }
+  glFinish();
+  result.buildMs = milliseconds(Clock::now() - start);
+  result.programs = cache.stages();
+  cache.report(std::cout);
+
+  Draw(options, result, [&pipelines](std::size_t material) { glBindProgramPipeline(pipelines[material]); });
+  glBindProgramPipeline(0);
+  return result;
+}
+
+int main(int argc, char *argv[]) {
+  Options options;
+  if(!ParseArguments(argc, argv,
+                     {{"--materials", &options.materials},
+                      {"--vertex", &options.vertex},
+                      {"--draws", &options.draws},
+                      {"--frames", &options.frames}})) {
+    std::cerr << "Usage: " << argv[0] << " [--materials N] [--vertex N] [--draws N] [--frames N]\n";
+    return EXIT_FAILURE;
+  }
+  options.vertex = std::min(options.vertex, options.materials);
+
+  const BenchmarkWindow window("pipelineBenchmark", 640, 480);
+  if(!window.created()) {
+    return EXIT_FAILURE;
+  }
+  std::cout << options.materials << " materials on " << options.vertex << " vertex stages, " << options.draws
+            << " draws per frame on " << BenchmarkWindow::renderer() << '\n';
+
+  // Core profiles draw nothing without a vertex array, the triangles need no attributes.
+  GLuint vao = 0;
+  glCreateVertexArrays(1, &vao);
+  glBindVertexArray(vao);
+
+  std::size_t failed = 0;
+  const auto report = [&failed](const char *pMode, const BenchmarkResult &result) {
+    std::cout << std::left << std::setw(10) << pMode << std::right << std::fixed << std::setprecision(3) << std::setw(6)
+              << result.programs << " linked in " << std::setw(9) << result.buildMs << " ms, submit " << std::setw(8)
+              << result.submitMs << " ms, frame " << std::setw(8) << result.frameMs << " ms\n";
+    failed += result.failed;
+  };
+  report("programs", Programs(options));
+  report("pipelines", Pipelines(options));
+
+  glDeleteVertexArrays(1, &vao);
+  if(failed != 0) {
+    std::cerr << failed << " materials failed to build\n";
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
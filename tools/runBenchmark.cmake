@@ -0,0 +1,47 @@
+# ${CMAKE_SOURCE_DIR}/tools/runBenchmark.cmake
+# Runs one demo in benchmark mode and compares the result against its baseline.
+# cmake -DDEMO=<exe> -DCOMPARE=<exe> -DBASELINE=<json> -DOUTPUT=<json> [-DFRAMES=300] [-DBACKEND=window] -P runBenchmark.cmake
+set(ENV{BENCHMARK_OUTPUT} ${OUTPUT})
+set(ENV{BENCHMARK_FRAMES} ${FRAMES})
+if(BACKEND)
+  set(ENV{DEMO_BACKEND} ${BACKEND})
+endif()
+
+# A result left by an earlier run must not pass for this one.
+file(REMOVE ${OUTPUT})
+
+execute_process(
+  COMMAND ${DEMO}
+  RESULT_VARIABLE demoResult
+  OUTPUT_QUIET
+)
+if(NOT demoResult EQUAL 0)
+  message(FATAL_ERROR "${DEMO} failed (${demoResult})")
+endif()
+if(NOT EXISTS ${OUTPUT})
+  message(FATAL_ERROR "${DEMO} wrote no ${OUTPUT}")
+endif()
+
+if(UPDATE_BASELINE)
+  configure_file(${OUTPUT} ${BASELINE} COPYONLY)
+  message(STATUS "Updated ${BASELINE}")
+  return()
+endif()
+
+if(NOT EXISTS ${BASELINE})
+  message(STATUS "No baseline ${BASELINE}, configure with -DBENCHMARK_UPDATE_BASELINE=ON to record one")
+  return()
+endif()
+
+execute_process(
+  COMMAND
+    ${COMPARE} ${BASELINE} ${OUTPUT}
+    --alpha ${ALPHA}
+    --frame-tolerance ${FRAME_TOLERANCE}
+    --load-tolerance ${LOAD_TOLERANCE}
+    --memory-tolerance ${MEMORY_TOLERANCE}
+  RESULT_VARIABLE compareResult
+)
+if(NOT compareResult EQUAL 0)
+  message(FATAL_ERROR "${DEMO} regressed against ${BASELINE}")
+endif()
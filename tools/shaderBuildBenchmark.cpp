@@ -0,0 +1,199 @@
+// STL
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+// glbinding
+#include <glbinding/gl/gl.h>
+// common
+#include <common/shaderBuilder.hpp>
+// tools
+#include <tools/benchmarkWindow.hpp>
+
+// Startup cost of building many programs in a hidden window, with every strategy of common/shaderBuilder.hpp:
+//
+//   shaderBuildBenchmark [--programs N] [--lights N]
+//
+// - blocking: compile, wait for the status and link every program in turn, like createShader/createProgram in the demos
+// - deferred: submit every compile first, then link and query the statuses
+// - parallel: as deferred, polling GL_COMPLETION_STATUS_KHR, when the driver has GL_KHR_parallel_shader_compile
+// Every program differs by a constant and every run and mode salts the sources, so neither in-memory nor disk shader
+// caches of the driver serve a program from another one. "blocked" is the time spent inside the GL calls, the rest of
+// the build the caller could have spent loading meshes.
+
+using namespace gl;
+
+struct Options {
+  std::size_t programs = 128;
+  std::size_t lights = 4;
+};
+
+using Clock = BenchmarkClock;
+
+// Per fragment Blinn-Phong over `lights` point lights, the work of the materials demos times the lights.
+static auto Stages(std::size_t variant, std::size_t lights, const std::string &salt) -> std::vector<ShaderBuilder::Stage> {
+  const auto header = "#version 330 core\n// " + salt + '\n' + "#define LIGHTS " + std::to_string(lights) + '\n' +
+                      "const float cVariant = " + std::to_string(variant) + ".0;\n";
+  return {
+    {GL_VERTEX_SHADER, header + R"GLSL(
+layout (location = 0) in vec3 iPosition;
+layout (location = 1) in vec3 iNormal;
+
+uniform mat3 uNormal;
+uniform mat4 uModelView;
+uniform mat4 uModelViewProjection;
+
+out vec3 Position;
+out vec3 Normal;
+
+void main() {
+  Normal      = normalize(uNormal * iNormal);
+  Position    = vec3(uModelView * vec4(iPosition, 1));
+  gl_Position = uModelViewProjection * vec4(iPosition * (1.0 + cVariant * 1e-6), 1);
+}
+)GLSL"},
+    {GL_FRAGMENT_SHADER, header + R"GLSL(
+in vec3 Position;
+in vec3 Normal;
+layout (location = 0) out vec4 oColor;
+
+struct Light {
+  vec3 Pos;
+  vec3 Color;
+};
+uniform Light uLights[LIGHTS];
+
+uniform vec3 uAmbient;
+uniform vec3 uDiffuse;
+uniform vec3 uSpecular;
+uniform float uShininess;
+
+void main() {
+  vec3 n     = normalize(Normal);
+  vec3 v     = normalize(-Position);
+  vec3 color = uAmbient;
+  for(int i = 0; i < LIGHTS; ++i) {
+    vec3 s       = normalize(uLights[i].Pos - Position);
+    vec3 h       = normalize(v + s);
+    float sn     = max(dot(s, n), 0.0);
+    float hn     = sn > 0.0 ? pow(max(dot(h, n), 0.0), uShininess) : 0.0;
+    color       += uLights[i].Color * (uDiffuse * sn + uSpecular * hn);
+  }
+  oColor = vec4(color * (1.0 - cVariant * 1e-6), 1.0);
+}
+)GLSL"},
+  };
+}
+
+static auto Salt(const char *pMode) -> std::string {
+  return std::string(pMode) + ' ' + std::to_string(Clock::now().time_since_epoch().count());
+}
+
+// What the demos do today: every status query waits for its compile or link.
+static auto BuildBlocking(const Options &options) -> BenchmarkResult {
+  BenchmarkResult result;
+  const auto salt = Salt("blocking");
+  std::vector<GLuint> programs;
+  const auto start = Clock::now();
+  for(std::size_t i = 0; i < options.programs; ++i) {
+    const auto program = glCreateProgram();
+    bool bCompiled = true;
+    for(const auto &stage : Stages(i, options.lights, salt)) {
+      const auto *pSource = stage.source.c_str();
+      const auto shader = glCreateShader(stage.type);
+      glShaderSource(shader, 1, &pSource, nullptr);
+      glCompileShader(shader);
+      GLint status = 0;
+      glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+      bCompiled = bCompiled && status == 1;
+      glAttachShader(program, shader);
+      glDeleteShader(shader);
+    }
+    glLinkProgram(program);
+    GLint status = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &status);
+    if(!bCompiled || status != 1) {
+      ++result.failed;
+    }
+    programs.push_back(program);
+  }
+  result.buildMs = milliseconds(Clock::now() - start);
+  result.blockedMs = result.buildMs;
+  for(const auto program : programs) {
+    glDeleteProgram(program);
+  }
+  return result;
+}
+
+static auto Build(const Options &options, bool bParallel) -> BenchmarkResult {
+  BenchmarkResult result;
+  const auto salt = Salt(bParallel ? "parallel" : "deferred");
+  ShaderBuilder builder(bParallel);
+  std::vector<std::size_t> programs;
+  const auto start = Clock::now();
+  for(std::size_t i = 0; i < options.programs; ++i) {
+    programs.push_back(builder.add(Stages(i, options.lights, salt)));
+  }
+  auto blocked = Clock::duration{};
+  auto call = Clock::now();
+  builder.submit();
+  for(;;) {
+    const auto bDone = builder.poll();
+    const auto now = Clock::now();
+    blocked += now - call;
+    if(bDone) {
+      break;
+    }
+    std::this_thread::yield();
+    call = Clock::now();
+  }
+  result.buildMs = milliseconds(Clock::now() - start);
+  result.blockedMs = milliseconds(blocked);
+  result.failed = builder.failed();
+  for(const auto index : programs) {
+    glDeleteProgram(builder.program(index));
+  }
+  return result;
+}
+
+int main(int argc, char *argv[]) {
+  Options options;
+  if(!ParseArguments(argc, argv, {{"--programs", &options.programs}, {"--lights", &options.lights}})) {
+    std::cerr << "Usage: " << argv[0] << " [--programs N] [--lights N]\n";
+    return EXIT_FAILURE;
+  }
+
+  const BenchmarkWindow window("shaderBuildBenchmark", 64, 64);
+  if(!window.created()) {
+    return EXIT_FAILURE;
+  }
+  std::cout << "Building " << options.programs << " programs with " << options.lights << " lights on "
+            << BenchmarkWindow::renderer() << '\n';
+
+  // The parallel builder raises the compiler threads of the context, it runs last so the other modes keep the default.
+  const bool bParallel = ShaderBuilder::parallelExtension() != ShaderBuilder::ParallelExtension::NONE;
+  if(!bParallel) {
+    std::cout << "The driver has no GL_KHR_parallel_shader_compile, parallel is skipped\n";
+  }
+
+  std::size_t failed = 0;
+  const auto report = [&failed, &options](const char *pMode, const BenchmarkResult &result) {
+    std::cout << std::left << std::setw(10) << pMode << std::right << std::fixed << std::setprecision(2) << std::setw(10)
+              << result.buildMs << " ms" << std::setw(10) << result.buildMs / static_cast<double>(options.programs)
+              << " ms/program" << std::setw(10) << result.blockedMs << " ms blocked\n";
+    failed += result.failed;
+  };
+  report("blocking", BuildBlocking(options));
+  report("deferred", Build(options, false));
+  if(bParallel) {
+    report("parallel", Build(options, true));
+  }
+
+  if(failed != 0) {
+    std::cerr << failed << " programs failed to build\n";
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
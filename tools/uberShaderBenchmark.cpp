@@ -0,0 +1,296 @@
+// STL
+#include <cmath>
+#include <array>
+#include <random>
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+#include <utility>
+#include <iomanip>
+#include <iostream>
+// glbinding
+#include <glbinding/gl/gl.h>
+// GLM
+#include <glm/vec3.hpp>
+#include <glm/matrix.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+// common
+#include <common/programCache.hpp>
+#include <common/shaderIncludes.hpp>
+#include <common/shaderPermutations.hpp>
+// materials
+#include <shaders/materials/materialShader.hpp>
+// tools
+#include <tools/benchmarkWindow.hpp>
+
+// Materials drawn with one uber-shader branching on a uniform or with a specialized variant each, in a hidden window:
+//
+//   uberShaderBenchmark [--materials N] [--frames N] [--sorted] [--per-vertex]
+//
+// Every material is a sphere of its own with random ambient, diffuse and specular terms, each missing at times. All of
+// them are lit per fragment, or per vertex with --per-vertex, so both modes shade the same and only the branching
+// differs.
+// - uber: the material shader with a shade() that tests the Feature bits of a uniform instead of macros, built once,
+//   with PER_FRAGMENT unless --per-vertex, and running the branches of every term
+// - variants: the variant of MaterialShader::features() of every material, switching programs whenever the variant
+//   differs from the one of the previous draw; --sorted draws the materials ordered by variant
+// Both copy the Shading block of every draw to the same uniform buffer. Reported per mode: the programs built and the
+// time to build them, the median CPU time submitting a frame, the median GPU time of a frame from GL_TIME_ELAPSED and
+// the glUseProgram calls per frame.
+
+using namespace gl;
+
+struct Options {
+  std::size_t materials = 64;
+  std::size_t frames = 100;
+  bool bSorted = false;
+  bool bPerVertex = false;
+};
+
+struct Scene {
+  std::vector<Material> materials;
+  std::vector<Matrices> matrices;
+  Light light;
+  GLsizei vertices = 0;
+  GLuint uniformBuffer = 0;
+};
+
+using Clock = BenchmarkClock;
+
+// shade() of lighting/shade.glsl with its terms selected by uniform branches instead of macros.
+static const char *const gUberShade = R"GLSL(
+#include "lighting/shading.glsl"
+
+layout (location = 0) uniform uint uFeatures; // MaterialShader::Feature bits
+
+// position and n in eye space, n normalized
+vec3 shade(vec3 position, vec3 n) {
+  vec3 color = vec3(0);
+  if((uFeatures & 1u) != 0u) {
+    color += uMaterial.Ambient * uLight.Ambient;
+  }
+  vec3 s      = normalize(uLight.Position.xyz - position);
+  float sDotN = max(dot(s, n), 0.0);
+  if((uFeatures & 2u) != 0u) {
+    color += uMaterial.Diffuse * uLight.Diffuse * sDotN;
+  }
+  if((uFeatures & 4u) != 0u && sDotN > 0.0) {
+    vec3 v = normalize(-position);
+    vec3 r = reflect(-s, n);
+    color += uMaterial.Specular * uLight.Specular * pow(max(dot(r, v), 0.0), uMaterial.Shininess);
+  }
+  return color;
+}
+)GLSL";
+
+// A unit sphere as triangles, every position is its own normal.
+static auto Sphere(int rings, int segments) -> std::vector<glm::vec3> {
+  const auto pi = std::acos(-1.F);
+  const auto point = [&](int ring, int segment) {
+    const auto theta = pi * static_cast<float>(ring) / static_cast<float>(rings);
+    const auto phi = 2 * pi * static_cast<float>(segment) / static_cast<float>(segments);
+    return glm::vec3(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+  };
+  constexpr std::array<std::pair<int, int>, 6> corners = {{{0, 0}, {1, 0}, {1, 1}, {0, 0}, {1, 1}, {0, 1}}};
+  std::vector<glm::vec3> vertices;
+  for(int ring = 0; ring < rings; ++ring) {
+    for(int segment = 0; segment < segments; ++segment) {
+      for(const auto &[r, s] : corners) {
+        vertices.push_back(point(ring + r, segment + s));
+      }
+    }
+  }
+  return vertices;
+}
+
+// Random materials on a grid of spheres filling the window, the same every run.
+static auto CreateScene(const Options &options) -> Scene {
+  Scene scene;
+  std::mt19937 random(7);
+  std::uniform_real_distribution<float> intensity(0.F, 1.F);
+  std::bernoulli_distribution present(0.7);
+  const auto term = [&](float scale) {
+    if(!present(random)) {
+      return glm::vec3(0);
+    }
+    const auto red = intensity(random);
+    const auto green = intensity(random);
+    const auto blue = intensity(random);
+    return glm::vec3(red, green, blue) * scale;
+  };
+  for(std::size_t i = 0; i < options.materials; ++i) {
+    Material material;
+    material.ambient = term(0.2F);
+    material.diffuse = term(1.F);
+    material.specular = term(1.F);
+    material.shininess = 1.F + intensity(random) * 63.F;
+    material.bPerFragment = !options.bPerVertex;
+    scene.materials.push_back(material);
+  }
+  if(options.bSorted) {
+    std::stable_sort(scene.materials.begin(), scene.materials.end(), [](const Material &left, const Material &right) {
+      return MaterialShader::features(left) < MaterialShader::features(right);
+    });
+  }
+
+  const auto columns = static_cast<std::size_t>(std::ceil(std::sqrt(static_cast<double>(options.materials))));
+  const auto cell = 2.F / static_cast<float>(columns);
+  const auto projection = glm::ortho(-1.F, 1.F, -1.F, 1.F, 0.1F, 10.F);
+  for(std::size_t i = 0; i < options.materials; ++i) {
+    const auto x = -1.F + (static_cast<float>(i % columns) + 0.5F) * cell;
+    const auto y = 1.F - (static_cast<float>(i / columns) + 0.5F) * cell;
+    Matrices matrices;
+    matrices.modelView = glm::scale(glm::translate(glm::mat4(1), glm::vec3(x, y, -3)), glm::vec3(cell * 0.45F));
+    matrices.modelViewProjection = projection * matrices.modelView;
+    matrices.normal = glm::mat3(1); // uniform scale, the shader normalizes
+    scene.matrices.push_back(matrices);
+  }
+  scene.light.position = glm::vec4(-2, 2, 2, 1);
+  return scene;
+}
+
+// Draws every frame and keeps the medians, `bind` makes material i current and returns the glUseProgram calls it made.
+template<typename Bind>
+static void Draw(const Options &options, const Scene &scene, BenchmarkResult &result, Bind bind) {
+  GLuint query = 0;
+  glGenQueries(1, &query);
+  std::vector<double> submits;
+  std::vector<double> gpu;
+  std::size_t switches = 0;
+  for(std::size_t frame = 0; frame < options.frames; ++frame) {
+    const auto start = Clock::now();
+    glBeginQuery(GL_TIME_ELAPSED, query);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    for(std::size_t i = 0; i < scene.materials.size(); ++i) {
+      switches += bind(i);
+      const auto block = MaterialShader::shading(scene.materials[i], scene.light, scene.matrices[i]);
+      glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(block), &block);
+      glDrawArrays(GL_TRIANGLES, 0, scene.vertices);
+    }
+    glEndQuery(GL_TIME_ELAPSED);
+    submits.push_back(milliseconds(Clock::now() - start));
+    GLuint64 elapsed = 0;
+    glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+    gpu.push_back(static_cast<double>(elapsed) / 1e6);
+  }
+  glDeleteQueries(1, &query);
+  glUseProgram(0);
+  result.submitMs = median(submits);
+  result.gpuMs = median(gpu);
+  result.switches = switches / options.frames;
+}
+
+static auto Uber(const Options &options, const Scene &scene, ProgramCache &programCache) -> BenchmarkResult {
+  BenchmarkResult result;
+  ShaderIncludes includes;
+  gShaders.add(includes);
+  includes.add("lighting/shade.glsl", gUberShade);
+  ShaderPermutations uber("uber", includes.expand("material.vert").source, includes.expand("material.frag").source,
+                          MaterialShader::features(), programCache);
+  const auto start = Clock::now();
+  const auto program = uber.program(options.bPerVertex ? 0U : MaterialShader::PER_FRAGMENT);
+  glFinish();
+  result.buildMs = milliseconds(Clock::now() - start);
+  result.programs = uber.compiles();
+  if(program == 0) {
+    result.failed = scene.materials.size();
+    return result;
+  }
+
+  Draw(options, scene, result, [&scene, program](std::size_t material) -> std::size_t {
+    const auto bFirst = material == 0;
+    if(bFirst) {
+      glUseProgram(program);
+    }
+    glUniform1ui(0, MaterialShader::features(scene.materials[material]));
+    return bFirst ? 1 : 0;
+  });
+  glUseProgram(0);
+  return result;
+}
+
+static auto Variants(const Options &options, const Scene &scene, ProgramCache &programCache) -> BenchmarkResult {
+  BenchmarkResult result;
+  ShaderPermutations variants(MaterialShader::gName, MaterialShader::source(GL_VERTEX_SHADER),
+                              MaterialShader::source(GL_FRAGMENT_SHADER), MaterialShader::features(), programCache);
+  std::vector<GLuint> programs;
+  const auto start = Clock::now();
+  for(const auto &material : scene.materials) {
+    programs.push_back(variants.program(MaterialShader::features(material)));
+    result.failed += programs.back() == 0 ? 1 : 0;
+  }
+  glFinish();
+  result.buildMs = milliseconds(Clock::now() - start);
+  result.programs = variants.compiles();
+
+  GLuint current = 0;
+  Draw(options, scene, result, [&programs, &current](std::size_t material) -> std::size_t {
+    if(material != 0 && programs[material] == current) {
+      return 0;
+    }
+    current = programs[material];
+    glUseProgram(current);
+    return 1;
+  });
+  glUseProgram(0);
+  return result;
+}
+
+int main(int argc, char *argv[]) {
+  Options options;
+  if(!ParseArguments(argc, argv, {{"--materials", &options.materials}, {"--frames", &options.frames}},
+                     {{"--sorted", &options.bSorted}, {"--per-vertex", &options.bPerVertex}})) {
+    std::cerr << "Usage: " << argv[0] << " [--materials N] [--frames N] [--sorted] [--per-vertex]\n";
+    return EXIT_FAILURE;
+  }
+
+  const BenchmarkWindow window("uberShaderBenchmark", 640, 640);
+  if(!window.created()) {
+    return EXIT_FAILURE;
+  }
+  std::cout << options.materials << " materials lit per " << (options.bPerVertex ? "vertex" : "fragment")
+            << (options.bSorted ? " sorted by variant" : "") << " on " << BenchmarkWindow::renderer() << '\n';
+
+  auto scene = CreateScene(options);
+  const auto sphere = Sphere(16, 32);
+  scene.vertices = static_cast<GLsizei>(sphere.size());
+  GLuint vao = 0;
+  GLuint vbo = 0;
+  glGenVertexArrays(1, &vao);
+  glBindVertexArray(vao);
+  glGenBuffers(1, &vbo);
+  glBindBuffer(GL_ARRAY_BUFFER, vbo);
+  glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(sphere.size() * sizeof(glm::vec3)), sphere.data(), GL_STATIC_DRAW);
+  for(const auto attribute : {0U, 1U}) { // position and normal
+    glVertexAttribPointer(attribute, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
+    glEnableVertexAttribArray(attribute);
+  }
+  glGenBuffers(1, &scene.uniformBuffer);
+  glBindBuffer(GL_UNIFORM_BUFFER, scene.uniformBuffer);
+  glBufferData(GL_UNIFORM_BUFFER, sizeof(ShadingBlock), nullptr, GL_DYNAMIC_DRAW);
+  glBindBufferBase(GL_UNIFORM_BUFFER, 0, scene.uniformBuffer); // gShadingBinding
+  glEnable(GL_DEPTH_TEST);
+
+  std::size_t failed = 0;
+  {
+    ProgramCache programCache;
+    const auto report = [&failed](const char *pMode, const BenchmarkResult &result) {
+      std::cout << std::left << std::setw(9) << pMode << std::right << std::fixed << std::setprecision(3) << std::setw(4)
+                << result.programs << " programs in " << std::setw(9) << result.buildMs << " ms, submit " << std::setw(8)
+                << result.submitMs << " ms, GPU " << std::setw(8) << result.gpuMs << " ms, " << std::setw(5)
+                << result.switches << " program switches per frame\n";
+      failed += result.failed;
+    };
+    report("uber", Uber(options, scene, programCache));
+    report("variants", Variants(options, scene, programCache));
+  }
+
+  glDeleteBuffers(1, &scene.uniformBuffer);
+  glDeleteBuffers(1, &vbo);
+  glDeleteVertexArrays(1, &vao);
+  if(failed != 0) {
+    std::cerr << failed << " materials failed to build\n";
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}